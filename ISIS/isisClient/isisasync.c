@@ -0,0 +1,509 @@
+//
+// isisasync - ISIS client asynchronous request/reply utilities
+//
+// Contents:
+//   ISISRequest()       - send a request and add it to the pending table
+//   ISISReply()         - match a received message to a pending request
+//   ISISExpire()        - time out overdue pending requests
+//   ISISWaitTime()      - time until the next pending request deadline
+//   ISISCompletion()    - get the next completed request from the queue
+//   ISISPending()       - number of requests in flight
+//   ISISCancel()        - forget a pending request
+//   ISISGetTag()        - strip a correlation tag from a message body
+//   ISISTaggedMessage() - create an IMPv2 message with a correlation tag
+//
+// Date:
+//   2026 October 17
+//
+// Modification History:
+//
+
+/*!
+  \file isisasync.c
+  \brief ISIS client asynchronous request/reply utilities.
+
+  SendToISISServer() is fire-and-forget, so a client that waits for
+  each reply before sending its next command can only have one command
+  in flight at a time.  These functions let a client keep up to
+  #ISIS_MAXPENDING requests outstanding, to any mix of nodes, and
+  match the replies as they come back.
+
+  ISISRequest() sends a request and enters it in a pending request table
+  with an optional deadline.  The client passes every message it reads
+  from its socket to ISISReply() before handling it as usual.  If the
+  message is the DONE:, ERROR:, or FATAL: reply to a pending request,
+  the request is completed and ISISReply() returns 1, otherwise it
+  returns 0 and the client handles the message as before.  STATUS: and
+  WARNING: messages never complete a request.  Requests still pending
+  at their deadline are completed with #ISIS_REPLY_TIMEOUT status by
+  ISISExpire(), and ISISWaitTime() gives a select() timeout that wakes
+  the client in time to call it.
+
+  A completed request is handed to the request's callback function if
+  it has one, otherwise it goes on a completion queue that the client
+  drains with ISISCompletion().
+
+  Replies are matched in one of two ways:
+  <ul>
+  <li>Tagged: a request sent with the #ISIS_TAGGED flag carries a
+      correlation tag, a \#n token at the start of the message body
+      (after the message type keyword, if any):
+      \verbatim M1>IE DONE: #17 TEMP T1=23.5 \endverbatim
+      A tag-aware node strips the tag from a request with ISISGetTag()
+      and echoes it in its reply with ISISTaggedMessage(), and the reply
+      is matched to the request exactly.
+  <li>Untagged: for legacy nodes, which must never be sent tagged
+      requests, an untagged reply is matched to the oldest pending
+      request to that node whose command word it echoes, following the
+      IMPv2 convention that replies start with the command word (a PONG
+      answers a PING).  An ERROR: or FATAL: reply that echoes no pending
+      command goes to the oldest request pending to that node.  The ISIS
+      server's "No Route to Destination Host" error is matched to the
+      unknown node's request.
+  </ul>
+  Tags are only added to requests, so untagged peers see exactly the
+  messages they always have.
+
+  The tables are private to the library and not thread safe, so these
+  functions should all be called from the client's main I/O loop.
+*/
+
+#include "isisclient.h"  // master ISIS client header
+
+//
+// Pending request table.  A free entry has tag 0.  Tags increase
+// monotonically, so the lowest tag is the oldest request.
+//
+
+static struct pending_request {
+  int    tag;                     // correlation tag, 0 if free
+  int    flags;                   // ISISRequest() flags
+  char   destID[ISIS_NODESIZE];   // node the request was sent to
+  char   cmd[SHORT_STR_SIZE];     // command word of the request
+  double sent;                    // SysTimestamp() when sent
+  double deadline;                // SysTimestamp() deadline, 0 if none
+  ISISCallback callback;          // completion callback or NULL
+  void  *arg;                     // callback argument
+} pendTab[ISIS_MAXPENDING];
+
+static int numPending = 0;        // requests in flight
+static int lastTag = 0;           // last tag issued
+
+//
+// Completion queue for requests without callbacks
+//
+
+static isisreply_t compQueue[ISIS_MAXPENDING];
+static int compHead = 0;          // next entry to fill
+static int compTail = 0;          // next entry to return
+static int numQueued = 0;         // completed requests waiting
+
+/*!
+  \brief Copy the first word of a string
+  \param word string to contain the word, at least #SHORT_STR_SIZE characters
+  \param str string to read
+*/
+
+static void
+FirstWord(char *word, char *str)
+{
+  int i = 0;
+
+  while (*str == ' ') str++;
+  while (*str != '\0' && *str != ' ' && *str != '\r' && *str != '\n' &&
+	 i < SHORT_STR_SIZE-1)
+    word[i++] = *str++;
+  word[i] = '\0';
+}
+
+/*!
+  \brief Complete a pending request
+  \param iReq pending request table index
+  \param status completion status, #ISIS_REPLY_DONE, #ISIS_REPLY_ERROR, or
+  #ISIS_REPLY_TIMEOUT
+  \param msgtype message type of the reply
+  \param msgbody reply message body, without the tag
+
+  Removes the request from the pending table, then calls its callback
+  or puts it on the completion queue.  The table entry is freed before
+  the callback runs so that the callback may send new requests.
+*/
+
+static void
+CompleteRequest(int iReq, int status, MsgType msgtype, char *msgbody)
+{
+  struct pending_request *req = &pendTab[iReq];
+  isisreply_t reply;
+  isisreply_t *rp;
+  ISISCallback callback = req->callback;
+
+  rp = (callback != NULL) ? &reply : &compQueue[compHead];
+
+  rp->tag = req->tag;
+  rp->status = status;
+  rp->msgtype = msgtype;
+  strcpy(rp->destID,req->destID);
+  strcpy(rp->cmd,req->cmd);
+  strncpy(rp->body,msgbody,ISIS_MSGSIZE-1);
+  rp->body[ISIS_MSGSIZE-1] = '\0';
+  rp->elapsed = SysTimestamp() - req->sent;
+  rp->arg = req->arg;
+
+  req->tag = 0;
+  numPending--;
+
+  if (callback != NULL)
+    callback(rp);
+  else {
+    compHead = (compHead + 1) % ISIS_MAXPENDING;
+    numQueued++;
+  }
+}
+
+/*!
+  \brief Send a request and add it to the pending request table.
+
+  \param client pointer to an isis_client struct
+  \param destID ISIS node name of the recipient
+  \param msgtype message type, normally #REQ or #EXEC
+  \param msgbody command to send
+  \param flags #ISIS_TAGGED to send a correlation tag, 0 otherwise
+  \param timeout seconds to wait for the reply, 0 to wait forever
+  \param callback function to call when the request completes, or NULL
+  to put the completed request on the completion queue
+  \param arg argument passed to the callback in the reply's arg member
+  \return the request's tag (>0) if sent, -1 if the pending table and
+  completion queue are full or the request could not be sent.
+
+  Only set #ISIS_TAGGED for requests to nodes that understand tags (see
+  ISISGetTag()).  The request is sent with SendToISISServer(), and
+  completes when ISISReply() matches a reply to it or ISISExpire() finds
+  it overdue.
+
+  \sa ISISReply(), ISISCompletion()
+*/
+
+int
+ISISRequest(isisclient_t *client, char *destID, MsgType msgtype, char *msgbody,
+	    int flags, double timeout, ISISCallback callback, void *arg)
+{
+  struct pending_request *req;
+  char *msgstr;
+  int iReq;
+
+  if (numPending + numQueued >= ISIS_MAXPENDING) {
+    errno = ENOBUFS;
+    return -1;
+  }
+
+  for (iReq=0; iReq<ISIS_MAXPENDING; iReq++)
+    if (pendTab[iReq].tag == 0) break;
+  req = &pendTab[iReq];
+
+  if (++lastTag > 999999) lastTag = 1;
+
+  if (flags & ISIS_TAGGED)
+    msgstr = ISISTaggedMessage(client->ID,destID,msgtype,lastTag,msgbody);
+  else
+    msgstr = ISISMessage(client->ID,destID,msgtype,msgbody);
+
+  if (SendToISISServer(client,msgstr) < 0)
+    return -1;
+
+  req->tag = lastTag;
+  req->flags = flags;
+  strncpy(req->destID,destID,ISIS_NODESIZE-1);
+  req->destID[ISIS_NODESIZE-1] = '\0';
+  UpperCase(req->destID);
+  FirstWord(req->cmd,msgbody);
+  req->sent = SysTimestamp();
+  req->deadline = (timeout > 0.0) ? req->sent + timeout : 0.0;
+  req->callback = callback;
+  req->arg = arg;
+  numPending++;
+
+  return req->tag;
+}
+
+/*!
+  \brief Match a received message to a pending request.
+
+  \param client pointer to an isis_client struct
+  \param msgstr raw IMPv2 message received by the client (not modified)
+  \return 1 if the message completed a pending request, 0 if not, in
+  which case the client should handle the message as usual.
+
+  Call this with every message read from the client socket.  A DONE:,
+  ERROR:, or FATAL: reply addressed to this client (or a PONG) completes
+  the pending request it answers, matched by tag or, for untagged
+  replies, by node and command word (see isisasync.c).  Also expires
+  any overdue requests.
+
+  \sa ISISRequest()
+*/
+
+int
+ISISReply(isisclient_t *client, char *msgstr)
+{
+  static char msgcopy[ISIS_MSGSIZE];
+  static char msgbody[ISIS_MSGSIZE];
+  char fromID[SHORT_STR_SIZE];
+  char destID[SHORT_STR_SIZE];
+  char word[SHORT_STR_SIZE];
+  MsgType msgtype;
+  char *p;
+  int status;
+  int tag;
+  int i;
+  int iReq = -1;
+  int iOldest = -1;
+
+  ISISExpire();
+  if (numPending == 0) return 0;
+
+  strncpy(msgcopy,msgstr,ISIS_MSGSIZE-1);
+  msgcopy[ISIS_MSGSIZE-1] = '\0';
+  if (SplitMessage(msgcopy,fromID,destID,&msgtype,msgbody) < 0)
+    return 0;
+  if (strcasecmp(destID,client->ID) != 0) return 0;
+  UpperCase(fromID);
+
+  tag = ISISGetTag(msgbody);
+  FirstWord(word,msgbody);
+  switch (msgtype) {
+  case DONE:
+    status = ISIS_REPLY_DONE;
+    break;
+  case ERROR:
+  case FATAL:
+    status = ISIS_REPLY_ERROR;
+    break;
+  case REQ:
+    if (strcasecmp(word,"PONG") != 0) return 0;
+    strcpy(word,"PING");
+    status = ISIS_REPLY_DONE;
+    break;
+  default:
+    return 0;
+  }
+
+  // Tagged reply: exact match
+
+  if (tag > 0) {
+    for (i=0; i<ISIS_MAXPENDING; i++)
+      if (pendTab[i].tag == tag && strcmp(pendTab[i].destID,fromID) == 0)
+	break;
+    if (i == ISIS_MAXPENDING) return 0;
+    CompleteRequest(i,status,msgtype,msgbody);
+    return 1;
+  }
+
+  // The ISIS server answers a request to an unknown node on its
+  // behalf, so treat its "No Route" error as coming from that node.
+
+  if (status == ISIS_REPLY_ERROR && strcasecmp(fromID,client->isisID) == 0 &&
+      (p = strstr(msgbody,"No Route to Destination Host ")) != NULL) {
+    FirstWord(fromID,p+strlen("No Route to Destination Host "));
+    fromID[ISIS_NODESIZE-1] = '\0';
+    UpperCase(fromID);
+    word[0] = '\0';
+  }
+
+  // Untagged reply: oldest pending request to the sender that it
+  // echoes, else the oldest one if it is an error
+
+  for (i=0; i<ISIS_MAXPENDING; i++) {
+    if (pendTab[i].tag == 0 || strcmp(pendTab[i].destID,fromID) != 0)
+      continue;
+    if (iOldest < 0 || pendTab[i].tag < pendTab[iOldest].tag)
+      iOldest = i;
+    if (strcasecmp(pendTab[i].cmd,word) == 0 &&
+	(iReq < 0 || pendTab[i].tag < pendTab[iReq].tag))
+      iReq = i;
+  }
+  if (iReq < 0 && status == ISIS_REPLY_ERROR)
+    iReq = iOldest;
+  if (iReq < 0) return 0;
+
+  CompleteRequest(iReq,status,msgtype,msgbody);
+  return 1;
+}
+
+/*!
+  \brief Time out overdue pending requests.
+  \return the number of requests timed out.
+
+  Completes every pending request past its deadline with
+  #ISIS_REPLY_TIMEOUT status and a blank reply body.  Called by
+  ISISReply(), and should be called by the client whenever its select()
+  times out (see ISISWaitTime()).
+*/
+
+int
+ISISExpire(void)
+{
+  double now;
+  int numExpired = 0;
+  int i;
+
+  if (numPending == 0) return 0;
+
+  now = SysTimestamp();
+  for (i=0; i<ISIS_MAXPENDING; i++) {
+    if (pendTab[i].tag > 0 && pendTab[i].deadline > 0.0 &&
+	now >= pendTab[i].deadline) {
+      CompleteRequest(i,ISIS_REPLY_TIMEOUT,ERROR,(char *)"");
+      numExpired++;
+    }
+  }
+  return numExpired;
+}
+
+/*!
+  \brief Time until the next pending request deadline.
+  \param tv timeval struct to fill for select(), may be NULL
+  \return milliseconds until the next deadline (0 if one has passed),
+  or -1 if no pending request has a deadline.
+
+  Clients that block in select() or poll() should use this as their
+  timeout while requests are pending, and call ISISExpire() when it
+  runs out.  If there is no deadline the timeval is not changed.
+*/
+
+long
+ISISWaitTime(struct timeval *tv)
+{
+  double next = 0.0;
+  double wait;
+  long msec;
+  int i;
+
+  for (i=0; i<ISIS_MAXPENDING; i++) {
+    if (pendTab[i].tag > 0 && pendTab[i].deadline > 0.0 &&
+	(next == 0.0 || pendTab[i].deadline < next))
+      next = pendTab[i].deadline;
+  }
+  if (next == 0.0) return -1;
+
+  wait = next - SysTimestamp();
+  if (wait < 0.0) wait = 0.0;
+  msec = (long)(1000.0*wait + 0.999);
+  if (tv != NULL) {
+    tv->tv_sec = msec / 1000;
+    tv->tv_usec = 1000 * (msec % 1000);
+  }
+  return msec;
+}
+
+/*!
+  \brief Get the next completed request from the completion queue.
+  \param reply isisreply_t struct to fill
+  \return 1 if a completed request was returned, 0 if the queue is empty.
+
+  Requests sent with a callback never go on the queue.
+*/
+
+int
+ISISCompletion(isisreply_t *reply)
+{
+  if (numQueued == 0) return 0;
+
+  memcpy(reply,&compQueue[compTail],sizeof(isisreply_t));
+  compTail = (compTail + 1) % ISIS_MAXPENDING;
+  numQueued--;
+  return 1;
+}
+
+/*!
+  \brief Number of requests in flight.
+  \return the number of requests sent with ISISRequest() that have not
+  completed yet.
+*/
+
+int
+ISISPending(void)
+{
+  return numPending;
+}
+
+/*!
+  \brief Forget a pending request.
+  \param tag tag of the request, as returned by ISISRequest()
+  \return 0 if the request was pending, -1 if not.
+
+  The request is dropped without calling its callback.  A reply that
+  arrives later is not consumed by ISISReply().
+*/
+
+int
+ISISCancel(int tag)
+{
+  int i;
+
+  for (i=0; i<ISIS_MAXPENDING; i++) {
+    if (tag > 0 && pendTab[i].tag == tag) {
+      pendTab[i].tag = 0;
+      numPending--;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/*!
+  \brief Strip a correlation tag from a message body.
+  \param msgbody message body from SplitMessage(), modified in place
+  \return the tag, or 0 if the body has no tag.
+
+  Tag-aware nodes call this on the body of each request they receive,
+  and echo a non-zero tag in their reply with ISISTaggedMessage().  A
+  tag is a \#n token, n a positive integer, at the start of the body.
+*/
+
+int
+ISISGetTag(char *msgbody)
+{
+  char *p = msgbody;
+  int tag = 0;
+
+  while (*p == ' ') p++;
+  if (*p != '#' || !isdigit(p[1])) return 0;
+
+  for (p++; isdigit(*p); p++)
+    tag = 10*tag + (*p - '0');
+  if (*p != ' ' && *p != '\0') return 0;
+
+  while (*p == ' ') p++;
+  memmove(msgbody,p,strlen(p)+1);
+  return tag;
+}
+
+/*!
+  \brief Create an IMPv2 message string with a correlation tag.
+
+  \param fromID ISIS node name of the client application
+  \param destID ISIS node name of the intended recipient
+  \param msgtype IMPv2 message type code (see #IMPv2_MsgType)
+  \param tag correlation tag, or 0 for none
+  \param msgbody Body of the message to create
+  \return a character pointer to the message string.
+
+  Same as ISISMessage(), with the tag inserted at the start of the
+  message body if it is non-zero.  Tag-aware nodes use this to reply
+  to a tagged request.
+
+  \sa ISISGetTag()
+*/
+
+char *
+ISISTaggedMessage(char *fromID, char *destID, MsgType msgtype, int tag,
+		  char *msgbody)
+{
+  static char tagbody[ISIS_MSGSIZE];
+
+  if (tag <= 0)
+    return ISISMessage(fromID,destID,msgtype,msgbody);
+
+  snprintf(tagbody,sizeof(tagbody)-16,"#%d %s",tag,msgbody);
+  return ISISMessage(fromID,destID,msgtype,tagbody);
+}
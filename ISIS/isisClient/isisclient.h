@@ -11,9 +11,11 @@
   to create ISIS client applications.  These include
 
   <ul>
-  <li>IMPv2 message handling functions (isismessage.c)
-  <li>UDP Socket I/O functions (isissocket.c)
+  <li>IMPv2 message handling and command tokenizing functions (isismessage.c)
+  <li>UDP and Unix-domain Socket I/O functions (isissocket.c)
   <li>Serial Port I/O functions (isisserial.c)
+  <li>Asynchronous request/reply functions (isisasync.c)
+  <li>Outbound STATUS message coalescing (isisstatus.c)
   <li>Common client string handling and time utilities (isisutils.c)
   </ul>
 
@@ -47,6 +49,11 @@
               runtime configuration tables for all client applications. [rwp/osu]
 2004 Jul 22 - Overhauled API (v2.0) to correct various problems that emerged
               during testing, and eliminated much clumsiness in v1.x [rwp/osu]
+2026 Oct 17 - Optional Unix-domain datagram socket to a same-host ISIS
+              server (isisSocket)
+2026 Oct 17 - Pipelined requests with reply correlation (isisasync.c)
+2026 Oct 17 - Single-pass message body tokenizer ISISTokenize()
+2026 Oct 17 - Optional outbound STATUS coalescing (isisstatus.c)
 </pre>
 */
 
@@ -59,11 +66,13 @@
   which encapsulates all of the various bits a client needs to become a
   basic ISIS client application.
 
-  The main client library is divided into 4 modules:
+  The main client library is divided into 6 modules:
   
-  \arg \c isismessage.c IMPv2 message handling routines
+  \arg \c isismessage.c IMPv2 message handling and tokenizing routines
   \arg \c isissocket.c ISIS UDP socket I/O handling routines
   \arg \c isisserial.c Serial port I/O handling routines 
+  \arg \c isisasync.c Asynchronous request/reply routines
+  \arg \c isisstatus.c Outbound STATUS message coalescing routines
   \arg \c isisutils.c Handy client application utilties (string and time handling)
 
 */
@@ -72,6 +81,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <unistd.h>
 #include <ctype.h>
 #include <string.h>
@@ -89,6 +99,7 @@
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/types.h> 
+#include <sys/un.h>
 #include <netdb.h>
 
 // Global definitions common to all ISIS client applications
@@ -124,12 +135,15 @@ typedef struct client_info
   char   isisHost[MED_STR_SIZE];   //!< ISIS server's hostname
   int    isisPort;                 //!< ISIS server's socket port
   sockaddr_in isisAddr;            //!< ISIS server's network socket address database
+  char   isisSocket[MED_STR_SIZE]; //!< ISIS server's Unix-domain socket path, blank to use UDP
+  sockaddr_un isisLocal;           //!< ISIS server's Unix-domain socket address
 
   // ISIS client info
   int    FD;                       //!< Client socket file descriptor  
   char   ID[ISIS_NODESIZE];        //!< Client Node ID (IMPv2 style)      
   char   Host[MED_STR_SIZE];       //!< Client hostname (localhost)
   int    Port;                     //!< Client socket port              
+  char   sockPath[MED_STR_SIZE];   //!< Client Unix-domain socket path, blank if using UDP
 
   // Remote client info (for STANDALONE mode)
   char   remHost[MED_STR_SIZE];    //!< hostname of a remote socket host
@@ -179,6 +193,75 @@ enum IMPv2_MsgType {
 
 typedef enum IMPv2_MsgType MsgType;
 
+//----------------------------------------------------------------
+//
+// isis_reply: completed asynchronous request (see isisasync.c)
+//
+
+#define ISIS_MAXPENDING  64  //!< Maximum number of asynchronous requests in flight
+#define ISIS_TAGGED       1  //!< ISISRequest() flag: send a correlation tag (tag-aware nodes only)
+#define ISIS_MAXHELD     16  //!< Maximum number of destinations with STATUS messages held for coalescing
+
+#define ISIS_REPLY_DONE     0  //!< Request completed with a DONE: reply (or PONG)
+#define ISIS_REPLY_ERROR   -1  //!< Request completed with an ERROR: or FATAL: reply
+#define ISIS_REPLY_TIMEOUT -2  //!< No reply before the request's deadline
+
+/*!
+  \brief Completed asynchronous request
+
+  Passed to the request's callback, or returned by ISISCompletion(),
+  when a request sent with ISISRequest() completes.
+*/
+
+typedef struct isis_reply
+{
+  int     tag;                     //!< Request tag returned by ISISRequest()
+  int     status;                  //!< #ISIS_REPLY_DONE, #ISIS_REPLY_ERROR, or #ISIS_REPLY_TIMEOUT
+  MsgType msgtype;                 //!< Message type of the reply
+  char    destID[ISIS_NODESIZE];   //!< Node the request was sent to
+  char    cmd[SHORT_STR_SIZE];     //!< Command word of the request
+  char    body[ISIS_MSGSIZE];      //!< Reply message body, without the tag (blank on timeout)
+  double  elapsed;                 //!< Seconds from sending the request to completion
+  void   *arg;                     //!< Argument given to ISISRequest()
+} isisreply_t;
+
+typedef void (*ISISCallback)(isisreply_t *);  //!< Request completion callback
+
+//----------------------------------------------------------------
+//
+// isis_args: tokenized message body (see ISISTokenize())
+//
+
+#define ISIS_MAXARGS 32  //!< Maximum number of arguments kept by ISISTokenize()
+
+/*!
+  \brief View of a token in a string
+
+  Points into the tokenized string and is not NUL-terminated.
+*/
+
+typedef struct isis_view
+{
+  char *str;   //!< Start of the token
+  int   len;   //!< Length of the token in characters
+} isisview_t;
+
+/*!
+  \brief Tokenized message body
+
+  Filled by ISISTokenize() in a single pass without copying or
+  modifying the string.
+*/
+
+typedef struct isis_args
+{
+  int        argc;               //!< Number of arguments
+  isisview_t argv[ISIS_MAXARGS]; //!< All whitespace-delimited arguments in order
+  int        nkeys;              //!< Number of keyword=value pairs
+  isisview_t key[ISIS_MAXARGS];  //!< Keywords
+  isisview_t val[ISIS_MAXARGS];  //!< Keyword values without quotes or ()s
+} isisargs_t;
+
 //----------------------------------------------------------------
 //
 // isisclient Function Prototypes 
@@ -189,6 +272,11 @@ typedef enum IMPv2_MsgType MsgType;
 char *ISISMessage(char *fromID, char *destID, MsgType msgtype, char *msgbody);
 int SplitMessage(char *msgstr, char *fromID, char *destID, 
                  MsgType *msgtype, char *msgbody);
+int  ISISTokenize(char *, isisargs_t *);
+char *ISISArgTail(isisargs_t *, int);
+int  ISISArgEq(isisview_t, const char *);
+char *ISISArgCopy(isisview_t, char *, int);
+isisview_t *ISISGetKey(isisargs_t *, const char *);
 
 // isissocket function prototypes
 
@@ -199,6 +287,26 @@ int  SendToISISServer(isisclient_t *, char *);
 int  ReplyToRemHost(isisclient_t *, char *);
 void CloseClientSocket(isisclient_t *); 
 
+// isisasync function prototypes
+
+int  ISISRequest(isisclient_t *, char *, MsgType, char *, int, double,
+                 ISISCallback, void *);
+int  ISISReply(isisclient_t *, char *);
+int  ISISExpire(void);
+long ISISWaitTime(struct timeval *);
+int  ISISCompletion(isisreply_t *);
+int  ISISPending(void);
+int  ISISCancel(int);
+int  ISISGetTag(char *);
+char *ISISTaggedMessage(char *, char *, MsgType, int, char *);
+
+// isisstatus function prototypes
+
+void ISISStatusWindow(double);
+int  ISISStatusQueue(isisclient_t *, char *);
+int  ISISStatusFlush(int);
+long ISISStatusWaitTime(struct timeval *);
+
 // isisserial function prototypes
 
 int  OpenSerialPort(char *);
@@ -4,6 +4,14 @@
 // Contents:
 //   int SplitMessage()  - decompose/validate a raw ISIS message
 //   char *ISISMessage() - create an ISIS message string
+//   int ISISTokenize()  - split a message body into args and keyword=value pairs
+//   char *ISISArgTail() - the rest of a tokenized string from an argument on
+//   int ISISArgEq()     - compare an argument to a string
+//   char *ISISArgCopy() - copy an argument into a string
+//   isisview_t *ISISGetKey() - look up the value of a keyword
+//
+// Modification History:
+//   2026 Oct 17 - added the single-pass ISISTokenize() parser
 // 
 
 #include "isisclient.h"  // master ISIS client header
@@ -277,3 +285,189 @@ char
 
 }
 
+
+/*!
+  \brief Split a message body into arguments and keyword=value pairs.
+
+  \param str String to tokenize, usually a message body from SplitMessage()
+  \param args isisargs_t struct to fill with views of the tokens
+  \return the number of arguments found (args->argc).
+
+  Makes a single pass over \p str and records each token as a view, a
+  pointer into \p str and a length, so nothing is copied and \p str is
+  not modified.  Every whitespace-delimited token goes into args->argv[]
+  in order, so for a command body argv[0] is the command word and
+  ISISArgTail(args,1) is the argument string the cmd_xxx() functions
+  expect.  Tokens beyond #ISIS_MAXARGS are ignored.
+
+  Tokens of the form keyword=value are also entered in args->key[] and
+  args->val[], following the same rules as the getKeys() method used
+  by the GUIs:
+  \verbatim
+    keyword=value                   single-word value
+    keyword='words with spaces'     multi-word value, quotes removed
+    keyword=(words with spaces)     old-style multi-word value, ()s removed
+    keyword=(1,2,3,4)               list, ()s removed
+    +keyword                        same as keyword=T (old-style)
+    -keyword                        same as keyword=F (old-style)
+  \endverbatim
+  A multi-word value runs to the first word ending in the closing quote
+  or ), or to the end of the string, and the whole keyword='...' is one
+  token in argv[].  A +/- token is only a boolean keyword if the next
+  character is a letter, so negative numbers stay ordinary arguments.
+
+  Views are not NUL-terminated; use ISISArgEq(), ISISArgCopy(), or
+  ISISArgTail() to work with them.  They are only valid as long as
+  \p str is.
+
+  \sa ISISGetKey()
+*/
+
+int
+ISISTokenize(char *str, isisargs_t *args)
+{
+  static char trueStr[] = "T";
+  static char falseStr[] = "F";
+  char *p = str;
+  char *tok;
+  char *eq;
+  char close;
+  int n;
+
+  args->argc = 0;
+  args->nkeys = 0;
+  if (str == NULL) return 0;
+
+  while (args->argc < ISIS_MAXARGS) {
+
+    // skip whitespace to the start of the next token
+
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+    if (*p == '\0') break;
+    tok = p;
+    eq = NULL;
+
+    // scan to the end of the token, noting the first =
+
+    while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+      if (*p == '=' && eq == NULL) eq = p;
+      p++;
+    }
+
+    // keyword=value, which may continue past the first word if quoted
+
+    if (eq != NULL && eq > tok && args->nkeys < ISIS_MAXARGS) {
+      n = args->nkeys++;
+      args->key[n].str = tok;
+      args->key[n].len = (int)(eq - tok);
+      args->val[n].str = eq + 1;
+      args->val[n].len = (int)(p - eq - 1);
+
+      close = (eq[1] == '\'') ? '\'' : (eq[1] == '(') ? ')' : '\0';
+      if (close != '\0') {
+	args->val[n].str++;
+	while (p - eq > 2 && p[-1] != close && *p != '\0') {
+	  while (*p != '\0' && p[-1] != close) p++;
+	  while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r' &&
+		 *p != '\n') p++;
+	}
+	args->val[n].len = (int)(p - args->val[n].str);
+	if (args->val[n].len > 0 && p[-1] == close && p - eq > 2)
+	  args->val[n].len--;
+	if (args->val[n].len < 0) args->val[n].len = 0;
+      }
+    }
+
+    // +keyword or -keyword booleans
+
+    else if ((tok[0] == '+' || tok[0] == '-') && isalpha(tok[1]) &&
+	     args->nkeys < ISIS_MAXARGS) {
+      n = args->nkeys++;
+      args->key[n].str = tok + 1;
+      args->key[n].len = (int)(p - tok - 1);
+      args->val[n].str = (tok[0] == '+') ? trueStr : falseStr;
+      args->val[n].len = 1;
+    }
+
+    args->argv[args->argc].str = tok;
+    args->argv[args->argc].len = (int)(p - tok);
+    args->argc++;
+  }
+
+  return args->argc;
+}
+
+/*!
+  \brief The rest of a tokenized string from an argument on.
+
+  \param args isisargs_t struct filled by ISISTokenize()
+  \param n index of the first argument wanted
+  \return a pointer into the tokenized string at argument \p n, or to
+  an empty string if there are fewer than n+1 arguments.
+
+  The tail is an ordinary NUL-terminated string.  ISISArgTail(args,1)
+  is everything after the command word.
+*/
+
+char *
+ISISArgTail(isisargs_t *args, int n)
+{
+  static char emptyStr[] = "";
+
+  if (n < 0 || n >= args->argc) return emptyStr;
+  return args->argv[n].str;
+}
+
+/*!
+  \brief Compare an argument to a string, ignoring case.
+
+  \param arg argument view from ISISTokenize()
+  \param str string to compare it to
+  \return 1 if the argument and string are the same, 0 if not.
+*/
+
+int
+ISISArgEq(isisview_t arg, const char *str)
+{
+  return (strncasecmp(arg.str,str,arg.len) == 0 && str[arg.len] == '\0');
+}
+
+/*!
+  \brief Copy an argument into a string.
+
+  \param arg argument view from ISISTokenize()
+  \param buf string to contain the argument
+  \param size size of \p buf, the argument is truncated to fit
+  \return \p buf, so the copy may be used in expressions.
+*/
+
+char *
+ISISArgCopy(isisview_t arg, char *buf, int size)
+{
+  int len = (arg.len < size) ? arg.len : size-1;
+
+  if (len > 0) memcpy(buf,arg.str,len);
+  if (len < 0) len = 0;
+  buf[len] = '\0';
+  return buf;
+}
+
+/*!
+  \brief Look up the value of a keyword.
+
+  \param args isisargs_t struct filled by ISISTokenize()
+  \param key keyword to look up, case-insensitive
+  \return a pointer to the view of the keyword's value, or NULL if the
+  keyword is not present.  If a keyword appears more than once the last
+  value is returned, as with getKeys().
+*/
+
+isisview_t *
+ISISGetKey(isisargs_t *args, const char *key)
+{
+  int i;
+
+  for (i=args->nkeys-1; i>=0; i--)
+    if (ISISArgEq(args->key[i],key)) return &args->val[i];
+  return NULL;
+}
@@ -18,6 +18,11 @@
 //   pogge@astronomy.ohio-state.edu
 //   2003 September 10
 //
+// Modification History:
+//   2026 Oct 17 - optional Unix-domain datagram socket to a same-host
+//                 ISIS server (isisSocket)
+//   2026 Oct 17 - SendToISISServer() holds STATUS: messages for
+//                 coalescing if enabled (isisstatus.c)
 //
 
 /*!
@@ -42,6 +47,16 @@
   Similarly, we also build a sockaddr_in struct inside of isisclient
   when we receive data from a remote non-ISIS client.
 
+  Clients running on the same host as the ISIS server can skip the
+  UDP/IP stack entirely by setting isisSocket to the path of the
+  server's Unix-domain datagram socket (the server's LocalSocket, e.g.,
+  with an ISISSocket entry in the client's runtime config file).  The
+  client socket is then bound to isisSocket.ID (e.g.,
+  /tmp/isis.IS.M1.IE), and all traffic with the server goes through it.
+  A leading @ names an abstract (Linux) socket instead of a file.
+  Nothing else changes for the application, and clients on other hosts
+  keep using UDP.  Standalone (non-ISIS) clients always use UDP.
+
   \author R. Pogge, OSU Astronomy Dept. (pogge@astronomy.ohio-state.edu)
   \date 2003 September 10
 
@@ -50,6 +65,44 @@
 
 #include "isisclient.h" // ISIS client master header file
 
+/*!
+  \brief Length of a Unix-domain socket address
+  \param path socket path, a leading @ means an abstract socket
+  \return length of the address to pass to bind() or sendto()
+
+  Abstract socket names are not NUL terminated, so their address length
+  must be exact.
+*/
+
+static socklen_t
+LocalSocketLen(char *path)
+{
+  if (path[0] == '@')
+    return (socklen_t)(offsetof(struct sockaddr_un,sun_path) + strlen(path));
+  return (socklen_t)sizeof(struct sockaddr_un);
+}
+
+/*!
+  \brief Build a Unix-domain socket address
+  \param addr sockaddr_un struct to fill
+  \param path socket path, a leading @ means an abstract socket
+  \return length of the address to pass to bind() or sendto(), or 0
+  if the path is blank or too long.
+*/
+
+static socklen_t
+LocalSocketAddr(struct sockaddr_un *addr, char *path)
+{
+  memset(addr,0,sizeof(struct sockaddr_un));
+  if (strlen(path) == 0 || strlen(path) >= sizeof(addr->sun_path))
+    return 0;
+
+  addr->sun_family = AF_UNIX;
+  strcpy(addr->sun_path,path);
+  if (path[0] == '@') addr->sun_path[0] = '\0';
+  return LocalSocketLen(path);
+}
+
 /*!
   \brief Initialize the ISIS server address information database.
 
@@ -57,7 +110,10 @@
   \return 0 if successful, -1 if cannot resolve the server hostname
 
   Uses the information in client->isisHost and client->isisPort to setup
-  the network socket communications database for an ISIS server.
+  the network socket communications database for an ISIS server.  If
+  client->isisSocket is set, it also sets up the address of the
+  server's Unix-domain socket, used instead of UDP by OpenClientSocket()
+  and SendToISISServer().
 
   To communicate with an active ISIS server, a client application needs
   to build a socket address database (sockaddr_in struct) with the
@@ -90,6 +146,15 @@ InitISISServer(isisclient_t *client)
   client->isisAddr.sin_family = AF_INET;
   memcpy(&client->isisAddr.sin_addr,host->h_addr, host->h_length);
 
+  // Setup the server's Unix-domain socket address if using it
+
+  if (strlen(client->isisSocket) > 0 &&
+      LocalSocketAddr(&client->isisLocal,client->isisSocket) == 0) {
+    printf("ERROR(InitISISServer): invalid ISIS server socket path %s, using UDP\n",
+	   client->isisSocket);
+    strcpy(client->isisSocket,"");
+  }
+
   return 0;
 
 }
@@ -111,6 +176,13 @@ InitISISServer(isisclient_t *client)
   database.  This way we do not need to regenerate the database each
   time we read the socket.
 
+  If client->useISIS is set and client->isisSocket names the ISIS
+  server's Unix-domain socket (see InitISISServer()), a Unix-domain
+  datagram socket bound to isisSocket.ID (client->sockPath) is opened
+  instead, and Port is not used.  Any stale socket file left at that
+  path by an earlier run is removed first.  If the Unix-domain socket
+  cannot be opened, it falls back to UDP.
+
   If port=0 (deprecated), it assigns the client the next free port.
   Technically this is allowed, and the standard ISIS server will
   know how to route messages to this client, but if the client is
@@ -125,11 +197,42 @@ OpenClientSocket(isisclient_t *client)
 {
   struct sockaddr_in cls;
   int cls_len;
+  struct sockaddr_un local;
+  socklen_t local_len;
 
   // If the socket is already open, close it as a precaution
 
   CloseClientSocket(client);
 
+  // Same-host ISIS server: open a Unix-domain datagram socket
+
+  if (client->useISIS && strlen(client->isisSocket) > 0) {
+    snprintf(client->sockPath,sizeof(client->sockPath),"%s.%s",
+	     client->isisSocket,client->ID);
+    if ((local_len=LocalSocketAddr(&local,client->sockPath)) == 0) {
+      printf("ERROR(OpenClientSocket): invalid client socket path %s, using UDP\n",
+	     client->sockPath);
+    }
+    else if ((client->FD=socket(AF_UNIX,SOCK_DGRAM,0)) < 0) {
+      printf("ERROR(OpenClientSocket): Cannot open client local socket - %s, using UDP\n",
+	     strerror(errno));
+    }
+    else {
+      if (client->sockPath[0] != '@')
+	unlink(client->sockPath);
+      if (bind(client->FD, (struct sockaddr *) &local, local_len) == 0) {
+	if (client->sockPath[0] != '@')
+	  chmod(client->sockPath,0666);
+	return 0;
+      }
+      printf("ERROR(OpenClientSocket): Cannot bind client local socket %s - %s, using UDP\n",
+	     client->sockPath,strerror(errno));
+      close(client->FD);
+    }
+    client->FD = -1;
+    strcpy(client->sockPath,"");
+  }
+
   // Open a datagram (UDP) socket 
 
   if ((client->FD=socket(AF_INET,SOCK_DGRAM,0)) < 0 ) {
@@ -195,7 +298,9 @@ OpenClientSocket(isisclient_t *client)
   directly if the application is a "standalone" client.  If instead the
   application is an ISIS client, it should send any replies back to the
   ISIS server (see InitISISServer() and SendToISISServer() functions).
-  hostname is returned as an unresolved IP address.
+  hostname is returned as an unresolved IP address.  On a Unix-domain
+  socket the sender can only be the ISIS server, so remHost is set
+  to the server's socket path and remPort to 0.
 
   \sa SendToISISServer(), ReplyToRemHost()
 */
@@ -217,6 +322,19 @@ ReadClientSocket(isisclient_t *client, char *msgstr)
   // Clear the incoming messge string
 
   memset(msgstr,0,ISIS_MSGSIZE);
+
+  // Unix-domain socket: the message is from the ISIS server
+
+  if (strlen(client->sockPath) > 0) {
+    nread = recv(client->FD, msgstr, ISIS_MSGSIZE, 0);
+    if (nread < 0)
+      printf("ERROR(ReadClientSocket): local socket recv() error - %s\n",
+	     strerror(errno));
+    client->remPort = 0;
+    strcpy(client->remHost,client->isisSocket);
+    return nread;
+  }
+
   rem_len = sizeof(client->remAddr);
 
   // Read the socket port with recvfrom()
@@ -254,6 +372,10 @@ ReadClientSocket(isisclient_t *client, char *msgstr)
   msgstr is a well-formed and properly terminated IMPv2 protocol message
   string (see ISISMessage()).
 
+  If the client has set a STATUS coalescing window with
+  ISISStatusWindow(), STATUS: messages may be held briefly and merged
+  (see isisstatus.c), in which case the full length is returned.
+
   The ISIS server address database must have been initialized by calling
   InitISISServer().  The ISISserver sockaddr_in struct is defined in
   global scope in the isissocket.h header file.
@@ -277,9 +399,19 @@ SendToISISServer(isisclient_t *client, char *msgstr)
     return -1;
   }
 
-  nsent = sendto(client->FD,msgstr,strlen(msgstr),0,
-		 (struct sockaddr *) &client->isisAddr, 
-		 sizeof(client->isisAddr));
+  // Hold STATUS: messages if the client asked for coalescing
+
+  if (ISISStatusQueue(client,msgstr))
+    return strlen(msgstr);
+
+  if (strlen(client->sockPath) > 0)
+    nsent = sendto(client->FD,msgstr,strlen(msgstr),0,
+		   (struct sockaddr *) &client->isisLocal, 
+		   LocalSocketLen(client->isisSocket));
+  else
+    nsent = sendto(client->FD,msgstr,strlen(msgstr),0,
+		   (struct sockaddr *) &client->isisAddr, 
+		   sizeof(client->isisAddr));
 
   if (nsent < 0)
     printf("ERROR(SendToISISServer): network socket sendto() error - %s\n",
@@ -323,6 +455,11 @@ ReplyToRemHost(isisclient_t *client, char *msgstr)
     return -1;
   }
 
+  // On a Unix-domain socket the only host we hear from is the server
+
+  if (strlen(client->sockPath) > 0)
+    return SendToISISServer(client,msgstr);
+
   // We assume that the message is going back to the last remote host we
   // heard from.  Since standalone clients are supposed to be
   // synchronous, this is a valid assumption.
@@ -344,9 +481,8 @@ ReplyToRemHost(isisclient_t *client, char *msgstr)
 
   \param client Pointer to an isisclient struct
 
-  Closes the ISIS client socket opened with OpenClientSocket().  While
-  currently very simple, in the future it could perform other
-  teardown tasks as required.
+  Closes the ISIS client socket opened with OpenClientSocket(), and
+  removes the socket file if it was a Unix-domain socket.
 
   \sa OpenClientSocket()
 */
@@ -357,5 +493,8 @@ CloseClientSocket(isisclient_t *client)
   if (client->FD > 0)
     close(client->FD);
   client->FD = -1;
+  if (strlen(client->sockPath) > 0 && client->sockPath[0] != '@')
+    unlink(client->sockPath);
+  strcpy(client->sockPath,"");
 }
   
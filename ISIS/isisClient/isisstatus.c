@@ -0,0 +1,379 @@
+//
+// isisstatus - ISIS client outbound STATUS message coalescing
+//
+// Contents:
+//   ISISStatusWindow()   - set the STATUS coalescing window
+//   ISISStatusQueue()    - hold a STATUS message for coalescing
+//   ISISStatusFlush()    - send held STATUS messages
+//   ISISStatusWaitTime() - time until the next held message is due
+//
+// Date:
+//   2026 October 17
+//
+// Modification History:
+//
+
+/*!
+  \file isisstatus.c
+  \brief ISIS client outbound STATUS message coalescing.
+
+  Agents that report progress, like a CCD readout, can send bursts of
+  small STATUS: messages that each cost the ISIS server and every GUI
+  downstream a datagram to handle.  If a client opts in by setting a
+  coalescing window with ISISStatusWindow(), SendToISISServer() passes
+  outgoing STATUS: messages to ISISStatusQueue() instead of sending them
+  at once.  Messages to the same destination received within the window
+  are merged into one, keeping only the latest value of each keyword:
+  \verbatim
+    M1.BC>IE STATUS: GO Readout PCTREAD=10 EXPSTATUS=READOUT
+    M1.BC>IE STATUS: GO Readout PCTREAD=20 EXPSTATUS=READOUT
+  \endverbatim
+  goes out as the second message only, at the end of the window.
+  Keywords are combined in the order they were first seen, and any
+  free text (words that are not keyword=value pairs) is taken from the
+  latest message.  STATUS: messages without keywords are not merged.
+
+  Any other message type (DONE:, ERROR:, FATAL:, requests, etc.) first
+  flushes everything being held and is then sent at once, so messages
+  keep their order.  The IMPv2 protocol is unchanged: receivers see
+  ordinary STATUS: messages, just fewer of them.
+
+  The client calls ISISStatusFlush() from its main I/O loop to send
+  messages whose window has expired, using ISISStatusWaitTime() to set
+  its select() timeout.  Like the asynchronous request table, the
+  coalescing table is private to the library and not thread safe.
+*/
+
+#include "isisclient.h"  // master ISIS client header
+
+//
+// Coalescing table, one entry per destination being held.  A free
+// entry has an empty header.
+//
+
+static struct held_status {
+  char   hdr[2*ISIS_NODESIZE+2];  // "fromID>destID" address header
+  char   body[ISIS_MSGSIZE];      // merged message body
+  double due;                     // SysTimestamp() when it must be sent
+  isisclient_t *client;           // client to send it with
+} heldTab[ISIS_MAXHELD];
+
+static int    numHeld = 0;        // entries in use
+static double holdWindow = 0.0;   // coalescing window in seconds, 0=off
+static int    inFlush = 0;        // set while flushing, sends pass through
+
+/*!
+  \brief Is argument i a keyword=value or +/-keyword token?
+  \param args tokenized message body
+  \param i argument index
+  \param ikey index of the next keyword to check, advanced on a match
+  \return 1 if a keyword, 0 if free text.
+
+  Keywords are entered by ISISTokenize() in argument order, so only the
+  next unmatched keyword need be checked.
+*/
+
+static int
+IsKeyArg(isisargs_t *args, int i, int *ikey)
+{
+  char *kp;
+
+  if (*ikey >= args->nkeys) return 0;
+  kp = args->key[*ikey].str;
+  if (kp == args->argv[i].str || kp == args->argv[i].str+1) {
+    (*ikey)++;
+    return 1;
+  }
+  return 0;
+}
+
+/*!
+  \brief Append a token to a message body
+  \param body body being built
+  \param len current length of body, updated
+  \param ntok number of tokens in body, updated
+  \param tok token to append
+  \return 0 if it fit, -1 if the body would be too long or have too
+  many tokens for ISISTokenize() to see them all.
+*/
+
+static int
+AddToken(char *body, int *len, int *ntok, isisview_t tok)
+{
+  if (*len + tok.len + 2 >= ISIS_MSGSIZE-2*ISIS_NODESIZE-16) return -1;
+  if (++(*ntok) >= ISIS_MAXARGS) return -1;
+  if (*len > 0) body[(*len)++] = ' ';
+  memcpy(&body[*len],tok.str,tok.len);
+  *len += tok.len;
+  body[*len] = '\0';
+  return 0;
+}
+
+/*!
+  \brief Merge a new STATUS message body into a held one
+  \param held body held so far, replaced by the merged body
+  \param oldArgs tokenized held body
+  \param newArgs tokenized new body
+  \return 0 if merged, -1 if the merged body would be too long.
+
+  The merge works from the ISISTokenize() arguments, which stop at
+  #ISIS_MAXARGS, so it refuses a body that has that many, and never
+  builds one that has that many, rather than drop the tokens past the
+  limit.
+*/
+
+static int
+MergeStatus(char *held, isisargs_t *oldArgs, isisargs_t *newArgs)
+{
+  char body[ISIS_MSGSIZE];
+  isisargs_t *textArgs;
+  int keyArg[ISIS_MAXARGS];  // argv index of each new keyword
+  int used[ISIS_MAXARGS];    // new keyword already merged?
+  int len = 0;
+  int ntok = 0;
+  int ikey;
+  int i, j;
+
+  if (oldArgs->argc >= ISIS_MAXARGS || newArgs->argc >= ISIS_MAXARGS)
+    return -1;
+
+  for (i=0, ikey=0; i<newArgs->argc; i++)
+    if (IsKeyArg(newArgs,i,&ikey)) {
+      keyArg[ikey-1] = i;
+      used[ikey-1] = 0;
+    }
+
+  // Free text from the latest message, or the held one if it has none
+
+  textArgs = (newArgs->argc > newArgs->nkeys) ? newArgs : oldArgs;
+  for (i=0, ikey=0; i<textArgs->argc; i++)
+    if (!IsKeyArg(textArgs,i,&ikey))
+      if (AddToken(body,&len,&ntok,textArgs->argv[i]) < 0) return -1;
+
+  // Held keywords in order, with the latest value if updated
+
+  for (i=0, ikey=0; i<oldArgs->argc; i++) {
+    if (!IsKeyArg(oldArgs,i,&ikey)) continue;
+    for (j=newArgs->nkeys-1; j>=0; j--)
+      if (newArgs->key[j].len == oldArgs->key[ikey-1].len &&
+	  strncasecmp(newArgs->key[j].str,oldArgs->key[ikey-1].str,
+		      newArgs->key[j].len) == 0) break;
+    if (j < 0) {
+      if (AddToken(body,&len,&ntok,oldArgs->argv[i]) < 0) return -1;
+    }
+    else if (!used[j]) {
+      if (AddToken(body,&len,&ntok,newArgs->argv[keyArg[j]]) < 0) return -1;
+      used[j] = 1;
+    }
+  }
+
+  // Then any new keywords
+
+  for (j=0; j<newArgs->nkeys; j++)
+    if (!used[j])
+      if (AddToken(body,&len,&ntok,newArgs->argv[keyArg[j]]) < 0) return -1;
+
+  strcpy(held,body);
+  return 0;
+}
+
+/*!
+  \brief Send a held STATUS message and free its table entry
+  \param i coalescing table index
+*/
+
+static void
+SendHeld(int i)
+{
+  char fromID[ISIS_NODESIZE];
+  char destID[ISIS_NODESIZE];
+  struct held_status *hp = &heldTab[i];
+
+  if (hp->hdr[0] == '\0') return;
+
+  memset(fromID,0,sizeof(fromID));
+  memset(destID,0,sizeof(destID));
+  sscanf(hp->hdr,"%8[^>]>%8s",fromID,destID);
+
+  inFlush = 1;
+  SendToISISServer(hp->client,ISISMessage(fromID,destID,STATUS,hp->body));
+  inFlush = 0;
+
+  hp->hdr[0] = '\0';
+  numHeld--;
+}
+
+/*!
+  \brief Set the STATUS coalescing window.
+
+  \param window coalescing window in seconds, 0 to disable coalescing
+
+  Coalescing is off until a client calls this function.  A window of
+  0.05 (50 ms) is enough to merge readout progress bursts without
+  delaying them noticeably.  Disabling coalescing sends any messages
+  still being held.
+*/
+
+void
+ISISStatusWindow(double window)
+{
+  if (window <= 0.0) {
+    ISISStatusFlush(1);
+    window = 0.0;
+  }
+  holdWindow = window;
+}
+
+/*!
+  \brief Hold a STATUS message for coalescing.
+
+  \param client Pointer to an isisclient struct
+  \param msgstr IMPv2 message string about to be sent
+  \return 1 if the message was held and must not be sent now, 0 if it
+  should be sent now.
+
+  Called by SendToISISServer() for every outgoing message while a
+  coalescing window is set; clients do not normally call it directly.
+  A STATUS: message with at least one keyword is merged into the one
+  being held for its destination, if any, or starts a new window.  Any
+  other message, or a STATUS: message with #ISIS_MAXARGS or more
+  tokens that ISISTokenize() cannot see all of, flushes all held
+  messages first so that it is not sent ahead of them, and is sent at
+  once, unmerged.  \p msgstr is not modified.
+
+  \sa ISISStatusWindow(), ISISStatusFlush()
+*/
+
+int
+ISISStatusQueue(isisclient_t *client, char *msgstr)
+{
+  char msgcopy[ISIS_MSGSIZE];
+  char fromID[ISIS_NODESIZE];
+  char destID[ISIS_NODESIZE];
+  char hdr[2*ISIS_NODESIZE+2];
+  char msgbody[ISIS_MSGSIZE];
+  MsgType msgtype;
+  isisargs_t oldArgs;
+  isisargs_t newArgs;
+  int i;
+  int ifree = -1;
+
+  if (holdWindow <= 0.0 || inFlush) return 0;
+
+  // SplitMessage() strips terminators, so work on a copy
+
+  strncpy(msgcopy,msgstr,sizeof(msgcopy)-1);
+  msgcopy[sizeof(msgcopy)-1] = '\0';
+  memset(msgbody,0,sizeof(msgbody));
+  if (SplitMessage(msgcopy,fromID,destID,&msgtype,msgbody) < 0 ||
+      msgtype != STATUS || ISISTokenize(msgbody,&newArgs) == 0 ||
+      newArgs.nkeys == 0 || newArgs.argc >= ISIS_MAXARGS) {
+    ISISStatusFlush(1);
+    return 0;
+  }
+  sprintf(hdr,"%s>%s",fromID,destID);
+
+  // Merge with the message held for this destination, if any
+
+  for (i=0; i<ISIS_MAXHELD; i++) {
+    if (heldTab[i].hdr[0] == '\0') {
+      if (ifree < 0) ifree = i;
+      continue;
+    }
+    if (strcasecmp(heldTab[i].hdr,hdr) != 0) continue;
+
+    ISISTokenize(heldTab[i].body,&oldArgs);
+    if (MergeStatus(heldTab[i].body,&oldArgs,&newArgs) == 0)
+      return 1;
+
+    // Too long to merge, send the held message and hold the new one
+
+    SendHeld(i);
+    ifree = i;
+    break;
+  }
+
+  // Start a new window, or send now if the table is full
+
+  if (ifree < 0) {
+    ISISStatusFlush(1);
+    return 0;
+  }
+  strcpy(heldTab[ifree].hdr,hdr);
+  strcpy(heldTab[ifree].body,msgbody);
+  heldTab[ifree].due = SysTimestamp() + holdWindow;
+  heldTab[ifree].client = client;
+  numHeld++;
+  return 1;
+}
+
+/*!
+  \brief Send held STATUS messages.
+
+  \param force if 0, send only messages whose coalescing window has
+  expired, otherwise send all held messages.
+  \return the number of messages sent.
+
+  Call this from the client's main I/O loop, and with \p force set
+  before the client exits.
+
+  \sa ISISStatusWaitTime()
+*/
+
+int
+ISISStatusFlush(int force)
+{
+  double now;
+  int numSent = 0;
+  int i;
+
+  if (numHeld == 0) return 0;
+
+  now = SysTimestamp();
+  for (i=0; i<ISIS_MAXHELD; i++) {
+    if (heldTab[i].hdr[0] == '\0') continue;
+    if (force || heldTab[i].due <= now) {
+      SendHeld(i);
+      numSent++;
+    }
+  }
+  return numSent;
+}
+
+/*!
+  \brief Time until the next held STATUS message is due.
+
+  \param tv timeval struct to fill with the wait time for select(), may
+  be NULL
+  \return milliseconds until the next held message must be sent (0 if
+  one is overdue), or -1 if nothing is being held, in which case \p tv
+  is not touched.
+
+  Clients use this to shorten their select() timeout so they wake in
+  time to call ISISStatusFlush().
+*/
+
+long
+ISISStatusWaitTime(struct timeval *tv)
+{
+  double next = 0.0;
+  double wait;
+  long msec;
+  int i;
+
+  if (numHeld == 0) return -1;
+
+  for (i=0; i<ISIS_MAXHELD; i++) {
+    if (heldTab[i].hdr[0] != '\0' && (next == 0.0 || heldTab[i].due < next))
+      next = heldTab[i].due;
+  }
+
+  wait = next - SysTimestamp();
+  if (wait < 0.0) wait = 0.0;
+  msec = (long)(1000.0*wait + 0.999);
+  if (tv != NULL) {
+    tv->tv_sec = msec / 1000;
+    tv->tv_usec = 1000 * (msec % 1000);
+  }
+  return msec;
+}
@@ -0,0 +1,239 @@
+//
+// capture.c - ISIS server binary traffic capture
+//
+// Contents:
+//   initCapture()    - open the traffic capture file
+//   captureMessage() - append a received message to the capture file
+//   closeCapture()   - close the capture file
+//
+// Date:
+//   2026 October 17
+//
+// Modification History:
+//
+
+/*!
+  \file capture.c
+  \brief ISIS server binary traffic capture
+
+  If enabled with the Capture keyword in the runtime config file, the
+  server records every message it receives, with its receive time,
+  sender address, and node IDs, in a compact binary capture file.  The
+  isisreplay tool can play a capture back against a server to turn a
+  real night's traffic into a repeatable test.  See isiscapture.h for
+  the file format.
+
+  Capture files are named like the runtime log, /path/rootname.CCYYMMDD.cap,
+  and are rotated whenever the runtime log rolls over to a new date (if
+  logging is disabled, the capture file is never rotated).
+
+  Records are copied straight into a shared memory map of the file,
+  extended #CAP_CHUNKSIZE bytes at a time, so capturing costs a memcpy()
+  per message and a remap every few MB.  The kernel writes the pages
+  back to disk in the background.
+*/
+
+#include "isisserver.h"
+#include "isiscapture.h"
+#include <sys/mman.h>
+
+static int   capFD = -1;          // capture file descriptor
+static char *capMap = NULL;       // mapping of the current chunk
+static long  capChunk = 0;        // file offset of the current chunk
+static long  capUsed = 0;         // bytes used in the current chunk
+static unsigned int capLogSeq;    // isis.logSeq when the file was opened
+
+/*!
+  \brief Map the next chunk of the capture file
+  \return 0 if successful, -1 on errors.
+
+  Extends the file by one chunk and maps it, unmapping the current
+  chunk if any.
+*/
+
+static int
+mapChunk(long offset)
+{
+  if (capMap != NULL) munmap(capMap,CAP_CHUNKSIZE);
+  capMap = NULL;
+
+  if (ftruncate(capFD,offset+CAP_CHUNKSIZE) < 0)
+    return(-1);
+
+  capMap = (char *)mmap(NULL,CAP_CHUNKSIZE,PROT_READ|PROT_WRITE,MAP_SHARED,
+			capFD,offset);
+  if (capMap == MAP_FAILED) {
+    capMap = NULL;
+    return(-1);
+  }
+  capChunk = offset;
+  capUsed = 0;
+  return(0);
+}
+
+/*!
+  \brief Report a capture error and disable capturing
+  \param what what failed
+*/
+
+static void
+captureError(const char *what)
+{
+  char errStr[MED_STR_SIZE];
+
+  sprintf(errStr,"ERROR: traffic capture %s failed on %s - %s, capture disabled",
+	  what,isis.capFile,strerror(errno));
+  if (isis.useCLI)
+    printf("%s\n",errStr);
+  logMessage(errStr);
+  closeCapture();
+  isis.doCapture = isis_FALSE;
+}
+
+/*!
+  \brief Open the traffic capture file
+  \return 0 if successful, -1 on errors, in which case capturing is
+  disabled.
+
+  Opens a new capture file named for the current runtime log date tag
+  (see initLog()), writes the file header, and maps the first chunk.
+  An existing file of the same name, for example from earlier in the
+  same night, is renamed with a .N suffix rather than overwritten.
+  Called at server startup and when the runtime log rolls over.
+*/
+
+int
+initCapture(void)
+{
+  struct capFileHeader *hdr;
+  struct timeval tv;
+  char oldFile[MED_STR_SIZE+8];
+  char logStr[MED_STR_SIZE];
+  char lastDate[SHORT_STR_SIZE];
+  int i;
+
+  if (!isis.doCapture) return(0);
+  closeCapture();
+
+  // Use the runtime log date tag, or the UTC date if not logging
+
+  capLogSeq = __atomic_load_n(&isis.logSeq,__ATOMIC_ACQUIRE);
+  logInfo(NULL,lastDate);
+  if (strlen(lastDate) == 0) {
+    getUTCTime();
+    strcpy(lastDate,isis.dateTag);
+  }
+  sprintf(isis.capFile,"%s.%s.cap",isis.capRoot,lastDate);
+
+  // Never overwrite an earlier capture
+
+  if (access(isis.capFile,F_OK) == 0) {
+    for (i=1; i<1000; i++) {
+      sprintf(oldFile,"%s.%d",isis.capFile,i);
+      if (access(oldFile,F_OK) != 0) break;
+    }
+    rename(isis.capFile,oldFile);
+  }
+
+  capFD = open(isis.capFile,(O_RDWR|O_CREAT|O_TRUNC),0644);
+  if (capFD < 0) {
+    captureError("open()");
+    return(-1);
+  }
+  if (mapChunk(0) < 0) {
+    captureError("mmap()");
+    return(-1);
+  }
+
+  // File header
+
+  hdr = (struct capFileHeader *)capMap;
+  memcpy(hdr->magic,CAP_MAGIC,8);
+  hdr->headerSize = CAP_HEADERSIZE;
+  hdr->chunkSize = CAP_CHUNKSIZE;
+  gettimeofday(&tv,NULL);
+  hdr->startTime = (int64_t)tv.tv_sec*1000000 + tv.tv_usec;
+  hdr->startMono = monoTime();
+  strncpy(hdr->serverID,isis.serverID,sizeof(hdr->serverID)-1);
+  capUsed = CAP_HEADERSIZE;
+
+  sprintf(logStr,"Traffic capture started in %s",isis.capFile);
+  logMessage(logStr);
+  return(0);
+}
+
+/*!
+  \brief Append a received message to the capture file
+  \param msg parsed message (see parseIMPv2())
+  \param method sender's transport method, SERIAL, SOCKET, or LOCAL
+  \param addr sender's IP address if SOCKET
+  \param port sender's UDP port if SOCKET, serial or local socket table
+  index otherwise
+
+  Time-stamps the message and copies it into the capture file,
+  moving to a new chunk or a new file (if the runtime log rolled
+  over) as needed.
+*/
+
+void
+captureMessage(impv2_t *msg, int method, long addr, int port)
+{
+  struct capRecord *rec;
+  long recLen;
+
+  if (!isis.doCapture) return;
+
+  // New capture file if the runtime log rolled over
+
+  if (capMap == NULL || __atomic_load_n(&isis.logSeq,__ATOMIC_ACQUIRE) != capLogSeq)
+    if (initCapture() < 0) return;
+
+  recLen = CAP_RECSIZE(msg->bodyLen);
+  if (recLen > CAP_CHUNKSIZE) return;   // can't happen, messages are <4KB
+
+  // New chunk if the record won't fit.  The unused tail of the chunk
+  // is already zero, which tells readers to skip to the next one.
+
+  if (capUsed + recLen > CAP_CHUNKSIZE) {
+    if (mapChunk(capChunk+CAP_CHUNKSIZE) < 0) {
+      captureError("mmap()");
+      return;
+    }
+  }
+
+  rec = (struct capRecord *)&capMap[capUsed];
+  memset(rec,0,recLen);
+  rec->len = recLen;
+  rec->method = method;
+  rec->port = port;
+  rec->addr = addr;
+  rec->bodyLen = msg->bodyLen;
+  rec->monoTime = monoTime();
+  strcpy(rec->srcID,msg->srcID);
+  strcpy(rec->destID,msg->destID);
+  memcpy((char *)rec+sizeof(struct capRecord),msg->body,msg->bodyLen);
+  capUsed += recLen;
+}
+
+/*!
+  \brief Close the capture file
+
+  Unmaps the current chunk and truncates the file to the bytes
+  actually used.  Registered with atexit() by the servers.
+*/
+
+void
+closeCapture(void)
+{
+  int ierr;
+
+  if (capMap != NULL) munmap(capMap,CAP_CHUNKSIZE);
+  capMap = NULL;
+  if (capFD >= 0) {
+    ierr = ftruncate(capFD,capChunk+capUsed);
+    close(capFD);
+  }
+  capFD = -1;
+  capChunk = 0;
+  capUsed = 0;
+}
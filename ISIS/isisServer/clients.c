@@ -6,6 +6,14 @@
 //   updateHosts()   Update the server client host table 
 //   removeHost()    Remove an entry from the client host table
 //   isKnownHost()   Verify that a host is in the client host table
+//   findHostByAddr() Find the network client using an address and port
+//   isPortOwner()   Test whether a network client owns its port
+//   findLocalPort() Find or add a Unix-domain client socket in localTab
+//   localPortName() Printable name of a Unix-domain client socket
+//   subscribeHost() Set a client's broadcast subscription
+//   broadcastType() Classify a broadcast message by IMPv2 message type
+//   wantsBroadcast() Test whether a client wants a broadcast message
+//   serialWantsBroadcast() Test whether a serial port wants a broadcast
 //   printHosts()    Print the contents of the client host table on stdout.
 //   hostInfo()      Report host information to a remote client
 //
@@ -16,6 +24,10 @@
 //
 // Modification History:
 //   2009 March 18 - updates for v2 [rwp/osu]
+//   2026 Oct 17 - hash indexes on node ID and network address, client
+//                 table grows at runtime instead of filling up
+//   2026 Oct 17 - broadcast subscriptions by message type and source
+//   2026 Oct 17 - LOCAL clients on the Unix-domain socket
 //
 
 /*!
@@ -30,18 +42,202 @@
   \arg updateHosts()   Update the server client host table 
   \arg removeHost()    Remove an entry from the client host table
   \arg isKnownHost()   Verify that a host is in the client host table
+  \arg findHostByAddr() Find the network client using an address and port
+  \arg isPortOwner()   Test whether a network client owns its port
+  \arg findLocalPort() Find or add a Unix-domain client socket in localTab
+  \arg localPortName() Printable name of a Unix-domain client socket
+  \arg subscribeHost() Set a client's broadcast subscription
+  \arg broadcastType() Classify a broadcast message by IMPv2 message type
+  \arg wantsBroadcast() Test whether a client wants a broadcast message
+  \arg serialWantsBroadcast() Test whether a serial port wants a broadcast
   \arg printHosts()    Print the contents of the client host table on stdout.
   \arg hostInfo()      Report host information to a remote client
 */
 
 #include "isisserver.h"
 
+//---------------------------------------------------------------------------
+//
+// Client table hash indexes
+//
+// Two open-addressing (linear probing) hash tables map keys onto
+// clientTab[] indices, -1 marks an empty slot:
+//
+//   idHash   - node ID, case-insensitive (IDs are stored uppercase)
+//   addrHash - (addr,port) of SOCKET and LOCAL clients (LOCAL clients
+//              have addr=LOCAL_ADDR and port=localTab index).  If
+//              several node IDs share one socket, the lowest table
+//              index owns the port.
+//
+// Both have hashSize slots, a power of 2 at least twice the table
+// capacity, so they never fill up.  They are rebuilt from clientTab[]
+// when the table grows or an entry is removed or moves to a new
+// port, all of which are rare, so no deletion logic is needed.
+//
+
+static int *idHash = NULL;      // node ID index
+static int *addrHash = NULL;    // network address index
+static int hashSize = 0;        // slots in each index (power of 2)
+
+static int numSubscribed = 0;   // number of clients with broadcast subscriptions
+
+/*!
+  \brief Case-insensitive FNV-1a hash of an IMPv2 node ID
+  \param hostID node ID to hash
+  \return hash value
+*/
+
+static unsigned int
+hashID(const char *hostID)
+{
+  unsigned int h = 2166136261u;
+  int i;
+
+  for (i=0; hostID[i] != NUL && i < IMPv2_HOST_SIZE-1; i++) {
+    h ^= (unsigned char)toupper(hostID[i]);
+    h *= 16777619u;
+  }
+  return(h);
+}
+
+/*!
+  \brief Hash of a network client address and port
+  \param addr 32-bit IP address (host byte order)
+  \param port port number
+  \return hash value
+*/
+
+static unsigned int
+hashAddr(long addr, int port)
+{
+  unsigned int h = (unsigned int)addr * 2654435761u;
+  return(h ^ ((unsigned int)port * 40503u));
+}
+
+/*!
+  \brief Add client table entry i to the hash indexes
+  \param i client table index
+*/
+
+static void
+indexHost(int i)
+{
+  unsigned int mask = hashSize - 1;
+  unsigned int h;
+  int j;
+
+  for (h = hashID(clientTab[i].ID) & mask; idHash[h] >= 0; h = (h+1) & mask);
+  idHash[h] = i;
+
+  if (clientTab[i].method != SOCKET && clientTab[i].method != LOCAL) return;
+
+  for (h = hashAddr(clientTab[i].addr,clientTab[i].port) & mask; 
+       (j=addrHash[h]) >= 0; h = (h+1) & mask) {
+    if (clientTab[j].addr == clientTab[i].addr &&
+	clientTab[j].port == clientTab[i].port)
+      return;  // port already owned by a lower-index host
+  }
+  addrHash[h] = i;
+}
+
+/*!
+  \brief Rebuild the hash indexes from the client table
+*/
+
+static void
+rebuildIndex(void)
+{
+  int i;
+
+  for (i=0; i<hashSize; i++) {
+    idHash[i] = -1;
+    addrHash[i] = -1;
+  }
+  for (i=0; i<isis.maxClients; i++)
+    if (clientTab[i].method != UNASSIGNED)
+      indexHost(i);
+}
+
+/*!
+  \brief Clear client table entry i
+  \param i client table index
+*/
+
+static void
+clearHost(int i)
+{
+  if (clientTab[i].subTypes != 0 || clientTab[i].numSubSrc > 0)
+    numSubscribed--;
+  memset(&clientTab[i],0,sizeof(struct clients));
+  clientTab[i].method = UNASSIGNED;
+  clientTab[i].fd     = UNASSIGNED;
+  clientTab[i].addr   = UNASSIGNED;
+  clientTab[i].port   = UNASSIGNED;
+  clientTab[i].tstamp = -1.0;
+}
+
+/*!
+  \brief Resize the client table and its hash indexes
+  \param newSize new capacity of the client table
+  \return 0 if successful, -1 if memory could not be allocated.
+
+  Existing entries keep their table indices.  Nothing changes unless
+  all three allocations succeed, so on failure the old table and its
+  indexes are left intact.
+*/
+
+static int
+resizeHostTable(int newSize)
+{
+  struct clients *newTab;
+  int *newID;
+  int *newAddr;
+  int newHash;
+  int i;
+
+  for (newHash = 16; newHash < 2*newSize; newHash *= 2);
+
+  newID   = (int *)malloc(newHash*sizeof(int));
+  newAddr = (int *)malloc(newHash*sizeof(int));
+  if (newID == NULL || newAddr == NULL) {
+    free(newID);
+    free(newAddr);
+    return(-1);
+  }
+  newTab = (struct clients *)realloc(clientTab,newSize*sizeof(struct clients));
+  if (newTab == NULL) {
+    free(newID);
+    free(newAddr);
+    return(-1);
+  }
+
+  clientTab = newTab;
+  memset(&clientTab[isis.maxClients],0,
+	 (newSize-isis.maxClients)*sizeof(struct clients));
+  for (i=isis.maxClients; i<newSize; i++)
+    clearHost(i);
+  isis.maxClients = newSize;
+
+  free(idHash);
+  free(addrHash);
+  idHash   = newID;   // rebuildIndex() fills them in
+  addrHash = newAddr;
+  hashSize = newHash;
+
+  rebuildIndex();
+  return(0);
+}
+
+//---------------------------------------------------------------------------
+
 /*!
   \brief Initialize the server client host table.
   
   Initializes the contents of the ISIS client table, clearing all host
   entries.  Must be called before filling the client table either at
-  server startup or restart.
+  server startup or restart.  The table is allocated with #MAXCLIENTS
+  entries the first time through, and keeps its current size after
+  that.  The local client socket table is also cleared.
 */
 
 void 
@@ -49,14 +245,18 @@ initHostTable()
 {
   int i;
   isis.numClients = 0;
-  for (i=0; i<MAXCLIENTS; i++) {
-    memset(clientTab[i].ID,0,sizeof(clientTab[i].ID));
-    clientTab[i].method = UNASSIGNED;
-    clientTab[i].fd     = UNASSIGNED;
-    clientTab[i].addr   = UNASSIGNED;
-    clientTab[i].port   = UNASSIGNED;
-    clientTab[i].tstamp = -1.0;
+  if (clientTab == NULL) {
+    isis.maxClients = 0;
+    if (resizeHostTable(MAXCLIENTS) < 0) {
+      printf("FATAL: cannot allocate the client host table - %s\n",
+	     strerror(errno));
+      exit(1);
+    }
   }
+  for (i=0; i<isis.maxClients; i++)
+    clearHost(i);
+  rebuildIndex();
+  memset(localTab,0,sizeof(localTab));
 }
 
 /*!
@@ -64,14 +264,16 @@ initHostTable()
   \param hostID new host's ID (IMPv2 format)
   \param method new host's transport method (SERIAL, SOCKET, etc.)
   \param fd new host's port file descriptor 
-  \param addr new host's 32-bit IP address if method=SOCKET
-  \param port new host's port number if method=SOCKET
+  \param addr new host's 32-bit IP address if method=SOCKET, #LOCAL_ADDR if LOCAL
+  \param port new host's port number if method=SOCKET, serial or local
+  table index if SERIAL or LOCAL
 
   \return The host table index assigned to this client if successful, or
-  ERR_HOSTS_FULL if the host table is full.
+  ERR_HOSTS_FULL if the host table is at #CLIENT_LIMIT or cannot grow.
 
-  Searches the Client Table (clientTab struct), and either adds or updates
-  the table with the incoming host info.  Because it changes the
+  Looks up the host in the node ID hash index, and either updates its
+  entry or adds the host in the first open slot in the client table.
+  If the table is full it is doubled in size.  Because it changes the
   contents of global variables, this particular routine is not very
   thread-safe without lots of work to wrap mutex_ bits around things.
 
@@ -83,81 +285,88 @@ int
 updateHosts(char *hostID, int method, int fd, long addr, int port)
 {
   int i;
-  char testStr[SHORT_STR_SIZE];
+  int newSize;
   char logStr[MED_STR_SIZE];
   double timeStamp;
   char inetStr[INET6_ADDRSTRLEN];
   struct sockaddr_in client;
 
-  // Copy the hostID into all upper case: this is how we store
-  // all hostIDs in the table
-  
-  strcpy(testStr,hostID);
-  upperCase(testStr);
-
   // Make a numerical timeStamp 
 
   timeStamp = sysTimeStamp();
 
-  // First Pass:  if this is a known host, update its information 
-  // and return immediately if it was found 
-
-  if (isis.numClients > 0) { 
-    for (i=0; i<MAXCLIENTS; i++) {
-      if (strcmp(testStr,clientTab[i].ID)==0) {
-	clientTab[i].method = method;
-	clientTab[i].fd     = fd;
-	clientTab[i].addr   = addr;
-	clientTab[i].port   = port;
-	clientTab[i].tstamp = timeStamp;
-	return (i);
-      }
+  // If this is a known host, update its information and return
+  // immediately.  If it moved to a new port, reindex.
+
+  if ((i = isKnownHost(hostID)) >= 0) {
+    clientTab[i].tstamp = timeStamp;
+    if (clientTab[i].method != method || clientTab[i].addr != addr ||
+	clientTab[i].port != port) {
+      clientTab[i].method = method;
+      clientTab[i].addr   = addr;
+      clientTab[i].port   = port;
+      clientTab[i].fd     = fd;
+      rebuildIndex();
     }
+    clientTab[i].fd = fd;
+    return(i);
   }
 
-  // If we got here, either this is the first client, or there were
-  // no matches on the first pass.
+  // A new client.  If the table is full, try to make it bigger
 
-  if (isis.numClients == MAXCLIENTS) { // the client host table is full 
-    return(ERR_HOSTS_FULL);
-  
-  } 
-  else {
+  if (isis.numClients == isis.maxClients) {
+    newSize = 2*isis.maxClients;
+    if (newSize > CLIENT_LIMIT) newSize = CLIENT_LIMIT;
+    if (newSize == isis.maxClients || resizeHostTable(newSize) < 0)
+      return(ERR_HOSTS_FULL);
+    sprintf(logStr,"Client host table grown to %d entries",isis.maxClients);
+    logMessage(logStr);
+  }
 
-    // Make a new client table entry in the first open slot in the table.
+  // Make a new client table entry in the first open slot in the table.
     
-    for (i=0; i<MAXCLIENTS; i++) {
-      if (clientTab[i].method == UNASSIGNED) {
-	strcpy(clientTab[i].ID,testStr);
-	clientTab[i].method = method;
-	clientTab[i].fd     = fd;
-	clientTab[i].addr   = addr;
-	clientTab[i].port   = port;
-	clientTab[i].tstamp = timeStamp;
-	isis.numClients++ ;
-
-	// Note this in the log
+  for (i=0; i<isis.maxClients; i++) {
+    if (clientTab[i].method == UNASSIGNED) {
+
+      // Store hostIDs in all upper case
+
+      strncpy(clientTab[i].ID,hostID,IMPv2_HOST_SIZE-1);
+      clientTab[i].ID[IMPv2_HOST_SIZE-1] = NUL;
+      upperCase(clientTab[i].ID);
+      clientTab[i].method = method;
+      clientTab[i].fd     = fd;
+      clientTab[i].addr   = addr;
+      clientTab[i].port   = port;
+      clientTab[i].tstamp = timeStamp;
+      isis.numClients++ ;
+      indexHost(i);
+
+      // Note this in the log
 	
-	switch (method) {
-	case SERIAL:
-	  sprintf(logStr,"Added Serial Client %s on device %s",
-		  testStr,ttyTab[port].devName);
-	  break;
+      switch (method) {
+      case SERIAL:
+	sprintf(logStr,"Added Serial Client %s on device %s",
+		clientTab[i].ID,ttyTab[port].devName);
+	break;
 	  
-	case SOCKET:
-	  client.sin_family = AF_INET;
-	  client.sin_addr.s_addr = htonl(addr) ;
-	  client.sin_port = htons(port) ;
-	  sprintf(logStr,"Added UDP Client %s on host %s:%d",
-		  testStr,
-		  inet_ntop(client.sin_family,&client.sin_addr,inetStr,
-			    sizeof(inetStr)),
-		  port);
-	  break;
-	}
-	logMessage(logStr);
-	return(i);
+      case SOCKET:
+	client.sin_family = AF_INET;
+	client.sin_addr.s_addr = htonl(addr) ;
+	client.sin_port = htons(port) ;
+	sprintf(logStr,"Added UDP Client %s on host %s:%d",
+		clientTab[i].ID,
+		inet_ntop(client.sin_family,&client.sin_addr,inetStr,
+			  sizeof(inetStr)),
+		port);
+	break;
+
+      case LOCAL:
+	sprintf(logStr,"Added Local Client %s on socket %s",
+		clientTab[i].ID,localPortName(port));
+	break;
       }
+      logMessage(logStr);
+      return(i);
     }
   }
 
@@ -176,10 +385,8 @@ updateHosts(char *hostID, int method, int fd, long addr, int port)
   Removes a single host by name from the ISIS client table.
   See InitHostTable() for how to clear the entire table all at once.
 
-  Since the number of allowed clients is expected to remain a small
-  number, repacking the table to remove gaps does not offer any
-  economies at present, but someday if it is decided it is necessary,
-  the repacking should go in this routine.
+  The table is not repacked, which would change the indices of the
+  other clients, the slot is simply reused by the next new client.
 */
 
 int 
@@ -187,26 +394,13 @@ removeHost(char *hostID)
 {
   int i;
 
-  if (isis.numClients == 0) return(0);
-
-  // Search for hostID and clear its entries if present 
-
-  for (i=0; i<MAXCLIENTS; i++) {
-    if (strcasecmp(clientTab[i].ID,hostID)==0) {
-      memset(clientTab[i].ID,0,sizeof(clientTab[i].ID));
-      clientTab[i].method = UNASSIGNED;
-      clientTab[i].fd     = UNASSIGNED;
-      clientTab[i].addr   = UNASSIGNED;
-      clientTab[i].port   = UNASSIGNED;
-      clientTab[i].tstamp = -1.0;
-      isis.numClients-- ;
-      return (0);
-    }
-  } 
+  if ((i = isKnownHost(hostID)) < 0)
+    return(ERR_UNKNOWN_HOST);
 
-  // If we got here, we were asked to remove an unknown host 
-
-  return(ERR_UNKNOWN_HOST);
+  clearHost(i);
+  isis.numClients-- ;
+  rebuildIndex();
+  return (0);
 
 }
 
@@ -214,32 +408,26 @@ removeHost(char *hostID)
   \brief Verify that client is a known host (i.e., in the client table)
   \param hostID Client host name to test
   
-  \return Host table index of the recipient if valid, or HostUnknown if not.
+  \return Host table index of the recipient if valid, or ERR_UNKNOWN_HOST if not.
 
-  Searches the server client table in clientTab struct, and returns the
-  index in the host table of the named client.  Called by the various
-  message handlers attached to the select() event handler.
+  Looks up the named client in the node ID hash index, and returns
+  its index in the client host table.  The test is case-insensitive.
+  Called by the various message handlers attached to the event loop.
 
 */
 
 int 
 isKnownHost(char *hostID)
 {
+  unsigned int mask = hashSize - 1;
+  unsigned int h;
   int i;
-  char testStr[SHORT_STR_SIZE];
-
-  // Oops! No clients, so it is by unknown by default
 
   if (isis.numClients == 0) 
     return(ERR_UNKNOWN_HOST);
 
-  // Is hostID in the table?  Work with an uppercase copy.
-  
-  strcpy(testStr,hostID);
-  upperCase(testStr);
-
-  for (i=0; i<MAXCLIENTS; i++) {
-    if (strcmp(testStr,clientTab[i].ID)==0)
+  for (h = hashID(hostID) & mask; (i=idHash[h]) >= 0; h = (h+1) & mask) {
+    if (strcasecmp(hostID,clientTab[i].ID)==0)
       return (i);
   }
 
@@ -249,6 +437,374 @@ isKnownHost(char *hostID)
 
 }
 
+/*!
+  \brief Find the network client using an address and port
+  \param addr 32-bit IP address (host byte order)
+  \param port port number
+  
+  \return Host table index of the client that owns the port, or
+  ERR_UNKNOWN_HOST if no SOCKET client uses it.
+
+  LOCAL clients are found with addr=#LOCAL_ADDR and port set to their
+  localTab index.
+
+  If several node IDs share the same socket, the one with the lowest
+  table index owns the port.
+*/
+
+int
+findHostByAddr(long addr, int port)
+{
+  unsigned int mask = hashSize - 1;
+  unsigned int h;
+  int i;
+
+  if (isis.numClients == 0) 
+    return(ERR_UNKNOWN_HOST);
+
+  for (h = hashAddr(addr,port) & mask; (i=addrHash[h]) >= 0; h = (h+1) & mask) {
+    if (clientTab[i].addr == addr && clientTab[i].port == port)
+      return(i);
+  }
+  return(ERR_UNKNOWN_HOST);
+}
+
+/*!
+  \brief Test whether a network client owns its port
+  \param iHost client host table index
+  \return 1 if iHost is the SOCKET or LOCAL client that owns its address
+  and port (see findHostByAddr()), 0 otherwise.
+
+  Broadcasts go to ports, not hosts, so they are only sent to the
+  owner of each port.
+*/
+
+int
+isPortOwner(int iHost)
+{
+  return((clientTab[iHost].method == SOCKET || clientTab[iHost].method == LOCAL) &&
+	 findHostByAddr(clientTab[iHost].addr,clientTab[iHost].port) == iHost);
+}
+
+/*!
+  \brief Find or add a Unix-domain client socket in the local socket table
+  \param addr client socket address, as returned by recvfrom()
+  \param addrLen length of the address
+
+  \return index of the socket in localTab, or -1 if the sender has no
+  address we can reply to (an unbound socket) or the table is full.
+
+  Unknown sockets take the first unused entry.  When the table is
+  full, entries no longer used by any LOCAL client (e.g., left by
+  clients that restarted under a new node ID) are reclaimed.  Same-host
+  clients are few, so a linear search is as fast as anything else.
+*/
+
+int
+findLocalPort(dgramaddr_t *addr, socklen_t addrLen)
+{
+  int i, iFree = -1;
+  int inUse[MAXLOCAL];
+
+  if (addrLen <= (socklen_t)offsetof(struct sockaddr_un,sun_path) ||
+      addrLen > (socklen_t)sizeof(struct sockaddr_un))
+    return(-1);
+
+  for (i=0; i<MAXLOCAL; i++) {
+    if (localTab[i].addrLen == addrLen &&
+	memcmp(&localTab[i].addr,addr,addrLen) == 0)
+      return(i);
+    if (localTab[i].addrLen == 0 && iFree < 0)
+      iFree = i;
+  }
+
+  // Reclaim any entries orphaned by departed clients
+
+  if (iFree < 0) {
+    memset(inUse,0,sizeof(inUse));
+    for (i=0; i<isis.maxClients; i++)
+      if (clientTab[i].method == LOCAL) inUse[clientTab[i].port] = 1;
+    for (i=0; i<MAXLOCAL; i++) {
+      if (!inUse[i]) {
+	localTab[i].addrLen = 0;
+	if (iFree < 0) iFree = i;
+      }
+    }
+    if (iFree < 0) return(-1);
+  }
+
+  memset(&localTab[iFree].addr,0,sizeof(dgramaddr_t));
+  memcpy(&localTab[iFree].addr,addr,addrLen);
+  localTab[iFree].addrLen = addrLen;
+  return(iFree);
+}
+
+/*!
+  \brief Printable name of a Unix-domain client socket
+  \param iPort local socket table index
+  \return socket path, or the abstract socket name preceded by @
+
+  Uses a static buffer, overwritten on each call.
+*/
+
+char *
+localPortName(int iPort)
+{
+  static char name[sizeof(struct sockaddr_un)];
+  int len;
+
+  if (iPort < 0 || iPort >= MAXLOCAL || localTab[iPort].addrLen == 0)
+    return((char *)"(none)");
+
+  len = localTab[iPort].addrLen - offsetof(struct sockaddr_un,sun_path);
+  if (localTab[iPort].addr.un.sun_path[0] == NUL) {
+    name[0] = '@';
+    memcpy(&name[1],&localTab[iPort].addr.un.sun_path[1],len-1);
+    name[len] = NUL;
+  }
+  else {
+    memcpy(name,localTab[iPort].addr.un.sun_path,len);
+    name[len] = NUL;
+  }
+  return(name);
+}
+
+//---------------------------------------------------------------------------
+//
+// Broadcast subscriptions
+//
+
+// Broadcast message type names, in BCAST_xxx bit order
+
+static const char *bcastNames[] = {"STATUS","DONE","ERROR","WARNING",
+				   "FATAL","REQ","EXEC"};
+#define NUM_BCAST_TYPES 7
+
+/*!
+  \brief Format a client's broadcast subscription as keyword=value pairs
+  \param iHost client host table index
+  \param reply string to hold the result
+
+  \verbatim Host=XX Types=STATUS,DONE Sources=M1,M2 \endverbatim
+  Types or Sources are ALL if not restricted.
+*/
+
+static void
+subscriptionInfo(int iHost, char *reply)
+{
+  int i;
+  int len;
+
+  len = sprintf(reply,"Host=%s Types=",clientTab[iHost].ID);
+  if (clientTab[iHost].subTypes == 0)
+    len += sprintf(&reply[len],"ALL");
+  else {
+    for (i=0; i<NUM_BCAST_TYPES; i++)
+      if (clientTab[iHost].subTypes & (1<<i))
+	len += sprintf(&reply[len],"%s,",bcastNames[i]);
+    reply[--len] = NUL;
+  }
+
+  len += sprintf(&reply[len]," Sources=");
+  if (clientTab[iHost].numSubSrc == 0)
+    sprintf(&reply[len],"ALL");
+  else {
+    for (i=0; i<clientTab[iHost].numSubSrc; i++)
+      len += sprintf(&reply[len],"%s,",clientTab[iHost].subSrc[i]);
+    reply[--len] = NUL;
+  }
+}
+
+/*!
+  \brief Set a client's broadcast subscription
+  \param iHost client host table index of the subscriber
+  \param args subscription arguments (see below), blank to query
+  \param reply string to hold the IMPv2 reply
+  \return 0 if successful, -1 if the arguments were invalid, in which case
+  the client's subscription is unchanged.
+
+  By default every client receives every broadcast (XX>AL) message.
+  A client may instead subscribe to broadcasts of certain message
+  types and/or from certain source node IDs:
+  \verbatim
+  SUBSCRIBE Types=STATUS,DONE Sources=M1,M2
+  SUBSCRIBE ALL
+  \endverbatim
+  Types are STATUS, DONE, ERROR, WARNING, FATAL, REQ (explicit or
+  implicit), or EXEC, and up to #MAXSUBSRC Sources may be given.  A
+  broadcast is sent to the client if it passes both filters, an
+  omitted filter (or ALL) passes everything.  Each SUBSCRIBE replaces
+  the previous subscription, SUBSCRIBE ALL restores the default.
+
+  Subscriptions are per client, but broadcasts go to ports: a port
+  gets a broadcast if any client on that port wants it.
+*/
+
+int
+subscribeHost(int iHost, char *args, char *reply)
+{
+  char argStr[MED_STR_SIZE];
+  char *arg, *argPtr;
+  char *val, *valPtr;
+  int  types = 0;
+  int  numSrc = 0;
+  char src[MAXSUBSRC][IMPv2_HOST_SIZE];
+  int  i;
+
+  strncpy(argStr,args,sizeof(argStr)-1);
+  argStr[sizeof(argStr)-1] = NUL;
+
+  // No arguments, report the current subscription
+
+  if ((arg = strtok_r(argStr," ",&argPtr)) == NULL) {
+    strcpy(reply,"DONE: SUBSCRIBE ");
+    subscriptionInfo(iHost,&reply[strlen(reply)]);
+    return(0);
+  }
+
+  // Parse the keyword=value arguments
+
+  for (; arg != NULL; arg = strtok_r(NULL," ",&argPtr)) {
+    if (strcasecmp(arg,"ALL")==0) continue;
+
+    if ((val = strchr(arg,'=')) == NULL) {
+      sprintf(reply,"ERROR: SUBSCRIBE Invalid argument '%s', must be "
+	      "Types=t1,t2,... or Sources=id1,id2,...",arg);
+      return(-1);
+    }
+    *val++ = NUL;
+
+    if (strcasecmp(arg,"TYPE")==0 || strcasecmp(arg,"TYPES")==0) {
+      for (val = strtok_r(val,",",&valPtr); val != NULL; 
+	   val = strtok_r(NULL,",",&valPtr)) {
+	if (strcasecmp(val,"ALL")==0) continue;
+	for (i=0; i<NUM_BCAST_TYPES; i++)
+	  if (strcasecmp(val,bcastNames[i])==0) break;
+	if (i == NUM_BCAST_TYPES) {
+	  sprintf(reply,"ERROR: SUBSCRIBE Unknown message type '%s', must be "
+		  "STATUS, DONE, ERROR, WARNING, FATAL, REQ, or EXEC",val);
+	  return(-1);
+	}
+	types |= (1<<i);
+      }
+    }
+    else if (strcasecmp(arg,"SRC")==0 || strcasecmp(arg,"SOURCE")==0 ||
+	     strcasecmp(arg,"SOURCES")==0) {
+      for (val = strtok_r(val,",",&valPtr); val != NULL; 
+	   val = strtok_r(NULL,",",&valPtr)) {
+	if (strcasecmp(val,"ALL")==0) continue;
+	if (strlen(val) > IMPv2_HOST_SIZE-1) {
+	  sprintf(reply,"ERROR: SUBSCRIBE Invalid source ID '%s'",val);
+	  return(-1);
+	}
+	if (numSrc == MAXSUBSRC) {
+	  sprintf(reply,"ERROR: SUBSCRIBE Too many sources, %d max",MAXSUBSRC);
+	  return(-1);
+	}
+	strcpy(src[numSrc],val);
+	upperCase(src[numSrc++]);
+      }
+    }
+    else {
+      sprintf(reply,"ERROR: SUBSCRIBE Unknown keyword '%s', must be "
+	      "Types or Sources",arg);
+      return(-1);
+    }
+  }
+
+  // All good, replace the client's subscription
+
+  if (clientTab[iHost].subTypes != 0 || clientTab[iHost].numSubSrc > 0)
+    numSubscribed--;
+  clientTab[iHost].subTypes = types;
+  clientTab[iHost].numSubSrc = numSrc;
+  for (i=0; i<numSrc; i++)
+    strcpy(clientTab[iHost].subSrc[i],src[i]);
+  if (types != 0 || numSrc > 0)
+    numSubscribed++;
+
+  strcpy(reply,"DONE: SUBSCRIBE ");
+  subscriptionInfo(iHost,&reply[strlen(reply)]);
+  return(0);
+}
+
+/*!
+  \brief Classify a broadcast message body by IMPv2 message type
+  \param msgBody message body
+  \return message type, one of the BCAST_xxx codes.
+
+  Messages without a type prefix are implicit requests (BCAST_REQ).
+*/
+
+int
+broadcastType(char *msgBody)
+{
+  int i;
+  int len;
+
+  for (i=0; i<NUM_BCAST_TYPES; i++) {
+    len = strlen(bcastNames[i]);
+    if (strncasecmp(msgBody,bcastNames[i],len)==0 && msgBody[len]==':')
+      return(1<<i);
+  }
+  return(BCAST_REQ);
+}
+
+/*!
+  \brief Test whether a client wants a broadcast message
+  \param iHost client host table index
+  \param msgType message type (see broadcastType())
+  \param srcID node ID of the broadcast source
+  \return 1 if the client's subscription passes the message, 0 if not.
+
+  Clients that have not subscribed want everything.
+*/
+
+int
+wantsBroadcast(int iHost, int msgType, char *srcID)
+{
+  int i;
+
+  if (numSubscribed == 0) return(1);
+
+  if (clientTab[iHost].subTypes != 0 && !(clientTab[iHost].subTypes & msgType))
+    return(0);
+
+  if (clientTab[iHost].numSubSrc == 0) return(1);
+
+  for (i=0; i<clientTab[iHost].numSubSrc; i++)
+    if (strcasecmp(srcID,clientTab[iHost].subSrc[i])==0)
+      return(1);
+
+  return(0);
+}
+
+/*!
+  \brief Test whether a serial port wants a broadcast message
+  \param iPort serial port table index
+  \param msgType message type (see broadcastType())
+  \param srcID node ID of the broadcast source
+  \return 1 if any client on the port wants the message, or if the port
+  has no known clients, 0 if not.
+*/
+
+int
+serialWantsBroadcast(int iPort, int msgType, char *srcID)
+{
+  int i;
+  int numHosts = 0;
+
+  if (numSubscribed == 0) return(1);
+
+  for (i=0; i<isis.maxClients; i++) {
+    if (clientTab[i].method == SERIAL && clientTab[i].port == iPort) {
+      if (wantsBroadcast(i,msgType,srcID)) return(1);
+      numHosts++;
+    }
+  }
+  return(numHosts == 0);
+}
+
 /*!
   \brief Prints the server's client host table on stdout.
   \param hostID Name of the host to print.  If "all", print all hosts.
@@ -291,8 +847,8 @@ printHosts(char *hostID)
   // Info is requested on all clients
 
   if (strcasecmp(hostID,"ALL")==0) {
-    printf("NumClients=%d MaxClients=%d\n",isis.numClients,MAXCLIENTS);
-    for (iHost=0; iHost<MAXCLIENTS; iHost++) {
+    printf("NumClients=%d MaxClients=%d\n",isis.numClients,isis.maxClients);
+    for (iHost=0; iHost<isis.maxClients; iHost++) {
       switch(clientTab[iHost].method) {
 
       case UNASSIGNED:
@@ -321,6 +877,14 @@ printHosts(char *hostID)
 	       idleTime);
 	break;
 
+      case LOCAL:
+	idleTime = tstamp0 - clientTab[iHost].tstamp;
+	printf("  Host%d: ID=%s Method=Local localSocket=%s IdleTime=%.3f\n",
+	       iHost,clientTab[iHost].ID,
+	       localPortName(clientTab[iHost].port),
+	       idleTime);
+	break;
+
       default:
 	break;
 
@@ -368,6 +932,13 @@ printHosts(char *hostID)
 	     clientTab[iHost].port, idleTime, iHost);
       break;
 
+    case LOCAL:
+      idleTime = tstamp0 - clientTab[iHost].tstamp;
+      printf("Host=%s Method=Local localSocket=%s IdleTime=%.3f Client=%.2d\n",
+	     clientTab[iHost].ID, localPortName(clientTab[iHost].port),
+	     idleTime, iHost);
+      break;
+
     default:
       break;
 
@@ -399,6 +970,7 @@ hostInfo(char *hostID, char *reply)
   char inetStr[INET6_ADDRSTRLEN];
   struct sockaddr_in client;
   int iHost;
+  int len;
   double tstamp0, idleTime;
 
   // clear the reply string 
@@ -415,10 +987,12 @@ hostInfo(char *hostID, char *reply)
   upperCase(hostID);  // force to uppercase for tests
 
   if (strcasecmp(hostID,"ALL")==0) {
-    sprintf(reply,"DONE: HOST numHosts=%d maxHosts=%d",isis.numClients,MAXCLIENTS);
-    for (i=0; i<MAXCLIENTS; i++) {
+    // append entries in place, stopping short of a full message
+
+    len = sprintf(reply,"DONE: HOST numHosts=%d maxHosts=%d",isis.numClients,isis.maxClients);
+    for (i=0; i<isis.maxClients && len < ISIS_MSGSIZE-64; i++) {
       if (clientTab[i].method != UNASSIGNED)
-	sprintf(reply,"%s host%d=%s",reply,i,clientTab[i].ID);
+	len += sprintf(&reply[len]," host%d=%s",i,clientTab[i].ID);
     }
   } else {
     if ((iHost=isKnownHost(hostID))==ERR_UNKNOWN_HOST) {
@@ -462,6 +1036,16 @@ hostInfo(char *hostID, char *reply)
 	      iHost, idleTime);
       break;
 
+    case LOCAL:
+      idleTime = tstamp0 - clientTab[iHost].tstamp;
+      sprintf(reply,
+	      "DONE: HOST Host%d=%s Method%d=Local localSocket%d=%s IdleTime%d=%.3f",
+	      iHost, clientTab[iHost].ID,
+	      iHost,
+	      iHost, localPortName(clientTab[iHost].port),
+	      iHost, idleTime);
+      break;
+
     default:
       sprintf(reply,"ERROR: HOST unsupported transport method %d",
 	      clientTab[iHost].method);
@@ -20,6 +20,9 @@
 //
 //   2026 Feb 25: added handshake command to force known
 //                client handshake (crash recovery) [rwp/osu]
+//   2026 Oct 17: added SUBSCRIBE/UNSUBSCRIBE broadcast filters
+//   2026 Oct 17: added STATS traffic statistics command
+//   2026 Oct 17: local socket and LOCAL clients in info
 //
 //---------------------------------------------------------------------------
 
@@ -60,11 +63,14 @@ isisCommand(char *cmdStr, char *replyStr)
 {
   char cmdWord[SHORT_STR_SIZE];  // command verb    
   char cmdArgs[MED_STR_SIZE];     // argument buffer
+  char *argPtr;                   // start of the arguments in cmdStr
   int  iport;
   int  i;
   char tstr[32];
   int  isExec = 0;
+  int  len;
   char errStr[MED_STR_SIZE];
+  char logFile[MED_STR_SIZE];
 
   // UDP Socket Communications
 
@@ -165,8 +171,7 @@ isisCommand(char *cmdStr, char *replyStr)
       sprintf(replyStr,"ERROR: FLUSH port %d out of range [0-%d]",iport,MAXSERIAL-1);
       return(MSG_REPLY);
     }
-    if (ttyTab[iport].fd > 0) {
-      tcflush(ttyTab[iport].fd,TCIOFLUSH);
+    if (serialFlush(iport) == 0) {
       sprintf(replyStr,"DONE: FLUSH serial port %d (%s) flushed",iport,
 	      ttyTab[iport].devName);
     } 
@@ -226,10 +231,52 @@ isisCommand(char *cmdStr, char *replyStr)
     return(MSG_REPLY);
   }
 
+  // SUBSCRIBE: restrict the broadcasts sent to the requesting client
+  //
+  // usage: SUBSCRIBE [Types=t1,t2,...] [Sources=id1,id2,...]
+  //        SUBSCRIBE ALL      (receive all broadcasts, the default)
+  //        SUBSCRIBE          (report the current subscription)
+  //
+  // UNSUBSCRIBE is an alias for SUBSCRIBE ALL.  See subscribeHost().
+
+  else if (strcasecmp(cmdWord,"SUBSCRIBE")==0 ||
+	   strcasecmp(cmdWord,"UNSUBSCRIBE")==0) {
+    if (isis.cmdHost == ISIS_SERVER) {
+      sprintf(replyStr,"ERROR: %s must be sent by a client",cmdWord);
+      return(MSG_REPLY);
+    }
+    if (strcasecmp(cmdWord,"UNSUBSCRIBE")==0)
+      subscribeHost(isis.cmdHost,(char *)"ALL",replyStr);
+    else {
+      argPtr = cmdStr;   // skip over [EXEC:] SUBSCRIBE
+      for (i=0; i<1+isExec; i++) {
+	argPtr += strspn(argPtr," ");
+	argPtr += strcspn(argPtr," ");
+      }
+      subscribeHost(isis.cmdHost,argPtr,replyStr);
+    }
+    return(MSG_REPLY);
+  }
+
+  // STATS: report traffic statistics
+  //
+  // usage: STATS        server totals and per-client message counts
+  //        STATS xx     detailed statistics for client xx
+  //        STATS RESET  clear all statistics
+  //
+  // See statsInfo() for the reply keywords
+
+  else if (strcasecmp(cmdWord,"STATS")==0) {
+    getArg(cmdStr,2+isExec,cmdArgs);
+    statsInfo(cmdArgs,replyStr);
+    return(MSG_REPLY);
+  }
+
   // LOG: report the name of the current runtime log
 
   else if (strcasecmp(cmdWord,"LOG")==0) {
-    sprintf(replyStr,"DONE: LOG logFile=%s",isis.logFile);
+    logInfo(logFile,NULL);
+    sprintf(replyStr,"DONE: LOG logFile=%s",logFile);
     return(MSG_REPLY);
   }
 
@@ -314,10 +361,10 @@ isisCommand(char *cmdStr, char *replyStr)
       strcpy(replyStr,"DONE: CONFIG NumClients=0");
     } else {
       strcpy(replyStr,"DONE: CONFIG ");
-      for (i=0; i<MAXCLIENTS; i++) {
+      len = strlen(replyStr);
+      for (i=0; i<isis.maxClients && len < ISIS_MSGSIZE-64; i++) {
 	if (clientTab[i].method != UNASSIGNED) {
-	  sprintf(tstr,"%s=ENABLED ",clientTab[i].ID);
-	  strcat(replyStr,tstr);
+	  len += sprintf(&replyStr[len],"%s=ENABLED ",clientTab[i].ID);
 	}
       }
     }
@@ -352,12 +399,15 @@ isisCommand(char *cmdStr, char *replyStr)
 int 
 serverInfo(char *replyStr)
 {
+  char logFile[MED_STR_SIZE];
+
+  logInfo(logFile,NULL);
   sprintf(replyStr,
 	  "DONE: STATUS HostName=%s HostAddr=%s:%d rcFile=%s logFile=%s numClients=%d %s %s %s %s\n",
 	  isis.serverID,\
 	  isis.localHost,isis.sockPort,
 	  isis.iniFile,
-	  isis.logFile,
+	  logFile,
 	  isis.numClients,
 	  ((isis.isVerbose) ? "Verbose":"Concise"),
 	  ((isis.doLogging) ? "+LOG":"-LOG"),
@@ -403,11 +453,14 @@ printHelp()
   printf("    PORTS     lists the active tty ports\n");
   printf("    FLUSH n   Flush tty port n of junk\n");
   printf("    REMOVE xx Remove host xx from the client host table\n");
+  printf("    SUBSCRIBE Types=t1,... Sources=id1,... Restrict broadcasts sent to a client\n");
+  printf("    UNSUBSCRIBE Receive all broadcasts again (same as SUBSCRIBE ALL)\n");
   printf("    UDPPING ip port Ping the named UDP socket port\n");
   printf(" Utilities\n");
   printf("    VERSION   Return program version info\n");
   printf("    HOST xx   Return info on a client host xx (or xx=all)\n");
   printf("    STATUS    Return a server status message\n");
+  printf("    STATS [xx|RESET] Report (or clear) message traffic and routing latency statistics\n");
   printf("    CONFIG    Displays current configuration with instrument info\n");
   printf("    TIME      Report the UTC time and date as FITS-like keywords\n");
   printf("    -LOG      Disable the server's runtime log temporarily\n");
@@ -435,27 +488,32 @@ printInfo()
 {
   if (!isis.useCLI) return;
   char inetstr[INET6_ADDRSTRLEN];
+  char logFile[MED_STR_SIZE];
   struct sockaddr_in client;
   int i;
 
+  logInfo(logFile,NULL);
+
   // Basic Server Information 
 
   printf("\nServer Information:\n");
   printf("  HostID: %s\n",isis.serverID);
   printf("  IPAddr: %s:%d\n",isis.localHost,isis.sockPort);
+  if (isis.localFD >= 0)
+    printf("  Socket: %s\n",isis.localPath);
   printf("  rcFile: %s\n",isis.iniFile);
-  printf(" logFile: %s\n",isis.logFile);
+  printf(" logFile: %s\n",logFile);
   printf("Server Status:\n");
   printf("  Started by user '%s' at %s\n",isis.userID,isis.startTime);
 
   // Give information about the ISIS clients 
 
   if (isis.numClients == 0) {
-    printf("  No clients connected (%d max)\n",MAXCLIENTS);
+    printf("  No clients connected (%d max)\n",isis.maxClients);
   }
   else {
-    printf("  Clients: %d of %d max\n",isis.numClients,MAXCLIENTS);
-    for (i=0; i<MAXCLIENTS; i++) {
+    printf("  Clients: %d of %d max\n",isis.numClients,isis.maxClients);
+    for (i=0; i<isis.maxClients; i++) {
       switch(clientTab[i].method) {
       case SERIAL:
 	printf("    %s: TTY %s\n",clientTab[i].ID,
@@ -471,6 +529,11 @@ printInfo()
 			 sizeof(inetstr)),clientTab[i].port);
 	break;
 
+      case LOCAL:
+	printf("    %s: Local %s\n",clientTab[i].ID,
+	       localPortName(clientTab[i].port));
+	break;
+
       default:
 	break;
 
@@ -504,6 +567,11 @@ printInfo()
     }
   }
 
+  // Runtime log
+
+  if (isis.doLogging)
+    printf("  Runtime Log: %s (%ld entries dropped)\n",logFile,isis.logDropped);
+
   // runtime flags 
 
   printf("  Flags: ");
@@ -522,6 +590,11 @@ printInfo()
   else
     printf("-HANDSHAKING ");
 
+  if (isis.epollFD >= 0)
+    printf("EPOLL ");
+  else
+    printf("SELECT ");
+
   printf("\n");
 
   // Instrument Config info 
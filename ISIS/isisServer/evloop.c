@@ -0,0 +1,592 @@
+//
+// evloop.c - ISIS server epoll event loop and batched datagram I/O
+//
+// Contents:
+//   initEventLoop()  - create the epoll instance and register descriptors
+//   rearmEventLoop() - re-register a descriptor reopened by a warm restart
+//   epollHandler()   - wait for and dispatch one pass of I/O events
+//   recvBatch()      - drain a server socket with recvmmsg()
+//   udpSend()        - send or queue a datagram for a network client
+//   localSend()      - send or queue a datagram for a local client
+//   flushSendQueue() - flush queued datagrams with sendmmsg()
+//   startSendBatch() - start queueing datagrams outside of recvBatch()
+//   endSendBatch()   - end a batch begun by startSendBatch() and flush it
+//
+// Date:
+//   2026 October 17
+//
+// Modification History:
+//   2026 Oct 17 - startSendBatch()/endSendBatch() so broadcasts are
+//                 always sent with sendmmsg()
+//   2026 Oct 17 - traffic and routing latency statistics
+//   2026 Oct 17 - Unix-domain socket for LOCAL clients
+//   2026 Oct 17 - watch the serial I/O wakeup pipe instead of the
+//                 tty ports
+//   2026 Oct 17 - rearmEventLoop() re-registers the serial descriptor
+//                 after a warm restart reopens the ports
+//
+
+/*!
+  \file evloop.c
+  \brief ISIS server epoll event loop and batched datagram I/O
+
+  On Linux the server uses epoll() for I/O multiplexing instead of
+  rebuilding an fd_set and calling select() on every pass.  When the
+  server socket is readable, recvBatch() drains it with recvmmsg() into
+  a batch of up to #ISIS_BATCHSIZE datagrams, routes the whole batch,
+  then flushes any outgoing UDP traffic generated while routing
+  (forwards, replies, and broadcast fan-out) with one sendmmsg() call.
+
+  The loop type is selected by the EventLoop keyword in the runtime
+  config file (EPOLL or SELECT).  Compiling with -DISIS_NOEPOLL removes
+  the epoll code and always uses the legacy select() loop in main.c.
+
+  udpSend() is the single path for datagrams sent to network clients,
+  and localSend() for same-host clients on the server's Unix-domain
+  socket (see openLocalSocket()), which is drained by recvBatch() the
+  same way.  Outside of a batch they call sendto() directly, so code
+  running outside the event loop (handshaking, the CLI, warm restarts)
+  is unaffected.
+*/
+
+#include "isisserver.h"
+
+#include <readline/readline.h>
+
+// Outgoing datagram queue, only used while routing a received batch
+
+#ifdef ISIS_EPOLL
+
+static struct {
+  int  client;                        // client table index (for errors)
+  int  len;                           // message length in bytes
+  int  fd;                            // server socket to send on
+  dgramaddr_t addr;                   // destination address
+  socklen_t addrLen;                  // length of the destination address
+  char *msg;                          // message text, in recvBuf or buf
+  long long rxTime;                   // when the triggering message arrived
+  char buf[ISIS_MSGSIZE];             // copy of a message built elsewhere
+} sendQueue[ISIS_BATCHSIZE];
+
+static int numQueued = 0;             // number of queued datagrams
+static int inBatch = isis_FALSE;      // queue sends if TRUE
+
+// Incoming datagram batch buffers
+
+static char recvBuf[ISIS_BATCHSIZE][ISIS_MSGSIZE];
+static dgramaddr_t recvAddr[ISIS_BATCHSIZE];
+
+#endif
+
+//---------------------------------------------------------------------------
+//
+// initEventLoop()
+//
+
+/*!
+  \brief Create the epoll instance and register the server descriptors
+  \param kbdFD Keyboard file descriptor, ignored if not using the CLI
+  \return 0 if successful, -1 on errors or if epoll is not available.
+
+  Registers the server socket and local socket (if open), the keyboard
+  (CLI mode only), and the serial I/O wakeup pipe (if there are serial
+  ports) with a new epoll instance, and stores its file
+  descriptor in isis.epollFD.  On failure isis.epollFD is left at -1
+  and the calling program should fall back to the select() loop.
+*/
+
+int
+initEventLoop(int kbdFD)
+{
+#ifdef ISIS_EPOLL
+  struct epoll_event ev;
+  char errStr[256];
+
+  isis.epollFD = epoll_create1(0);
+  if (isis.epollFD < 0) {
+    sprintf(errStr,"ERROR: Could not create epoll instance - %s",
+	    strerror(errno));
+    if (isis.useCLI)
+      printf("%s\n",errStr);
+    else
+      logMessage(errStr);
+    isis.epollFD = -1;
+    return(-1);
+  }
+
+  memset(&ev,0,sizeof(ev));
+  ev.events = EPOLLIN;
+
+  ev.data.fd = isis.sockFD;
+  if (epoll_ctl(isis.epollFD,EPOLL_CTL_ADD,isis.sockFD,&ev) < 0)
+    goto failed;
+
+  if (isis.localFD >= 0) {
+    ev.data.fd = isis.localFD;
+    if (epoll_ctl(isis.epollFD,EPOLL_CTL_ADD,isis.localFD,&ev) < 0)
+      goto failed;
+  }
+
+  if (isis.useCLI) {
+    ev.data.fd = kbdFD;
+    if (epoll_ctl(isis.epollFD,EPOLL_CTL_ADD,kbdFD,&ev) < 0)
+      goto failed;
+  }
+
+  if (isis.serialFD >= 0) {
+    ev.data.fd = isis.serialFD;
+    if (epoll_ctl(isis.epollFD,EPOLL_CTL_ADD,isis.serialFD,&ev) < 0)
+      goto failed;
+  }
+
+  return(0);
+
+ failed:
+  sprintf(errStr,"ERROR: Could not register fd %d with epoll - %s",
+	  ev.data.fd,strerror(errno));
+  if (isis.useCLI)
+    printf("%s\n",errStr);
+  else
+    logMessage(errStr);
+  close(isis.epollFD);
+  isis.epollFD = -1;
+  return(-1);
+
+#else
+  isis.epollFD = -1;
+  return(-1);
+#endif
+}
+
+//---------------------------------------------------------------------------
+//
+// rearmEventLoop()
+//
+
+/*!
+  \brief Re-register a reopened descriptor with the epoll instance
+  \param oldFD descriptor registered before it was reopened, -1 if none
+  \param newFD descriptor to register in its place, -1 if none
+  \return 0 if successful, -1 on errors.
+
+  The epoll instance only watches the descriptors registered with it,
+  so a descriptor that is closed and reopened, like the serial I/O
+  wakeup pipe when a warm restart reopens the serial ports, has to be
+  taken out with EPOLL_CTL_DEL and put back with EPOLL_CTL_ADD.  The
+  old descriptor may already have been closed, which removed it
+  from the epoll set, so that error is ignored.  Does nothing if the
+  server is using the select() loop, which rebuilds its descriptor set
+  on every pass.
+*/
+
+int
+rearmEventLoop(int oldFD, int newFD)
+{
+#ifdef ISIS_EPOLL
+  struct epoll_event ev;
+  char errStr[256];
+
+  if (isis.epollFD < 0)
+    return(0);
+
+  if (oldFD >= 0)
+    epoll_ctl(isis.epollFD,EPOLL_CTL_DEL,oldFD,NULL);
+
+  if (newFD < 0)
+    return(0);
+
+  memset(&ev,0,sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = newFD;
+  if (epoll_ctl(isis.epollFD,EPOLL_CTL_ADD,newFD,&ev) < 0) {
+    sprintf(errStr,"ERROR: Could not register fd %d with epoll - %s",
+	    newFD,strerror(errno));
+    if (isis.useCLI)
+      printf("%s\n",errStr);
+    else
+      logMessage(errStr);
+    return(-1);
+  }
+  return(0);
+
+#else
+  return(0);
+#endif
+}
+
+//---------------------------------------------------------------------------
+//
+// epollHandler()
+//
+
+/*!
+  \brief Wait for and dispatch one pass of I/O events
+  \param kbdFD Keyboard file descriptor, ignored if not using the CLI
+  \return Number of ready descriptors, or <0 if epoll_wait() failed
+  (errno is preserved for the caller).
+
+  The epoll counterpart of one pass of the select() loop in main():
+  socket input goes to recvBatch(), keyboard input to the readline
+  callback, and serial I/O thread wakeups to serialHandler().
+*/
+
+int
+epollHandler(int kbdFD)
+{
+#ifdef ISIS_EPOLL
+  struct epoll_event events[ISIS_MAXEVENTS];
+  int numReady;
+  int i;
+  int fd;
+
+  numReady = epoll_wait(isis.epollFD,events,ISIS_MAXEVENTS,-1);
+  if (numReady <= 0)
+    return(numReady);
+
+  for (i=0; i<numReady; i++) {
+    fd = events[i].data.fd;
+
+    if (fd == isis.sockFD || fd == isis.localFD) {  // pending socket input
+      recvBatch(fd);
+      if (isis.useCLI) rl_refresh_line(0,0);
+    }
+    else if (isis.useCLI && fd == kbdFD) {  // pending keyboard input
+      rl_callback_read_char();
+    }
+    else if (fd == isis.serialFD) {  // pending serial input
+      serialHandler();
+      if (isis.useCLI) rl_refresh_line(0,0);
+    }
+  }
+
+  return(numReady);
+
+#else
+  errno = ENOSYS;
+  return(-1);
+#endif
+}
+
+//---------------------------------------------------------------------------
+//
+// recvBatch()
+//
+
+/*!
+  \brief Drain a server socket with recvmmsg() and route the batch
+  \param sockFD File descriptor of the server's UDP or Unix-domain socket.
+
+  Reads up to #ISIS_BATCHSIZE datagrams per recvmmsg() call without
+  blocking, hands each one to routeDatagram(), and then flushes all
+  UDP sends queued while routing with a single sendmmsg().  A full batch
+  is followed by another read, up to 4 batches per call, so a burst is
+  drained in one wakeup without starving the keyboard and serial ports.
+  Anything left is picked up on the next (level-triggered) pass.
+
+  If epoll support was not compiled in, this is socketHandler().
+*/
+
+void
+recvBatch(int sockFD)
+{
+#ifdef ISIS_EPOLL
+  struct mmsghdr msgs[ISIS_BATCHSIZE];
+  struct iovec iovecs[ISIS_BATCHSIZE];
+  char errStr[256];
+  int numRecv;
+  int pass;
+  int i;
+
+  for (pass=0; pass<4; pass++) {
+
+    memset(msgs,0,sizeof(msgs));
+    for (i=0; i<ISIS_BATCHSIZE; i++) {
+      iovecs[i].iov_base = recvBuf[i];
+      iovecs[i].iov_len  = ISIS_MSGSIZE-2;  // room for frameMessage()'s \r\0
+      msgs[i].msg_hdr.msg_iov = &iovecs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      msgs[i].msg_hdr.msg_name = &recvAddr[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(recvAddr[i]);
+    }
+
+    numRecv = recvmmsg(sockFD,msgs,ISIS_BATCHSIZE,MSG_DONTWAIT,NULL);
+
+    if (numRecv < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+	sprintf(errStr,"ERROR: Cannot recvmmsg() network socket - %s",
+		strerror(errno));
+	if (isis.useCLI) printf("\n%s\n",errStr);
+	logMessage(errStr);
+      }
+      return;
+    }
+
+    // Route the batch, queueing the resulting UDP traffic
+
+    isis.rxTime = monoTime();
+    inBatch = isis_TRUE;
+    for (i=0; i<numRecv; i++) {
+      recvBuf[i][msgs[i].msg_len] = NUL;
+      routeDatagram(recvBuf[i],&recvAddr[i],msgs[i].msg_hdr.msg_namelen);
+    }
+    inBatch = isis_FALSE;
+    flushSendQueue();
+    isis.rxTime = 0;  // later traffic is not a reply to this batch
+
+    if (numRecv < ISIS_BATCHSIZE)
+      return;
+  }
+
+#else
+  socketHandler(sockFD);
+#endif
+}
+
+//---------------------------------------------------------------------------
+//
+// dgramSend()
+//
+
+/*!
+  \brief Send a datagram on one of the server sockets, or queue it inside a batch
+  \param iHost Client table index of the recipient (for error reports), or
+  -1 if not a client table entry
+  \param fd Server socket to send on, isis.sockFD or isis.localFD
+  \param addr Socket address of the recipient
+  \param addrLen Length of the recipient's address
+  \param message Message to send, already IMPv2 terminated
+  \param msgLen Length of the message in bytes
+  \return Number of bytes sent or queued, or -1 on errors.
+
+  Common code of udpSend() and localSend().
+*/
+
+static int
+dgramSend(int iHost, int fd, struct sockaddr *addr, socklen_t addrLen,
+	  char *message, int msgLen)
+{
+  int numSent;
+  char errStr[256];
+  const char *sockType = (fd == isis.sockFD) ? "Network" : "Local";
+
+#ifdef ISIS_EPOLL
+  if (inBatch && msgLen < ISIS_MSGSIZE) {
+    if (numQueued == ISIS_BATCHSIZE)
+      flushSendQueue();
+    sendQueue[numQueued].client = iHost;
+    sendQueue[numQueued].len = msgLen;
+    sendQueue[numQueued].fd = fd;
+    memcpy(&sendQueue[numQueued].addr,addr,addrLen);
+    sendQueue[numQueued].addrLen = addrLen;
+    sendQueue[numQueued].rxTime = isis.rxTime;
+
+    // Messages framed in place in a receive buffer stay put until the
+    // batch is flushed, anything else must be copied
+
+    if (message >= recvBuf[0] && message < recvBuf[ISIS_BATCHSIZE])
+      sendQueue[numQueued].msg = message;
+    else {
+      memcpy(sendQueue[numQueued].buf,message,msgLen);
+      sendQueue[numQueued].msg = sendQueue[numQueued].buf;
+    }
+    numQueued++;
+    statsSent(iHost,msgLen);
+    return(msgLen);
+  }
+#endif
+
+  numSent = sendto(fd,message,msgLen,0,addr,addrLen);
+  statsSent(iHost,msgLen);
+  if (numSent < msgLen) {
+    statsSendError(iHost);
+    if (iHost >= 0)
+      sprintf(errStr,"ERROR: %s Socket sendto() Error, Client %d (%s) - %s",
+	      sockType,iHost,clientTab[iHost].ID,strerror(errno));
+    else
+      sprintf(errStr,"ERROR: %s Socket sendto() Error - %s",
+	      sockType,strerror(errno));
+    if (isis.useCLI)
+      printf("%s\n",errStr);
+    else
+      logMessage(errStr);
+    return(-1);
+  }
+  if (isis.rxTime > 0) statsLatency(isis.rxTime,monoTime());
+  return(numSent);
+}
+
+//---------------------------------------------------------------------------
+//
+// udpSend()
+//
+
+/*!
+  \brief Send a datagram to a network client, or queue it inside a batch
+  \param iHost Client table index of the recipient (for error reports), or
+  -1 if not a client table entry
+  \param client Network address of the recipient
+  \param message Message to send, already IMPv2 terminated
+  \param msgLen Length of the message in bytes
+  \return Number of bytes sent or queued, or -1 on errors.
+
+  While recvBatch() is routing a batch the message is queued and sent
+  by flushSendQueue(), otherwise it goes out immediately with sendto().
+  Forwards and broadcasts framed in place in a batch receive buffer
+  (see frameMessage()) are queued by reference, everything else (server
+  replies, error messages) is copied into the queue.  Errors are reported on the console in
+  CLI mode or in the runtime log otherwise.
+*/
+
+int
+udpSend(int iHost, struct sockaddr_in *client, char *message, int msgLen)
+{
+  return(dgramSend(iHost,isis.sockFD,(struct sockaddr *)client,
+		   sizeof(*client),message,msgLen));
+}
+
+//---------------------------------------------------------------------------
+//
+// localSend()
+//
+
+/*!
+  \brief Send a datagram to a local client, or queue it inside a batch
+  \param iHost Client table index of the recipient (for error reports), or
+  -1 if not a client table entry
+  \param iPort Local socket table index of the recipient (see findLocalPort())
+  \param message Message to send, already IMPv2 terminated
+  \param msgLen Length of the message in bytes
+  \return Number of bytes sent or queued, or -1 on errors.
+
+  The Unix-domain socket counterpart of udpSend(), batched the same way.
+*/
+
+int
+localSend(int iHost, int iPort, char *message, int msgLen)
+{
+  if (isis.localFD < 0 || iPort < 0 || iPort >= MAXLOCAL ||
+      localTab[iPort].addrLen == 0) {
+    statsSendError(iHost);
+    return(-1);
+  }
+  return(dgramSend(iHost,isis.localFD,&localTab[iPort].addr.sa,
+		   localTab[iPort].addrLen,message,msgLen));
+}
+
+//---------------------------------------------------------------------------
+//
+// flushSendQueue()
+//
+
+/*!
+  \brief Send all queued datagrams with sendmmsg()
+
+  Sends the outgoing queue built by udpSend() and localSend() during a
+  batch, one sendmmsg() call for each run of datagrams going out on the
+  same socket.  If sendmmsg() stops short on an error, the failed
+  datagram is reported and dropped, and the rest of the queue is sent.
+*/
+
+void
+flushSendQueue(void)
+{
+#ifdef ISIS_EPOLL
+  struct mmsghdr msgs[ISIS_BATCHSIZE];
+  struct iovec iovecs[ISIS_BATCHSIZE];
+  char errStr[256];
+  long long now;
+  int numSent;
+  int first;
+  int last;
+  int i;
+
+  if (numQueued == 0) return;
+
+  memset(msgs,0,sizeof(msgs));
+  for (i=0; i<numQueued; i++) {
+    iovecs[i].iov_base = sendQueue[i].msg;
+    iovecs[i].iov_len  = sendQueue[i].len;
+    msgs[i].msg_hdr.msg_iov = &iovecs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_name = &sendQueue[i].addr;
+    msgs[i].msg_hdr.msg_namelen = sendQueue[i].addrLen;
+  }
+
+  first = 0;
+  while (first < numQueued) {
+    for (last=first+1; last<numQueued && sendQueue[last].fd == sendQueue[first].fd; last++);
+    numSent = sendmmsg(sendQueue[first].fd,&msgs[first],last-first,0);
+    if (numSent > 0) {
+      now = monoTime();
+      for (i=first; i<first+numSent; i++)
+	statsLatency(sendQueue[i].rxTime,now);
+    }
+    else if (numSent < 0) {
+      i = sendQueue[first].client;
+      statsSendError(i);
+      if (i >= 0)
+	sprintf(errStr,"ERROR: %s Socket sendmmsg() Error, Client %d (%s) - %s",
+		(sendQueue[first].fd == isis.sockFD) ? "Network" : "Local",
+		i,clientTab[i].ID,strerror(errno));
+      else
+	sprintf(errStr,"ERROR: %s Socket sendmmsg() Error - %s",
+		(sendQueue[first].fd == isis.sockFD) ? "Network" : "Local",
+		strerror(errno));
+      if (isis.useCLI)
+	printf("%s\n",errStr);
+      else
+	logMessage(errStr);
+      numSent = 1;  // skip the failed datagram
+    }
+    first += numSent;
+  }
+
+  numQueued = 0;
+#endif
+}
+
+//---------------------------------------------------------------------------
+//
+// startSendBatch() and endSendBatch()
+//
+
+/*!
+  \brief Start queueing datagrams for a batched send
+  \return TRUE if a batch was already in progress, FALSE otherwise, to be
+  passed to endSendBatch()
+
+  Lets code outside of recvBatch(), like broadcasts from the server
+  console, queue a burst of UDP datagrams with udpSend() and send them
+  with one sendmmsg().  Calls may nest, only the outermost
+  endSendBatch() flushes the queue.
+*/
+
+int
+startSendBatch(void)
+{
+#ifdef ISIS_EPOLL
+  int wasInBatch = inBatch;
+  inBatch = isis_TRUE;
+  return(wasInBatch);
+#else
+  return(isis_FALSE);
+#endif
+}
+
+/*!
+  \brief End a batched send begun by startSendBatch()
+  \param wasInBatch value returned by the matching startSendBatch() call
+
+  If this ends the outermost batch, sends everything queued with
+  flushSendQueue().
+*/
+
+void
+endSendBatch(int wasInBatch)
+{
+#ifdef ISIS_EPOLL
+  if (wasInBatch) return;
+  inBatch = isis_FALSE;
+  flushSendQueue();
+#endif
+}
@@ -4,11 +4,14 @@
 // Contents:
 //    openSocket()  - Open and setup the ISIS server UDP network socket
 //    closeSocket() - Close the ISIS server UDP network socket
+//    openLocalSocket()  - Open the ISIS server Unix-domain datagram socket
+//    closeLocalSocket() - Close and remove the Unix-domain datagram socket
 //    initSerialPorts() - Open/Initialize server serial ports
 //    getSerialInfo()   - Map a serial port fd onto a serial port table entry
 //    handShake()       - handshake with the serial ports
-//    serialHandler()   - handle messages from serial ports
-//    socketHandler()   - handle messages from the server network socket
+//    serialHandler()   - handle lines received by the serial I/O threads
+//    socketHandler()   - handle messages from the server UDP or local socket
+//    routeDatagram()   - parse and route one network or local socket message
 //    ttyHandler()      - keyboard input from the server console
 //
 // Author: 
@@ -19,6 +22,15 @@
 // Modification History:
 //   2004 May 11 - introduced Doxygen documentation comment blocks [rwp/osu]
 //   2009 Mar 18 - v2 updates [rwp/osu]
+//   2026 Oct 17 - split routeDatagram() out of socketHandler() for
+//                 the recvmmsg() batching event loop
+//   2026 Oct 17 - handlers use preallocated buffers and parseIMPv2()
+//                 instead of malloc() and getArg()/sscanf()
+//   2026 Oct 17 - receive time stamps and counts for STATS
+//   2026 Oct 17 - received messages go to the traffic capture
+//   2026 Oct 17 - Unix-domain datagram socket for same-host clients
+//   2026 Oct 17 - serial ports are read and written by I/O threads,
+//                 serialHandler() routes the lines they queue
 //
 
 #include "isisserver.h"
@@ -31,15 +43,17 @@
 
   Three basic routines are provided for handling input message traffic 
   on the various server interfaces:
-  \arg serialHandler() Server serial port input input handler
-  \arg socketHandler() Server UDP network socket input handler
+  \arg serialHandler() Server serial port input handler (lines queued by the serial I/O threads)
+  \arg socketHandler() Server UDP network and Unix-domain socket input handler
   \arg ttyHandler() Keyboard input at the server console (readline callback)
   These handlers are designed to be called from within the select()
-  communications multiplexing loop when input is available on the
-  watched file descriptors.
+  or epoll() communications multiplexing loop when input is available
+  on the watched file descriptors (see evloop.c).
 
 */
 
+static void routeSerial(int, char *, int);
+
 
 //---------------------------------------------------------------------------
 //
@@ -171,6 +185,115 @@ closeSocket(int sockFD)
   return;
 }
 
+//---------------------------------------------------------------------------
+//
+// openLocalSocket()
+//
+
+/*!
+  \brief Open the ISIS server Unix-domain datagram socket
+  \param sockPath path of the socket, a leading @ names an abstract
+  (Linux) socket instead of a file
+  \return 0 if successful, -1 if errors occurred.
+
+  Clients running on the same host as the server can use this socket
+  instead of UDP, saving the trip through the IP stack.  They are
+  entered in the client host table with the LOCAL transport method.
+  Messages are routed exactly as for UDP clients, and remote clients
+  are unaffected.
+
+  Any stale socket file left at sockPath by a previous server is
+  removed, and the new one is made writable by all, like a UDP port.
+  The file descriptor is stored in isis.localFD.
+
+  \sa closeLocalSocket()
+*/
+
+int
+openLocalSocket(char *sockPath)
+{
+  struct sockaddr_un server;
+  socklen_t serverLen;
+  char errStr[256];
+
+  isis.localFD = -1;
+  if (strlen(sockPath) == 0 || strlen(sockPath) >= sizeof(server.sun_path)) {
+    sprintf(errStr,"ERROR: Invalid ISIS server local socket path '%s'",sockPath);
+    if (isis.useCLI)
+      printf("%s\n",errStr);
+    else
+      logMessage(errStr);
+    return(-1);
+  }
+
+  memset(&server,0,sizeof(server));
+  server.sun_family = AF_UNIX;
+  strcpy(server.sun_path,sockPath);
+  if (sockPath[0] == '@') {
+    server.sun_path[0] = NUL;
+    serverLen = offsetof(struct sockaddr_un,sun_path) + strlen(sockPath);
+  }
+  else {
+    unlink(sockPath);
+    serverLen = sizeof(server);
+  }
+
+  if ((isis.localFD = socket(AF_UNIX,SOCK_DGRAM,0)) < 0) {
+    sprintf(errStr,"ERROR: Could not create ISIS server local socket - %s",
+	    strerror(errno));
+    if (isis.useCLI)
+      printf("%s\n",errStr);
+    else
+      logMessage(errStr);
+    isis.localFD = -1;
+    return(-1);
+  }
+
+  if (bind(isis.localFD,(struct sockaddr *) &server,serverLen) < 0) {
+    sprintf(errStr,"ERROR: Could not bind server local socket to %s - %s",
+	    sockPath,strerror(errno));
+    if (isis.useCLI)
+      printf("%s\n",errStr);
+    else
+      logMessage(errStr);
+    close(isis.localFD);
+    isis.localFD = -1;
+    return(-1);
+  }
+  if (sockPath[0] != '@')
+    chmod(sockPath,0666);
+
+  return(0);
+
+}
+
+//---------------------------------------------------------------------------
+//
+// closeLocalSocket()
+//
+
+/*!
+  \brief Close the ISIS server Unix-domain datagram socket
+
+  Closes the socket opened by openLocalSocket(), if any, and removes
+  its socket file.
+
+  \sa openLocalSocket()
+*/
+
+void
+closeLocalSocket(void)
+{
+  if (isis.localFD < 0) return;
+
+  close(isis.localFD);
+  isis.localFD = -1;
+  if (isis.localPath[0] != '@')
+    unlink(isis.localPath);
+
+  return;
+}
+
 //---------------------------------------------------------------------------
 //
 // initSerialPorts()
@@ -184,7 +307,8 @@ closeSocket(int sockFD)
   table (ttyTab struct, defined by entries in the runtime config file).
   It also attempts to close them first, allowing this function to also
   be used to re-initialize the ports.  One failure is enough to cause an
-  abort.
+  abort.  Once the ports are open, their I/O threads are (re)started
+  with startSerialIO().
 
 */
 
@@ -197,21 +321,25 @@ initSerialPorts()
   int numOpen = 0;
   char errStr[256];
 
-  // If there are no serial ports in the table, return now 
-
-  if (isis.numSerial == 0) 
-    return(0);
-
   // Check to see if any of the serial port file handles are open
   // and close them now.  This lets us use InitSerial to re-init ports.
-  // In any case, set the port fd's to -1 to mark as disabled.
-  
-  for (i=0; i<isis.numSerial; i++) {
+  // In any case, set the port fd's to -1 to mark as disabled.  The
+  // I/O threads must be stopped before their ports are closed.  All
+  // of the table is swept, since a warm restart may have reloaded a
+  // config file with fewer ports than before.
+
+  stopSerialIO();
+  for (i=0; i<MAXSERIAL; i++) {
     if (ttyTab[i].fd > 0) 
       status = close(ttyTab[i].fd);
     ttyTab[i].fd = -1;
   }
 
+  // If there are no serial ports in the table, return now 
+
+  if (isis.numSerial == 0) 
+    return(0);
+
   // Attempt to open the ports and set the attributes 
 
   for (i=0; i<isis.numSerial; i++) {
@@ -229,7 +357,7 @@ initSerialPorts()
     }
     tcgetattr(ttyTab[i].fd, &tty);
     tty.c_iflag &= ~ISTRIP;     
-    tty.c_lflag |= ICANON;
+    tty.c_lflag &= ~ICANON;     // the I/O thread assembles lines
     tty.c_lflag &= ~ECHO;
     tty.c_cflag |= CS8;
     tty.c_cflag |= CREAD;
@@ -245,6 +373,11 @@ initSerialPorts()
     
   } // isis.numSerial loop 
 
+  // Start the I/O threads that service the ports
+
+  if (startSerialIO() < 0)
+    return(-1);
+
   return(numOpen); // Return the number of open ports 
 
 }
@@ -308,7 +441,6 @@ handShake()
   char message[MED_STR_SIZE];
   int iPort; 
   int serialFD;
-  int bytesSent;
   struct sockaddr_in client;  // network client socket info   
   int clientLen;       
   int numSent;
@@ -337,10 +469,9 @@ handShake()
       serialFD = ttyTab[iPort].fd;
       if (serialFD > 0) 
 	tcflush(serialFD,TCIOFLUSH);
-      bytesSent = write(serialFD,message,strlen(message));
-      if (bytesSent < 0) {
-	sprintf(errStr,"ERROR: Serial Port write() Error on %s - %s\n",
-		ttyTab[iPort].devName,strerror(errno));
+      if (serialSend(iPort,message,strlen(message)) < 0) {
+	sprintf(errStr,"ERROR: Serial Port %s not accepting output, handshake not sent",
+		ttyTab[iPort].devName);
 	if (isis.useCLI)
 	  printf("%s\n",errStr);
 	else
@@ -389,210 +520,157 @@ handShake()
 //
 
 /*!
-  \brief Handle input from server serial ports.
-  \param serialFD File descriptor of the serial port with input ready.
+  \brief Handle lines received by the serial port I/O threads.
 
-  Reads a line of input from the specified serial port file descriptor,
-  and spits the message into components: source host ID, destination
+  Called when the serial I/O wakeup pipe (isis.serialFD) is readable.
+  Reports any errors noted by the I/O threads, then takes each line
+  they have queued (see serialRecv()) and passes it to routeSerial().
+  The serial ports themselves are never read or written here, so a
+  slow or wedged device cannot stall the event loop.
+
+  This function is designed to be invoked by a select() or epoll()
+  loop that watches isis.serialFD.  See main.c for how it is
+  implemented.
+*/
+
+void
+serialHandler(void)
+{
+  static char message[ISIS_MSGSIZE];  // preallocated input buffer
+  long long rxTime;
+  int numLines;
+  int numBytes;
+  int iPort;
+
+  numLines = serialWakeup();
+  while (numLines-- > 0) {
+    numBytes = serialRecv(&iPort,message,&rxTime);
+    if (numBytes < 0) break;
+    isis.rxTime = rxTime;
+    routeSerial(iPort,message,numBytes);
+  }
+  isis.rxTime = 0;
+}
+
+//---------------------------------------------------------------------------
+//
+// routeSerial()
+//
+
+/*!
+  \brief Parse and route one line received on a serial port.
+  \param iPort Serial port table index of the port the line came from
+  \param message The line, NUL-terminated, with room for 2 more bytes
+  \param numBytes Length of the line in bytes
+
+  Splits the message into components: source host ID, destination
   host ID, and message body (including message type).
 
   If the source and destination are valid, and the message is not blank
-  or malformed, it then passes the message off to HandleMessage() to
+  or malformed, it then passes the message off to routeMessage() to
   route the message to its intended recipient.
 
   When generating IMPv2 messages for direct transmission through the
   server, the strings must be terminated with return (\\r = ASCII 13)
   not a newline (\\n = ASCII 10).
-
-  This function is designed to be invoked by a select() loop that watches
-  particular file descriptors.  See main.c for how it is implemented.
 */
 
-void
-serialHandler(int serialFD) 
+static void
+routeSerial(int iPort, char *message, int numBytes)
 {
-  char srcID[IMPv2_HOST_SIZE];
-  char destID[IMPv2_HOST_SIZE];
-  char argStr[MED_STR_SIZE];
-  char *reply;
-  char *msgBody;
+  static char reply[ISIS_MSGSIZE];    // preallocated reply buffer
+  impv2_t msg;
 
   int sendHost;   // index of the srcID in the host table                    
   int destHost;   // index of the destID in the host table                   
-  int numBytes;   // number of bytes read from the serial port          
-  int iPort;      // index of the serial port in the serial table            
-
-  // Dynamically allocate the message string buffer
-
-  char *message = (char *)malloc((ISIS_MSGSIZE)*sizeof(char));
-
-  // Clear it 
-
-  memset(message, 0, ISIS_MSGSIZE);
- 
-  // Allocate a reply buffer now (needed to log errors) 
-
-  reply = (char *)malloc((ISIS_MSGSIZE)*sizeof(char));
-  memset(reply, 0, ISIS_MSGSIZE);
 
-  // Get information about this serial port for later.  If we fail
-  // something evil is happening, so squawk, log and exit with a fatal
-  // error.  
-  
-  iPort = getSerialInfo(serialFD);
-  if (iPort == ERR_UNKNOWN_FD) {
-    sprintf(reply,"ERROR Unknown serial FD %d, serial table corrupted?",
-	    serialFD);
-    if (isis.useCLI) printf("\n%s\n",reply);
-    logMessage(reply);
-    free(reply);
-    free(message);
-    return;
-  }    
-
-  // read the message from the serial port 
-
-  numBytes = read(serialFD, message, ISIS_MSGSIZE);
-
-  // read error: report back to the server console, free buffers, and return 
-
-  if (numBytes < 0) {
-    sprintf(reply,"ERROR cannot read() from serial port %s - %s",
-	    ttyTab[iPort].devName,strerror(errno));
-    if (isis.useCLI) printf("\n%s\n",reply);
-    logMessage(reply);
-    free(reply);
-    free(message);
-    return;
-  }
-
-  // Allocate the message body buffer 
-
-  msgBody = (char *)malloc((ISIS_MSGSIZE)*sizeof(char));
-  memset(msgBody,0,ISIS_MSGSIZE);
-
-  // strip off any \n or \r terminators at the end of the message string 
-
-  if (message[strlen(message)-1]=='\n') message[strlen(message)-1]='\0';
-  if (message[strlen(message)-1]=='\r') message[strlen(message)-1]='\0';
-
-  // Extract the first token from the message, this should be the the
-  // address header of the IMPv2 message in "SourceID>DestID" form
+  // Split the message in place into its components: source and
+  // destination host IDs and the message body.
 
-  getArg(message,1,argStr);
-  
-  // Check to see if there is a ">" in the first token.  If present,
-  // break it into components.
-
-  if (strstr(argStr,">")) {
-    sscanf(message,"%[^>]>%s %[^\n]",srcID,destID,msgBody);
-    upperCase(srcID);
-    upperCase(destID);
-
-  }
-  else {
+  if (parseIMPv2(message,&msg) < 0) {
     // Malformed message: move on and don't bother logging except to
     // give a warning on the console in CLI mode
-    sprintf(reply,"ERROR: Malformed message received on serial port %s: '%s' [size: %d bytes]",
-	    ttyTab[iPort].devName,message,strlen(message));
-    
-    if (isis.useCLI) printf("\n%s\n",reply);
-    free(message);
-    free(reply);
-    free(msgBody);
+    if (isis.useCLI)
+      printf("\nERROR: Malformed message received on serial port %s: '%s' [size: %d bytes]\n",
+	     ttyTab[iPort].devName,message,numBytes);
     return;
   }
 
-  // We are all done with the raw message, and from here on out we only
-  // work with its components.  Log it, echo it to the screen if in
-  // verbose mode, and then free the incoming message memory now so
-  // we don't forget later (leak abatement).  We only log non-blank
-  // messages.
+  // From here on out we only work with the message components.  Log
+  // it and echo it to the screen if in verbose mode.  The address
+  // header in the buffer is still intact at this point.
    
   if (isis.isVerbose && isis.useCLI) printf("\n%s\n",message);
   logMessage(message);
-  free(message);
+  captureMessage(&msg,SERIAL,0,iPort);
 
   // We have an IMPv2-conformal message string and its components:
-  //   srcID = hostID of the sender
-  //   destID = hostID if the intended recipient
-  //   msgBody = message test to be delivered to destID
+  //   msg.srcID = hostID of the sender
+  //   msg.destID = hostID if the intended recipient
+  //   msg.body = message test to be delivered to destID
   // Now we deal with it.
 
   // Update the host table with the srcID client information 
   
-  sendHost = updateHosts(srcID,SERIAL,serialFD,0,iPort);
+  sendHost = updateHosts(msg.srcID,SERIAL,ttyTab[iPort].fd,0,iPort);
 
   // If the host table is full, we got problems.  Hit the console screen
   // and runtime log with an error message, try to echo one back to the
-  // sender port, clean up, and return.
+  // sender port, and return.
 
   if (sendHost == ERR_HOSTS_FULL) {
     sprintf(reply,
-    "ERROR: ISIS Host Table Full, cannot create entry for tty port client %s",srcID);
+    "ERROR: ISIS Host Table Full, cannot create entry for tty port client %s",msg.srcID);
     if (isis.useCLI) printf("\n%s\n",reply);
     logMessage(reply);
-    memset(reply,0,ISIS_MSGSIZE);
     sprintf(reply,
 	    "%s>%s ERROR: ISIS Server Host Table Full, Cannot Service Request\r",
-	    isis.serverID,srcID);
-    numBytes = write(serialFD, reply, sizeof(reply));
-    free(reply);
-    free(msgBody);
+	    isis.serverID,msg.srcID);
+    serialSend(iPort,reply,strlen(reply));
     return;
   }    
+  statsReceived(sendHost,numBytes);
 
   // If msgBody is blank, make note of it but take no further action.  This
   // is a "heartbeat" message in IMPv2.
 
-  if (strlen(msgBody)==0) {
-    free(msgBody);
+  if (msg.bodyLen == 0)
     return;
-  }
 
   // Validate the destination host 
 
-  if (strcasecmp(destID,isis.serverID)==0) {
+  if (strcasecmp(msg.destID,isis.serverID)==0) {
     destHost = ISIS_SERVER;
 
   } 
-  else if (strcasecmp(destID,"AL")==0) {
+  else if (strcmp(msg.destID,"AL")==0) {
     destHost = BROADCAST;
 
   }
   else {
-    destHost = isKnownHost(destID);
+    destHost = isKnownHost(msg.destID);
 
     // Oops! destination is an unknown host, so we don't know how to
     // route the message.  Gripe.
 
     if (destHost == ERR_UNKNOWN_HOST) {
       sprintf(reply,"%s>%s ERROR: No Route to Destination Host %s - host is unknown/unlisted\r",
-	      isis.serverID,srcID,destID);
+	      isis.serverID,msg.srcID,msg.destID);
       sendMessage(sendHost,reply);
       if (reply[strlen(reply)-1]=='\r') reply[strlen(reply)-1]='\0';
       logMessage(reply);
       if (isis.isVerbose && isis.useCLI) printf("\n<< %s >>\n",reply);
-      free(msgBody);
-      free(reply);
       return;
     }
 
   }
 
-  // All done with the reply buffer, free it 
-
-  free(reply);
-
   // We have valid source and destination hosts, and a non-blank
-  // message.  Hand them off to handleMessage() for processing, return
-  // when it is done.  [future multithreading point?]
+  // message.  Hand them off to routeMessage() for processing, return
+  // when it is done.
 
-  handleMessage(sendHost,destHost,msgBody);
+  routeMessage(sendHost,destHost,&msg);
 
-  // all done 
-
-  free(msgBody);
   return;
 
 }
@@ -604,7 +682,7 @@ serialHandler(int serialFD)
 
 /*!
   \brief Handle input from a network client socket.
-  \param sockFD File descriptor of the server's socket.
+  \param sockFD File descriptor of the server's UDP or Unix-domain socket.
 
   Read a line of input from the specified network socket file
   descriptor, and parse the message into components (source host ID,
@@ -625,200 +703,236 @@ serialHandler(int serialFD)
 void
 socketHandler(int sockFD) 
 {
-  char srcID[IMPv2_HOST_SIZE];
-  char destID[IMPv2_HOST_SIZE];
-  char argStr[BIG_STR_SIZE];
-  char *reply;
-  char *msgBody;
+  static char message[ISIS_MSGSIZE];  // preallocated input buffer
+  char errStr[256];
+  int numBytes;   // number of bytes read from the server socket         
 
   // Network client socket addressing stuff 
 
-  int clientLen;
-  struct sockaddr_in client;
-
-  char clientAddr[INET6_ADDRSTRLEN];
-  long clientHost;
-  int  clientPort;
+  socklen_t clientLen;
+  dgramaddr_t client;
 
-  char inetStr[INET6_ADDRSTRLEN];
+  // Read the message from the socket, leaving room for a terminator
+  // and for frameMessage() to add a \r
 
-  // Working variables 
+  clientLen = sizeof(client);
+  numBytes = recvfrom(sockFD, message, ISIS_MSGSIZE-2, 0,
+		     &client.sa, &clientLen);
 
-  int sendHost;   // index of the source client in the client host table      
-  int destHost;   // index of the destination client in the client host table 
-  int numBytes;   // number of bytes read from the server socket         
-  int bytesSent;  // number of bytes sent                                     
+  // Error, report back to the server console and return 
 
-  // Dynamically allocate the incoming message buffer 
+  if (numBytes < 0) {
+    sprintf(errStr,"ERROR: Cannot recvfrom() network socket - %s",
+	    strerror(errno));
+    if (isis.useCLI) printf("\n%s\n",errStr);
+    logMessage(errStr);
+    return;
+  }
+  message[numBytes] = NUL;
 
-  char *message = (char *)malloc((ISIS_MSGSIZE)*sizeof(char));
-  memset(message, 0, ISIS_MSGSIZE);
+  isis.rxTime = monoTime();
+  routeDatagram(message,&client,clientLen);
+  isis.rxTime = 0;
 
-  // Allocate a reply buffer now (needed to log errors) 
+  return;
 
-  reply = (char *)malloc((ISIS_MSGSIZE)*sizeof(char));
-  memset(reply, 0, ISIS_MSGSIZE);
+}
 
-  // Read the message from the socket 
+//---------------------------------------------------------------------------
+//
+// clientAddrName()
+//
 
-  clientLen = sizeof(client);
-  numBytes = recvfrom(sockFD, message, ISIS_MSGSIZE, 0,
-		     (struct sockaddr *) &client, 
-		     (socklen_t *) &clientLen);
+/*!
+  \brief Printable address of a datagram client, for messages
+  \param method client transport method, SOCKET or LOCAL
+  \param client socket address of the client
+  \param port UDP port if SOCKET, local socket table index if LOCAL
+  \param name string to contain the address, addr:port or socket path
+*/
 
-  // Error, report back to the server console, free memory, and return 
+static void
+clientAddrName(int method, dgramaddr_t *client, int port, char *name)
+{
+  char inetStr[INET6_ADDRSTRLEN];
 
-  if (numBytes < 0) {
-    sprintf(reply,"ERROR: Cannot recvfrom() network socket - %s",
-	    strerror(errno));
-    if (isis.useCLI) printf("\n%s\n",reply);
-    logMessage(reply);
-    free(reply);
-    free(message);
-    return;
-  }
+  if (method == LOCAL)
+    strcpy(name,localPortName(port));
+  else
+    sprintf(name,"%s:%d",
+	    inet_ntop(AF_INET,&client->in.sin_addr,inetStr,sizeof(inetStr)),
+	    port);
+}
 
-  // Allocate the message body buffer 
+//---------------------------------------------------------------------------
+//
+// routeDatagram()
+//
 
-  msgBody = (char *)malloc((ISIS_MSGSIZE)*sizeof(char));
-  memset(msgBody,0,ISIS_MSGSIZE);
+/*!
+  \brief Route one datagram received on a server socket
+  \param message NUL-terminated message text (modified in place)
+  \param client Socket address of the sending client, AF_INET or AF_UNIX
+  \param clientLen Length of the client socket address
+
+  Parses the message in place into components (source host ID,
+  destination host ID, and message body) with parseIMPv2(), updates the
+  client host table, validates the destination, and passes the message
+  to routeMessage() for routing.  Nothing is allocated or copied on the
+  way: forwarded messages are framed in front of the body inside
+  \c message, so the buffer must have 2 spare bytes after the received
+  text (see frameMessage()).
+
+  Messages from the Unix-domain socket (AF_UNIX senders) come from
+  LOCAL clients, identified by their index in the local socket table
+  (see findLocalPort()), everything else from SOCKET (UDP) clients.
+  Senders on unbound Unix-domain sockets cannot be replied to, so their
+  messages are dropped.
+
+  Called by socketHandler() for the select() loop and for each datagram
+  of a recvmmsg() batch by recvBatch() in the epoll loop.
+*/
 
-  // Get basic information about the client for later use 
+void
+routeDatagram(char *message, dgramaddr_t *client, socklen_t clientLen)
+{
+  static char reply[ISIS_MSGSIZE];  // preallocated reply buffer
+  impv2_t msg;
 
-  clientHost = ntohl(client.sin_addr.s_addr);
-  clientPort = ntohs(client.sin_port);
-  strcpy(clientAddr,inet_ntop(client.sin_family,&client.sin_addr,
-			      inetStr,sizeof(inetStr)));
+  // Network client socket addressing stuff 
 
-  // Strip off any \n or \r terminators at the end of the message string 
+  int  method;
+  long clientHost;
+  int  clientPort;
+  char clientName[MED_STR_SIZE];
 
-  if (message[strlen(message)-1]=='\n') message[strlen(message)-1]='\0';
-  if (message[strlen(message)-1]=='\r') message[strlen(message)-1]='\0';
+  // Working variables 
 
-  // Extract the first token from the message, this should be the the
-  // address header of the IMPv2 message in "SourceID>DestID" form
-  
-  getArg(message,1,argStr);
-  
-  // Check to see if there is a ">" in the first token.  If so, split
-  // the message into components.  If not, we have a malformed message.
-  // Warn the console if interactive, otherwise just ignore it and return.
+  int sendHost;   // index of the source client in the client host table      
+  int destHost;   // index of the destination client in the client host table 
+  int numBytes;   // size of the message
 
-  if (strstr(argStr,">")) {
-    sscanf(message,"%[^>]>%s %[^\n]",srcID,destID,msgBody);
-    upperCase(srcID);
-    upperCase(destID);
+  // Get basic information about the client for later use 
 
+  numBytes = strlen(message);
+  if (client->sa.sa_family == AF_UNIX) {
+    method = LOCAL;
+    clientHost = LOCAL_ADDR;
+    if ((clientPort = findLocalPort(client,clientLen)) < 0) {
+      snprintf(reply,sizeof(reply),
+	       "ERROR: message from unbound or excess local client dropped: '%.200s'",
+	       message);
+      if (isis.useCLI) printf("\n%s\n",reply);
+      logMessage(reply);
+      return;
+    }
   }
   else {
-    sprintf(reply,
-	    "ERROR: malformed message from network client %s (%s:%d): '%s' [size %d bytes]",
-	    srcID,clientAddr,clientPort,message,strlen(message));
+    method = SOCKET;
+    clientHost = ntohl(client->in.sin_addr.s_addr);
+    clientPort = ntohs(client->in.sin_port);
+  }
 
-    if (isis.useCLI) printf("\n%s\n",reply);
-    free(message);
-    free(reply);
-    free(msgBody);
+  // Split the message in place into its components.  If the address
+  // header is not in "SourceID>DestID" form we have a malformed
+  // message.  Warn the console if interactive, otherwise just ignore
+  // it and return.
+
+  if (parseIMPv2(message,&msg) < 0) {
+    if (isis.useCLI) {
+      clientAddrName(method,client,clientPort,clientName);
+      printf("\nERROR: malformed message from network client (%s): '%s' [size %d bytes]\n",
+	     clientName,message,(int)strlen(message));
+    }
     return;
   }
 
-  // We are all done with the raw message, and from here on out we only
-  // work with its components.  Free the incoming message memory now so
-  // we don't forget later (leak abatement).  We only log non-blank
-  // messages.
+  // From here on out we only work with the message components.  We
+  // only log non-blank messages.  The address header in the buffer is
+  // still intact at this point.
 
   if (isis.isVerbose && isis.useCLI) printf("<< %s >>\n",message);
-  if (strlen(msgBody)>0) 
+  if (msg.bodyLen > 0) 
     logMessage(message);
-  free(message);
+  captureMessage(&msg,method,clientHost,clientPort);
 
   // We have an IMPv2-conformal message string and its components:
-  //   srcID = hostID of the sender
-  //   destID = hostID of the intended recipient
-  //   msgBody = message test to be delivered to destID
+  //   msg.srcID = hostID of the sender
+  //   msg.destID = hostID of the intended recipient
+  //   msg.body = message test to be delivered to destID
   // Now we deal with it.
 
   // Update the host table with the srcID information 
   
-  sendHost = updateHosts(srcID,SOCKET,sockFD,clientHost,clientPort);
+  sendHost = updateHosts(msg.srcID,method,
+			 (method == LOCAL) ? isis.localFD : isis.sockFD,
+			 clientHost,clientPort);
 
   // If the host table is full, we got problems.  Hit the console screen
   // and runtime log with an error message, try to echo one back to the
-  // sender port, clean up, and return.
+  // sender port, and return.
 
   if (sendHost == ERR_HOSTS_FULL) {
     sprintf(reply,
 	    "ERROR: Host Table Full, cannot create entry for network client %s",
-	    srcID);
+	    msg.srcID);
 
     if (isis.useCLI) printf("\n%s\n",reply);
     logMessage(reply);
-    memset(reply,0,ISIS_MSGSIZE);
     sprintf(reply,
 	    "%s>%s ERROR: Server Host Table Full, Cannot Service Request\r",
-	    isis.serverID,srcID);
-    clientLen = sizeof(client);
-    bytesSent = sendto(sockFD,reply,strlen(reply),0, 
-		   (struct sockaddr *) &client, clientLen);
-    free(reply);
-    free(msgBody);
+	    isis.serverID,msg.srcID);
+    if (method == LOCAL)
+      localSend(-1,clientPort,reply,strlen(reply));
+    else
+      udpSend(-1,&client->in,reply,strlen(reply));
     return;
   }    
+  statsReceived(sendHost,numBytes);
 
   // If msgBody is blank, make note of it but take no further action 
 
-  if (strlen(msgBody)==0) {
-    sprintf(reply,"heartbeat %s (%s:%d)",srcID,clientAddr,clientPort);
+  if (msg.bodyLen == 0) {
+    clientAddrName(method,client,clientPort,clientName);
+    sprintf(reply,"heartbeat %s (%s)",msg.srcID,clientName);
     if (isis.useCLI) printf("\n%s\n",reply);
     logMessage(reply);
-    free(reply);
-    free(msgBody);
     return;
   }
 
   // Validate the destination host 
 
-  if (strcasecmp(destID,isis.serverID)==0) {
+  if (strcasecmp(msg.destID,isis.serverID)==0) {
     destHost = ISIS_SERVER;
 
   } 
-  else if (strcasecmp(destID,"AL")==0) {
+  else if (strcmp(msg.destID,"AL")==0) {
     destHost = BROADCAST;
 
   }
   else {
-    destHost = isKnownHost(destID);
+    destHost = isKnownHost(msg.destID);
     
     // Oops! Destination is an unknown host, we have no idea how to
     // route the message, so gripe.
 
     if (destHost == ERR_UNKNOWN_HOST) {
       sprintf(reply,"%s>%s ERROR: No Route to Destination Host %s - host is unknown/unlisted\r",
-	      isis.serverID,srcID,destID);
+	      isis.serverID,msg.srcID,msg.destID);
       sendMessage(sendHost,reply);
       if (reply[strlen(reply)-1]=='\r') reply[strlen(reply)-1]='\0';
       if (isis.isVerbose && isis.useCLI) printf("<< %s >>\n",reply);
       logMessage(reply);
-      free(reply);
-      free(msgBody);
       return;
     }
 
   }
 
-  // All done with the reply buffer, free it 
-
-  free(reply);
-
   // We have valid source and destination hosts, and a non-blank
-  // message.  Hand them off to handleMessage() for routing, return
-  // when it is done.  [future multithreading point?]
-
-  handleMessage(sendHost,destHost,msgBody);
+  // message.  Hand them off to routeMessage() for routing, return
+  // when it is done.
 
-  // all done 
-
-  free(msgBody);
+  routeMessage(sendHost,destHost,&msg);
 
   return;
 
@@ -882,6 +996,10 @@ ttyHandler(char *ttyStr)
 
   if (ttyStr==NULL) return;
 
+  // Anything sent from here is not in response to a received message
+
+  isis.rxTime = 0;
+
   // If the ttyStr is blank, return 
 
   if (strlen(ttyStr)==0) {
@@ -1076,6 +1194,7 @@ ttyHandler(char *ttyStr)
     // All that's left are generic ISIS commands 
 
     else {
+      isis.cmdHost = ISIS_SERVER;
       doReply = isisCommand(message,message);
       
       if (doReply == MSG_REPLY)	printf("%s\n",message);
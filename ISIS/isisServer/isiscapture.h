@@ -0,0 +1,72 @@
+#ifndef ISISCAPTURE_H
+#define ISISCAPTURE_H
+
+//
+// isiscapture.h - ISIS traffic capture file format
+//
+// Shared by the capture code in the ISIS server (capture.c) and the
+// isisreplay tool (isisreplay.c).
+//
+// Date:
+//   2026 October 17
+//
+// Modification History:
+//
+
+/*!
+  \file isiscapture.h
+  \brief ISIS traffic capture file format
+
+  A capture file starts with a #CAP_HEADERSIZE byte file header
+  (struct capFileHeader) followed by variable-length message records.
+  Each record is a struct capRecord header followed by the message
+  body (not NUL terminated, no IMPv2 \\r terminator), padded with zeros
+  to a multiple of 8 bytes.  All fields are in host byte order.
+
+  The file is written through a memory map that is extended
+  #CAP_CHUNKSIZE bytes at a time, and records never straddle a chunk
+  boundary.  A record length of 0 means the rest of the chunk is
+  unused, readers skip to the next chunk boundary.  The file is
+  truncated to its used length when closed, but if the server dies
+  it may end with a zero-filled partial chunk.
+*/
+
+#include <stdint.h>
+
+#define CAP_MAGIC      "ISISCAP1"        //!< Capture file magic string
+#define CAP_HEADERSIZE 64                //!< Size of the file header in bytes
+#define CAP_CHUNKSIZE  (4*1024*1024)     //!< File growth/mapping chunk size in bytes
+
+/*!
+  \brief Capture file header
+*/
+
+struct capFileHeader {
+  char     magic[8];        //!< #CAP_MAGIC, not NUL terminated
+  uint32_t headerSize;      //!< Size of this header, #CAP_HEADERSIZE
+  uint32_t chunkSize;       //!< Chunk size, #CAP_CHUNKSIZE
+  int64_t  startTime;       //!< UTC time the file was opened, usec since 1970-01-01
+  int64_t  startMono;       //!< CLOCK_MONOTONIC time the file was opened, ns
+  char     serverID[16];    //!< Server node ID
+  char     spare[16];       //!< Reserved, zero
+};
+
+/*!
+  \brief Capture record header, followed by the message body
+*/
+
+struct capRecord {
+  uint32_t len;             //!< Total record length in bytes including padding, 0=end of chunk
+  uint16_t method;          //!< Transport: 1=SERIAL, 2=SOCKET, 3=LOCAL (see isisserver.h)
+  uint16_t port;            //!< UDP port if SOCKET, serial or local socket table index otherwise
+  uint32_t addr;            //!< IPv4 address if SOCKET (host byte order), 0xffffffff if LOCAL
+  uint32_t bodyLen;         //!< Length of the message body in bytes
+  int64_t  monoTime;        //!< CLOCK_MONOTONIC time the message was received, ns
+  char     srcID[9];        //!< Source node ID, NUL terminated
+  char     destID[9];       //!< Destination node ID, NUL terminated
+  char     spare[6];        //!< Reserved, zero
+};
+
+#define CAP_RECSIZE(bodyLen) ((sizeof(struct capRecord)+(bodyLen)+7) & ~7)
+
+#endif  // ISISCAPTURE_H
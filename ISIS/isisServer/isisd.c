@@ -108,9 +108,10 @@
   Programming, Volume 1, Network APIs: Sockets and XTI" (Prentice Hall,
   2nd edition).
 
-  Uses select() for I/O multiplexing.  No multithreading at the present
-  time, but probably should if we get into services that take a long
-  time to execute.
+  Uses epoll() for I/O multiplexing on Linux, with the legacy select()
+  loop available as an option (see evloop.c).  No multithreading at the
+  present time, but probably should if we get into services that take
+  a long time to execute.
 
   Uses the GNU readline and history utilties for the CLI.  
 
@@ -128,6 +129,13 @@
   2009 Mar 18 - modifications for version 2.x, including daemon mode
                 and cleanup of old junk we never use anymore [rwp/osu]
   2010 Apr 14 - further modifications for operation as a daemon [rwp/osu]
+  2026 Oct 17 - epoll() event loop with recvmmsg()/sendmmsg() batching
+  2026 Oct 17 - optional binary traffic capture (Capture keyword)
+  2026 Oct 17 - Unix-domain datagram socket for same-host clients (LocalSocket keyword)
+  2026 Oct 17 - serial ports serviced by per-port I/O threads, the event
+                loop only watches their wakeup pipe
+  2026 Oct 17 - warm restart reopens the serial ports and re-registers
+                them with the epoll event loop
   </pre>
 */
 
@@ -147,9 +155,10 @@
 // extern in the isisserver.h header
 
 struct server isis;                   //!< Server runtime parameter table
-struct clients clientTab[MAXCLIENTS]; //!< Server client table
+struct clients *clientTab = NULL;    //!< Server client table (see clients.c)
 struct serial ttyTab[MAXSERIAL];      //!< Server serial port table
 struct udpPreset udpTab[MAXPRESET];   //!< Server preset UDP port table
+struct localPort localTab[MAXLOCAL];  //!< Server local client socket table
 
 // Function prototypes only used in main()
 
@@ -166,6 +175,7 @@ main(int argc, char *argv[])
   int n;
   int numReady;
   int c;
+  int oldSerialFD;
   char logStr[256];
 
   // stuff for select() 
@@ -186,6 +196,8 @@ main(int argc, char *argv[])
   strcpy(isis.exeFile,argv[0]);       // how this executable was invoked 
   strcpy(isis.userID,getenv("USER")); // and by whom                     
   strcpy(isis.iniFile,ISIS_DCONFIG);  // default daemon-mode runtime init file
+  isis.localFD = -1;                  // no local socket until we open it
+  isis.serialFD = -1;                 // no serial I/O threads until we open the ports
   if (loadConfig(isis.iniFile) < 0) {
     printf("ERROR parsing the isisd ini file %s - aborting\n",
 	   isis.iniFile);
@@ -213,9 +225,13 @@ main(int argc, char *argv[])
 
   umask(0);
 
-  // start logging
+  // start logging, and traffic capture if enabled
 
   initLog();
+  if (isis.doCapture) {
+    initCapture();
+    atexit(closeCapture);
+  }
 
   // Create a new SID for the child process
 
@@ -258,9 +274,10 @@ main(int argc, char *argv[])
     }
   }
 
-  // Initialize the client host table 
+  // Initialize the client host table and traffic statistics
 
   initHostTable();
+  resetStats();
 
   // Open the server network socket 
 
@@ -273,6 +290,26 @@ main(int argc, char *argv[])
 	  isis.serverID,isis.sockPort);
   logMessage(logStr);
 
+  // Open the local socket for same-host clients if configured
+
+  if (strlen(isis.localPath) > 0) {
+    if (openLocalSocket(isis.localPath) < 0)
+      sprintf(logStr,"Local socket %s unavailable, same-host clients must use UDP",
+	      isis.localPath);
+    else
+      sprintf(logStr,"Server local socket %s",isis.localPath);
+    logMessage(logStr);
+  }
+
+  // Setup the epoll() event loop if requested, otherwise (or if it
+  // fails) we fall back to the select() loop
+
+  isis.epollFD = -1;
+  if (isis.evLoop == EPOLL_LOOP) {
+    if (initEventLoop(-1) < 0)
+      logMessage((char *)"epoll event loop unavailable, using select() loop");
+  }
+
   // Set the server process flags 
 
   isis.keepGoing = isis_TRUE;   // server runs while KeepGoing is TRUE   
@@ -308,6 +345,10 @@ main(int argc, char *argv[])
 	sprintf(logStr,"Reloading initialization file %s",isis.iniFile);
  	logMessage(logStr);
 	loadConfig(isis.iniFile);
+	oldSerialFD = isis.serialFD;  // reopen the serial ports, swap into epoll
+	if (initSerialPorts() < isis.numSerial)
+	  logMessage((char *)"Error reopening serial ports");
+	rearmEventLoop(oldSerialFD,isis.serialFD);
 	logMessage((char *)"Pinging clients");
 	broadcastMessage(ISIS_SERVER,(char *)"PING");
 	logMessage((char *)"Warm restart completed");
@@ -320,15 +361,24 @@ main(int argc, char *argv[])
       isis.doStartup = NO_STARTUP;
     }
 
+    // epoll() event loop: one pass dispatches all ready descriptors,
+    // draining the server socket in recvmmsg() batches
+
+    if (isis.epollFD >= 0) {
+      numReady = epollHandler(-1);
+      if (numReady < 0 && errno != EINTR) {
+	sprintf(logStr,"WARNING: Server epoll_wait() Error - %s",strerror(errno));
+	logMessage(logStr);
+      }
+      continue;
+    }
+
     // Set up the file descriptor table for select() 
 
     FD_ZERO(&fdList);
     FD_SET(isis.sockFD, &fdList) ;
-    if (isis.numSerial > 0) {
-      for (i=0; i<isis.numSerial; i++) {
-	FD_SET(ttyTab[i].fd, &fdList) ;
-      }
-    }
+    if (isis.localFD >= 0) FD_SET(isis.localFD, &fdList) ;
+    if (isis.serialFD >= 0) FD_SET(isis.serialFD, &fdList) ;
 
     // See if anyone has anything to say to us 
 
@@ -364,15 +414,12 @@ main(int argc, char *argv[])
       if (FD_ISSET(isis.sockFD,&fdList)) {  // pending socket input 
 	socketHandler(isis.sockFD);
       }
-      else {
-	if (isis.numSerial > 0) {
-	  for (i=0; i<isis.numSerial; i++) {
-	    if (FD_ISSET(ttyTab[i].fd, &fdList)) { // pending serial input 
-	      serialHandler(ttyTab[i].fd);
-	    }
-	  }
-	} // end of serial port checking 
-      } // ed of FD_ISSET() checking 
+      else if (isis.localFD >= 0 && FD_ISSET(isis.localFD,&fdList)) {  // pending local socket input
+	socketHandler(isis.localFD);
+      }
+      else if (isis.serialFD >= 0 && FD_ISSET(isis.serialFD,&fdList)) {  // pending serial input
+	serialHandler();
+      } // end of FD_ISSET() checking 
     } // end of select() input handling 
     
   }
@@ -384,6 +431,8 @@ main(int argc, char *argv[])
   // Tear down the server socket
 
   closeSocket(isis.sockFD);
+  closeLocalSocket();
+  stopSerialIO();
 
   // all done! 
 
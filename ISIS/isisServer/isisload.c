@@ -0,0 +1,494 @@
+//
+// isisload - synthetic load generator and routing benchmark for ISIS
+//
+// Date:
+//   2026 October 17
+//
+// Modification History:
+//
+
+/*!
+  \mainpage isisload - ISIS load generator and routing benchmark
+
+  \date 2026 October 17
+
+  \section Usage Usage
+
+  \verbatim
+  isisload [-h host] [-p port] [-s serverID] [-n clients] [-t threads]
+           [-d sec] [-r pct] [-b pct] [-o file] [-Q]
+  \endverbatim
+
+  Where:
+  <pre>
+   -h host      ISIS server host (default: localhost)
+   -p port      ISIS server port (default: 6600)
+   -s serverID  ISIS server node ID (default: IS)
+   -n clients   number of fake clients (default: 16)
+   -t threads   number of threads (default: 4)
+   -d sec       test duration in seconds (default: 10)
+   -r pct       percent of requests that are server PINGs (default: 10)
+   -b pct       percent of requests that are also sent as AL broadcasts (default: 1)
+   -o file      append the results line to file as well as printing it
+   -Q           send the server an EXEC: QUIT when done
+  </pre>
+
+  \section Intro Description
+
+  Spawns fake ISIS clients (node IDs L000, L001, ...) divided among
+  several threads.  Each client handshakes with the server (PING/PONG)
+  and then runs closed-loop, keeping one request in flight:
+  <ul>
+  <li>a PING to the server, answered by the server with PONG, or
+  <li>a REQ: to its partner client (the next client in the same thread),
+      which answers with DONE: through the server.
+  </ul>
+  A percentage of requests also send a STATUS: broadcast to AL, which
+  the server fans out to every other client.  Round-trip times of
+  PING/PONG and REQ/DONE exchanges are measured with the monotonic
+  clock and collected in a 1 usec resolution histogram.  Requests not
+  answered within 1 second are counted as timeouts and replaced.
+
+  When done it prints one line of keyword=value pairs:
+  \verbatim
+  isisload Clients=n Threads=n Duration=s Requests=n Timeouts=n Errors=n
+           Broadcasts=n BcastRecv=n MsgRate=msg/s ReqRate=req/s
+           RttMean=us RttP50=us RttP99=us RttP999=us RttMax=us
+  \endverbatim
+  where MsgRate counts every datagram sent to or received from the
+  server by the fake clients, so it is the server's total routing rate.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define MSGSIZE      4096      //!< maximum IMPv2 message size
+#define MAXCLIENTS   1000      //!< maximum number of fake clients (L000-L999)
+#define MAXTHREADS   64        //!< maximum number of threads
+#define HISTSIZE     100000    //!< RTT histogram bins, 1 usec each, plus overflow
+#define TIMEOUT_NS   1000000000LL  //!< request timeout
+
+#define OP_NONE 0
+#define OP_PING 1
+#define OP_REQ  2
+
+/*!
+  \brief Fake client
+*/
+
+struct client {
+  char ID[9];            //!< node ID
+  int  sockFD;           //!< UDP socket
+  int  partner;          //!< client index of the REQ: partner
+  int  op;               //!< request in flight, OP_xxx
+  long seq;              //!< sequence number of the request in flight
+  long long sentTime;    //!< when the request in flight was sent
+  unsigned int rand;     //!< random number state
+};
+
+/*!
+  \brief Per-thread results
+*/
+
+struct results {
+  long requests;         //!< completed requests
+  long timeouts;         //!< requests that timed out
+  long errors;           //!< ERROR: replies
+  long broadcasts;       //!< broadcasts sent
+  long bcastRecv;        //!< broadcasts received
+  long msgOut;           //!< datagrams sent
+  long msgIn;            //!< datagrams received
+  long long sumRtt;      //!< sum of RTTs in ns
+  long long maxRtt;      //!< longest RTT in ns
+  long hist[HISTSIZE+1]; //!< RTT histogram in usec, last bin is overflow
+};
+
+// Test setup, shared read-only by all threads
+
+struct client clients[MAXCLIENTS];
+struct sockaddr_in server;
+char serverID[9] = "IS";
+int numClients = 16;
+int numThreads = 4;
+int pingPct = 10;
+int bcastPct = 1;
+double duration = 10.0;
+pthread_barrier_t startBarrier;
+volatile int stopNow = 0;
+
+/*!
+  \brief Read the monotonic clock
+  \return CLOCK_MONOTONIC time in nanoseconds
+*/
+
+long long
+monoTime(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return((long long)ts.tv_sec*1000000000LL + ts.tv_nsec);
+}
+
+/*!
+  \brief Send a message to the server from a client
+  \param c client
+  \param msg NUL-terminated message, the \\r terminator is added here
+  \param res results to count in
+*/
+
+void
+sendMsg(struct client *c, char *msg, struct results *res)
+{
+  char buf[MSGSIZE];
+  int len;
+
+  len = snprintf(buf,sizeof(buf),"%s\r",msg);
+  if (sendto(c->sockFD,buf,len,0,(struct sockaddr *)&server,sizeof(server)) == len)
+    res->msgOut++;
+}
+
+/*!
+  \brief Start a new request for a client
+  \param c client
+  \param res results to count in
+*/
+
+void
+newRequest(struct client *c, struct results *res)
+{
+  char msg[128];
+
+  c->seq++;
+  if ((int)(rand_r(&c->rand) % 100) < pingPct) {
+    c->op = OP_PING;
+    sprintf(msg,"%s>%s PING",c->ID,serverID);
+  }
+  else {
+    c->op = OP_REQ;
+    sprintf(msg,"%s>%s REQ: LOAD %ld",c->ID,clients[c->partner].ID,c->seq);
+  }
+  c->sentTime = monoTime();
+  sendMsg(c,msg,res);
+
+  if ((int)(rand_r(&c->rand) % 100) < bcastPct) {
+    sprintf(msg,"%s>AL STATUS: LOAD %ld",c->ID,c->seq);
+    sendMsg(c,msg,res);
+    res->broadcasts++;
+  }
+}
+
+/*!
+  \brief Finish the request in flight for a client
+  \param c client
+  \param res results to count in
+*/
+
+void
+endRequest(struct client *c, struct results *res)
+{
+  long long rtt = monoTime() - c->sentTime;
+  long usec = (long)(rtt/1000);
+
+  res->requests++;
+  res->sumRtt += rtt;
+  if (rtt > res->maxRtt) res->maxRtt = rtt;
+  res->hist[(usec < HISTSIZE) ? usec : HISTSIZE]++;
+  c->op = OP_NONE;
+}
+
+/*!
+  \brief Handle a message received by a client
+  \param c client
+  \param msg NUL-terminated message
+  \param res results to count in
+*/
+
+void
+handleMsg(struct client *c, char *msg, struct results *res)
+{
+  char src[16], dest[16], word[32], reply[128];
+  long seq = -1;
+
+  if (sscanf(msg,"%15[^>]>%15s %31s LOAD %ld",src,dest,word,&seq) < 3)
+    return;
+
+  if (strcmp(dest,"AL")==0) {
+    res->bcastRecv++;
+  }
+  else if (strcmp(word,"PONG")==0) {
+    if (c->op == OP_PING) endRequest(c,res);
+  }
+  else if (strcmp(word,"REQ:")==0) {
+    sprintf(reply,"%s>%s DONE: LOAD %ld",c->ID,src,seq);
+    sendMsg(c,reply,res);
+  }
+  else if (strcmp(word,"DONE:")==0) {
+    if (c->op == OP_REQ && seq == c->seq) endRequest(c,res);
+  }
+  else if (strcmp(word,"ERROR:")==0) {
+    res->errors++;
+    c->op = OP_NONE;
+  }
+}
+
+/*!
+  \brief Load generator thread
+  \param arg thread number
+  \return the thread's results
+
+  Thread t runs clients t, t+numThreads, t+2*numThreads, ...
+*/
+
+void *
+loadThread(void *arg)
+{
+  int t = (int)(long)arg;
+  struct results *res;
+  struct epoll_event ev, events[64];
+  char buf[MSGSIZE+1];
+  char msg[64];
+  int epollFD;
+  int numReady;
+  int numRead;
+  int i, j;
+  long long now, lastCheck;
+
+  res = (struct results *)calloc(1,sizeof(struct results));
+  epollFD = epoll_create1(0);
+  for (i=t; i<numClients; i+=numThreads) {
+    ev.events = EPOLLIN;
+    ev.data.u32 = i;
+    epoll_ctl(epollFD,EPOLL_CTL_ADD,clients[i].sockFD,&ev);
+  }
+
+  // Handshake with the server: ping until every client has a PONG
+
+  for (i=t; i<numClients; i+=numThreads) {
+    sprintf(msg,"%s>%s PING",clients[i].ID,serverID);
+    for (j=0; j<10; j++) {
+      sendMsg(&clients[i],msg,res);
+      usleep(10000);
+      numRead = recv(clients[i].sockFD,buf,MSGSIZE,MSG_DONTWAIT);
+      if (numRead > 0) break;
+    }
+    if (numRead <= 0) {
+      printf("ERROR: client %s got no PONG from the server\n",clients[i].ID);
+      exit(1);
+    }
+  }
+  pthread_barrier_wait(&startBarrier);
+  memset(res,0,sizeof(struct results));
+
+  // Run closed-loop until told to stop
+
+  for (i=t; i<numClients; i+=numThreads)
+    newRequest(&clients[i],res);
+  lastCheck = monoTime();
+
+  while (!stopNow) {
+    numReady = epoll_wait(epollFD,events,64,10);
+    for (j=0; j<numReady; j++) {
+      i = events[j].data.u32;
+      while ((numRead = recv(clients[i].sockFD,buf,MSGSIZE,MSG_DONTWAIT)) > 0) {
+	res->msgIn++;
+	buf[numRead] = '\0';
+	handleMsg(&clients[i],buf,res);
+	if (clients[i].op == OP_NONE && !stopNow)
+	  newRequest(&clients[i],res);
+      }
+    }
+
+    // Replace requests that timed out, checked every 100 ms
+
+    now = monoTime();
+    if (now - lastCheck > 100000000LL) {
+      for (i=t; i<numClients; i+=numThreads) {
+	if (clients[i].op != OP_NONE && now - clients[i].sentTime > TIMEOUT_NS) {
+	  res->timeouts++;
+	  newRequest(&clients[i],res);
+	}
+      }
+      lastCheck = now;
+    }
+  }
+  close(epollFD);
+  return(res);
+}
+
+/*!
+  \brief Latency at a percentile of the merged histogram
+  \param res merged results
+  \param pct percentile, 0-100
+  \return latency in usec
+*/
+
+long
+percentile(struct results *res, double pct)
+{
+  long target = (long)(pct*0.01*res->requests + 0.5);
+  long count = 0;
+  long i;
+
+  if (target < 1) target = 1;
+  for (i=0; i<HISTSIZE; i++) {
+    count += res->hist[i];
+    if (count >= target) return(i+1);
+  }
+  return(HISTSIZE);
+}
+
+void
+printUsage(void)
+{
+  printf("Usage: isisload [-h host] [-p port] [-s serverID] [-n clients] [-t threads]\n");
+  printf("                [-d sec] [-r pct] [-b pct] [-o file] [-Q]\n");
+  printf("  -h host      ISIS server host (default: localhost)\n");
+  printf("  -p port      ISIS server port (default: 6600)\n");
+  printf("  -s serverID  ISIS server node ID (default: IS)\n");
+  printf("  -n clients   number of fake clients (default: 16)\n");
+  printf("  -t threads   number of threads (default: 4)\n");
+  printf("  -d sec       test duration in seconds (default: 10)\n");
+  printf("  -r pct       percent of requests that are server PINGs (default: 10)\n");
+  printf("  -b pct       percent of requests also sent as AL broadcasts (default: 1)\n");
+  printf("  -o file      append the results line to file as well as printing it\n");
+  printf("  -Q           send the server an EXEC: QUIT when done\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+  char *serverHost = (char *)"localhost";
+  char *outFile = NULL;
+  int serverPort = 6600;
+  int doQuit = 0;
+  pthread_t threads[MAXTHREADS];
+  struct results total, *res;
+  struct sockaddr_in addr;
+  struct hostent *hostInfo;
+  char resultStr[1024];
+  char msg[64];
+  long long tStart, tEnd;
+  double elapsed;
+  FILE *fp;
+  int c;
+  int i, j;
+
+  while ((c = getopt(argc,argv,"h:p:s:n:t:d:r:b:o:Q")) != -1) {
+    switch (c) {
+    case 'h': serverHost = optarg; break;
+    case 'p': serverPort = atoi(optarg); break;
+    case 's': strncpy(serverID,optarg,8); break;
+    case 'n': numClients = atoi(optarg); break;
+    case 't': numThreads = atoi(optarg); break;
+    case 'd': duration = atof(optarg); break;
+    case 'r': pingPct = atoi(optarg); break;
+    case 'b': bcastPct = atoi(optarg); break;
+    case 'o': outFile = optarg; break;
+    case 'Q': doQuit = 1; break;
+    default:
+      printUsage();
+      exit(1);
+    }
+  }
+  if (optind != argc || numClients < 2 || numClients > MAXCLIENTS ||
+      numThreads < 1 || numThreads > MAXTHREADS || duration <= 0.0) {
+    printUsage();
+    exit(1);
+  }
+  if (numThreads > numClients/2) numThreads = numClients/2;
+
+  if ((hostInfo = gethostbyname(serverHost)) == NULL) {
+    printf("ERROR: unknown server host %s\n",serverHost);
+    exit(1);
+  }
+  memset(&server,0,sizeof(server));
+  server.sin_family = AF_INET;
+  memcpy(&server.sin_addr,hostInfo->h_addr_list[0],hostInfo->h_length);
+  server.sin_port = htons(serverPort);
+
+  // Create the clients.  Partners are the next client in the same thread.
+
+  for (i=0; i<numClients; i++) {
+    sprintf(clients[i].ID,"L%03d",i);
+    clients[i].sockFD = socket(AF_INET,SOCK_DGRAM,0);
+    memset(&addr,0,sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (clients[i].sockFD < 0 ||
+	bind(clients[i].sockFD,(struct sockaddr *)&addr,sizeof(addr)) < 0) {
+      printf("ERROR: cannot create client socket - %s\n",strerror(errno));
+      exit(1);
+    }
+    clients[i].partner = (i+numThreads < numClients) ? i+numThreads : i%numThreads;
+    if (clients[i].partner == i) clients[i].partner = (i+1) % numClients;
+    clients[i].rand = 12345 + i;
+  }
+
+  // Run the test
+
+  pthread_barrier_init(&startBarrier,NULL,numThreads+1);
+  for (i=0; i<numThreads; i++)
+    pthread_create(&threads[i],NULL,loadThread,(void *)(long)i);
+  pthread_barrier_wait(&startBarrier);
+  tStart = monoTime();
+  usleep((useconds_t)(duration*1.0e6));
+  stopNow = 1;
+  tEnd = monoTime();
+
+  memset(&total,0,sizeof(total));
+  for (i=0; i<numThreads; i++) {
+    pthread_join(threads[i],(void **)&res);
+    total.requests += res->requests;
+    total.timeouts += res->timeouts;
+    total.errors += res->errors;
+    total.broadcasts += res->broadcasts;
+    total.bcastRecv += res->bcastRecv;
+    total.msgOut += res->msgOut;
+    total.msgIn += res->msgIn;
+    total.sumRtt += res->sumRtt;
+    if (res->maxRtt > total.maxRtt) total.maxRtt = res->maxRtt;
+    for (j=0; j<=HISTSIZE; j++)
+      total.hist[j] += res->hist[j];
+    free(res);
+  }
+  elapsed = 1.0e-9*(tEnd-tStart);
+
+  sprintf(resultStr,"isisload Clients=%d Threads=%d Duration=%.3f Requests=%ld "
+	  "Timeouts=%ld Errors=%ld Broadcasts=%ld BcastRecv=%ld MsgRate=%.1f "
+	  "ReqRate=%.1f RttMean=%.1f RttP50=%ld RttP99=%ld RttP999=%ld RttMax=%.1f",
+	  numClients,numThreads,elapsed,total.requests,total.timeouts,
+	  total.errors,total.broadcasts,total.bcastRecv,
+	  (total.msgOut+total.msgIn)/elapsed,total.requests/elapsed,
+	  (total.requests > 0) ? 0.001*total.sumRtt/total.requests : 0.0,
+	  percentile(&total,50.0),percentile(&total,99.0),percentile(&total,99.9),
+	  0.001*total.maxRtt);
+  printf("%s\n",resultStr);
+
+  if (outFile != NULL) {
+    if ((fp = fopen(outFile,"a")) == NULL)
+      printf("ERROR: cannot append to %s - %s\n",outFile,strerror(errno));
+    else {
+      fprintf(fp,"%s\n",resultStr);
+      fclose(fp);
+    }
+  }
+
+  if (doQuit) {
+    sprintf(msg,"%s>%s EXEC: QUIT\r",clients[0].ID,serverID);
+    sendto(clients[0].sockFD,msg,strlen(msg),0,(struct sockaddr *)&server,sizeof(server));
+  }
+
+  exit(0);
+}
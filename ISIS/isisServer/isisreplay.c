@@ -0,0 +1,392 @@
+//
+// isisreplay - replay an ISIS traffic capture against a server
+//
+// Date:
+//   2026 October 17
+//
+// Modification History:
+//
+
+/*!
+  \mainpage isisreplay - replay an ISIS traffic capture
+
+  \date 2026 October 17
+
+  \section Usage Usage
+
+  \verbatim
+  isisreplay [-h host] [-p port] [-f | -x speed] [-w sec] [-q] capfile
+  isisreplay -l capfile
+  \endverbatim
+
+  Where:
+  <pre>
+   -h host   ISIS server host (default: localhost)
+   -p port   ISIS server port (default: 6600)
+   -f        replay as fast as possible
+   -x speed  replay at speed times the original rate (default: 1.0)
+   -w sec    seconds to wait for replies after the last message (default: 1)
+   -q        quiet, only print the summary
+   -l        list the capture as text and exit
+  </pre>
+
+  \section Intro Description
+
+  Reads a binary traffic capture recorded by an ISIS server (see the
+  Capture keyword and capture.c) and sends every captured message to
+  a server, from a stand-in UDP client for each source node ID in the
+  capture.  Messages are sent either with their original timing
+  (optionally sped up), or as fast as possible.  Replies and forwards
+  the server sends back to the stand-ins are read and counted.
+
+  The stand-ins register with the server under the captured node IDs,
+  so replay against a test server, not one with the real agents
+  attached.  Messages captured from serial clients are replayed over
+  UDP like all the others.
+
+  When done, prints a summary of keyword=value pairs:
+  \verbatim
+  isisreplay Records=n Clients=n Sent=n SendErr=n Replies=n Elapsed=s Rate=msg/s
+  \endverbatim
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "isiscapture.h"
+
+#define MAXSTANDINS 1024   //!< maximum number of stand-in clients
+#define MSGSIZE     4096   //!< maximum IMPv2 message size
+
+/*!
+  \brief Stand-in client table
+*/
+
+struct standIn {
+  char ID[9];        //!< node ID of the client
+  int  sockFD;       //!< UDP socket
+} standIns[MAXSTANDINS];
+
+int numStandIns = 0;        //!< number of stand-in clients
+long numReplies = 0;        //!< datagrams received by the stand-ins
+
+/*!
+  \brief Print the usage message
+*/
+
+void
+printUsage(void)
+{
+  printf("Usage: isisreplay [-h host] [-p port] [-f | -x speed] [-w sec] [-q] capfile\n");
+  printf("       isisreplay -l capfile\n");
+  printf("  -h host   ISIS server host (default: localhost)\n");
+  printf("  -p port   ISIS server port (default: 6600)\n");
+  printf("  -f        replay as fast as possible\n");
+  printf("  -x speed  replay at speed times the original rate (default: 1.0)\n");
+  printf("  -w sec    seconds to wait for replies after the last message (default: 1)\n");
+  printf("  -q        quiet, only print the summary\n");
+  printf("  -l        list the capture as text and exit\n");
+}
+
+/*!
+  \brief Read the monotonic clock
+  \return CLOCK_MONOTONIC time in nanoseconds
+*/
+
+long long
+monoTime(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return((long long)ts.tv_sec*1000000000LL + ts.tv_nsec);
+}
+
+/*!
+  \brief Find the next record in a capture file
+  \param map capture file memory map
+  \param size size of the capture file in bytes
+  \param offset offset of the current record, 0 to get the first one
+  \return offset of the next record, or -1 at the end of the file.
+
+  Skips over the unused tail of a chunk (see isiscapture.h).
+*/
+
+long
+nextRecord(char *map, long size, long offset)
+{
+  struct capFileHeader *hdr = (struct capFileHeader *)map;
+  struct capRecord *rec;
+
+  if (offset == 0)
+    offset = hdr->headerSize;
+  else
+    offset += ((struct capRecord *)&map[offset])->len;
+
+  while (offset + (long)sizeof(struct capRecord) <= size) {
+    rec = (struct capRecord *)&map[offset];
+    if (rec->len >= sizeof(struct capRecord) && offset + rec->len <= size)
+      return(offset);
+    if (rec->len != 0)
+      return(-1);   // corrupted record, stop here
+    offset = (offset/hdr->chunkSize + 1) * hdr->chunkSize;
+  }
+  return(-1);
+}
+
+/*!
+  \brief Get the stand-in client for a node ID, creating it if needed
+  \param ID node ID
+  \return stand-in table index, or -1 on errors
+*/
+
+int
+getStandIn(char *ID)
+{
+  struct sockaddr_in addr;
+  int i;
+
+  for (i=0; i<numStandIns; i++)
+    if (strcmp(standIns[i].ID,ID)==0) return(i);
+
+  if (numStandIns == MAXSTANDINS) {
+    printf("ERROR: too many clients in the capture, %d max\n",MAXSTANDINS);
+    return(-1);
+  }
+
+  standIns[i].sockFD = socket(AF_INET,SOCK_DGRAM,0);
+  if (standIns[i].sockFD < 0) {
+    printf("ERROR: cannot create stand-in socket for %s - %s\n",ID,strerror(errno));
+    return(-1);
+  }
+  memset(&addr,0,sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = 0;
+  if (bind(standIns[i].sockFD,(struct sockaddr *)&addr,sizeof(addr)) < 0) {
+    printf("ERROR: cannot bind stand-in socket for %s - %s\n",ID,strerror(errno));
+    close(standIns[i].sockFD);
+    return(-1);
+  }
+  fcntl(standIns[i].sockFD,F_SETFL,O_NONBLOCK);
+  strcpy(standIns[i].ID,ID);
+  numStandIns++;
+  return(i);
+}
+
+/*!
+  \brief Read and count anything the server sent to the stand-ins
+  \param quiet if 0, print what was received
+*/
+
+void
+drainReplies(int quiet)
+{
+  char buf[MSGSIZE+1];
+  int numRead;
+  int i;
+
+  for (i=0; i<numStandIns; i++) {
+    while ((numRead = recv(standIns[i].sockFD,buf,MSGSIZE,0)) > 0) {
+      numReplies++;
+      if (!quiet) {
+	buf[numRead] = '\0';
+	if (buf[numRead-1]=='\r') buf[numRead-1] = '\0';
+	printf("  <- %s\n",buf);
+      }
+    }
+  }
+}
+
+int
+main(int argc, char *argv[])
+{
+  char *serverHost = (char *)"localhost";
+  int  serverPort = 6600;
+  int  fastMode = 0;
+  int  listMode = 0;
+  int  quiet = 0;
+  double speed = 1.0;
+  double waitTime = 1.0;
+
+  struct capFileHeader *hdr;
+  struct capRecord *rec;
+  struct sockaddr_in server;
+  struct hostent *hostInfo;
+  struct stat st;
+  struct timespec ts;
+  char *map;
+  char msg[MSGSIZE+32];
+  long offset;
+  long numRecords = 0;
+  long numSent = 0;
+  long numErr = 0;
+  long long t0, tStart, tEnd, tNext;
+  int msgLen;
+  int fd;
+  int c;
+  int i;
+
+  // Command line
+
+  while ((c = getopt(argc,argv,"h:p:fx:w:ql")) != -1) {
+    switch (c) {
+    case 'h': serverHost = optarg; break;
+    case 'p': serverPort = atoi(optarg); break;
+    case 'f': fastMode = 1; break;
+    case 'x': speed = atof(optarg); break;
+    case 'w': waitTime = atof(optarg); break;
+    case 'q': quiet = 1; break;
+    case 'l': listMode = 1; break;
+    default:
+      printUsage();
+      exit(1);
+    }
+  }
+  if (optind != argc-1 || speed <= 0.0) {
+    printUsage();
+    exit(1);
+  }
+
+  // Map the capture file
+
+  if ((fd = open(argv[optind],O_RDONLY)) < 0 || fstat(fd,&st) < 0) {
+    printf("ERROR: cannot open capture file %s - %s\n",argv[optind],strerror(errno));
+    exit(1);
+  }
+  if (st.st_size < CAP_HEADERSIZE) {
+    printf("ERROR: %s is not an ISIS capture file\n",argv[optind]);
+    exit(1);
+  }
+  map = (char *)mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+  if (map == MAP_FAILED) {
+    printf("ERROR: cannot mmap() capture file %s - %s\n",argv[optind],strerror(errno));
+    exit(1);
+  }
+  hdr = (struct capFileHeader *)map;
+  if (memcmp(hdr->magic,CAP_MAGIC,8) != 0 || hdr->chunkSize == 0) {
+    printf("ERROR: %s is not an ISIS capture file\n",argv[optind]);
+    exit(1);
+  }
+
+  // List mode: print the records as text, times relative to the
+  // start of the capture
+
+  if (listMode) {
+    printf("# Capture of server %s started at %ld.%06ld UTC\n",hdr->serverID,
+	   (long)(hdr->startTime/1000000),(long)(hdr->startTime%1000000));
+    for (offset = nextRecord(map,st.st_size,0); offset > 0;
+	 offset = nextRecord(map,st.st_size,offset)) {
+      rec = (struct capRecord *)&map[offset];
+      if (rec->method == 2) {
+	struct in_addr in;
+	in.s_addr = htonl(rec->addr);
+	printf("%.6f %s:%d %s>%s %.*s\n",1.0e-9*(rec->monoTime-hdr->startMono),
+	       inet_ntoa(in),rec->port,rec->srcID,rec->destID,
+	       (int)rec->bodyLen,(char *)rec+sizeof(struct capRecord));
+      }
+      else if (rec->method == 3)
+	printf("%.6f local%d %s>%s %.*s\n",1.0e-9*(rec->monoTime-hdr->startMono),
+	       rec->port,rec->srcID,rec->destID,
+	       (int)rec->bodyLen,(char *)rec+sizeof(struct capRecord));
+      else
+	printf("%.6f tty%d %s>%s %.*s\n",1.0e-9*(rec->monoTime-hdr->startMono),
+	       rec->port,rec->srcID,rec->destID,
+	       (int)rec->bodyLen,(char *)rec+sizeof(struct capRecord));
+    }
+    exit(0);
+  }
+
+  // Server address
+
+  if ((hostInfo = gethostbyname(serverHost)) == NULL) {
+    printf("ERROR: unknown server host %s\n",serverHost);
+    exit(1);
+  }
+  memset(&server,0,sizeof(server));
+  server.sin_family = AF_INET;
+  memcpy(&server.sin_addr,hostInfo->h_addr_list[0],hostInfo->h_length);
+  server.sin_port = htons(serverPort);
+
+  // Create the stand-in clients up front so their sockets exist before
+  // the server starts routing to them
+
+  for (offset = nextRecord(map,st.st_size,0); offset > 0;
+       offset = nextRecord(map,st.st_size,offset)) {
+    rec = (struct capRecord *)&map[offset];
+    if (getStandIn(rec->srcID) < 0) exit(1);
+    numRecords++;
+  }
+  if (numRecords == 0) {
+    printf("isisreplay Records=0 Clients=0 Sent=0 SendErr=0 Replies=0 Elapsed=0 Rate=0\n");
+    exit(0);
+  }
+  if (!quiet)
+    printf("Replaying %ld messages from %d clients to %s:%d %s\n",numRecords,
+	   numStandIns,serverHost,serverPort,(fastMode) ? "as fast as possible" : "");
+
+  // Replay
+
+  t0 = -1;
+  tStart = monoTime();
+  for (offset = nextRecord(map,st.st_size,0); offset > 0;
+       offset = nextRecord(map,st.st_size,offset)) {
+    rec = (struct capRecord *)&map[offset];
+    if (t0 < 0) t0 = rec->monoTime;
+
+    // Wait for the message's time, reading replies while we wait
+
+    if (!fastMode) {
+      tNext = tStart + (long long)((rec->monoTime - t0)/speed);
+      drainReplies(quiet);
+      if (tNext > monoTime()) {
+	ts.tv_sec = tNext / 1000000000LL;
+	ts.tv_nsec = tNext % 1000000000LL;
+	clock_nanosleep(CLOCK_MONOTONIC,TIMER_ABSTIME,&ts,NULL);
+      }
+    }
+    else if ((numSent % 64) == 0)
+      drainReplies(quiet);
+
+    if (rec->bodyLen > 0)
+      msgLen = snprintf(msg,sizeof(msg),"%s>%s %.*s\r",rec->srcID,rec->destID,
+			(int)rec->bodyLen,(char *)rec+sizeof(struct capRecord));
+    else
+      msgLen = snprintf(msg,sizeof(msg),"%s>%s\r",rec->srcID,rec->destID);
+    if (msgLen >= (int)sizeof(msg)) msgLen = sizeof(msg)-1;
+
+    i = getStandIn(rec->srcID);
+    if (!quiet) printf("  -> %.*s\n",msgLen-1,msg);
+    if (sendto(standIns[i].sockFD,msg,msgLen,0,(struct sockaddr *)&server,
+	       sizeof(server)) < msgLen)
+      numErr++;
+    else
+      numSent++;
+  }
+  tEnd = monoTime();
+
+  // Collect the last replies
+
+  for (tNext = monoTime() + (long long)(waitTime*1.0e9); monoTime() < tNext; ) {
+    drainReplies(quiet);
+    usleep(10000);
+  }
+
+  printf("isisreplay Records=%ld Clients=%d Sent=%ld SendErr=%ld Replies=%ld "
+	 "Elapsed=%.3f Rate=%.1f\n",numRecords,numStandIns,numSent,numErr,
+	 numReplies,1.0e-9*(tEnd-tStart),
+	 (tEnd > tStart) ? numSent/(1.0e-9*(tEnd-tStart)) : 0.0);
+
+  exit(0);
+}
@@ -19,6 +19,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
@@ -27,6 +28,7 @@
 #include <sys/times.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <sys/file.h>
 #include <netdb.h>
 #include <netinet/in.h>
@@ -36,6 +38,14 @@
 #include <fcntl.h>
 #include <ctype.h>
 
+// Linux builds use the epoll()/recvmmsg()/sendmmsg() event loop unless
+// compiled with -DISIS_NOEPOLL, which forces the legacy select() loop.
+
+#if defined(__linux__) && !defined(ISIS_NOEPOLL)
+#define ISIS_EPOLL
+#include <sys/epoll.h>
+#endif
+
 // In case the version and compilation data are not defined at
 // compilation, put in some placeholders to prevent code barfing
 
@@ -86,6 +96,26 @@
 #define BIG_STR_SIZE      2048  //!< size of generic a big string
 #define SHORT_STR_SIZE    32    //!< size of generic a short string
 
+// Event loop batching 
+
+#define ISIS_BATCHSIZE    32    //!< datagrams per recvmmsg()/sendmmsg() batch
+#define ISIS_MAXEVENTS    16    //!< maximum events per epoll_wait() pass
+
+// Runtime log buffering (see serverlog.c)
+
+#define LOG_RINGSIZE      2048  //!< log ring buffer entries (must be a power of 2)
+#define LOG_RECSIZE       (ISIS_MSGSIZE+MED_STR_SIZE)  //!< maximum log entry size, a full message plus the text logged with it
+#define LOG_BATCHSIZE     64    //!< maximum log entries per writev()
+
+// Serial port I/O threads (see serialio.c)
+
+#define SERIAL_RINGSIZE   32    //!< lines queued per serial port and direction (must be a power of 2)
+#define SERIAL_TXWAIT     500   //!< serial output poll() interval in milliseconds
+
+// Traffic statistics (see stats.c)
+
+#define STATS_NUMBINS     24    //!< log2 routing latency histogram bins, <2us to >8s
+
 // Some useful flags 
 
 #define isis_TRUE       1       //!< condition is TRUE value
@@ -128,6 +158,9 @@ extern struct server {
   int  sockFD;                        //!< Server socket file descriptor 
   int  sockPort;                      //!< Server socket port number        
   char sockAddr[INET6_ADDRSTRLEN];    //!< Server socket IP Address (IPv4)
+  int  localFD;                       //!< Server Unix-domain socket file descriptor, -1 if none
+  char localPath[MED_STR_SIZE];       //!< Server Unix-domain socket path, blank if none
+  int  serialFD;                      //!< Serial I/O thread wakeup pipe (read end), -1 if none
   char hostName[64];                  //!< Server's full resolved hostname
   char localHost[64];                 //!< Name of the local host (w/o domain)
   char startTime[24];                 //!< UTC time the server was started
@@ -148,10 +181,20 @@ extern struct server {
   char logFile[MED_STR_SIZE];         //!< name of the current server log file
   int  logFD;                         //!< Server log file descriptor
   int  logDate;                       //!< Server log date convention, either UTCDATE or OBSDAY
+  long logDropped;                    //!< Log entries dropped because the log buffer was full
+  int  cmdHost;                       //!< Client table index of the host whose command is being executed, or ISIS_SERVER
+  long long rxTime;                   //!< monoTime() when the message being routed was received, 0 if none
+  unsigned int logSeq;                //!< Incremented each time a runtime log file is opened
+  int  doCapture;                     //!< Traffic capture enabled if TRUE (see capture.c)
+  char capRoot[MED_STR_SIZE];         //!< path/rootname for traffic capture files
+  char capFile[MED_STR_SIZE];         //!< name of the current traffic capture file
   int  numClients;                    //!< Number of connected clients   
+  int  maxClients;                    //!< Current capacity of the client table
   int  numSerial;                     //!< Number of serial ports   
   int  numPreset;                     //!< Number of preset UDP socket ports
   char instID[MED_STR_SIZE];          //!< ID of instrument connected
+  int  evLoop;                        //!< Requested event loop, either SELECT_LOOP or EPOLL_LOOP
+  int  epollFD;                       //!< epoll instance file descriptor, -1 if using select()
 } isis;
 
 // ISIS Start/Restart Flags 
@@ -165,12 +208,19 @@ extern struct server {
 #define UTCDATE      0  //!< Logs use the UTC date
 #define OBSDAY       1  //!< Logs use the noon-to-noon local date [Default]
 
+// ISIS event loop types
+
+#define SELECT_LOOP  0  //!< Legacy select() loop, one datagram per wakeup
+#define EPOLL_LOOP   1  //!< epoll() loop with recvmmsg()/sendmmsg() batching [Default]
+
 //--------------------------------------------------------------------------
 //
 // ISIS Client Table
 //
  
-#define MAXCLIENTS 32  //!< Maximum number of client hosts 
+#define MAXCLIENTS   32    //!< Initial size of the client host table
+#define CLIENT_LIMIT 1024  //!< Hard limit on the size of the client host table
+#define MAXSUBSRC    8     //!< Maximum broadcast source IDs per subscription
 
 /*!
   \brief ISIS server client table
@@ -179,24 +229,56 @@ extern struct server {
   added to the client table every time they pass messages through the
   server.  This allows clients to come and go dynamically.
 
-  The maximum number of allowed clients is #MAXCLIENTS.
+  The table starts with #MAXCLIENTS entries and is grown at runtime
+  by updateHosts() as needed, up to #CLIENT_LIMIT entries.  The current
+  capacity is isis.maxClients.  Table indices are stable, growing the
+  table never moves a client to a new index.
 
+  Entries are found through hash indexes on the node ID and, for
+  network clients, on the address and port (see clients.c), so always
+  add and remove entries with updateHosts() and removeHost().
+
+  Clients may subscribe to a subset of broadcasts by message type
+  and/or source node ID with the SUBSCRIBE command, see
+  subscribeHost().  Clients that never subscribe get all broadcasts.
 */
 
 extern struct clients {
   char ID[IMPv2_HOST_SIZE];     //!< Client host ID (IMPv2 protocol)           
   int  method;                  //!< Client transport method
   int  fd;                      //!< File descriptor for client I/O port
-  long addr;                    //!< Client IP address if method=SOCKET 
-  int  port;                    //!< Client port @ addr if method=SOCKET or serial table index 
+  long addr;                    //!< Client IP address if method=SOCKET, #LOCAL_ADDR if method=LOCAL
+  int  port;                    //!< Client port @ addr if method=SOCKET, serial or local table index 
   double tstamp;                //!< Time since last message in seconds since UTC1970-01-01
-} clientTab[MAXCLIENTS];
+  int  subTypes;                //!< Broadcast message types subscribed to (BCAST_xxx bits), 0=all
+  int  numSubSrc;               //!< Number of broadcast source IDs subscribed to, 0=all
+  char subSrc[MAXSUBSRC][IMPv2_HOST_SIZE]; //!< Broadcast source IDs subscribed to
+  unsigned int bcastSeq;        //!< Sequence number of the last broadcast sent to this port
+  long msgIn;                   //!< Messages received from this client
+  long msgOut;                  //!< Messages sent to this client
+  long bytesIn;                 //!< Bytes received from this client
+  long bytesOut;                //!< Bytes sent to this client
+  long sendErr;                 //!< Failed sends to this client
+} *clientTab;
+
+// Broadcast message types for subscriptions (see subscribeHost())
+
+#define BCAST_STATUS  0x01  //!< STATUS: messages
+#define BCAST_DONE    0x02  //!< DONE: messages
+#define BCAST_ERROR   0x04  //!< ERROR: messages
+#define BCAST_WARNING 0x08  //!< WARNING: messages
+#define BCAST_FATAL   0x10  //!< FATAL: messages
+#define BCAST_REQ     0x20  //!< REQ: messages, explicit or implicit
+#define BCAST_EXEC    0x40  //!< EXEC: messages
 
 // Client transport method codes 
 
 #define UNASSIGNED 0   //!< No transport method assigned to client
 #define SERIAL     1   //!< Client uses a serial port
 #define SOCKET     2   //!< Client uses a UDP network socket
+#define LOCAL      3   //!< Client uses a Unix-domain datagram socket on this host
+
+#define LOCAL_ADDR -1L //!< clientTab addr of LOCAL clients, never a valid IPv4 address
 
 //--------------------------------------------------------------------------
 //
@@ -210,6 +292,8 @@ extern struct clients {
 
   Contains the parameters of serial ports opened by the ISIS server.
   The maximum number of allowed ports opened at startup is #MAXSERIAL.
+  Each open port is read and written only by its I/O thread, see
+  serialio.c.
 */
 
 extern struct serial {
@@ -217,6 +301,42 @@ extern struct serial {
   int  fd;                     //!< Serial port file descriptor
 } ttyTab[MAXSERIAL];
 
+//--------------------------------------------------------------------------
+//
+// ISIS local client socket table
+//
+
+#define MAXLOCAL 64  //!< maximum number of Unix-domain client sockets
+
+/*!
+  \brief Datagram socket address of a network or local client
+
+  Large enough for either an AF_INET or an AF_UNIX address, the
+  sa.sa_family member says which.
+*/
+
+typedef union dgramaddr {
+  struct sockaddr    sa;      //!< Generic socket address
+  struct sockaddr_in in;      //!< AF_INET address of a SOCKET client
+  struct sockaddr_un un;      //!< AF_UNIX address of a LOCAL client
+} dgramaddr_t;
+
+/*!
+  \brief ISIS server local client socket table
+
+  Same-host clients may talk to the server over its Unix-domain
+  datagram socket (LocalSocket in the runtime config file) instead of
+  UDP.  Each distinct client socket address seen is entered here, and
+  LOCAL clients in the client host table refer to their socket by its
+  index in this table, like SERIAL clients do with ttyTab.  Entries are
+  reused once no client refers to them.  See findLocalPort().
+*/
+
+extern struct localPort {
+  dgramaddr_t addr;         //!< Client socket address (AF_UNIX)
+  socklen_t   addrLen;      //!< Length of the client socket address, 0 if unused
+} localTab[MAXLOCAL];
+
 //--------------------------------------------------------------------------
 //
 // ISIS preset UDP socket port table
@@ -243,6 +363,29 @@ extern struct udpPreset {
   int  port;                //!< UDP socket port number
 } udpTab[MAXPRESET];
 
+//--------------------------------------------------------------------------
+//
+// Parsed IMPv2 message
+//
+
+/*!
+  \brief IMPv2 message parsed in place by parseIMPv2()
+
+  The node IDs are short uppercased copies, the message body is a slice
+  of the buffer holding the raw message, NUL-terminated in place.  The
+  bytes in front of the body (the original address header) may be
+  overwritten by frameMessage() to build a forwarded message without
+  copying the body.
+*/
+
+typedef struct impv2 {
+  char  srcID[IMPv2_HOST_SIZE];   //!< Source node ID (uppercase)
+  char  destID[IMPv2_HOST_SIZE];  //!< Destination node ID (uppercase)
+  char *body;                     //!< Message body (NUL-terminated in place)
+  int   bodyLen;                  //!< Length of the message body
+  int   headroom;                 //!< Writable bytes in front of body, 0 if none
+} impv2_t;
+
 //--------------------------------------------------------------------------
 //
 // Function prototypes 
@@ -252,6 +395,8 @@ extern struct udpPreset {
 
 int  openSocket(int );
 void closeSocket(int );
+int  openLocalSocket(char *);
+void closeLocalSocket(void);
 int  loadConfig(char *);
 void handShake(void);
 
@@ -261,6 +406,14 @@ void initHostTable();
 int  updateHosts(char *, int, int, long, int);
 int  removeHost(char *);
 int  isKnownHost(char *);
+int  findHostByAddr(long, int);
+int  isPortOwner(int);
+int  findLocalPort(dgramaddr_t *, socklen_t);
+char *localPortName(int);
+int  subscribeHost(int, char *, char *);
+int  broadcastType(char *);
+int  wantsBroadcast(int, int, char *);
+int  serialWantsBroadcast(int, int, char *);
 void printHosts(char *);
 void hostInfo(char *, char *);
 
@@ -270,14 +423,55 @@ int  initSerialPorts(void);
 int  getSerialInfo(int );
 void portInfo(char *);
 
+// Serial port I/O threads
+
+int  startSerialIO(void);
+void stopSerialIO(void);
+int  serialSend(int, char *, int);
+int  serialFlush(int);
+int  serialRecv(int *, char *, long long *);
+int  serialWakeup(void);
+
 // I/O handlers 
 
 void ttyHandler(char *line);
 void socketHandler(int );
-void serialHandler(int );
+void routeDatagram(char *, dgramaddr_t *, socklen_t);
+void serialHandler(void);
 void sendMessage(int, char *);
 void handleMessage(int, int, char *);
 void broadcastMessage(int, char *);
+void routeMessage(int, int, impv2_t *);
+void routeBroadcast(int, impv2_t *);
+char *frameMessage(char *, char *, impv2_t *, int *);
+
+// Event loop and batched datagram I/O
+
+int  initEventLoop(int);
+int  rearmEventLoop(int, int);
+int  epollHandler(int);
+void recvBatch(int);
+int  udpSend(int, struct sockaddr_in *, char *, int);
+int  localSend(int, int, char *, int);
+void flushSendQueue(void);
+int  startSendBatch(void);
+void endSendBatch(int);
+
+// Traffic capture
+
+int  initCapture(void);
+void captureMessage(impv2_t *, int, long, int);
+void closeCapture(void);
+
+// Traffic statistics
+
+long long monoTime(void);
+void statsReceived(int, int);
+void statsSent(int, int);
+void statsSendError(int);
+void statsLatency(long long, long long);
+void statsInfo(char *, char *);
+void resetStats(void);
 
 // Command Utilities 
 
@@ -289,7 +483,9 @@ void printHelp(void);
 // Runtime Logging Utilities 
 
 void initLog(void);
+void closeLog(void);
 int  logMessage(char *);
+void logInfo(char *, char *);
 
 // Utilities 
 
@@ -299,6 +495,7 @@ char   *getDateTime(void);
 double sysTimeStamp(void);
 char   *noonDateTag(void);
 void   getArg(char *, int, char *);
+int    parseIMPv2(char *, impv2_t *);
 void   upperCase(char *);
 
 #endif  // ISISSERVER_H
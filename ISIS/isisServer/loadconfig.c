@@ -10,6 +10,9 @@
 // Modification History:
 //   2009 Mar 18 - updates for v2 [rwp/osu]
 //   2010 Jun 21 - updates stemming from LBT/MODS deployment [rwp/osu]
+//   2026 Oct 17 - added EventLoop keyword
+//   2026 Oct 17 - added Capture keyword
+//   2026 Oct 17 - added LocalSocket keyword
 
 /*!
   \file loadconfig.c
@@ -75,6 +78,14 @@ loadConfig(char *cfgFile)
 
   isis.logDate = OBSDAY; // default is observing day date for log file names
 
+  isis.doCapture = isis_FALSE;  // default: no traffic capture
+
+#ifdef ISIS_EPOLL
+  isis.evLoop = EPOLL_LOOP;  // default: epoll() event loop if available
+#else
+  isis.evLoop = SELECT_LOOP;
+#endif
+
   // clear the serial port and present UDP port counters
 
   isis.numSerial = 0;  
@@ -144,6 +155,60 @@ loadConfig(char *cfgFile)
 	  isis.logDate = OBSDAY;  // default
       }
 
+      // Traffic capture file rootname (including path)
+      //
+      // usage: Capture %s
+      //
+      // Enables binary capture of all traffic received by the server
+      // for replay with isisreplay.  The log date tag and .cap
+      // extension are appended to the rootname, and capture files are
+      // rotated with the runtime log (see capture.c).  Only read at
+      // startup.
+
+      else if (strcasecmp(keyStr, "CAPTURE")==0) {
+	getArg(valStr, 1, argStr);
+	strcpy(isis.capRoot, argStr);
+	isis.doCapture = isis_TRUE;
+      }
+
+      // Unix-domain datagram socket for same-host clients
+      //
+      // usage: LocalSocket %s
+      //
+      // Opens a second server socket at this path (an abstract socket
+      // if the name starts with @) that clients on the same host may
+      // use instead of UDP by setting ISISSocket to the same path in
+      // their runtime config files.  Remote clients are unaffected.
+      // Only read at startup, ignored on warm restarts.
+
+      else if (strcasecmp(keyStr, "LOCALSOCKET")==0) {
+	getArg(valStr, 1, argStr);
+	if (isis.localFD < 0) strcpy(isis.localPath, argStr);
+      }
+
+      // Select the I/O event loop
+      //
+      // usage: EventLoop EPOLL  - epoll() with recvmmsg()/sendmmsg() batching
+      //        EventLoop SELECT - legacy select() loop
+      //
+      // Only read at startup, ignored on warm restarts.  EPOLL is the
+      // default on Linux unless compiled with -DISIS_NOEPOLL.
+
+      else if (strcasecmp(keyStr, "EVENTLOOP")==0) {
+	getArg(valStr, 1, argStr);
+	if (strcasecmp(argStr,"SELECT")==0)
+	  isis.evLoop = SELECT_LOOP;
+	else if (strcasecmp(argStr,"EPOLL")==0) {
+#ifdef ISIS_EPOLL
+	  isis.evLoop = EPOLL_LOOP;
+#else
+	  printf("WARNING: EventLoop EPOLL not supported by this build, using SELECT\n");
+#endif
+	}
+	else
+	  printf("WARNING: Unknown EventLoop type %s - ignored\n",argStr);
+      }
+
       // disable the runtime log (not advised), but...
       //
       // usage: NOLOG
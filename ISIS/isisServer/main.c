@@ -112,7 +112,11 @@
   Programming, Volume 1, Network APIs: Sockets and XTI" (Prentice Hall,
   2nd edition).
 
-  Uses select() for I/O multiplexing.  No multithreading at the present
+  Uses epoll() for I/O multiplexing on Linux, draining the server
+  socket in batches with recvmmsg() and flushing forwards with
+  sendmmsg() (see evloop.c).  The legacy select() loop is retained and
+  may be selected with the EventLoop keyword in the runtime config file
+  or by compiling with -DISIS_NOEPOLL.  No multithreading at the present
   time, but probably should if we get into services that take a long
   time to execute.
 
@@ -132,6 +136,14 @@
   2009 Mar 18 - modifications for version 2.x, including daemon mode
                 and cleanup of old junk we never use anymore [rwp/osu]
   2010 Apr 14 - further modifications for operation as a daemon [rwp/osu]
+  2026 Oct 17 - epoll() event loop with recvmmsg()/sendmmsg() batching,
+                select() loop kept as a runtime/compile-time option
+  2026 Oct 17 - optional binary traffic capture (Capture keyword)
+  2026 Oct 17 - Unix-domain datagram socket for same-host clients (LocalSocket keyword)
+  2026 Oct 17 - serial ports serviced by per-port I/O threads, the event
+                loop only watches their wakeup pipe
+  2026 Oct 17 - warm restart reopens the serial ports and re-registers
+                them with the epoll event loop
   </pre>
 */
 
@@ -151,9 +163,10 @@
 // extern in the isisserver.h header
 
 struct server isis;                   //!< Server runtime parameter table
-struct clients clientTab[MAXCLIENTS]; //!< Server client table
+struct clients *clientTab = NULL;    //!< Server client table (see clients.c)
 struct serial ttyTab[MAXSERIAL];      //!< Server serial port table
 struct udpPreset udpTab[MAXPRESET];   //!< Server preset UDP port table
+struct localPort localTab[MAXLOCAL];  //!< Server local client socket table
 
 // Function prototypes only used in main()
 
@@ -172,6 +185,7 @@ main(int argc, char *argv[])
   int n;
   int numReady;
   int kbdFD;
+  int oldSerialFD;
   int c;
   char cliPrompt[IMPv2_HOST_SIZE+2];
 
@@ -252,6 +266,8 @@ main(int argc, char *argv[])
  
   // Open and parse the initialization file 
 
+  isis.localFD = -1;  // no local socket until we open it
+  isis.serialFD = -1; // no serial I/O threads until we open the ports
   if (loadConfig(isis.iniFile) < 0) {
     if (isis.useCLI)
       printf("Error parsing ini file %s - %s aborting\n",
@@ -276,9 +292,10 @@ main(int argc, char *argv[])
     }
   }
 
-  // Initialize the client host table 
+  // Initialize the client host table and traffic statistics
 
   initHostTable();
+  resetStats();
 
   // Open the server network socket 
 
@@ -292,9 +309,22 @@ main(int argc, char *argv[])
     exit(2);
   }
 
+  // Open the local socket for same-host clients if configured
+
+  if (strlen(isis.localPath) > 0 && openLocalSocket(isis.localPath) < 0) {
+    if (isis.useCLI)
+      printf("Local socket %s unavailable, same-host clients must use UDP\n",
+	     isis.localPath);
+    else
+      printf("%s %s: local socket %s unavailable, same-host clients must use UDP\n",
+	     getDateTime(),isis.exeFile,isis.localPath);
+  }
+
   if (isis.useCLI) {
     printf("%s server started on port %d\n", isis.serverID,
 	   isis.sockPort);
+    if (isis.localFD >= 0)
+      printf("%s server local socket %s\n",isis.serverID,isis.localPath);
     printf("Type quit to terminate the server session.\n");
   }
   else
@@ -307,6 +337,27 @@ main(int argc, char *argv[])
   if (isis.doLogging)
     initLog();
 
+  // Start the traffic capture if enabled
+
+  if (isis.doCapture) {
+    initCapture();
+    atexit(closeCapture);
+  }
+
+  // Setup the epoll() event loop if requested, otherwise (or if it
+  // fails) we fall back to the select() loop
+
+  isis.epollFD = -1;
+  if (isis.evLoop == EPOLL_LOOP) {
+    if (initEventLoop(kbdFD) < 0) {
+      if (isis.useCLI)
+	printf("epoll event loop unavailable, using select() loop\n");
+      else
+	printf("%s %s: epoll event loop unavailable, using select() loop\n",
+	       getDateTime(),isis.exeFile);
+    }
+  }
+
   if (isis.useCLI) {
     // Startup the history mechanism 
 
@@ -371,6 +422,20 @@ main(int argc, char *argv[])
 		 getDateTime(),isis.exeFile,isis.iniFile);
 	}
 	loadConfig(isis.iniFile);
+
+	// reopen the serial ports from the reloaded file, and swap
+	// the reopened serial descriptor into the epoll set
+
+	oldSerialFD = isis.serialFD;
+	if (initSerialPorts() < isis.numSerial) {
+	  if (isis.useCLI)
+	    printf("   ... error reopening serial ports\n");
+	  else
+	    printf("%s %s: error reopening serial ports\n",
+		   getDateTime(),isis.exeFile);
+	}
+	rearmEventLoop(oldSerialFD,isis.serialFD);
+
 	if (isis.useCLI)
 	  printf("   ... pinging clients ...\n");
 	else
@@ -394,16 +459,25 @@ main(int argc, char *argv[])
       if (isis.useCLI) rl_refresh_line(0,0);
     }
 
+    // epoll() event loop: one pass dispatches all ready descriptors,
+    // draining the server socket in recvmmsg() batches
+
+    if (isis.epollFD >= 0) {
+      numReady = epollHandler(kbdFD);
+      if (numReady < 0 && errno != EINTR) {
+	printf("\n<<WARNING: Server epoll_wait() Error - %s\n",strerror(errno));
+	if (isis.useCLI) rl_refresh_line(0,0);
+      }
+      continue;
+    }
+
     // Set up the file descriptor table for select() 
 
     FD_ZERO(&fdList);
     if (isis.useCLI) FD_SET(kbdFD, &fdList) ;
     FD_SET(isis.sockFD, &fdList) ;
-    if (isis.numSerial > 0) {
-      for (i=0; i<isis.numSerial; i++) {
-	FD_SET(ttyTab[i].fd, &fdList) ;
-      }
-    }
+    if (isis.localFD >= 0) FD_SET(isis.localFD, &fdList) ;
+    if (isis.serialFD >= 0) FD_SET(isis.serialFD, &fdList) ;
 
     // See if anyone has anything to say to us 
 
@@ -442,24 +516,21 @@ main(int argc, char *argv[])
 	socketHandler(isis.sockFD);
 	if (isis.useCLI) rl_refresh_line(0,0);
       }
+      else if (isis.localFD >= 0 && FD_ISSET(isis.localFD,&fdList)) {  // pending local socket input
+	socketHandler(isis.localFD);
+	if (isis.useCLI) rl_refresh_line(0,0);
+      }
 
       else if (FD_ISSET(kbdFD, &fdList)) { // pending keyboard input 
 	if (isis.useCLI) rl_callback_read_char();
 	
       } 
       
-      else {
-
-	if (isis.numSerial > 0) {
-	  for (i=0; i<isis.numSerial; i++) {
-	    if (FD_ISSET(ttyTab[i].fd, &fdList)) { // pending serial input 
-	      serialHandler(ttyTab[i].fd);
-	      if (isis.useCLI) rl_refresh_line(0,0);
-	    }
-	  }
-	} // end of serial port checking 
+      else if (isis.serialFD >= 0 && FD_ISSET(isis.serialFD,&fdList)) {  // pending serial input
+	serialHandler();
+	if (isis.useCLI) rl_refresh_line(0,0);
 	
-      } // ed of FD_ISSET() checking 
+      } // end of FD_ISSET() checking 
       
     } // end of select() input handling 
     
@@ -472,6 +543,8 @@ main(int argc, char *argv[])
   // Tear down the server 
 
   closeSocket(isis.sockFD);
+  closeLocalSocket();
+  stopSerialIO();
 
   // Remove the readline callback handler if running the CLI
 
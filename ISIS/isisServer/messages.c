@@ -3,7 +3,10 @@
 //
 // Contents:
 //   handleMessage()
+//   routeMessage()
+//   frameMessage()
 //   broadcastMessage()
+//   routeBroadcast()
 //   sendMessage()
 //
 // Author:
@@ -15,6 +18,18 @@
 //   2003 Jan 09 - fixed incorrect IMPv2 termination [rwp/osu]
 //   2004 May 11 - added Doxygen documentation hooks [rwp/osu]
 //   2009 Mar 18 - v2 updates [rwp/osu]
+//   2026 Oct 17 - UDP sends go through udpSend() so they can be
+//                 batched with sendmmsg()
+//   2026 Oct 17 - zero-allocation routing: routeMessage() and
+//                 routeBroadcast() work on messages parsed in place by
+//                 parseIMPv2(), forwards are framed in front of the
+//                 received body by frameMessage()
+//   2026 Oct 17 - broadcasts honor client subscriptions (SUBSCRIBE)
+//                 and are sent in one batch
+//   2026 Oct 17 - count serial sends for STATS
+//   2026 Oct 17 - route to LOCAL clients on the Unix-domain socket
+//   2026 Oct 17 - serial output is queued for the serial I/O threads
+//                 with serialSend() instead of written inline
 //
 
 #include "isisserver.h"  
@@ -26,8 +41,17 @@
   The ISIS server passes messages between clients using the ICIMACS
   Messaging Protocol version 2 (IMPv2).
 
-  ... more to come ...
-
+  Messages received on the server socket and serial ports are parsed in
+  place by parseIMPv2() and routed by routeMessage() and
+  routeBroadcast() without allocating or copying the message body.
+  handleMessage() and broadcastMessage() are the entry points for
+  message bodies that did not come from a receive buffer (the server
+  console, restarts, etc.).
+
+  All of the working buffers here are static and preallocated.  The
+  server routes one message at a time, and the only nesting (a client
+  broadcast is also processed by the server as a command) never uses
+  the same buffer twice.
 */
 
 //---------------------------------------------------------------------------
@@ -41,17 +65,61 @@
   \param destHost Client table index of the destination host
   \param msgBody Body of the message
 
+  Convenience wrapper for routeMessage() for a message body that is
+  not in a receive buffer, for example a message built by the server
+  itself.  The forwarded message is built in a static frame buffer.
+
+  \sa routeMessage()
+*/
+
+void
+handleMessage(int sendHost, int destHost, char *msgBody) 
+{
+  impv2_t msg;
+
+  // Remove any extraneous termination characters on msgBody 
+
+  if (msgBody[strlen(msgBody)-1]=='\n') msgBody[strlen(msgBody)-1]='\0';
+  if (msgBody[strlen(msgBody)-1]=='\r') msgBody[strlen(msgBody)-1]='\0';
+
+  memset(msg.srcID,0,sizeof(msg.srcID));
+  memset(msg.destID,0,sizeof(msg.destID));
+  msg.body = msgBody;
+  msg.bodyLen = strlen(msgBody);
+  msg.headroom = 0;
+
+  routeMessage(sendHost,destHost,&msg);
+
+  return;
+
+}
+
+//---------------------------------------------------------------------------
+//
+// routeMessage()
+//
+
+/*!
+  \brief Route a parsed message received by the ISIS server
+  \param sendHost Client table index of the sending client host
+  \param destHost Client table index of the destination host
+  \param msg Parsed message (see parseIMPv2())
+
   Figures out what to do with a message received and already
   validated by the calling procedure.  There are three possibilities:
   <ol>
   <li>It is an ISIS server command request to be passed to isisCommand()
       for processing.
   <li>It is a broadcast message to be copied out to all known ISIS client 
-      hosts (passed to broadcastMessage()), as well as being processed
+      hosts (passed to routeBroadcast()), as well as being processed
       by the server proper (passed to isisCommand()).
   <li>It is a message to be routed to another client host using sendMessage().
   </ol>
-  This routine is designed to be safe for future multithreading.
+
+  Server replies are written by isisCommand() directly behind a
+  preallocated reply header.  Forwarded messages are built by
+  frameMessage(), which writes the new address header in front of the
+  message body in the receive buffer when there is room for it.
 
   IMPv2 messages are terminated with return (\\r = ASCII 13), not with a
   newline (\\n = ASCII 10).  Messages prepared for further routing by
@@ -63,29 +131,12 @@
 */
 
 void
-handleMessage(int sendHost, int destHost, char *msgBody) 
+routeMessage(int sendHost, int destHost, impv2_t *msg)
 {
-
-  // Pointers for character strings 
-
-  char *argStr;
-  char *reply;
-
-  // Reply handling flag (MSG_REPLY,MSG_FORWARD,MSG_ECHO,MSG_NOOP) 
-
-  int doReply; 
-
-  // Allocate memory for the working strings 
-
-  reply  = (char *)malloc((ISIS_MSGSIZE)*sizeof(char));
-  memset(reply,0,ISIS_MSGSIZE);
-
-  doReply = MSG_NOOP;
-
-  // Remove any extraneous termination characters on msgBody 
-
-  if (msgBody[strlen(msgBody)-1]=='\n') msgBody[strlen(msgBody)-1]='\0';
-  if (msgBody[strlen(msgBody)-1]=='\r') msgBody[strlen(msgBody)-1]='\0';
+  static char reply[ISIS_MSGSIZE];  // preallocated server reply buffer
+  char *frame;                      // forwarded message
+  int frameLen;
+  int hdrLen;
 
   // Action depends on the message recipient
 
@@ -93,87 +144,151 @@ handleMessage(int sendHost, int destHost, char *msgBody)
   
   case ISIS_SERVER:
 
-    // Message is a server command, pass to isisCommand() for processing 
+    // Message is a server command, pass to isisCommand() for
+    // processing, which writes any reply right after the header
 
-    argStr = (char *)malloc((BIG_STR_SIZE)*sizeof(char));
-    doReply = isisCommand(msgBody,argStr);
+    hdrLen = sprintf(reply,"%s>%s ",isis.serverID,clientTab[sendHost].ID);
 
-    switch (doReply) {
+    isis.cmdHost = sendHost;
+    switch (isisCommand(msg->body,&reply[hdrLen])) {
 
     case MSG_REPLY:
-      // Return ISIS reply to sending host 
-      sprintf(reply,"%s>%s %s\r",isis.serverID,clientTab[sendHost].ID,argStr);
-      free(argStr);
+      // Return ISIS reply to sending host, correctly terminated
+      strcat(&reply[hdrLen],"\r");
+      sendMessage(sendHost,reply);
+      if (reply[strlen(reply)-1]=='\r') reply[strlen(reply)-1]='\0';
+      if (isis.isVerbose && isis.useCLI) printf("%s\n",reply);
+      logMessage(reply);
       break;
 
     case MSG_ECHO:
       // Echo message body on the server console as-is (no termination) 
-      sprintf(reply,"%s> %s",clientTab[sendHost].ID,msgBody);
-      free(argStr);
+      if (isis.useCLI) printf("\n%s> %s\n",clientTab[sendHost].ID,msg->body);
       break;
 
     default:
-      // No action required, return now 
-      free(argStr);
-      free(reply);
-      return;
+      // No action required
       break;
 
-
-    } // end of doReply switch for ISIS commands 
+    } // end of reply switch for ISIS commands 
 
     break;
 
   case BROADCAST:
 
     // The message is to be broadcast to all known clients except the
-    // sender.  Pass the message to BroadcastMesssage() for handling.
+    // sender.  Pass the message to routeBroadcast() for handling.
   
-    broadcastMessage(sendHost,msgBody); 
-    doReply = MSG_NOOP;
+    routeBroadcast(sendHost,msg); 
     break;
 
   default:
 
     // The message is to be routed to a known client host.  We have
     // already validated the destination host in the calling program, so
-    // rebuild the message and set for forwarding.
-    //
-    // Make sure the message is correctly terminated.
+    // frame the message with its new (terminated) header and forward it.
   
-    sprintf(reply,"%s>%s %s\r",clientTab[sendHost].ID,clientTab[destHost].ID,msgBody);
-    doReply = MSG_FORWARD;
+    frame = frameMessage(clientTab[sendHost].ID,clientTab[destHost].ID,
+			 msg,&frameLen);
+    sendMessage(destHost,frame);
     break;
 
   } // end of message handling 
 
-  // Reply handling 
+  return;
 
-  switch (doReply) {
+}
 
-  case MSG_REPLY:
-    sendMessage(sendHost,reply);  // reply back to sending host 
-    if (reply[strlen(reply)-1]=='\r') reply[strlen(reply)-1]='\0';
-    if (isis.isVerbose && isis.useCLI) printf("%s\n",reply);
-    logMessage(reply);
-    break;
+//---------------------------------------------------------------------------
+//
+// frameMessage()
+//
 
-  case MSG_FORWARD:
-    sendMessage(destHost,reply);  // reply forward to destination host 
-    break;
+/*!
+  \brief Build a terminated IMPv2 message from a parsed message body
+  \param srcID Source node ID for the address header
+  \param destID Destination node ID for the address header
+  \param msg Parsed message with the body to send
+  \param frameLen Returns the length of the framed message in bytes
+  \return Pointer to the framed message \verbatim srcID>destID body\r \endverbatim
+
+  If msg->headroom is large enough, the address header is written
+  directly in front of the body in the receive buffer and the \\r
+  terminator after it, so the body is never copied.  This needs 2
+  bytes after the body for the \\r and a NUL, which the receive
+  handlers reserve.  Otherwise the message is built in a static frame
+  buffer.
+
+  Framing in place consumes the message: the body is no longer
+  NUL-terminated by itself, so frame a message once and reuse the
+  returned frame for every recipient.
+*/
 
-  case MSG_ECHO:
-    if (isis.useCLI) printf("\n%s\n",reply);      // echo to the server console 
-    break;
+char *
+frameMessage(char *srcID, char *destID, impv2_t *msg, int *frameLen)
+{
+  static char frameBuf[ISIS_MSGSIZE];  // used if there is no headroom
+  char *frame;
+  int srcLen;
+  int destLen;
+  int hdrLen;
+
+  srcLen  = strlen(srcID);
+  destLen = strlen(destID);
+  hdrLen  = srcLen + destLen + 2;  // "src>dest "
+
+  if (msg->headroom >= hdrLen) {
+    frame = msg->body - hdrLen;
+    memcpy(frame,srcID,srcLen);
+    frame[srcLen] = '>';
+    memcpy(&frame[srcLen+1],destID,destLen);
+    frame[hdrLen-1] = ' ';
+    msg->body[msg->bodyLen]   = '\r';
+    msg->body[msg->bodyLen+1] = NUL;
+    msg->headroom = 0;
+    *frameLen = hdrLen + msg->bodyLen + 1;
+  }
+  else {
+    *frameLen = snprintf(frameBuf,sizeof(frameBuf),"%s>%s %s\r",
+			 srcID,destID,msg->body);
+    if (*frameLen >= (int)sizeof(frameBuf))
+      *frameLen = sizeof(frameBuf)-1;
+    frame = frameBuf;
+  }
 
-  default:
-    break;
+  return(frame);
+
+}
+
+//---------------------------------------------------------------------------
+//
+// broadcastMessage()
+//
+
+/*!
+  \brief Broadcast a message to all clients.
+  \param sendHost Client table index of the sending host
+  \param msgBody Body of the broadcast message.
 
-  } // end of doReply switch 
+  Convenience wrapper for routeBroadcast() for a message body that is
+  not in a receive buffer, for example a broadcast from the server
+  itself.
 
-  // Free the reply string memory and return 
+  \sa routeBroadcast()
+*/
+
+void
+broadcastMessage(int sendHost, char *msgBody) 
+{
+  impv2_t msg;
 
-  free(reply);
+  memset(msg.srcID,0,sizeof(msg.srcID));
+  memset(msg.destID,0,sizeof(msg.destID));
+  msg.body = msgBody;
+  msg.bodyLen = strlen(msgBody);
+  msg.headroom = 0;
+
+  routeBroadcast(sendHost,&msg);
 
   return;
 
@@ -181,13 +296,13 @@ handleMessage(int sendHost, int destHost, char *msgBody)
 
 //---------------------------------------------------------------------------
 //
-// broadcastMessage()
+// routeBroadcast()
 //
 
 /*!
-  \brief Broadcast a message to all clients.
+  \brief Broadcast a parsed message to all clients.
   \param sendHost Client table index of the sending host
-  \param msgBody Body of the broadcast message.
+  \param msg Parsed message to broadcast (see parseIMPv2())
 
   Sends a broadcast message out to all known clients on the
   system.  Broadcast messages take the form of
@@ -198,218 +313,134 @@ handleMessage(int sendHost, int destHost, char *msgBody)
   <li>to each active serial port
   <li>to each active network client
   </ol>
-  If XX is one of our known clients, we pass the message along
-  only to ports other than the one the sending client is using.
+  If XX is one of our known clients, the server first processes the
+  message itself, then we pass the message along only to ports other
+  than the one the sending client is using.
 
-  This is a key distinction: broadcasts are blind-sent to \em ports not
+  This is a key distinction: broadcasts are sent to \em ports not
   hosts.  We have to be careful not to echo a broadcast back to the
   sender, which risks starting infinite regressions.
 
-  Designed to be lightweight and thread safe.  All routines called by
-  this (and the routine itself) must not alter global variables.  this
-  means that logging is the responsibility of calling programs upstream.
+  Clients may restrict the broadcasts they receive by message type
+  and source with the SUBSCRIBE command.  A port gets the broadcast if
+  any client on it wants it (see wantsBroadcast() and
+  serialWantsBroadcast()), so clients that never subscribe get
+  everything, as before.
+
+  The broadcast message is framed once by frameMessage() and the same
+  frame is sent to every port.  The network sends are queued and go
+  out together with sendmmsg() (see startSendBatch()), and the serial
+  sends are queued for the serial I/O threads (see serialSend()).
+
+  Designed to be lightweight.  The only global state changed is the
+  per-port broadcast sequence number in the client table used to send
+  each port only one copy.  Logging is the responsibility of calling
+  programs upstream.
 */
 
 void
-broadcastMessage(int sendHost, char *msgBody) 
+routeBroadcast(int sendHost, impv2_t *msg)
 {
+  static unsigned int bcastSeq = 0;  // broadcast sequence number
   struct sockaddr_in client;  // network client socket info   
-  int clientLen;       
-  int serialFD;               // serial port file descriptor 
-  int senderFD;               // sender file descriptor      
-  int numSent;                // number of bytes sent        
-  int i;
+  int senderTTY = -1;         // sender serial port table index
+  long senderAddr = -1;       // sender network address and port
+  int senderPort = -1;
+  int msgLen;                 // message length
+  int msgType;                // message type for subscriptions
+  int wasInBatch;
+  int i, iPort;
   char errStr[256];           // error string
+  char *srcID;                // broadcast source ID
   char *message;              // full mesage string
 
-  // Which host is sending the broadcast message?
+  // If the sending host is one of our clients, ISIS must first process
+  // the broadcast message itself, and must not send it back to the
+  // sender's port.
 
-  message  = (char *)malloc((ISIS_MSGSIZE)*sizeof(char));
-  memset(message,0,ISIS_MSGSIZE);
+  if (sendHost == ISIS_SERVER) 
+    srcID = isis.serverID;
 
-  // The sending host is the ISIS server... 
+  else {
+    routeMessage(sendHost,ISIS_SERVER,msg);
+    srcID = clientTab[sendHost].ID;
 
-  if (sendHost == ISIS_SERVER) {
-    
-    // Build the properly terminated IMPv2 broadcast message string 
-
-    sprintf(message,"%s>AL %s\r",isis.serverID,msgBody);
+    switch (clientTab[sendHost].method) {
+    case SOCKET:
+    case LOCAL:
+      senderAddr = clientTab[sendHost].addr;
+      senderPort = clientTab[sendHost].port;
+      break;
 
-    // First, send to all serial ports 
+    case SERIAL:
+      senderTTY = clientTab[sendHost].port;
+      break;
 
-    if (isis.numSerial > 0) {
-      for (i=0; i<isis.numSerial; i++) {
-	serialFD = ttyTab[i].fd;
-	if (serialFD > 0) {
-	  numSent = write(serialFD,message,strlen(message));
-	  if (numSent < 0) {
-	    sprintf(errStr,"ERROR: Serial Port write() Error on port %s - %s",
-		    ttyTab[i].devName,strerror(errno));
-	    if (isis.useCLI)
-	      printf("%s\n",errStr);
-	    else
-	      logMessage(errStr);
-	  }
-	}
-      }
+    default:
+      sprintf(errStr,"ERROR: unsupported transport method %d for client %d (%s)",
+	      clientTab[sendHost].method,sendHost,clientTab[sendHost].ID);
+      if (isis.useCLI)
+	printf("%s\n",errStr);
+      else
+	logMessage(errStr);
+      return;
     }
+  }
 
-    // Now, send it out to each active network client, skipping serial ports.
-
-    if (isis.numClients > 0) {
-      for (i=0; i<MAXCLIENTS; i++) {
-	if (clientTab[i].method == SOCKET) {
-	  client.sin_family = AF_INET;
-	  client.sin_addr.s_addr = htonl(clientTab[i].addr) ;
-	  client.sin_port = htons(clientTab[i].port) ;
-	  clientLen = sizeof(client);
-	  numSent=sendto(isis.sockFD,message,strlen(message),0, 
-		       (struct sockaddr *) &client, clientLen);
-	  if (numSent < strlen(message)) {
-	    sprintf(errStr,"ERROR: (broadcastMessage): Network Socket sendto() Error"
-		    ", Client %d (%s) - %s",
-		    i,clientTab[i].ID,strerror(errno));
-	    if (isis.useCLI)
-	      printf("%s\n",errStr);
-	    else
-	      logMessage(errStr);
-	  }
-	}
+  // Build the properly terminated IMPv2 broadcast message string 
+
+  message = frameMessage(srcID,(char *)"AL",msg,&msgLen);
+  msgType = broadcastType(msg->body);
+
+  // First, send to all active serial ports except the sender's
+
+  for (i=0; i<isis.numSerial; i++) {
+    if (ttyTab[i].fd > 0 && i != senderTTY && 
+	serialWantsBroadcast(i,msgType,srcID)) {
+      statsSent(-1,msgLen);
+      if (serialSend(i,message,msgLen) < 0) {
+	statsSendError(-1);
+	sprintf(errStr,"ERROR: Serial Port %s output queue full, broadcast dropped",
+		ttyTab[i].devName);
+	if (isis.useCLI)
+	  printf("%s\n",errStr);
+	else
+	  logMessage(errStr);
       }
+      else if (isis.rxTime > 0)
+	statsLatency(isis.rxTime,monoTime());
     }
-
-    // all done 
-
-    free(message);
-    return;
-
   }
 
-  // The sending host is another client, take care not to reflect
-  // it back to their port
-
-  // First, ISIS must process the broadcast message itself 
+  // Now, send it out to each network and local client port except the
+  // sender's, once per port no matter how many clients share it.
 
-  handleMessage(sendHost,ISIS_SERVER,msgBody);
+  if (isis.numClients == 0) return;
 
-  // Second, it must pass along the message to all known hosts
-  // EXCEPT the sending host and all clients that share
-  // the same port as the sending host. 
-   
-  sprintf(message,"%s>AL %s\r",clientTab[sendHost].ID,msgBody);
+  bcastSeq++;
+  wasInBatch = startSendBatch();
 
-  // Subsequent actions depend on the client's transport method 
+  for (i=0; i<isis.maxClients; i++) {
+    if (clientTab[i].method != SOCKET && clientTab[i].method != LOCAL) continue;
+    if (clientTab[i].addr == senderAddr && clientTab[i].port == senderPort) 
+      continue;
+    if (!wantsBroadcast(i,msgType,srcID)) continue;
 
-  switch (clientTab[sendHost].method) {
+    iPort = findHostByAddr(clientTab[i].addr,clientTab[i].port);
+    if (clientTab[iPort].bcastSeq == bcastSeq) continue;
+    clientTab[iPort].bcastSeq = bcastSeq;
 
-  case SOCKET:
-
-    // Broadcast was from a network client, so send it to all active
-    // serial ports 
-
-    if (isis.numSerial > 0) {
-      for (i=0; i<isis.numSerial; i++) {
-	serialFD = ttyTab[i].fd;
-	if (serialFD > 0) {
-	  numSent = write(serialFD,message,strlen(message));
-	  if (numSent < 0) {
-	    sprintf(errStr,"ERROR: Serial Port write() Error on port %s - %s",
-		    ttyTab[i].devName,strerror(errno));
-	    if (isis.useCLI)
-	      printf("%s\n",errStr);
-	    else
-	      logMessage(errStr);
-	  }
-	}
-      }
-    }
-    
-    // Now, send it out to each active network client, except itself,
-    // and skipping serial ports
-
-    if (isis.numClients > 0) {
-      for (i=0; i<MAXCLIENTS; i++) {
-	if (clientTab[i].method == SOCKET) {
-	  if (i != sendHost) {
-	    client.sin_family = AF_INET;
-	    client.sin_addr.s_addr = htonl(clientTab[i].addr) ;
-	    client.sin_port = htons(clientTab[i].port) ;
-	    clientLen = sizeof(client);
-	    numSent=sendto(isis.sockFD,message,strlen(message),0, 
-			 (struct sockaddr *) &client, clientLen);
-	    if (numSent < strlen(message)) {
-	      sprintf(errStr,"ERROR: Network Socket sendto() Error, Client %d (%s) - %s",
-		      i,clientTab[i].ID,strerror(errno));
-	      if (isis.useCLI)
-		printf("%s\n",errStr);
-	      else
-		logMessage(errStr);
-	    }
-	  }
-	}
-      }
+    if (clientTab[iPort].method == LOCAL) {
+      localSend(iPort,clientTab[iPort].port,message,msgLen);
+      continue;
     }
-    break;
-
-  case SERIAL:
-    // sending host is on the serial port, first pass the
-    // broadcast to all other serial ports (if only one
-    // port active, skip serial passing entirely)
-     
-    if (isis.numSerial > 1) {
-      senderFD = ttyTab[clientTab[sendHost].port].fd;
-      for (i=0; i<isis.numSerial; i++) {
-	serialFD = ttyTab[i].fd;
-	if (serialFD != senderFD) {
-	  numSent = write(serialFD,message,strlen(message));
-	  if (numSent < 0) {
-	    sprintf(errStr,"ERROR: Serial Port write() Error on port %s - %s",
-		    ttyTab[i].devName,strerror(errno));
-	    if (isis.useCLI)
-	      printf("%s\n",errStr);
-	    else
-	      logMessage(errStr);
-	  }
-	}
-      }
-    }
-    
-    // Now, send it out to each active network client, skipping serial
-    // ports
-    
-    if (isis.numClients > 0) {
-      for (i=0; i<MAXCLIENTS; i++) {
-	if (clientTab[i].method == SOCKET) {
-	  client.sin_family = AF_INET;
-	  client.sin_addr.s_addr = htonl(clientTab[i].addr) ;
-	  client.sin_port = htons(clientTab[i].port) ;
-	  clientLen = sizeof(client);
-	  numSent=sendto(isis.sockFD,message,strlen(message),0, 
-			 (struct sockaddr *) &client, clientLen);
-	  if (numSent < strlen(message)) {
-	    sprintf(errStr,"ERROR: Network Socket sendto() Error, Client %d (%s) - %s",
-		    i,clientTab[i].ID,strerror(errno));
-	    if (isis.useCLI)
-	      printf("%s\n",errStr);
-	    else
-	      logMessage(errStr);
-	  }
-	}
-      }
-    }
-    break;
-
-  default:
-    sprintf(errStr,"ERROR: unsupported transport method %d for client %d (%s)",
-	    clientTab[sendHost].method,sendHost,clientTab[sendHost].ID);
-    if (isis.useCLI)
-      printf("%s\n",errStr);
-    else
-      logMessage(errStr);
-    return;
-    break;
+    client.sin_family = AF_INET;
+    client.sin_addr.s_addr = htonl(clientTab[iPort].addr) ;
+    client.sin_port = htons(clientTab[iPort].port) ;
+    udpSend(iPort,&client,message,msgLen);
+  }
 
-  } // end of method switch 
+  endSendBatch(wasInBatch);
 
   return;
 
@@ -444,12 +475,7 @@ void
 sendMessage(int destHost, char *message) 
 {
   struct sockaddr_in client;  // network client socket info   
-  int clientLen;       
-  int serialFD;               // serial port file descriptor 
-  int numSent;                // number of bytes sent        
   char errStr[256];           // error string
-  char clientAddr[INET6_ADDRSTRLEN];
-  char inetStr[INET6_ADDRSTRLEN];
 
   switch (clientTab[destHost].method) {
 
@@ -457,35 +483,29 @@ sendMessage(int destHost, char *message)
     client.sin_family = AF_INET;
     client.sin_addr.s_addr = htonl(clientTab[destHost].addr) ;
     client.sin_port = htons(clientTab[destHost].port) ;
-    clientLen = sizeof(client);
-    strcpy(clientAddr,inet_ntop(client.sin_family,&client.sin_addr,
-				inetStr,sizeof(inetStr)));
-    numSent=sendto(isis.sockFD,message,strlen(message),0, 
-		 (struct sockaddr *) &client, clientLen);
-    if (numSent < strlen(message)) {
-      sprintf(errStr,"ERROR: Network Socket sendto() Error, Client %d (%s) - %s",
-	      destHost,clientTab[destHost].ID,strerror(errno));
-      if (isis.useCLI)
-	printf("%s\n",errStr);
-      else
-	logMessage(errStr);
+    if (udpSend(destHost,&client,message,strlen(message)) < 0)
+      return;
+    break;
+
+  case LOCAL:
+    if (localSend(destHost,clientTab[destHost].port,message,strlen(message)) < 0)
       return;
-    }
     break;
 
   case SERIAL:
-    serialFD = ttyTab[clientTab[destHost].port].fd;
-    numSent = write(serialFD,message,strlen(message));
-    if (numSent < 0) {
-      sprintf(errStr,"ERROR: Serial Port write() Error on %s, Client %d (%s) - %s",
+    statsSent(destHost,strlen(message));
+    if (serialSend(clientTab[destHost].port,message,strlen(message)) < 0) {
+      statsSendError(destHost);
+      sprintf(errStr,"ERROR: Serial Port %s output queue full, message to Client %d (%s) dropped",
 	      ttyTab[clientTab[destHost].port].devName,destHost,
-	      clientTab[destHost].ID,strerror(errno));
+	      clientTab[destHost].ID);
       if (isis.useCLI)
 	printf("%s\n",errStr);
       else
 	logMessage(errStr);
       return;
     }
+    if (isis.rxTime > 0) statsLatency(isis.rxTime,monoTime());
     break;
 
   default:
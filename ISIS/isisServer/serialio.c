@@ -0,0 +1,569 @@
+//
+// serialio.c - ISIS server serial port I/O threads
+//
+// Contents:
+//   startSerialIO() - start an I/O thread for each open serial port
+//   stopSerialIO()  - flush queued output and stop the I/O threads
+//   serialSend()    - queue a message for output on a serial port
+//   serialFlush()   - have a port's I/O thread flush the port
+//   serialRecv()    - get the next line received on any serial port
+//   serialWakeup()  - acknowledge a wakeup and report I/O thread errors
+//
+// Date:
+//   2026 October 17
+//
+// Modification History:
+//
+
+/*!
+  \file serialio.c
+  \brief ISIS server serial port I/O threads
+
+  RS-232 devices are slow, and a wedged one can block a write() for a
+  long time, so the server event loop never touches the serial ports
+  directly.  Each open port in ttyTab is serviced by its own I/O
+  thread that reads the port, assembles input into lines terminated
+  by \\r or \\n, and writes out queued messages.
+
+  Lines travel between the event loop and each I/O thread on two
+  single-producer, single-consumer ring buffers of #SERIAL_RINGSIZE
+  entries, one per direction, like the runtime log ring (see
+  serverlog.c).  When a line arrives, the I/O thread writes a byte to
+  a wakeup pipe that the event loop watches instead of the tty ports
+  (isis.serialFD), and serialHandler() pulls the lines off with
+  serialRecv().  Outgoing messages are queued by serialSend() and a
+  byte written to the port's own pipe wakes its thread.  Only one
+  wakeup byte is outstanding on a pipe at a time.
+
+  If a ring is full the new line is dropped and counted rather than
+  waiting, so a stuck device fills its output queue and then loses
+  messages without delaying traffic on the network sockets.  The I/O
+  threads may not call logMessage(), so they count errors and the event
+  loop reports them in serialWakeup().
+*/
+
+#include "isisserver.h"
+#include <pthread.h>
+#include <poll.h>
+
+//
+// Serial line ring buffer entry
+//
+
+struct serialLine {
+  int  len;                          // length of the line in bytes
+  long long rxTime;                  // monoTime() the line was completed (input only)
+  char text[ISIS_MSGSIZE];           // line text, not terminated on input
+};
+
+//
+// Per-port I/O thread state.  The event loop owns rxTail and txHead,
+// the I/O thread owns rxHead and txTail, all updated with release
+// stores.  Indices run freely and are masked on use.  The error
+// counters are only incremented by the I/O thread.
+//
+
+static struct serialIO {
+  struct serialLine rxRing[SERIAL_RINGSIZE];  // lines received
+  struct serialLine txRing[SERIAL_RINGSIZE];  // messages to send
+  unsigned int rxHead, rxTail;
+  unsigned int txHead, txTail;
+  int  txPipe[2];                    // wakes the I/O thread for output
+  int  txWake;                       // a byte is pending in txPipe
+  int  flush;                        // tells the I/O thread to tcflush() the port
+  int  stop;                         // tells the I/O thread to flush and exit
+  int  running;                      // the I/O thread is running
+  pthread_t thread;                  // the I/O thread
+  long rxDropped;                    // lines dropped, input ring full
+  long rxErrors;                     // read() errors
+  int  rxErrno;                      // errno of the most recent read() error
+  long txErrors;                     // write() errors and timeouts
+  int  txErrno;                      // errno of the most recent write() error
+  long rxReported;                   // rxDropped+rxErrors already reported
+  long txReported;                   // txErrors already reported
+} serIO[MAXSERIAL];
+
+static int wakePipe[2] = {-1,-1};    // wakes the event loop for input
+static int wakePending = 0;          // a byte is pending in wakePipe
+static int rxNext = 0;               // next port for serialRecv() to check
+
+/*!
+  \brief Write a wakeup byte to a pipe unless one is already pending
+  \param fd write end of the pipe
+  \param pending flag that a byte is pending, cleared by the reader
+*/
+
+static void
+wakeup(int fd, int *pending)
+{
+  char c = 1;
+  int ierr;
+
+  if (__atomic_exchange_n(pending,1,__ATOMIC_SEQ_CST) == 0)
+    ierr = write(fd,&c,1);
+}
+
+/*!
+  \brief Drain a wakeup pipe and clear its pending flag
+  \param fd read end of the pipe
+  \param pending flag that a byte is pending
+
+  The pipe is read empty before the flag is cleared.  Clearing it first
+  would let a producer set the flag and write its byte before we read,
+  leaving the flag set with no byte in the pipe, and no producer would
+  ever write another wakeup.  A line queued after the read but before
+  the flag is cleared writes no byte, so the caller must check its
+  rings after this returns.
+*/
+
+static void
+drainPipe(int fd, int *pending)
+{
+  char buf[16];
+
+  while (read(fd,buf,sizeof(buf)) > 0);
+  __atomic_store_n(pending,0,__ATOMIC_SEQ_CST);
+}
+
+/*!
+  \brief Open a non-blocking pipe
+  \param fds pipe file descriptors, set to -1 on failure
+  \return 0 if successful, -1 on errors
+*/
+
+static int
+openPipe(int *fds)
+{
+  if (pipe(fds) < 0) {
+    fds[0] = fds[1] = -1;
+    return(-1);
+  }
+  fcntl(fds[0],F_SETFL,O_NONBLOCK);
+  fcntl(fds[1],F_SETFL,O_NONBLOCK);
+  return(0);
+}
+
+/*!
+  \brief Queue a line received on a serial port for the event loop
+  \param sp serial port I/O state
+  \param line line text
+  \param len length of the line in bytes
+*/
+
+static void
+pushLine(struct serialIO *sp, char *line, int len)
+{
+  struct serialLine *rec;
+  unsigned int head = sp->rxHead;
+
+  if (head - __atomic_load_n(&sp->rxTail,__ATOMIC_ACQUIRE) >= SERIAL_RINGSIZE)
+    __atomic_add_fetch(&sp->rxDropped,1,__ATOMIC_RELAXED);
+  else {
+    rec = &sp->rxRing[head & (SERIAL_RINGSIZE-1)];
+    memcpy(rec->text,line,len);
+    rec->len = len;
+    rec->rxTime = monoTime();
+    __atomic_store_n(&sp->rxHead,head+1,__ATOMIC_RELEASE);
+  }
+  wakeup(wakePipe[1],&wakePending);
+}
+
+/*!
+  \brief Write all queued output to a serial port
+  \param sp serial port I/O state
+  \param fd serial port file descriptor
+
+  The port is non-blocking, so a partial write waits in poll() for the
+  port to drain, checking every #SERIAL_TXWAIT milliseconds whether
+  the thread has been told to stop, in which case the rest of the
+  message is abandoned.
+*/
+
+static void
+writeQueued(struct serialIO *sp, int fd)
+{
+  struct serialLine *rec;
+  struct pollfd pfd;
+  unsigned int tail = sp->txTail;
+  int numSent;
+  int nDone;
+
+  while (tail != __atomic_load_n(&sp->txHead,__ATOMIC_ACQUIRE)) {
+    rec = &sp->txRing[tail & (SERIAL_RINGSIZE-1)];
+    nDone = 0;
+    while (nDone < rec->len) {
+      numSent = write(fd,rec->text+nDone,rec->len-nDone);
+      if (numSent > 0) {
+	nDone += numSent;
+	continue;
+      }
+      if (numSent < 0 && errno == EINTR) continue;
+      if (numSent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+	sp->txErrno = errno;
+	__atomic_add_fetch(&sp->txErrors,1,__ATOMIC_RELEASE);
+	wakeup(wakePipe[1],&wakePending);
+	break;
+      }
+      pfd.fd = fd;
+      pfd.events = POLLOUT;
+      if (poll(&pfd,1,SERIAL_TXWAIT) == 0 &&
+	  __atomic_load_n(&sp->stop,__ATOMIC_ACQUIRE)) {
+	sp->txErrno = ETIMEDOUT;
+	__atomic_add_fetch(&sp->txErrors,1,__ATOMIC_RELEASE);
+	break;
+      }
+    }
+    tail++;
+    __atomic_store_n(&sp->txTail,tail,__ATOMIC_RELEASE);
+  }
+}
+
+/*!
+  \brief Serial port I/O thread
+  \param arg serial port table index
+  \return NULL
+
+  Waits for input on the serial port or a wakeup on the port's output
+  pipe.  Queued output is written first, then any input is split into
+  lines at \\r or \\n and queued for the event loop.  A flush requested
+  by serialFlush() is done before the output is written, and also
+  drops any partial input line.  Blank lines are dropped.  A line longer than the ISIS message buffer is passed on in
+  pieces.  Runs until stopSerialIO() sets the stop flag, then writes
+  any output still queued and exits.
+*/
+
+static void *
+serialThread(void *arg)
+{
+  int iPort = (int)(long)arg;
+  struct serialIO *sp = &serIO[iPort];
+  int fd = ttyTab[iPort].fd;
+  struct pollfd pfd[2];
+  char inBuf[ISIS_MSGSIZE];
+  char line[ISIS_MSGSIZE];
+  int lineLen = 0;
+  int numRead;
+  int i;
+
+  pfd[0].fd = fd;
+  pfd[0].events = POLLIN;
+  pfd[1].fd = sp->txPipe[0];
+  pfd[1].events = POLLIN;
+
+  while (!__atomic_load_n(&sp->stop,__ATOMIC_ACQUIRE)) {
+    if (poll(pfd,2,-1) < 0) {
+      if (errno == EINTR) continue;
+      sp->rxErrno = errno;
+      __atomic_add_fetch(&sp->rxErrors,1,__ATOMIC_RELEASE);
+      wakeup(wakePipe[1],&wakePending);
+      break;
+    }
+
+    if (pfd[1].revents & POLLIN) {
+      drainPipe(sp->txPipe[0],&sp->txWake);
+      if (__atomic_exchange_n(&sp->flush,0,__ATOMIC_ACQ_REL)) {
+	tcflush(fd,TCIOFLUSH);
+	lineLen = 0;
+      }
+      writeQueued(sp,fd);
+    }
+
+    if (pfd[0].revents & (POLLIN|POLLERR|POLLHUP)) {
+      numRead = read(fd,inBuf,sizeof(inBuf));
+      if (numRead <= 0) {
+	if (numRead < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+
+	// The device went away or failed.  Note it, and back off so a
+	// dead port does not spin this thread.
+
+	sp->rxErrno = (numRead == 0) ? EIO : errno;
+	__atomic_add_fetch(&sp->rxErrors,1,__ATOMIC_RELEASE);
+	wakeup(wakePipe[1],&wakePending);
+	poll(&pfd[1],1,1000);
+	continue;
+      }
+      for (i=0; i<numRead; i++) {
+	if (inBuf[i] == '\r' || inBuf[i] == '\n') {
+	  if (lineLen > 0) pushLine(sp,line,lineLen);
+	  lineLen = 0;
+	}
+	else {
+	  line[lineLen++] = inBuf[i];
+	  if (lineLen == ISIS_MSGSIZE-2) {  // room for frameMessage()'s \r\0
+	    pushLine(sp,line,lineLen);
+	    lineLen = 0;
+	  }
+	}
+      }
+    }
+  }
+
+  writeQueued(sp,fd);
+  return(NULL);
+}
+
+//---------------------------------------------------------------------------
+//
+// startSerialIO()
+//
+
+/*!
+  \brief Start an I/O thread for each open serial port
+  \return 0 if successful, -1 on errors.
+
+  Creates the event loop wakeup pipe the first time it is called (its
+  read end is isis.serialFD), then starts one I/O thread for each open
+  port in the serial port table, stopping any already running first.
+  Called by initSerialPorts() after opening the ports.
+*/
+
+int
+startSerialIO(void)
+{
+  struct serialIO *sp;
+  char errStr[256];
+  int i;
+
+  stopSerialIO();
+
+  if (wakePipe[0] < 0 && openPipe(wakePipe) < 0) {
+    sprintf(errStr,"ERROR: Could not create serial I/O wakeup pipe - %s",
+	    strerror(errno));
+    if (isis.useCLI)
+      printf("%s\n",errStr);
+    else
+      logMessage(errStr);
+    return(-1);
+  }
+  isis.serialFD = wakePipe[0];
+
+  for (i=0; i<isis.numSerial; i++) {
+    if (ttyTab[i].fd < 0) continue;
+    sp = &serIO[i];
+    sp->rxHead = sp->rxTail = 0;
+    sp->txHead = sp->txTail = 0;
+    sp->txWake = 0;
+    sp->flush = 0;
+    sp->stop = 0;
+    sp->rxDropped = sp->rxErrors = sp->txErrors = 0;
+    sp->rxReported = sp->txReported = 0;
+
+    if (openPipe(sp->txPipe) < 0 ||
+	pthread_create(&sp->thread,NULL,serialThread,(void *)(long)i) != 0) {
+      sprintf(errStr,"ERROR: Could not start I/O thread for serial port %s - %s",
+	      ttyTab[i].devName,strerror(errno));
+      if (isis.useCLI)
+	printf("%s\n",errStr);
+      else
+	logMessage(errStr);
+      return(-1);
+    }
+    sp->running = isis_TRUE;
+  }
+
+  return(0);
+}
+
+//---------------------------------------------------------------------------
+//
+// stopSerialIO()
+//
+
+/*!
+  \brief Flush queued output and stop the serial port I/O threads
+
+  Tells each running I/O thread to stop, and waits for it to write
+  out whatever is left in its output queue and exit.  Input not yet
+  picked up by serialRecv() is discarded.
+*/
+
+void
+stopSerialIO(void)
+{
+  struct serialIO *sp;
+  int i;
+
+  for (i=0; i<MAXSERIAL; i++) {
+    sp = &serIO[i];
+    if (!sp->running) continue;
+    __atomic_store_n(&sp->stop,1,__ATOMIC_RELEASE);
+    wakeup(sp->txPipe[1],&sp->txWake);
+    pthread_join(sp->thread,NULL);
+    close(sp->txPipe[0]);
+    close(sp->txPipe[1]);
+    sp->running = isis_FALSE;
+  }
+}
+
+//---------------------------------------------------------------------------
+//
+// serialSend()
+//
+
+/*!
+  \brief Queue a message for output on a serial port
+  \param iPort serial port table index
+  \param message message to send
+  \param msgLen length of the message in bytes
+  \return msgLen if the message was queued, -1 if the port is not
+  open or its output queue is full.
+
+  Copies the message onto the port's output ring and wakes its I/O
+  thread.  Never blocks.  Event loop thread only.
+*/
+
+int
+serialSend(int iPort, char *message, int msgLen)
+{
+  struct serialIO *sp;
+  struct serialLine *rec;
+  unsigned int head;
+
+  if (iPort < 0 || iPort >= MAXSERIAL || !serIO[iPort].running)
+    return(-1);
+
+  sp = &serIO[iPort];
+  head = sp->txHead;
+  if (head - __atomic_load_n(&sp->txTail,__ATOMIC_ACQUIRE) >= SERIAL_RINGSIZE)
+    return(-1);
+
+  if (msgLen > ISIS_MSGSIZE) msgLen = ISIS_MSGSIZE;
+  rec = &sp->txRing[head & (SERIAL_RINGSIZE-1)];
+  memcpy(rec->text,message,msgLen);
+  rec->len = msgLen;
+  __atomic_store_n(&sp->txHead,head+1,__ATOMIC_RELEASE);
+  wakeup(sp->txPipe[1],&sp->txWake);
+
+  return(msgLen);
+}
+
+//---------------------------------------------------------------------------
+//
+// serialFlush()
+//
+
+/*!
+  \brief Have a serial port's I/O thread flush the port
+  \param iPort serial port table index
+  \return 0 if the flush was requested, -1 if the port is not open.
+
+  The I/O thread owns the port, so rather than calling tcflush() on its
+  descriptor here, this sets the port's flush flag and wakes the thread,
+  which discards the port's pending input and output with
+  tcflush(TCIOFLUSH).  Never blocks.  Event loop thread only.
+*/
+
+int
+serialFlush(int iPort)
+{
+  struct serialIO *sp;
+
+  if (iPort < 0 || iPort >= MAXSERIAL || !serIO[iPort].running)
+    return(-1);
+
+  sp = &serIO[iPort];
+  __atomic_store_n(&sp->flush,1,__ATOMIC_RELEASE);
+  wakeup(sp->txPipe[1],&sp->txWake);
+  return(0);
+}
+
+//---------------------------------------------------------------------------
+//
+// serialRecv()
+//
+
+/*!
+  \brief Get the next line received on any serial port
+  \param iPort set to the serial port table index of the port
+  \param line buffer of at least #ISIS_MSGSIZE bytes for the line
+  \param rxTime set to the monoTime() when the line was received
+  \return length of the line, or -1 if there are no lines waiting.
+
+  Copies out the next received line, NUL terminated, taking the ports
+  in turn so that a chatty device cannot starve the others.  Event
+  loop thread only.
+*/
+
+int
+serialRecv(int *iPort, char *line, long long *rxTime)
+{
+  struct serialIO *sp;
+  struct serialLine *rec;
+  int i;
+  int n;
+  int len;
+
+  for (n=0; n<isis.numSerial; n++) {
+    i = (rxNext + n) % isis.numSerial;
+    sp = &serIO[i];
+    if (sp->rxTail == __atomic_load_n(&sp->rxHead,__ATOMIC_ACQUIRE))
+      continue;
+    rec = &sp->rxRing[sp->rxTail & (SERIAL_RINGSIZE-1)];
+    len = rec->len;
+    memcpy(line,rec->text,len);
+    line[len] = NUL;
+    *rxTime = rec->rxTime;
+    *iPort = i;
+    __atomic_store_n(&sp->rxTail,sp->rxTail+1,__ATOMIC_RELEASE);
+    rxNext = i + 1;
+    return(len);
+  }
+
+  return(-1);
+}
+
+//---------------------------------------------------------------------------
+//
+// serialWakeup()
+//
+
+/*!
+  \brief Acknowledge an I/O thread wakeup and report I/O thread errors
+  \return Maximum number of lines that may be waiting.
+
+  Called by serialHandler() when isis.serialFD is readable.  Drains
+  the wakeup pipe, then logs any dropped input lines and read/write
+  errors counted by the I/O threads since the last call, since they
+  cannot log them themselves.  Write errors are also counted in the
+  traffic statistics.  Event loop thread only.
+*/
+
+int
+serialWakeup(void)
+{
+  struct serialIO *sp;
+  char errStr[256];
+  long rxCount;
+  long txCount;
+  int i;
+
+  drainPipe(wakePipe[0],&wakePending);
+
+  for (i=0; i<isis.numSerial; i++) {
+    sp = &serIO[i];
+    if (!sp->running) continue;
+
+    rxCount = __atomic_load_n(&sp->rxDropped,__ATOMIC_ACQUIRE) +
+      __atomic_load_n(&sp->rxErrors,__ATOMIC_ACQUIRE);
+    if (rxCount != sp->rxReported) {
+      sprintf(errStr,"ERROR: Serial Port %s input lost, %ld line(s) dropped, %ld read() error(s) - %s",
+	      ttyTab[i].devName,sp->rxDropped,sp->rxErrors,
+	      (sp->rxErrors > 0) ? strerror(sp->rxErrno) : "input queue full");
+      if (isis.useCLI) printf("\n%s\n",errStr);
+      logMessage(errStr);
+      sp->rxReported = rxCount;
+    }
+
+    txCount = __atomic_load_n(&sp->txErrors,__ATOMIC_ACQUIRE);
+    if (txCount != sp->txReported) {
+      for ( ; sp->txReported < txCount; sp->txReported++)
+	statsSendError(-1);
+      sprintf(errStr,"ERROR: Serial Port write() Error on %s - %s [%ld total]",
+	      ttyTab[i].devName,strerror(sp->txErrno),txCount);
+      if (isis.useCLI) printf("\n%s\n",errStr);
+      logMessage(errStr);
+    }
+  }
+
+  return(isis.numSerial*SERIAL_RINGSIZE);
+}
@@ -1,65 +1,312 @@
 //
 // serverlog - routines for server runtime logging
 //
+// Contents:
+//   initLog()    - open the runtime log and start the log writer thread
+//   logMessage() - append a time-tagged entry to the runtime log
+//   closeLog()   - flush pending log entries and stop the writer thread
+//   logInfo()    - get the current log file name and date tag
+//
+// Modification History:
+//   2026 Oct 17 - log entries are queued on a lock-free ring buffer and
+//                 written by a background thread
+//
 
 /*!
   \file serverlog.c
   \brief Routines for creating a server runtime log.
 
+  logMessage() is called from the server event loop for nearly every
+  message the server routes, so it must never wait on the disk.  It
+  time-stamps the entry and pushes it onto a single-producer,
+  single-consumer ring buffer of #LOG_RINGSIZE records.  A writer
+  thread drains the ring, formats the date/time tags, and appends up
+  to #LOG_BATCHSIZE entries at a time to the log file with a single
+  writev() call.  The writer also handles the OBSDAY or UTCDATE log
+  rollover, opening a new log file when the first entry of a new day
+  comes through.
+
+  If the ring fills up because the disk is slow, new entries are
+  dropped and counted in isis.logDropped rather than blocking message
+  routing.  The writer notes the number of dropped entries in the log
+  when it catches up.  When the ring is empty the writer sleeps on a
+  condition variable, and logMessage() only takes the lock to signal
+  it if it is asleep.
+
+  While the writer thread runs it alone uses isis.logFD and opens new
+  log files.  isis.lastDate and isis.logFile change under logNameLock,
+  so other threads must read them with logInfo().
+
+  The ring has only one producer, so logMessage() may only be called
+  from the main server thread.  If the writer thread cannot be
+  started, logMessage() falls back to writing each entry directly.
 */
 
-#include "isisserver.h"  
+#include "isisserver.h"
+#include <pthread.h>
+#include <sys/uio.h>
+
+//
+// Log ring buffer.  head is only written by the producer (logMessage)
+// and tail only by the writer thread, both with release stores, so no
+// locks are needed.  Indices run freely and are masked on use.
+//
+
+static struct logRecord {
+  struct timeval tv;              // time the entry was logged
+  int  len;                       // length of text including the newline
+  char text[LOG_RECSIZE];         // log entry text, newline terminated
+} logRing[LOG_RINGSIZE];
+
+static unsigned int logHead = 0;  // next record to fill (producer)
+static unsigned int logTail = 0;  // next record to write (writer thread)
+
+static pthread_t logThread;       // log writer thread
+static int logRunning = 0;        // writer thread is running
+static int logStop = 0;           // tells the writer thread to drain and exit
+static int logIdle = 0;           // writer thread is waiting on logWake
+
+static pthread_mutex_t logWakeLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  logWake = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t logNameLock = PTHREAD_MUTEX_INITIALIZER; // isis.lastDate, isis.logFile
 
 /*!
-  \brief Initialize the ISIS server runtime log for this session.
+  \brief Format a log date/time tag
+  \param tv time to format
+  \param str string to hold the tag, at least 32 characters
 
-  Opens the server's runtime log.  Log entries are created by the
-  logMessage() function.
+  Thread-safe version of getDateTime() for a given time, giving the
+  UTC date/time in ISO 8601 format with microseconds.
+*/
 
+static void
+logDateTime(struct timeval *tv, char *str)
+{
+  struct tm gmt;
+
+  gmtime_r(&tv->tv_sec,&gmt);
+  sprintf(str,"%.4i-%.2i-%.2iT%.2i:%.2i:%.2i.%06ld",gmt.tm_year+1900,
+	  gmt.tm_mon+1,gmt.tm_mday,gmt.tm_hour,gmt.tm_min,gmt.tm_sec,
+	  (long)tv->tv_usec);
+}
+
+/*!
+  \brief Compute the log file date tag for a given time
+  \param t time in seconds since UTC 1970-01-01
+  \param tag string to hold the CCYYMMDD date tag
+
+  For UTCDATE logs this is the UTC date.  For OBSDAY logs it is the
+  noon-to-noon local date (see noonDateTag()), which is the local date
+  12 hours earlier.  Thread-safe.
 */
 
-void
-initLog()
+static void
+logDateTag(time_t t, char *tag)
 {
-  int ierr;
-  char logStr[MED_STR_SIZE];
-  
-  // Query the system clock for the date tag to use.
+  struct tm tm;
 
-  getUTCTime();
   switch (isis.logDate) {
   case UTCDATE:
-    strcpy(isis.lastDate,isis.dateTag);
+    gmtime_r(&t,&tm);
     break;
   default:
-    strcpy(isis.lastDate,noonDateTag());
+    t -= 43200;
+    localtime_r(&t,&tm);
     break;
   }
+  sprintf(tag,"%.4i%.2i%.2i",tm.tm_year+1900,tm.tm_mon+1,tm.tm_mday);
+}
+
+/*!
+  \brief Open the runtime log file for a date tag
+  \param dateTag CCYYMMDD date tag of the log file
+  \param tv time the log is being (re)started
+  \return 0 if successful, -1 if the log file could not be opened.
+
+  Closes the current log file if open, then opens the new log file,
+  appending to it if it exists, and writes the log start banner.
+  Logging is disabled if the file cannot be opened.
+*/
+
+static int
+openLog(char *dateTag, struct timeval *tv)
+{
+  int ierr;
+  char logStr[MED_STR_SIZE];
+  char timeStr[SHORT_STR_SIZE];
+
+  char logFile[MED_STR_SIZE];
+
+  if (isis.logFD >= 0) close(isis.logFD);
 
   // Build the log file name from the /path/rootname provided
   // at runtime
 
-  sprintf(isis.logFile,"%s.%s.log",isis.logRoot,isis.lastDate);
+  sprintf(logFile,"%s.%s.log",isis.logRoot,dateTag);
+  pthread_mutex_lock(&logNameLock);
+  strcpy(isis.lastDate,dateTag);
+  strcpy(isis.logFile,logFile);
+  pthread_mutex_unlock(&logNameLock);
 
-  // Open the new runtime log file, append to it if it exists 
+  // Open the new runtime log file, append to it if it exists
 
-  isis.logFD = open(isis.logFile,(O_WRONLY|O_CREAT|O_APPEND));
+  isis.logFD = open(logFile,(O_WRONLY|O_CREAT|O_APPEND),0666);
 
   if (isis.logFD == -1) {
     printf("ERROR: cannot open runtime log file %s - %s\n",
-	   isis.logFile,strerror(errno));
-    isis.doLogging == isis_FALSE;
-    return;
+	   logFile,strerror(errno));
+    __atomic_store_n(&isis.doLogging,isis_FALSE,__ATOMIC_RELAXED);
+    return(-1);
   }
-  chmod(isis.logFile,0666);
-  sprintf(logStr,"------------------------------\n");
-  ierr = write(isis.logFD,logStr,strlen(logStr));
+  chmod(logFile,0666);
+
+  // Tell the traffic capture (see capture.c) to follow the log
+
+  __atomic_add_fetch(&isis.logSeq,1,__ATOMIC_RELEASE);
 
-  memset(logStr,0,sizeof(logStr));
-  sprintf(logStr,"%s runtime log (re)started at UTC %s\n",
-	  isis.serverID,getDateTime());
+  logDateTime(tv,timeStr);
+  sprintf(logStr,"------------------------------\n"
+	  "%s runtime log (re)started at UTC %s\n",isis.serverID,timeStr);
   ierr = write(isis.logFD,logStr,strlen(logStr));
 
+  return(0);
+}
+
+/*!
+  \brief Log writer thread
+  \param arg unused
+
+  Drains the log ring buffer, writing batches of up to #LOG_BATCHSIZE
+  entries with writev().  A batch is cut short at a change of date
+  tag so that rollover to a new log file happens on the first entry
+  of the new day.  Waits on logWake when there is nothing to write,
+  and exits once the ring is empty after closeLog() sets the stop
+  flag.  The writer keeps its own copy of the date tag, so only it
+  reads isis.lastDate while it runs, apart from logInfo().
+*/
+
+static void *
+logWriter(void *arg)
+{
+  struct iovec iov[2*LOG_BATCHSIZE];
+  char stamps[LOG_BATCHSIZE][SHORT_STR_SIZE+1];
+  char dateTag[SHORT_STR_SIZE];
+  char logStr[MED_STR_SIZE];
+  struct logRecord *rec;
+  struct timeval tv;
+  unsigned int head, tail;
+  long dropped;
+  long reported = 0;
+  char lastDate[SHORT_STR_SIZE];
+  int n;
+  int ierr;
+
+  tail = logTail;
+  logInfo(NULL,lastDate);
+
+  while (1) {
+    head = __atomic_load_n(&logHead,__ATOMIC_ACQUIRE);
+
+    if (head == tail) {
+      if (__atomic_load_n(&logStop,__ATOMIC_ACQUIRE)) break;
+
+      // Nothing to write, sleep until logMessage() or closeLog()
+      // wakes us.  logIdle is set before the ring is checked again,
+      // so a producer either sees it or its entry is seen here.
+
+      pthread_mutex_lock(&logWakeLock);
+      __atomic_store_n(&logIdle,1,__ATOMIC_SEQ_CST);
+      if (__atomic_load_n(&logHead,__ATOMIC_SEQ_CST) == tail &&
+	  !__atomic_load_n(&logStop,__ATOMIC_SEQ_CST))
+	pthread_cond_wait(&logWake,&logWakeLock);
+      __atomic_store_n(&logIdle,0,__ATOMIC_SEQ_CST);
+      pthread_mutex_unlock(&logWakeLock);
+      continue;
+    }
+
+    // Gather a batch of entries
+
+    for (n=0; tail != head && n < LOG_BATCHSIZE; n++, tail++) {
+      rec = &logRing[tail & (LOG_RINGSIZE-1)];
+
+      logDateTag(rec->tv.tv_sec,dateTag);
+      if (strcmp(dateTag,lastDate) != 0) {
+	if (n > 0) break;   // write what we have, then roll over
+	openLog(dateTag,&rec->tv);
+	strcpy(lastDate,dateTag);
+      }
+
+      logDateTime(&rec->tv,stamps[n]);
+      strcat(stamps[n]," ");
+      iov[2*n].iov_base = stamps[n];
+      iov[2*n].iov_len = strlen(stamps[n]);
+      iov[2*n+1].iov_base = rec->text;
+      iov[2*n+1].iov_len = rec->len;
+    }
+
+    if (isis.logFD >= 0)
+      ierr = writev(isis.logFD,iov,2*n);
+
+    // Release the records back to logMessage()
+
+    __atomic_store_n(&logTail,tail,__ATOMIC_RELEASE);
+
+    // Note any entries dropped since the last time we looked
+
+    dropped = __atomic_load_n(&isis.logDropped,__ATOMIC_RELAXED);
+    if (dropped > reported && isis.logFD >= 0) {
+      gettimeofday(&tv,NULL);
+      logDateTime(&tv,stamps[0]);
+      sprintf(logStr,"%s WARNING: %ld log entries dropped, log buffer full\n",
+	      stamps[0],dropped-reported);
+      ierr = write(isis.logFD,logStr,strlen(logStr));
+      reported = dropped;
+    }
+  }
+  return(NULL);
+}
+
+/*!
+  \brief Initialize the ISIS server runtime log for this session.
+
+  Opens the server's runtime log and starts the log writer thread.
+  Log entries are created by the logMessage() function.  Call once at
+  server startup, closeLog() is registered with atexit() to flush any
+  pending entries when the server exits.
+
+*/
+
+void
+initLog()
+{
+  char dateTag[SHORT_STR_SIZE];
+  struct timeval tv;
+
+  // Query the system clock for the date tag to use.
+
+  gettimeofday(&tv,NULL);
+  logDateTag(tv.tv_sec,dateTag);
+
+  isis.logFD = -1;
+  isis.logDropped = 0;
+  if (openLog(dateTag,&tv) < 0)
+    return;
+
+  // Start the log writer thread.  If this fails, log synchronously
+
+  if (logRunning) return;
+
+  logStop = 0;
+  logHead = logTail = 0;
+  if (pthread_create(&logThread,NULL,logWriter,NULL) != 0) {
+    printf("WARNING: cannot start the log writer thread - %s\n"
+	   "         runtime log entries will be written synchronously\n",
+	   strerror(errno));
+    return;
+  }
+  logRunning = 1;
+  atexit(closeLog);
+
   return;
 
 }
@@ -67,55 +314,122 @@ initLog()
 /*!
   \brief Append an entry to the server's runtime log with date/time tagging.
   \param message String with the log entry to append to the log.
-  \return 0 if successful, <0 if an error occurred.  
-  
-  Appends the message string given into the server's runtime log, along
-  with a date and time tag.  If errors occur, messages are printed on the
-  server's command console.  
+  \return 0 if successful, <0 if an error occurred or the entry was dropped.
 
-  If the date tag has changed, start a new logfile for a new observing
-  day.
+  Time-stamps the message and queues it for the log writer thread,
+  which appends it to the server's runtime log with a date and time
+  tag, starting a new logfile if the date tag has changed.  A trailing
+  newline on the message is removed.
+
+  If the log buffer is full, the entry is dropped and counted in
+  isis.logDropped so a slow disk cannot hold up the server.  If the
+  writer thread is not running, the entry is written immediately.
 
   Returns 0 if the logging has been disabled, making it look the same as
   if the log had been updated.
 */
 
 int
-logMessage(char *message) 
+logMessage(char *message)
 {
+  struct logRecord *rec;
+  struct timeval tv;
+  struct iovec iov[3];
+  char dateTag[SHORT_STR_SIZE];
+  char timeStr[SHORT_STR_SIZE];
+  unsigned int head;
+  int len;
   int ierr;
-  char logStr[BIG_STR_SIZE];
-  char dateTag[MED_STR_SIZE];
 
-  // If logging is disabled, return now 
+  // If logging is disabled, return now
 
   if (isis.doLogging == isis_FALSE) return(0);
-  
-  // Did we cross over into the next day?
 
-  getUTCTime();
-  switch (isis.logDate) {
-  case UTCDATE:
-    strcpy(dateTag,isis.dateTag);
-    break;
-  default:
-    strcpy(dateTag,noonDateTag());
-    break;
-  }
+  len = strlen(message);
+  if (len > 0 && message[len-1]=='\n') len--;
+  if (len > LOG_RECSIZE-2) len = LOG_RECSIZE-2;
 
-  if (strcasecmp(dateTag,isis.lastDate) != 0) {
-    close(isis.logFD);
-    initLog();
+  // Normal case: queue the entry for the writer thread
+
+  if (logRunning) {
+    head = logHead;
+    if (head - __atomic_load_n(&logTail,__ATOMIC_ACQUIRE) >= LOG_RINGSIZE) {
+      __atomic_add_fetch(&isis.logDropped,1,__ATOMIC_RELAXED);
+      return(-1);
+    }
+    rec = &logRing[head & (LOG_RINGSIZE-1)];
+    gettimeofday(&rec->tv,NULL);
+    memcpy(rec->text,message,len);
+    rec->text[len++] = '\n';
+    rec->len = len;
+    __atomic_store_n(&logHead,head+1,__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&logIdle,__ATOMIC_SEQ_CST)) {
+      pthread_mutex_lock(&logWakeLock);
+      pthread_cond_signal(&logWake);
+      pthread_mutex_unlock(&logWakeLock);
+    }
+    return(0);
   }
 
-  // Append the log entry
+  // No writer thread, append the log entry directly, starting a new
+  // log file if we crossed over into the next day
 
-  if (message[strlen(message)-1]=='\n') message[strlen(message)-1]='\0';
+  gettimeofday(&tv,NULL);
+  logDateTag(tv.tv_sec,dateTag);
+  if (strcmp(dateTag,isis.lastDate) != 0)
+    if (openLog(dateTag,&tv) < 0) return(-1);
 
-  memset(logStr,0,sizeof(logStr));
-  sprintf(logStr,"%s %s\n",getDateTime(),message);
-  ierr = write(isis.logFD,logStr,strlen(logStr));
+  logDateTime(&tv,timeStr);
+  strcat(timeStr," ");
+  iov[0].iov_base = timeStr;
+  iov[0].iov_len = strlen(timeStr);
+  iov[1].iov_base = message;
+  iov[1].iov_len = len;
+  iov[2].iov_base = (void *)"\n";
+  iov[2].iov_len = 1;
+  ierr = writev(isis.logFD,iov,3);
 
   return(0);
 
 }
+
+/*!
+  \brief Flush the runtime log and stop the log writer thread
+
+  Waits for the writer thread to write all pending log entries, then
+  stops it.  Subsequent logMessage() calls write directly to the log.
+  Registered with atexit() by initLog().
+*/
+
+void
+closeLog(void)
+{
+  if (!logRunning) return;
+
+  pthread_mutex_lock(&logWakeLock);
+  __atomic_store_n(&logStop,1,__ATOMIC_SEQ_CST);
+  pthread_cond_signal(&logWake);
+  pthread_mutex_unlock(&logWakeLock);
+  pthread_join(logThread,NULL);
+  logRunning = 0;
+}
+
+/*!
+  \brief Get the current runtime log file name and date tag
+  \param logFile string to hold the log file name, at least
+  #MED_STR_SIZE characters, or NULL
+  \param lastDate string to hold the log date tag, at least
+  #SHORT_STR_SIZE characters, or NULL
+
+  The log writer thread changes both when the log rolls over, so
+  other threads must read them through here rather than from isis.
+*/
+
+void
+logInfo(char *logFile, char *lastDate)
+{
+  pthread_mutex_lock(&logNameLock);
+  if (logFile != NULL) strcpy(logFile,isis.logFile);
+  if (lastDate != NULL) strcpy(lastDate,isis.lastDate);
+  pthread_mutex_unlock(&logNameLock);
+}
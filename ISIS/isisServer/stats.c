@@ -0,0 +1,274 @@
+//
+// stats.c - ISIS server traffic statistics
+//
+// Contents:
+//   monoTime()       - read the monotonic clock in nanoseconds
+//   statsReceived()  - count a message received from a client
+//   statsSent()      - count a message sent to a client
+//   statsSendError() - count a failed send to a client
+//   statsLatency()   - add a receive-to-send latency to the histogram
+//   statsInfo()      - report traffic statistics (STATS command)
+//   resetStats()     - clear all traffic statistics (STATS RESET)
+//
+// Date:
+//   2026 October 17
+//
+// Modification History:
+//
+
+/*!
+  \file stats.c
+  \brief ISIS server traffic statistics
+
+  The server keeps message and byte counts for each client in the
+  client host table (see struct clients), and server-wide totals and
+  a histogram of routing latency here.  They are reported by the STATS
+  server command and cleared by STATS RESET.
+
+  Routing latency is the time from when the server read a message
+  (isis.rxTime, set by the socket and serial handlers) to when the
+  resulting forward, broadcast, or reply was handed to the kernel,
+  so it includes any time spent waiting in a sendmmsg() batch.  The
+  histogram has #STATS_NUMBINS log2 bins: bin 0 counts latencies under
+  2 microseconds, bin k counts latencies of 2^k to 2^(k+1) microseconds,
+  and the last bin counts everything longer.
+
+  Counting is a few integer adds per message, and one monotonic clock
+  read per datagram batch for the latency.
+*/
+
+#include "isisserver.h"
+
+// Server-wide statistics
+
+static struct {
+  long msgIn;                       // messages received
+  long msgOut;                      // messages sent
+  long bytesIn;                     // bytes received
+  long bytesOut;                    // bytes sent
+  long sendErr;                     // failed sends
+  long numLat;                      // number of latency measurements
+  long long sumLat;                 // sum of latencies in ns
+  long long maxLat;                 // longest latency in ns
+  long latHist[STATS_NUMBINS];      // log2 latency histogram in usec
+  double since;                     // time statistics were last cleared
+} stats;
+
+/*!
+  \brief Read the monotonic clock
+  \return time in nanoseconds on the CLOCK_MONOTONIC clock
+
+  Use for measuring intervals, not for time-of-day.
+*/
+
+long long
+monoTime(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return((long long)ts.tv_sec*1000000000LL + ts.tv_nsec);
+}
+
+/*!
+  \brief Count a message received from a client
+  \param iHost client host table index of the sender
+  \param nBytes size of the message in bytes
+*/
+
+void
+statsReceived(int iHost, int nBytes)
+{
+  stats.msgIn++;
+  stats.bytesIn += nBytes;
+  if (iHost >= 0 && iHost < isis.maxClients) {
+    clientTab[iHost].msgIn++;
+    clientTab[iHost].bytesIn += nBytes;
+  }
+}
+
+/*!
+  \brief Count a message sent to a client
+  \param iHost client host table index of the recipient, or -1 if the
+  recipient is a port rather than a known client
+  \param nBytes size of the message in bytes
+*/
+
+void
+statsSent(int iHost, int nBytes)
+{
+  stats.msgOut++;
+  stats.bytesOut += nBytes;
+  if (iHost >= 0 && iHost < isis.maxClients) {
+    clientTab[iHost].msgOut++;
+    clientTab[iHost].bytesOut += nBytes;
+  }
+}
+
+/*!
+  \brief Count a failed send to a client
+  \param iHost client host table index of the recipient, or -1
+*/
+
+void
+statsSendError(int iHost)
+{
+  stats.sendErr++;
+  if (iHost >= 0 && iHost < isis.maxClients)
+    clientTab[iHost].sendErr++;
+}
+
+/*!
+  \brief Add a routing latency measurement to the histogram
+  \param rxTime monoTime() when the message was received, 0 if the
+  message was not sent in response to a received message
+  \param txTime monoTime() when the message was sent
+*/
+
+void
+statsLatency(long long rxTime, long long txTime)
+{
+  long long lat;
+  long usec;
+  int bin;
+
+  if (rxTime <= 0) return;
+
+  lat = txTime - rxTime;
+  if (lat < 0) lat = 0;
+  stats.numLat++;
+  stats.sumLat += lat;
+  if (lat > stats.maxLat) stats.maxLat = lat;
+
+  for (bin=0, usec=(long)(lat/2000); usec > 0 && bin < STATS_NUMBINS-1; bin++)
+    usec >>= 1;
+  stats.latHist[bin]++;
+}
+
+/*!
+  \brief Latency at a given percentile from the histogram
+  \param pct percentile, 0..100
+  \return upper edge of the histogram bin containing the percentile in
+  microseconds, or 0 if there are no measurements.
+*/
+
+static long
+latPercentile(double pct)
+{
+  long target;
+  long count = 0;
+  int bin;
+
+  if (stats.numLat == 0) return(0);
+
+  target = (long)(pct*0.01*stats.numLat + 0.5);
+  if (target < 1) target = 1;
+  for (bin=0; bin<STATS_NUMBINS-1; bin++) {
+    count += stats.latHist[bin];
+    if (count >= target) break;
+  }
+  return(2L<<bin);
+}
+
+/*!
+  \brief Report traffic statistics
+  \param args command arguments: blank for server totals and a summary
+  for each client, a client ID for that client's detailed statistics,
+  or RESET to clear them.
+  \param reply string to contain the IMPv2 reply
+
+  Server totals are reported as
+  \verbatim
+  DONE: STATS Time=s MsgIn=n MsgOut=n BytesIn=n BytesOut=n SendErr=n
+              LatN=n LatMean=us LatP50=us LatP99=us LatP999=us LatMax=us
+              LatHist=n0,n1,...  XX=in,out ...
+  \endverbatim
+  where Time is the seconds since the statistics were cleared,
+  latencies are in microseconds (percentiles are the upper edge of
+  their histogram bin, see stats.c), and each client is listed as its
+  ID with its message in and out counts.  The client list is cut
+  short if the reply gets too long for one message.
+
+  For one client:
+  \verbatim
+  DONE: STATS Host=XX MsgIn=n MsgOut=n BytesIn=n BytesOut=n SendErr=n Idle=s
+  \endverbatim
+  where Idle is the seconds since the client was last heard from.
+*/
+
+void
+statsInfo(char *args, char *reply)
+{
+  double now;
+  int len;
+  int iHost;
+  int i;
+
+  now = sysTimeStamp();
+
+  if (strcasecmp(args,"RESET")==0) {
+    resetStats();
+    strcpy(reply,"DONE: STATS RESET traffic statistics cleared");
+    return;
+  }
+
+  // Detailed statistics for one client
+
+  if (strlen(args) > 0) {
+    if ((iHost = isKnownHost(args)) == ERR_UNKNOWN_HOST) {
+      sprintf(reply,"ERROR: STATS Unknown Host %s",args);
+      return;
+    }
+    sprintf(reply,"DONE: STATS Host=%s MsgIn=%ld MsgOut=%ld BytesIn=%ld "
+	    "BytesOut=%ld SendErr=%ld Idle=%.3f",clientTab[iHost].ID,
+	    clientTab[iHost].msgIn,clientTab[iHost].msgOut,
+	    clientTab[iHost].bytesIn,clientTab[iHost].bytesOut,
+	    clientTab[iHost].sendErr,now-clientTab[iHost].tstamp);
+    return;
+  }
+
+  // Server totals and latency histogram
+
+  len = sprintf(reply,"DONE: STATS Time=%.1f MsgIn=%ld MsgOut=%ld "
+		"BytesIn=%ld BytesOut=%ld SendErr=%ld LatN=%ld LatMean=%.1f "
+		"LatP50=%ld LatP99=%ld LatP999=%ld LatMax=%.1f LatHist=",
+		now-stats.since,stats.msgIn,stats.msgOut,stats.bytesIn,
+		stats.bytesOut,stats.sendErr,stats.numLat,
+		(stats.numLat > 0) ? 0.001*stats.sumLat/stats.numLat : 0.0,
+		latPercentile(50.0),latPercentile(99.0),latPercentile(99.9),
+		0.001*stats.maxLat);
+  for (i=0; i<STATS_NUMBINS; i++)
+    len += sprintf(&reply[len],(i==0) ? "%ld" : ",%ld",stats.latHist[i]);
+
+  // Message counts for each client, stopping short of a full message
+
+  for (i=0; i<isis.maxClients && len < ISIS_MSGSIZE-64; i++) {
+    if (clientTab[i].method != UNASSIGNED)
+      len += sprintf(&reply[len]," %s=%ld,%ld",clientTab[i].ID,
+		     clientTab[i].msgIn,clientTab[i].msgOut);
+  }
+}
+
+/*!
+  \brief Clear all traffic statistics
+
+  Clears the server totals, the latency histogram, and the counters
+  of every client in the client host table.  Also called at startup.
+*/
+
+void
+resetStats(void)
+{
+  int i;
+
+  memset(&stats,0,sizeof(stats));
+  stats.since = sysTimeStamp();
+
+  for (i=0; i<isis.maxClients; i++) {
+    clientTab[i].msgIn = 0;
+    clientTab[i].msgOut = 0;
+    clientTab[i].bytesIn = 0;
+    clientTab[i].bytesOut = 0;
+    clientTab[i].sendErr = 0;
+  }
+}
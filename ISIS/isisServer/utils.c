@@ -3,6 +3,7 @@
 //
 // Contents:
 //   getArg()  - get an argument by position out of a message string
+//   parseIMPv2() - single-pass in-place IMPv2 message parser
 //   upperCase() - convert to all uppercase
 //
 // Time Utilities: 
@@ -180,8 +181,6 @@ double
 sysTimeStamp(void)
 {
   struct timeval tv;
-  static char str[30];
-  char *ptr;
 
   if (gettimeofday(&tv,NULL)<0) {
     if (isis.useCLI)
@@ -189,11 +188,11 @@ sysTimeStamp(void)
     else
       logMessage("ERROR sysTimeStamp() gettimeofday fault");
   }
-  ptr = ctime(&tv.tv_sec);
 
-  sprintf(str,"%ld.%06ld",tv.tv_sec,tv.tv_usec);
-  
-  return((double)(atof(str)));
+  // Called for every message received, so skip the ctime() and
+  // string conversion the old version did
+
+  return((double)tv.tv_sec + 1.0e-6*(double)tv.tv_usec);
 
 }
 
@@ -359,3 +358,64 @@ getArg(char *argStr, int argNum, char *returnStr)
   returnStr[j] = NUL;
 }
 
+
+/*!
+  \brief Parse an IMPv2 message in place in a single pass
+  \param message NUL-terminated raw message string (modified in place)
+  \param msg impv2_t struct to receive the parsed message
+  \return 0 if successful, -1 if the message is malformed.
+
+  Splits a raw message of the form
+  \verbatim SourceID>DestID message_body\r \endverbatim
+  into its components.  The node IDs are copied into msg in uppercase,
+  and msg->body points at the message body inside \c message, which is
+  NUL-terminated in place at the first newline with any trailing \\r
+  removed.  The address header in front of the body is left intact so
+  the caller can still log the raw message.
+
+  Equivalent to the old getArg() test for a ">" in the first token
+  followed by sscanf("%[^>]>%s %[^\\n]"), except that blank or
+  oversized (>8 character) node IDs are rejected as malformed instead of
+  being left undefined or overflowing.
+*/
+
+int
+parseIMPv2(char *message, impv2_t *msg)
+{
+  char *p = message;
+  int n;
+
+  // Source node ID, everything up to the '>' with no whitespace
+
+  for (n=0; *p != '>'; p++, n++) {
+    if (*p == NUL || isspace((unsigned char)*p) || n == IMPv2_HOST_SIZE-1) return(-1);
+    msg->srcID[n] = toupper((unsigned char)*p);
+  }
+  if (n == 0) return(-1);
+  msg->srcID[n] = NUL;
+  p++;
+
+  // Destination node ID, everything up to the next whitespace
+
+  for (n=0; *p != NUL && !isspace((unsigned char)*p); p++, n++) {
+    if (n == IMPv2_HOST_SIZE-1) return(-1);
+    msg->destID[n] = toupper((unsigned char)*p);
+  }
+  if (n == 0) return(-1);
+  msg->destID[n] = NUL;
+
+  // The message body starts after the whitespace and runs to the
+  // first newline (or the end of the string), less any trailing \r.
+  // The whitespace skip stops at the line terminator, so an empty
+  // body never runs on into the next line.
+
+  while (*p != '\r' && *p != '\n' && isspace((unsigned char)*p)) p++;
+  msg->body = p;
+  for (n=0; p[n] != NUL && p[n] != '\n'; n++);
+  if (n > 0 && p[n-1] == '\r') n--;
+  p[n] = NUL;
+  msg->bodyLen = n;
+  msg->headroom = (int)(p - message);
+
+  return(0);
+}
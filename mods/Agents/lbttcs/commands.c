@@ -1955,6 +1955,7 @@ cmd_skyoffset(char *args, MsgType msgtype, char *reply)
   double dPA = 0.0;
   int numArgs;
   char mySide[16];
+  isisargs_t av;
 
   // Check for an LBT TCS link first
 
@@ -1965,7 +1966,7 @@ cmd_skyoffset(char *args, MsgType msgtype, char *reply)
 
   // We require arguments
 
-  if (strlen(args)==0) {
+  if (ISISTokenize(args,&av)==0) {
     strcpy(reply,"Insufficient arguments, usage: skyoffset dRA dDec [rel|abs] [side]");
     return CMD_ERR;
   }
@@ -1973,13 +1974,12 @@ cmd_skyoffset(char *args, MsgType msgtype, char *reply)
   // Look at the first argument, see if it is HOME, which will execute
   // an absolute offset to 0,0 to the pointing reference.
 
-  GetArg(args,1,argStr1);
-  if (strcasecmp(argStr1,"HOME")==0) {
+  if (ISISArgEq(av.argv[0],"HOME")) {
     dRA = 0.0;
     dDec = 0.0;
     strcpy(offMode,"ABS");
-    GetArg(args,2,argStr2);
-    if (strlen(argStr2) > 0) {
+    if (av.argc > 1) {
+      ISISArgCopy(av.argv[1],argStr2,sizeof(argStr2));
       if (strcasecmp(argStr2,"left")==0)
 	strcpy(mySide,"left");
       else if (strcasecmp(argStr2,"right")==0)
@@ -2086,6 +2086,7 @@ cmd_slitoffset(char *args, MsgType msgtype, char *reply)
   double dPA = 0.0;
   int numArgs;
   char mySide[16];
+  isisargs_t av;
 
   // Check for an LBT TCS link first
 
@@ -2096,7 +2097,7 @@ cmd_slitoffset(char *args, MsgType msgtype, char *reply)
 
   // We require arguments
 
-  if (strlen(args)==0) {
+  if (ISISTokenize(args,&av)==0) {
     strcpy(reply,"Insufficient arguments, usage: slitoffset dX dY [rel|abs] [side]");
     return CMD_ERR;
   }
@@ -2104,14 +2105,13 @@ cmd_slitoffset(char *args, MsgType msgtype, char *reply)
   // Look at the first argument, see if it is HOME, which will execute
   // an absolute offset to 0,0 to the pointing reference.
 
-  GetArg(args,1,argStr1);
-  if (strcasecmp(argStr1,"HOME")==0) {
+  if (ISISArgEq(av.argv[0],"HOME")) {
     dX = 0.0;
     dY = 0.0;
     dPA = 0.0;
     strcpy(offMode,"ABS");
-    GetArg(args,2,argStr2);
-    if (strlen(argStr2) > 0) {
+    if (av.argc > 1) {
+      ISISArgCopy(av.argv[1],argStr2,sizeof(argStr2));
       if (strcasecmp(argStr2,"left")==0)
 	strcpy(mySide,"left");
       else if (strcasecmp(argStr2,"right")==0)
@@ -3139,6 +3139,7 @@ KeyboardCommand(char *line)
 {
   char cmd[BIG_STR_SIZE];       // command string (oversized)
   char args[BIG_STR_SIZE];      // command-line argument buffer (oversized)
+  isisargs_t cmdArgs;           // tokenized command line (see ISISTokenize())
   char reply[ISIS_MSGSIZE];     // command reply buffer
 
   // ISIS message handling stuff
@@ -3225,7 +3226,10 @@ KeyboardCommand(char *line)
 
   // Split message into command and argument strings
 
-  sscanf(message,"%s %[^\n]",cmd,args);
+  if (ISISTokenize(message,&cmdArgs) > 0) {
+    ISISArgCopy(cmdArgs.argv[0],cmd,sizeof(cmd));
+    strncpy(args,ISISArgTail(&cmdArgs,1),sizeof(args)-1);
+  }
 
   // We're all done with the message string, free its memory
 
@@ -3368,7 +3372,8 @@ SocketCommand(char *buf)
   // Command components (command args)
 
   char cmd[BIG_STR_SIZE];       // command string (oversized)
-  char args[BIG_STR_SIZE];      // command-line argument buffer (oversized)
+  char *args;                   // command arguments, points into msgbody
+  isisargs_t cmdArgs;           // tokenized message body (see ISISTokenize())
   char reply[ISIS_MSGSIZE];     // command reply string
 
   // Other working variables
@@ -3381,7 +3386,6 @@ SocketCommand(char *buf)
   // Some simple initializations
 
   memset(reply,0,sizeof(reply));
-  memset(args,0,sizeof(args));
   memset(cmd,0,sizeof(cmd));
   memset(msg,0,ISIS_MSGSIZE);
 
@@ -3421,7 +3425,9 @@ SocketCommand(char *buf)
   case EXEC:   // and executive override commands
 
     memset(msg,0,ISIS_MSGSIZE);
-    sscanf(msgbody,"%s %[^\n]",cmd,args);  // split into command + args
+    if (ISISTokenize(msgbody,&cmdArgs) > 0)  // split into command + args
+      ISISArgCopy(cmdArgs.argv[0],cmd,sizeof(cmd));
+    args = ISISArgTail(&cmdArgs,1);
 
     // Traverse the command table, exact case-insensitive match required
 
@@ -72,6 +72,7 @@ loadConfig(char *cfgfile)
   client.useISIS = 0;  // default: STANDALONE mode rather than an ISIS client
   strcpy(client.isisHost,DEFAULT_ISISHOST); 
   client.isisPort = DEFAULT_ISISPORT;       
+  strcpy(client.isisSocket,"");   // default: UDP to the ISIS server
   strcpy(client.isisID,DEFAULT_ISISID);     
 
   // Client information (defaults in client.h):
@@ -189,6 +190,15 @@ loadConfig(char *cfgfile)
 	client.isisPort = atoi(argStr);
       }
 
+      // ISISSocket: path of the ISIS server's Unix-domain socket (its
+      //             LocalSocket).  Only if ISISHost is this host, to
+      //             talk to the server without going through UDP.
+
+      else if (strcasecmp(keyword,"ISISSOCKET")==0) {
+	GetArg(inStr, 2, argStr);
+	strcpy(client.isisSocket,argStr);
+      }
+
        // UseTTY: enable/disable the interactive command shell
       //
       // Usage: UseTTY [T|F]  --> recognizes aliases T=Y and F=N
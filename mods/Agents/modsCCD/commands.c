@@ -2810,6 +2810,7 @@ KeyboardCommand(char *line)
 {
   char cmd[BIG_STR_SIZE];       // command string (oversized)
   char args[BIG_STR_SIZE];      // command-line argument buffer (oversized)
+  isisargs_t cmdArgs;           // tokenized command line (see ISISTokenize())
   char reply[BIG_STR_SIZE];     // command reply buffer
 
   // ISIS message handling stuff
@@ -2892,7 +2893,10 @@ KeyboardCommand(char *line)
 
   // Split message into command and argument strings
 
-  sscanf(message,"%s %[^\n]",cmd,args);
+  if (ISISTokenize(message,&cmdArgs) > 0) {
+    ISISArgCopy(cmdArgs.argv[0],cmd,sizeof(cmd));
+    strncpy(args,ISISArgTail(&cmdArgs,1),sizeof(args)-1);
+  }
 
   // We're all done with the message string, free its memory
 
@@ -3039,7 +3043,8 @@ SocketCommand(char *buf)
   // Command components (command args)
 
   char cmd[BIG_STR_SIZE];       // command string (oversized)
-  char args[BIG_STR_SIZE];      // command-line argument buffer (oversized)
+  char *args;                   // command arguments, points into msgbody
+  isisargs_t cmdArgs;           // tokenized message body (see ISISTokenize())
   char reply[BIG_STR_SIZE];     // command reply string
 
   // Other working variables
@@ -3051,7 +3056,6 @@ SocketCommand(char *buf)
   // Some simple initializations
 
   memset(reply,0,sizeof(reply));
-  memset(args,0,sizeof(args));
   memset(cmd,0,sizeof(cmd));
 
   // Split the ISIS format message into components
@@ -3086,7 +3090,9 @@ SocketCommand(char *buf)
 
     memset(msg,0,ISIS_MSGSIZE);
 
-    sscanf(msgbody,"%s %[^\n]",cmd,args);  // split into command + args
+    if (ISISTokenize(msgbody,&cmdArgs) > 0)  // split into command + args
+      ISISArgCopy(cmdArgs.argv[0],cmd,sizeof(cmd));
+    args = ISISArgTail(&cmdArgs,1);
 
     // If the command is GO record the host requesting it
     
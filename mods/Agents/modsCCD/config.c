@@ -123,6 +123,7 @@ loadConfig(char *cfgfile)
   client.useISIS = 0;   
   strcpy(client.isisHost,DEFAULT_ISISHOST); 
   client.isisPort = DEFAULT_ISISPORT;       
+  strcpy(client.isisSocket,"");   // default: UDP to the ISIS server
   strcpy(client.isisID,DEFAULT_ISISID);     
 
   // Client information (defaults in client.h):
@@ -242,6 +243,25 @@ loadConfig(char *cfgfile)
 	client.isisPort = atoi(argbuf);
       }
 
+      // ISISSocket: path of the ISIS server's Unix-domain socket (its
+      //             LocalSocket).  Only if ISISHost is this host, to
+      //             talk to the server without going through UDP.
+
+      else if (strcasecmp(keyword,"ISISSOCKET")==0) {
+	GetArg(inbuf, 2, argbuf);
+	strcpy(client.isisSocket,argbuf);
+      }
+
+      // StatusWindow: coalesce STATUS: messages sent within this many
+      //               milliseconds of each other, keeping only the
+      //               latest value of each keyword (e.g., readout
+      //               PCTREAD=).  Default is no coalescing.
+
+      else if (strcasecmp(keyword,"STATUSWINDOW")==0) {
+	GetArg(inbuf, 2, argbuf);
+	ISISStatusWindow(0.001*atof(argbuf));
+      }
+
       // LogFile: Runtime log file rootname (including path) 
       //
       // The .log extension will be appended to this rootname. 
@@ -361,49 +361,61 @@ main(int argc, char *argv[])
      
     n_ready = 0;
 
-    // Setup the select() loop timeout depending on the exposure state
+    // If STATUS: messages are being held for coalescing (see the
+    // StatusWindow config keyword), wake up in time to send them,
+    // otherwise setup the select() loop timeout depending on the
+    // exposure state
 
-    switch(ccd.State) {
-      
-    case EXPOSING:
-    case SETUP:
-    case RESUME:
-      // azcam server is busy integrating. Poll at 50-100msec
-
-      timeout.tv_sec = 0;
-      timeout.tv_usec = 100000;
+    if (ISISStatusWaitTime(&timeout) >= 0) {
       n_ready = select(sel_wid, &read_fd, NULL, NULL, &timeout);
-      break;
-
-    case READ:
-    case READOUT:
-    case WRITING:
-    case ABORT:
-      // azcam server is busy reading out, writing, servicing abort,
-      //   setup select() for faster polling. Shortest readout is ~1.5 sec,
-      //   longest about 20 sec.
-      // NOTE: 0.5sec seemed more reasonable, but it was missing state changes
-      //       on faster readouts for small ROIs. Trying 0.20s 
+      if (n_ready == 0) {
+	ISISStatusFlush(0);
+	continue;
+      }
+    }
+    else {
+      switch(ccd.State) {
       
-      timeout.tv_sec = 0;
-      timeout.tv_usec = 200000;
-      n_ready = select(sel_wid, &read_fd, NULL, NULL, &timeout);
-      break;
+      case EXPOSING:
+      case SETUP:
+      case RESUME:
+	// azcam server is busy integrating. Poll at 50-100msec
 
-    default:
-      // azcam server is idle or paused
-      //   setup select() for 60s polling for idle-time housekeeping
+	timeout.tv_sec = 0;
+	timeout.tv_usec = 100000;
+	n_ready = select(sel_wid, &read_fd, NULL, NULL, &timeout);
+	break;
 
-      if (ccd.FD>0) {
-	timeout.tv_sec = 60; // was 120s
-	timeout.tv_usec = 0;
+      case READ:
+      case READOUT:
+      case WRITING:
+      case ABORT:
+	// azcam server is busy reading out, writing, servicing abort,
+	//   setup select() for faster polling. Shortest readout is ~1.5 sec,
+	//   longest about 20 sec.
+	// NOTE: 0.5sec seemed more reasonable, but it was missing state changes
+	//       on faster readouts for small ROIs. Trying 0.20s 
+      
+	timeout.tv_sec = 0;
+	timeout.tv_usec = 200000;
 	n_ready = select(sel_wid, &read_fd, NULL, NULL, &timeout);
-      }
-      else {
-	n_ready = select(sel_wid, &read_fd, NULL, NULL, NULL);
-      }
-      break;
+	break;
+
+      default:
+	// azcam server is idle or paused
+	//   setup select() for 60s polling for idle-time housekeeping
+
+	if (ccd.FD>0) {
+	  timeout.tv_sec = 60; // was 120s
+	  timeout.tv_usec = 0;
+	  n_ready = select(sel_wid, &read_fd, NULL, NULL, &timeout);
+	}
+	else {
+	  n_ready = select(sel_wid, &read_fd, NULL, NULL, NULL);
+	}
+	break;
       
+      }
     }
     
     //----------------------------------------------------------------
@@ -764,8 +776,10 @@ main(int argc, char *argv[])
   if (dm.FD>0)
     closeDM(&dm);
   
-  // Tear down the application's client socket
+  // Send any held STATUS: messages and tear down the application's
+  // client socket
 
+  ISISStatusFlush(1);
   CloseClientSocket(&client);
 
   // Remove the readline() callback handler
@@ -185,6 +185,10 @@ void getUTCTime(utcinfo_t *);
 int getMechID(char []);
 int powerState(int, char *);
 
+// Mechanism name hash index (libislutils mechindex.c)
+
+int mechIndex(char []);
+
 // Signal Handlers
 
 void HandleExit(int); // SIGKILL/SIGINT exit handler
@@ -100,7 +100,9 @@ getUTCTime(utcinfo_t *utci)
   \param mechName name of the mechanism (lowercase)
   \return mechID  or -1
 
-  Get the mechanism ID index in shared memory for a named mechanism
+  Get the mechanism ID index in shared memory for a named mechanism.
+  Exact names come from the hash index the mmcServer keeps in shared
+  memory (mechIndex() in libislutils).
 
 */
 
@@ -108,7 +110,9 @@ int
 getMechID(char mechName[])
 {
   int dev;
-  
+
+  if ((dev=mechIndex(mechName)) >= 0) return dev;
+
   for (dev=0;
        !strstr(mechName,shm_addr->MODS.who[dev]) && dev<=MAX_ML;
        dev++);
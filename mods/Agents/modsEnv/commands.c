@@ -1059,6 +1059,7 @@ KeyboardCommand(char *line)
 {
   char cmd[BIG_STR_SIZE];       // command string (oversized)
   char args[BIG_STR_SIZE];      // command-line argument buffer (oversized)
+  isisargs_t cmdArgs;           // tokenized command line (see ISISTokenize())
   char reply[ISIS_MSGSIZE];     // command reply buffer
 
   // ISIS message handling stuff
@@ -1145,7 +1146,10 @@ KeyboardCommand(char *line)
 
   // Split message into command and argument strings
 
-  sscanf(message,"%s %[^\n]",cmd,args);
+  if (ISISTokenize(message,&cmdArgs) > 0) {
+    ISISArgCopy(cmdArgs.argv[0],cmd,sizeof(cmd));
+    strncpy(args,ISISArgTail(&cmdArgs,1),sizeof(args)-1);
+  }
 
   // We're all done with the message string, free its memory
 
@@ -1288,7 +1292,8 @@ SocketCommand(char *buf)
   // Command components (command args)
 
   char cmd[BIG_STR_SIZE];       // command string (oversized)
-  char args[BIG_STR_SIZE];      // command-line argument buffer (oversized)
+  char *args;                   // command arguments, points into msgbody
+  isisargs_t cmdArgs;           // tokenized message body (see ISISTokenize())
   char reply[ISIS_MSGSIZE];     // command reply string
 
   // Other working variables
@@ -1301,7 +1306,6 @@ SocketCommand(char *buf)
   // Some simple initializations
 
   memset(reply,0,sizeof(reply));
-  memset(args,0,sizeof(args));
   memset(cmd,0,sizeof(cmd));
   memset(msg,0,ISIS_MSGSIZE);
 
@@ -1341,7 +1345,9 @@ SocketCommand(char *buf)
   case EXEC:   // and executive override commands
 
     memset(msg,0,ISIS_MSGSIZE);
-    sscanf(msgbody,"%s %[^\n]",cmd,args);  // split into command + args
+    if (ISISTokenize(msgbody,&cmdArgs) > 0)  // split into command + args
+      ISISArgCopy(cmdArgs.argv[0],cmd,sizeof(cmd));
+    args = ISISArgTail(&cmdArgs,1);
 
     // Traverse the command table, exact case-insensitive match required
 
@@ -123,6 +123,7 @@ loadConfig(char *cfgfile)
   client.useISIS = 0;  // default: STANDALONE mode rather than an ISIS client
   strcpy(client.isisHost,DEFAULT_ISISHOST); 
   client.isisPort = DEFAULT_ISISPORT;       
+  strcpy(client.isisSocket,"");   // default: UDP to the ISIS server
   strcpy(client.isisID,DEFAULT_ISISID);     
 
   // Client information (defaults in client.h):
@@ -240,6 +241,15 @@ loadConfig(char *cfgfile)
 	client.isisPort = atoi(argStr);
       }
 
+      // ISISSocket: path of the ISIS server's Unix-domain socket (its
+      //             LocalSocket).  Only if ISISHost is this host, to
+      //             talk to the server without going through UDP.
+
+      else if (strcasecmp(keyword,"ISISSOCKET")==0) {
+	GetArg(inStr, 2, argStr);
+	strcpy(client.isisSocket,argStr);
+      }
+
       // InstID: Formal ID of the MODS we're monitoring (e.g., MODS1)
 
       else if (strcasecmp(keyword,"INSTID")==0) {
@@ -742,6 +742,7 @@ int cmd_device (char* cmd, char* args, MsgType msgtype, char* reply, int replyBu
   device_t* device;           // The device targeted by this command.
 
   char argBuf[MAXCFGLINE];    // A buffer that will be used to hold a command line argument.
+  isisargs_t av;              // The tokenized command line arguments.
 
   int moduleIndex;            // The index of the module we are querying.
   int deviceIndex;            // The index of the device we are querying.
@@ -761,7 +762,7 @@ int cmd_device (char* cmd, char* args, MsgType msgtype, char* reply, int replyBu
   //// and we know this is a device command.
 
   // If there are no arguments, print all of the connected devices. 
-  if(strlen(args) == 0){
+  if(ISISTokenize(args, &av) == 0){
     // Query the module to get the most up to date data.
     int ierr = getDeviceModuleData(&env, moduleIndex);
     if (ierr != 0) {
@@ -785,16 +786,16 @@ int cmd_device (char* cmd, char* args, MsgType msgtype, char* reply, int replyBu
   }
 
   // If there is an argument, find the target device.
-  GetArg(args,1,argBuf);
   for(deviceIndex=0; deviceIndex < module->numDevices; deviceIndex++){
     device = module->devices + deviceIndex;
     
     // The matching device was found. We can stop looking.
-    if(strcasecmp(argBuf, device->name)==0) break;
+    if(ISISArgEq(av.argv[0], device->name)) break;
   }
 
   // If the device wasn't found (the second arg is not a device), return that.
   if(deviceIndex >= module->numDevices){
+    ISISArgCopy(av.argv[0], argBuf, sizeof(argBuf));
     sprintf(reply,"No device with name \"%s\" found in module \"%s\".", argBuf, module->name);
     return CMD_ERR;
   };
@@ -802,8 +803,8 @@ int cmd_device (char* cmd, char* args, MsgType msgtype, char* reply, int replyBu
   //// At this point, the 'device' variable points to the correct structure.
 
   // If there is a third argument, this is a "set" command.
-  GetArg(args,2,argBuf);
-  if(strlen(argBuf) > 0){
+  if(av.argc > 1){
+    ISISArgCopy(av.argv[1], argBuf, sizeof(argBuf));
     // Only DO's can have their state changed.
     if(module->processingType != DO){
       sprintf(reply,"%s is not a DO device. Only DO devices can have their state changed.", device->name);
@@ -888,6 +889,7 @@ int cmd_device (char* cmd, char* args, MsgType msgtype, char* reply, int replyBu
 void KeyboardCommand(char *line) {
   char cmd[BIG_STR_SIZE];       // command string (oversized)
   char args[BIG_STR_SIZE];      // command-line argument buffer (oversized)
+  isisargs_t cmdArgs;           // tokenized command line (see ISISTokenize())
   char reply[ISIS_MSGSIZE];     // command reply buffer
 
   // ISIS message handling stuff
@@ -959,7 +961,10 @@ void KeyboardCommand(char *line) {
   memset(cmd,0,sizeof(cmd));
 
   // Split message into command and argument strings
-  sscanf(message,"%s %[^\n]",cmd,args);
+  if (ISISTokenize(message,&cmdArgs) > 0) {
+    ISISArgCopy(cmdArgs.argv[0],cmd,sizeof(cmd));
+    strncpy(args,ISISArgTail(&cmdArgs,1),sizeof(args)-1);
+  }
 
   // We're all done with the message string, free its memory
   free(message);
@@ -1087,7 +1092,8 @@ void SocketCommand(char *buf) {
 
   // Command components (command args)
   char cmd[BIG_STR_SIZE];       // command string (oversized)
-  char args[BIG_STR_SIZE];      // command-line argument buffer (oversized)
+  char *args;                   // command arguments, points into msgbody
+  isisargs_t cmdArgs;           // tokenized message body (see ISISTokenize())
   char reply[ISIS_MSGSIZE];     // command reply string
 
   // Other working variables
@@ -1099,7 +1105,6 @@ void SocketCommand(char *buf) {
 
   // Some simple initializations
   memset(reply,0,sizeof(reply));
-  memset(args,0,sizeof(args));
   memset(cmd,0,sizeof(cmd));
   memset(msg,0,ISIS_MSGSIZE);
 
@@ -1136,7 +1141,9 @@ void SocketCommand(char *buf) {
   case EXEC:   // and executive override commands
 
     memset(msg,0,ISIS_MSGSIZE);
-    sscanf(msgbody,"%s %[^\n]",cmd,args);  // split into command + args
+    if (ISISTokenize(msgbody,&cmdArgs) > 0)  // split into command + args
+      ISISArgCopy(cmdArgs.argv[0],cmd,sizeof(cmd));
+    args = ISISArgTail(&cmdArgs,1);
 
     // Traverse the command table, exact case-insensitive match required
     nfound = 0;
@@ -10,6 +10,12 @@
   <li>Add a command action function prototype to the code below
   <li>Add the command verb and its function call to the #cmdtab struct
   </ol>
+
+  The args string passed to a command function points into the
+  received message body and holds everything after the command word.
+  Commands that need more than one argument should split it once with
+  ISISTokenize() and work with the argument views (see cmd_device())
+  instead of calling GetArg() for each argument.
   
   See commands.c for the full implementation details.
 */
@@ -15,6 +15,10 @@
   2025 June 24 - AlmaLinux 9 port and introduction of a WAGO-based
                  IMCS quad cell readout system with the new ARCHON
                  CCD controller update. [rwp/osu]
+  2026 Oct 17 - mmcscript runs a command script on one pipelined
+                mmcServer session
+  2026 Oct 17 - getMechanismID() uses the shared-memory name hash
+                index
 
 */
 #include <iostream>
@@ -31,6 +35,7 @@ using namespace std;
 #define MAX_OUT 256
 #define MAX_LEN 256+1
 #define BLANK 8
+#define MMCSCRIPT_DEPTH 16 // mmcscript commands in flight
 
 #include "system_dep.h"     // OS dependent headers
 #include "dpi.h"
@@ -94,7 +99,8 @@ StrUpper(char *str)
   \param reply reply message
   \return mechanismID  or error
 
-  Get Mechanism ID
+  Get Mechanism ID, from the mmcServer's hash index (mechIndex()) for
+  exact names.
 
   <pre>
   </pre>
@@ -104,6 +110,8 @@ getMechanismID(char mechanism_name[], char dummy[])
 {
   int dev;
 
+  if ((dev=mechIndex(mechanism_name)) >= 0) return dev;
+
   for(dev=0;
       !strstr(mechanism_name,shm_addr->MODS.who[dev]) && dev<=MAX_ML-1;
       dev++);
@@ -175,6 +183,7 @@ main(int argc, char *argv[])
 	<<"vueinfo islcmd[1-30] value\n"
 	<<"vueinfo masksm[S|I|A]   :Check slitmask\n"<<"vueinfo MLC[1-30]\n"
 	<<"vueinfo mmccmd command\n"<<"vueinfo agwlocate\n"
+	<<"vueinfo mmcscript [file]   :mmcServer commands, one per line\n"
 	<<"vueinfo agwcmd command\n"<<"vueinfo agwlocate\n"
 	<<"vueinfo tcscmd command\n"<<"vueinfo agwlocate\n"
 	<<"vueinfo agwval or vueinfo agwval[X:Y:PF:FW:1:2:3:4]\n";
@@ -948,6 +957,42 @@ main(int argc, char *argv[])
     } else printf("%s\n",buff);
     exit(0);
   }
+  // run a script of mmcServer commands (file or stdin, one per line)
+  // on one persistent session, up to MMCSCRIPT_DEPTH in flight
+  else if (!strcasecmp(what,"MMCSCRIPT")) {
+    FILE *fp = stdin;
+    char line[512];
+    int conn, nsent=0, nrecv=0, nerr=0;
+
+    if (strlen(cmd)>0 && (fp=fopen(cmd,"r"))==NULL) {
+      printf("ERROR: cannot open %s\n",cmd);
+      exit(1);
+    }
+    sprintf(ipascii,"%d",shm_addr->MODS.modsPorts[2]);
+    if ((conn=mmcOpenSession((char*)"localhost",ipascii))<0) {
+      printf("ERROR: cannot open an mmcServer session\n");
+      exit(1);
+    }
+    while (fgets(line,sizeof(line),fp)!=NULL) {
+      line[strcspn(line,"\r\n")]='\0';
+      if (line[0]=='\0' || line[0]=='#') continue;
+      if (mmcSessionSend(conn,line)<0) break;
+      nsent++;
+      if (nsent-nrecv < MMCSCRIPT_DEPTH) continue;
+      if (mmcSessionRecv(conn,buff,sizeof(buff))<0) break;
+      nrecv++;
+      if (strstr(buff,"ERROR")) nerr++;
+      printf("%s\n",buff);
+    }
+    while (nrecv<nsent && mmcSessionRecv(conn,buff,sizeof(buff))==0) {
+      nrecv++;
+      if (strstr(buff,"ERROR")) nerr++;
+      printf("%s\n",buff);
+    }
+    mmcCloseSession(conn);
+    if (nrecv<nsent) printf("ERROR: mmcServer session lost after %d of %d commands\n",nrecv,nsent);
+    exit((nerr>0 || nrecv<nsent) ? 1 : 0);
+  }
   // command AGW with the agwServer
   else if (!strcasecmp(what,"AGWCU")) {
     //sprintf(ipascii,"%d",shm_addr->MODS.modsPorts[1]);
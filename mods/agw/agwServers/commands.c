@@ -3343,6 +3343,7 @@ GCSCommand(char *line, char agw_reply[])
 {
   char cmd[BIG_STR_SIZE];       // command string (oversized)
   char args[BIG_STR_SIZE];      // command-line argument buffer (oversized)
+  isisargs_t cmdArgs;           // tokenized command line (see ISISTokenize())
   char reply[BIG_STR_SIZE];     // command reply buffer
   char dummy[BIG_STR_SIZE];
 
@@ -3399,7 +3400,10 @@ GCSCommand(char *line, char agw_reply[])
   // Split message into command and argument strings
   // and free its memory
   */
-  sscanf(message,"%s %[^\n]",cmd,args);
+  if (ISISTokenize(message,&cmdArgs) > 0) {
+    ISISArgCopy(cmdArgs.argv[0],cmd,sizeof(cmd));
+    strncpy(args,ISISArgTail(&cmdArgs,1),sizeof(args)-1);
+  }
   memset(message,0,sizeof(message));
   free(message);
 
@@ -3500,7 +3504,8 @@ SocketCommand(char *buf)
   // Command components (command args)
   */
   char cmd[BIG_STR_SIZE];       // command string (oversized)
-  char args[BIG_STR_SIZE];      // command-line argument buffer (oversized)
+  char *args;                   // command arguments, points into msgbody
+  isisargs_t cmdArgs;           // tokenized message body (see ISISTokenize())
   char reply[BIG_STR_SIZE];     // command reply string
   char dummy[BIG_STR_SIZE];
 
@@ -3515,7 +3520,6 @@ SocketCommand(char *buf)
   // Some simple initializations
   */
   memset(reply,0,sizeof(reply));
-  memset(args,0,sizeof(args));
   memset(cmd,0,sizeof(cmd));
 
   /*
@@ -3559,7 +3563,9 @@ SocketCommand(char *buf)
 
     memset(msg,0,ISIS_MSGSIZE);
 
-    sscanf(msgbody,"%s %[^\n]",cmd,args);  // split into command + args
+    if (ISISTokenize(msgbody,&cmdArgs) > 0)  // split into command + args
+      ISISArgCopy(cmdArgs.argv[0],cmd,sizeof(cmd));
+    args = ISISArgTail(&cmdArgs,1);
 
     /*
     // Traverse the command table, exact case-insensitive match required
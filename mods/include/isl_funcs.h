@@ -101,6 +101,10 @@ int islsmc(int, char []);
 //int getComm(int, char []);
 int getComm(int, char [], float *);
 int setComm(int, char []);
+unsigned int nameHash(const char *);
+void mechIndexBuild(void);
+int mechIndex(char []);
+int wagoIndex(char []);
 int smccmd(int, char [], int);
 int commcmd(int, char []);
 int smcmech(char[], char [], float);
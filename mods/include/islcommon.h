@@ -16,6 +16,12 @@
   \date 2025 June - AlmaLinux 9 port and switching to a WAGO-based
                     IMCS quadcell readout system [rwp/osu]
 
+  \date 2026 Oct 17 - MicroLynx state poller cache (stateTime, stateSeq,
+                    mlcPos, mlcIO20, mlcPwrFail)
+
+  \date 2026 Oct 17 - mechanism and WAGO name hash indexes (whoHash,
+                    wagoHash)
+
   Note: ttyport_t is defined in instrutils.h
 
 */
@@ -291,6 +297,13 @@ typedef struct islcommon {
     short int temps[30];        // temp for WAGO address information.
     char REPLY[MAX_ML][120];
     char state_word[MAX_ML][8]; // Mechanism word states IN,OUT,CLOSE..etc
+    double stateTime[MAX_ML];   // UNIX time of the last state poll, 0 if stale (see mlcPollState())
+    unsigned int stateSeq[MAX_ML]; // State poll count, odd while a poll is being stored
+    float  mlcPos[MAX_ML];      // Polled MicroLynx POS
+    int    mlcIO20[MAX_ML];     // Polled MicroLynx IO 20 (bits 21-28)
+    int    mlcPwrFail[MAX_ML];  // Polled MicroLynx PWRFAIL
+    short  whoHash[MECH_HASHSIZE];  // who[] name hash index, entry+1 or 0 (see mechIndex())
+    short  wagoHash[WAGO_HASHSIZE]; // WAGOWHO[] name hash index (see wagoIndex())
     char hkUpdate[80];          // mmcHouseKeeker updated time.
     char mmcUpdate1[80];        // Another Timer if needed.
     char mmcUpdate2[80];        // Another Timer if needed.
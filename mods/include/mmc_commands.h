@@ -15,6 +15,7 @@ See commands.c for the full implementation details.
 
 \date 2025 June 21 - AlmaLinux 9 port [rwp/osu]
 \date 2025 July 17 - Added WAGO HEB functions [rwp/osu]
+\date 2026 Oct 17 - Added the CONFIG command
 
 */
 
@@ -74,6 +75,7 @@ int cmd_imcs     (char *, MsgType, char *); // IMCS
 int cmd_bimcs    (char *, MsgType, char *); // Blue channel IMCS control
 int cmd_rimcs    (char *, MsgType, char *); // Red channel IMCS control
 int cmd_misc     (char *, MsgType, char *); // miscellaneous functions (util, llb, calmode, obsmode, estatus)
+int cmd_config   (char *, MsgType, char *); // set up several mechanisms at once
 
 // Application command/action structure
 
@@ -191,6 +193,7 @@ cmdtab[] = {   //!< global scope command table for this application
   {"obsmode",  cmd_misc,     "obsmode","Observing mode"},
   {"estatus",  cmd_misc,     "estatus ","Query instrument environmental sensor status"},
   {"heb",      cmd_misc,     "heb","heb [status] [archon igpower [on|off]] [temps]"},
+  {"config",   cmd_config,   "config mech=value [mech=value ...]","Set up several mechanisms at once, independent moves run concurrently"},
   {"?",        cmd_help,"",""}  // "" excludes from help
 };
 
@@ -44,6 +44,8 @@
 #define BAD_VALUE "BAD_VALUE"
 
 #define MAX_ML     40        // maximum number of microlynx controllers
+#define MECH_HASHSIZE 128    // mechanism name hash index slots (power of 2, see mechindex.c)
+#define WAGO_HASHSIZE 16     // WAGO name hash index slots (power of 2)
 #define MAX_MOTORS 40        // maximum number of motors in a mods
 #define MAX_DIST   2
 #define MAX_USER_DEV  40
@@ -0,0 +1,209 @@
+/** \file mmcSession.c
+ * \brief Persistent, pipelined command sessions with the MODS
+ * MicroLynx Controller Service (mmcService).
+ *
+ * Contents:
+ *   mmcOpenSession()  - open a session connection to the mmcServer
+ *   mmcSessionSend()  - send a command without waiting for its reply
+ *   mmcSessionRecv()  - read the reply to the oldest unanswered command
+ *   mmcSessionCmd()   - send a command and wait for its reply
+ *   mmcCloseSession() - close a session connection
+ *
+ * The one-shot clients (mmcu(), utilities(), etc.) open a new TCP
+ * connection for every command.  A session opens one connection with
+ * the "session" command and keeps it, so scripts sending hundreds of
+ * commands do not pay for a connect and teardown on each one.
+ * Commands are sent newline-terminated and each reply comes back
+ * NUL-terminated, in the order the commands were sent, so a caller can
+ * send a batch of commands with mmcSessionSend() and then collect the
+ * replies with mmcSessionRecv().  Up to MMC_MAXSESSIONS sessions may
+ * be open at once in a program.
+ *
+ * Date:
+ *   2026 October 17
+ *
+ * Modification History:
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "islapi.h"         // API for service communication
+#include "mmccontrol.h"     // Mechanism command functions
+
+#define BUFFSIZE		512
+#define MMC_MAXSESSIONS		8     // sessions open at once
+#define MMC_SESSBUFSIZE		4096  // reply read-ahead buffer
+
+/*
+ * Read-ahead buffers.  A read may return more than one reply, so the
+ * rest is kept for the next mmcSessionRecv() on the connection.
+ */
+
+static struct mmc_session {
+  int  conn;                   // connection, 0 if the entry is free
+  int  len;                    // bytes in buf
+  char buf[MMC_SESSBUFSIZE];   // received, not yet returned
+} sessTab[MMC_MAXSESSIONS];
+
+static struct mmc_session *
+findSession(int conn)
+{
+  int i;
+
+  for (i=0; i<MMC_MAXSESSIONS; i++)
+    if (sessTab[i].conn == conn && conn > 0) return &sessTab[i];
+  return NULL;
+}
+
+/** Open a persistent session with the mmcServer
+ * @param host: the host that mmcService(s) reside
+ * @param port: port assignment to the mmcService
+ * @return the session connection, or -1 on errors
+ */
+
+int mmcOpenSession(char *host, char *port)
+{
+  islcomp comp;             // place holder for host
+  islnum app;               // place holder for port
+  islconn conn;             // place holder connections
+  struct mmc_session *sp;
+  char reply[BUFFSIZE];
+  int i;
+
+  comp = islCnameToComp(host); // convert host argument to binary format
+  app = (islnum) atoi(port);   // convert port argument to binary format
+
+  if (comp == -1) {
+    (void) fprintf(stderr, "<HOST %s> not available\n", host);
+    return -1;
+  }
+
+  if (app == -1) {
+    (void) fprintf(stderr, "<PORT %s> not available\n", port);
+    return -1;
+  }
+
+  for (i=0; i<MMC_MAXSESSIONS && sessTab[i].conn>0; i++);
+  if (i == MMC_MAXSESSIONS) {
+    (void) fprintf(stderr, "too many mmcServer sessions open\n");
+    return -1;
+  }
+
+  conn = islMakeContact(comp, app); // form a connection with mmcService
+  if (conn < 0) {
+    (void) fprintf(stderr, "connection to <HOST %s> failed\n", host);
+    return -1;
+  }
+  sp = &sessTab[i];
+  sp->conn = conn;
+  sp->len = 0;
+
+  // Older mmcServers run "session" as an unknown command and close
+
+  if (mmcSessionCmd(conn, (char*)"session", reply, sizeof(reply)) < 0 ||
+      strcmp(reply, "DONE: SESSION") != 0) {
+    (void) fprintf(stderr, "<HOST %s> mmcServer does not support sessions\n", host);
+    mmcCloseSession(conn);
+    return -1;
+  }
+  return conn;
+}
+
+/** Send a command on a session without waiting for its reply
+ * @param conn: session connection from mmcOpenSession()
+ * @param command: command string, without a terminator
+ * @return 0 if sent, -1 on errors
+ */
+
+int mmcSessionSend(int conn, char command[])
+{
+  char send_buff[BUFFSIZE]; // send message buffer
+  int len;
+  int n;
+
+  if (findSession(conn) == NULL) return -1;
+
+  len = snprintf(send_buff, sizeof(send_buff), "%s\n", command);
+  if (len >= (int)sizeof(send_buff)) return -1;
+
+  while (len > 0) {
+    n = send(conn, &send_buff[strlen(send_buff)-len], len, 0);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    }
+    len -= n;
+  }
+  return 0;
+}
+
+/** Read the reply to the oldest command sent on a session
+ * @param conn: session connection from mmcOpenSession()
+ * @param reply: reply string, truncated to maxlen-1 characters
+ * @param maxlen: size of reply
+ * @return 0 if the reply was received, -1 if the connection failed
+ */
+
+int mmcSessionRecv(int conn, char reply[], int maxlen)
+{
+  struct mmc_session *sp;
+  char *end;
+  int len;
+  int n;
+
+  if ((sp = findSession(conn)) == NULL) return -1;
+
+  while ((end = (char *)memchr(sp->buf, '\0', sp->len)) == NULL) {
+    if (sp->len == MMC_SESSBUFSIZE) { // reply too long, return what we have
+      end = &sp->buf[sp->len-1];
+      break;
+    }
+    n = recv(conn, &sp->buf[sp->len], MMC_SESSBUFSIZE-sp->len, 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return -1;
+    sp->len += n;
+  }
+
+  len = end - sp->buf;
+  if (len > maxlen-1) len = maxlen-1;
+  memcpy(reply, sp->buf, len);
+  reply[len] = '\0';
+
+  len = end - sp->buf + 1;
+  sp->len -= len;
+  memmove(sp->buf, &sp->buf[len], sp->len);
+  return 0;
+}
+
+/** Send a command on a session and wait for its reply
+ * @param conn: session connection from mmcOpenSession()
+ * @param command: command string
+ * @param reply: reply string
+ * @param maxlen: size of reply
+ * @return 0 if the reply was received, -1 on errors
+ */
+
+int mmcSessionCmd(int conn, char command[], char reply[], int maxlen)
+{
+  if (mmcSessionSend(conn, command) < 0) return -1;
+  return mmcSessionRecv(conn, reply, maxlen);
+}
+
+/** Close a session with the mmcServer
+ * @param conn: session connection from mmcOpenSession()
+ */
+
+void mmcCloseSession(int conn)
+{
+  struct mmc_session *sp;
+
+  if ((sp = findSession(conn)) == NULL) return;
+  (void) islSendEOF(conn);
+  sp->conn = 0;
+  sp->len = 0;
+}
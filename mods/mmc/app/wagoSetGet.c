@@ -1,13 +1,186 @@
 // Platform header
 
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <time.h>
+#include <pthread.h>
 
 // libmodbus include file
 
 #include <modbus.h>
 
+//---------------------------------------------------------------------------
+//
+// WAGO connection pool
+//
+// wagoSetGet() keeps one Modbus/TCP connection open per WAGO host and
+// reuses it, instead of connecting, sleeping 60 ms, and closing for
+// every register access.  Each pool entry has its own mutex, so a WAGO
+// sees one transaction at a time from this process while different
+// WAGOs are used concurrently.  A failed transaction closes the entry's
+// connection and is retried once on a fresh one, which covers a WAGO
+// that dropped an idle connection.  After a failed connect the host is
+// not tried again until a backoff (WAGO_BACKOFFMS, doubling up to
+// WAGO_MAXBACKOFFMS) has passed, so a powered-off WAGO costs callers an
+// immediate error rather than a connect timeout each time.
+//
+
+#define WAGO_MAXPOOL       16    // WAGO hosts with pooled connections
+#define WAGO_BACKOFFMS     100   // first reconnect backoff, msec
+#define WAGO_MAXBACKOFFMS  5000  // longest reconnect backoff, msec
+
+static struct wago_conn {
+  char host[64];            // WAGO IP address, "" if the entry is free
+  modbus_t *modbus;         // open connection, NULL if none
+  int fails;                // connect failures in a row
+  long retryAt;             // no connect attempts before this, msec
+  pthread_mutex_t lock;     // one transaction at a time per WAGO
+} wagoPool[WAGO_MAXPOOL];
+
+static pthread_mutex_t wagoPoolLock = PTHREAD_MUTEX_INITIALIZER;
+
+static long
+wagoMSec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return (long)ts.tv_sec*1000L + ts.tv_nsec/1000000L;
+}
+
+// Find or add the pool entry for a WAGO host, NULL if the pool is full
+
+static struct wago_conn *
+wagoFind(char *host)
+{
+  struct wago_conn *wc = NULL;
+  int i;
+
+  pthread_mutex_lock(&wagoPoolLock);
+  for (i=0; i<WAGO_MAXPOOL && wagoPool[i].host[0]; i++)
+    if (!strcmp(wagoPool[i].host,host)) {
+      wc = &wagoPool[i];
+      break;
+    }
+  if (wc == NULL && i < WAGO_MAXPOOL && strlen(host) < sizeof(wagoPool[i].host)) {
+    wc = &wagoPool[i];
+    pthread_mutex_init(&wc->lock,NULL);
+    wc->modbus = NULL;
+    wc->fails = 0;
+    wc->retryAt = 0;
+    strcpy(wc->host,host);
+  }
+  pthread_mutex_unlock(&wagoPoolLock);
+  return wc;
+}
+
+// Open a Modbus/TCP connection to the WAGO, NULL on errors
+
+static modbus_t *
+wagoConnect(char *host)
+{
+  modbus_t* modbus;
+
+  modbus = modbus_new_tcp(host,502);
+  if (modbus == NULL) return NULL;
+
+  usleep(50000); // allow open to finish before connect
+
+  // Connect to the WAGO.  Allow one retry before exiting with an error
+
+  if (modbus_connect(modbus) == -1) {
+    usleep(50000); // wait a beat before retrying
+    if (modbus_connect(modbus) == -1) {
+      // printf("ERROR: Cannot connect to WAGO host %s: %s\n",host,modbus_strerror(errno));
+      modbus_free(modbus);
+      return NULL;
+    }
+  }
+
+  // Short pause to give a slow TCP link a chance to catch up
+
+  usleep(10000);
+
+  return modbus;
+}
+
+// Close an entry's connection
+
+static void
+wagoDrop(struct wago_conn *wc)
+{
+  if (wc->modbus == NULL) return;
+  modbus_close(wc->modbus);
+  modbus_free(wc->modbus);
+  wc->modbus = NULL;
+}
+
+// Make sure an entry has an open connection, honoring the backoff.
+// Returns 0 if connected, -1 if not.
+
+static int
+wagoOpen(struct wago_conn *wc)
+{
+  long backoff;
+
+  if (wc->modbus != NULL) return 0;
+  if (wc->fails > 0 && wagoMSec() < wc->retryAt) {
+    errno = ECONNREFUSED;
+    return -1;
+  }
+
+  if ((wc->modbus = wagoConnect(wc->host)) == NULL) {
+    backoff = WAGO_BACKOFFMS << (wc->fails < 6 ? wc->fails : 6);
+    if (backoff > WAGO_MAXBACKOFFMS) backoff = WAGO_MAXBACKOFFMS;
+    wc->retryAt = wagoMSec() + backoff;
+    wc->fails++;
+    return -1;
+  }
+  wc->fails = 0;
+  return 0;
+}
+
+// One register transaction on an open connection
+
+static int
+wagoXfer(modbus_t* modbus, int gs, int slaveAddr, int startRef, short regArr[], int refCnt)
+{
+  uint16_t data[refCnt];
+  int result = 0;
+
+  // Set the slave device
+
+  if (modbus_set_slave(modbus,slaveAddr) == -1) {
+    // printf("ERROR: Slave address %d is invalid: %s\n",slaveAddr,modbus_strerror(errno));
+    return -1;
+  }
+
+  // If setGet = 1 (true), we are writing data to WAGO registers/coils
+
+  if (gs) {
+    // This function takes an array of shorts, but libmodbus requires an array of uint16_t.
+    for(int i=0; i<refCnt; i++) data[i] = static_cast<uint16_t>(regArr[i]);
+
+    // Write 'data' to the registers.
+    result = modbus_write_registers(modbus,startRef,refCnt,data);
+  }
+
+  // If setGet = 0 (false), we are writing data to WAGO registers/coils
+
+  else {
+    // Read the 'data' from the regsiters.
+    result = modbus_read_registers(modbus,startRef,refCnt,data);
+
+    // This function fills an array of shorts, but libmodbus provides an array of uint16_t.
+    if (result >= 0)
+      for(int i=0; i<refCnt; i++) regArr[i] = static_cast<short>(data[i]);
+  }
+
+  return result;
+}
+
 //---------------------------------------------------------------------------
 //
 // wagoSetGet function
@@ -24,10 +197,10 @@
 // @param startRef  Start reference (Range: 1 - 0x10000)
 // @param regArr    Buffer with the data to be sent
 // @param refCnt    Number of references to be written (Range: 1-100)
-// 
+//
 // @return          0 on send success, value or error code on faults
 //
-// This version rewritten for libmodbus to replace defunct and unsupported FieldTalk 
+// This version rewritten for libmodbus to replace defunct and unsupported FieldTalk
 // code [xc/osu - Jun 2025].
 //
 // Updates:
@@ -39,74 +212,54 @@
 //                 gets a fault (usually "Operation now in progress")
 //   2026 Feb 20 - [op] now in progress errors now just noise, not diagnostic
 //                 throttling error messages as we're past port debugging [rwp/osu]
+//   2026 Oct 17 - connections are pooled, one per WAGO host, and reused;
+//                 the connect pauses are paid only on (re)connect
 //
 //---------------------------------------------------------------------------
 
 int
 wagoSetGet(int gs, char* host, int slaveAddr, int startRef, short regArr[], int refCnt)
 {
+  struct wago_conn *wc;
   modbus_t* modbus;
-  uint16_t data[refCnt];
   int result = 0;
-  int ierr = 0;
-
-  // Open a Modbus/TCP connection to the WAGO
-
-  modbus = modbus_new_tcp(host,502);
-
-  usleep(50000); // allow open to finish before connect
-
-  // Connect to the WAGO.  Allow one retry before exiting with an error
-  
-  if (modbus_connect(modbus) == -1) {
-    usleep(50000); // wait a beat before retrying
-    ierr = modbus_connect(modbus);
-    if (ierr < 0) {
-      // printf("ERROR: Cannot connect to WAGO host %s: %s\n",host,modbus_strerror(errno));
-      modbus_free(modbus);
-      return -1;
-    }
-  }
-
-  // Short pause to give a slow TCP link a chance to catch up
-
-  usleep(10000);
 
-  // Set the slave device
+  // Pool full: fall back to a connection for just this transaction
 
-  if (modbus_set_slave(modbus,slaveAddr) == -1) {
-    // printf("ERROR: Slave address %d is invalid: %s\n",slaveAddr,modbus_strerror(errno));
+  if ((wc = wagoFind(host)) == NULL) {
+    if ((modbus = wagoConnect(host)) == NULL) return -1;
+    result = wagoXfer(modbus,gs,slaveAddr,startRef,regArr,refCnt);
     modbus_close(modbus);
     modbus_free(modbus);
-    return -1;
+    return result;
   }
 
-  // If setGet = 1 (true), we are writing data to WAGO registers/coils
-  
-  if (gs) {
-    // This function takes an array of shorts, but libmodbus requires an array of uint16_t.
-    for(int i=0; i<refCnt; i++) data[i] = static_cast<uint16_t>(regArr[i]);
-    
-    // Write 'data' to the registers.
-    result = modbus_write_registers(modbus,startRef,refCnt,data);
+  pthread_mutex_lock(&wc->lock);
+
+  if (wagoOpen(wc) < 0) {
+    pthread_mutex_unlock(&wc->lock);
+    return -1;
   }
-  
-  // If setGet = 0 (false), we are writing data to WAGO registers/coils
 
-  else {
-    // Read the 'data' from the regsiters.
-    result = modbus_read_registers(modbus,startRef,refCnt,data);
+  // A Modbus exception reply means the connection is fine and the
+  // request was refused.  Anything else may be a dead connection (e.g.,
+  // the WAGO closed it while idle), so reconnect and try once more.
 
-    // This function fills an array of shorts, but libmodbus provides an array of uint16_t.
-    for(int i=0; i<refCnt; i++) regArr[i] = static_cast<short>(data[i]);
+  result = wagoXfer(wc->modbus,gs,slaveAddr,startRef,regArr,refCnt);
+  if (result == -1 && !(errno >= EMBXILFUN && errno <= EMBXGTAR)) {
+    wagoDrop(wc);
+    if (wagoOpen(wc) == 0) {
+      result = wagoXfer(wc->modbus,gs,slaveAddr,startRef,regArr,refCnt);
+      if (result == -1 && !(errno >= EMBXILFUN && errno <= EMBXGTAR))
+	wagoDrop(wc);
+    }
+    else
+      result = -1;
   }
 
-  // close connection and free libmodbus context
-  
-  modbus_close(modbus);
-  modbus_free(modbus);
+  pthread_mutex_unlock(&wc->lock);
 
   // Return status: 0 on success, -1 on errors with errno set by modbus_xxx_registers()
-  
+
   return result;
 }
@@ -27,6 +27,20 @@ extern "C" {
  */
   int mmcu(char *host,char *port, char *who, char command[]);
 
+/** Persistent, pipelined mmcServer sessions (see mmcSession.c)
+ * @param host: the host that mmcService(s) reside
+ * @param port: Port assigned to the mmcService
+ * @param conn: session connection returned by mmcOpenSession()
+ * @param command: command to send
+ * @param reply: reply message, at most maxlen-1 characters
+ * @return the connection (mmcOpenSession) or 0, -1 on errors
+ */
+  int mmcOpenSession(char *host, char *port);
+  int mmcSessionSend(int conn, char command[]);
+  int mmcSessionRecv(int conn, char reply[], int maxlen);
+  int mmcSessionCmd(int conn, char command[], char reply[], int maxlen);
+  void mmcCloseSession(int conn);
+
 /** All purpose MODS calibration tower client
  * @param host: the host that mmcService(s) reside
  * @param port: port assignment to the mmcService
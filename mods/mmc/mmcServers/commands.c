@@ -54,6 +54,13 @@
   \date 2025 Aug 08 - many changes after live tests with MODS1 at LBT (off telescope) [rwp/osu]
   \date 2025 Oct 04 - bug fixes during live testing of MODS1 and MODS2 on-telescope [rwp/osu]
   \date 2025 Oct 31 - removed NOCOMM placeholders where int or float expected [rwp/osu]
+  \date 2026 Oct 17 - per-mechanism command queues (runAction()), per-command globals thread-local
+  \date 2026 Oct 17 - mechanism query paths send their MicroLynx commands as one batch (mlcPrefetch())
+  \date 2026 Oct 17 - background MicroLynx state poller (statePoller()), linear mechanism queries answer from its cache
+  \date 2026 Oct 17 - WAGO register reads and writes go through the register mirror (wagoMirror())
+  \date 2026 Oct 17 - hashed command lookup (cmdLookup()), command queue lists resolved once at startup
+  \date 2026 Oct 17 - status replies built with the bounded reply builder (replyAppend() etc.)
+  \date 2026 Oct 17 - new CONFIG command sets up several mechanisms concurrently (cmd_config())
 */
 
 #include <iostream>
@@ -64,6 +71,7 @@
 #include <sys/wait.h>
 #include <time.h>
 #include <errno.h>   // system error code
+#include <pthread.h> // per-mechanism command queues
 
 using namespace std;
 
@@ -86,7 +94,9 @@ using namespace std;
 int
 wagoSetGet(int gs, char *host, int slaveAddr, int startRef, short regArr[], int refCnt);
 
-short devOnOff[1];
+static int cmdLookup(char *);  // command table lookup (see cmdIndexBuild())
+
+__thread short devOnOff[1];
 
 int itoa(int ,char []);
 
@@ -112,8 +122,11 @@ int itoa(int ,char []);
 
 #define MAXPGMLINE 80 
 
-char argbuf[MAXPGMLINE]; // Generic argument buffer
-int commandID;           // Keeps the command id that identifies the mechanism
+// Per-command working storage is thread-local, the mmcServer workers
+// run commands concurrently (see runAction())
+
+__thread char argbuf[MAXPGMLINE]; // Generic argument buffer
+__thread int commandID;           // Keeps the command id that identifies the mechanism
  
 void StrUpper(char *);
 int logLampParam(char *, int [], int[]);
@@ -132,7 +145,7 @@ static char *util_names[7] =
 
 static short int lamp_codes[9] = {1,2,4,8,16,32,1024,2048,4096}; // lamp codes
 
-char who_srcID[MAXPGMLINE];    // Generic input buffer
+__thread char who_srcID[MAXPGMLINE];    // Generic input buffer
 
 #include "./mlc.c"         // local 'C' functions
 
@@ -145,9 +158,8 @@ int  ieb2ID; // Blue Instrument Electronics Box (ieb 2)
 int  rhebID; // Red Head Electronics Box
 int  bhebID; // Blue Head Electronics Box
 
-int ierr;                  // Error indicator
-int he_token=1;            // Head Electronic is ENABLED/DISABLED
-char inbuf[MAXPGMLINE];    // Generic input buffer
+__thread int ierr;         // Error indicator
+int heDisabled[MAX_ML];    // Head Electronics trigger DISABLED, per shutter
 FILE *pgmFP;               // Program file pointer
 
 /* ---------------------------------------------------------------------------
@@ -535,16 +547,10 @@ cmd_help(char *args, MsgType msgtype, char *reply)
    
   } else if (strlen(args)>0) {  // we are being asked for help on a specific command
     found = 0;
-    for (i=0; i<NumCommands; i++) {
-      if (strcasecmp(cmdtab[i].cmd,argbuf)==0) {
-	found++;
-	icmd = i;
-	break;
-      }
-    }
+    if ((icmd=cmdLookup(argbuf)) >= 0) found++;
     if (found > 0) {
      //sprintf(reply,"HELP HELP=%s  Usage:%s\n",cmdtab[i].cmd,cmdtab[i].usage);
-      sprintf(reply,"HELP HELP=%s  Usage: %s",makeUpper(cmdtab[i].cmd),cmdtab[i].usage);
+      sprintf(reply,"HELP HELP=%s  Usage: %s",makeUpper(cmdtab[icmd].cmd),cmdtab[icmd].usage);
     }
 
     if(found==0) {
@@ -580,12 +586,13 @@ cmd_help(char *args, MsgType msgtype, char *reply)
 int
 cmd_mstatus(char *args, MsgType msgtype, char *reply)
 {
+  static char *query[] = {"PRINT POS","PRINT IO 20,\" EXTENED=\",IO 30"};
   int device;
   int len;
   char who_selected[24];
   char dummy[PAGE_SIZE];
   char cmd_selected[24];
-  char EncBits[24];
+  replybuf_t rb;
 
 
   if(strlen(args)<=0) {
@@ -607,18 +614,19 @@ cmd_mstatus(char *args, MsgType msgtype, char *reply)
     return CMD_ERR;
   }
 
+  mlcPrefetch(device,query,2); // send the status reads as one batch
+
   // clear out the reply buffer, then build it up piece-by-piece
 
-  memset(reply,0,sizeof(reply));
+  replyInit(&rb,reply,MMC_REPLYSIZE);
   rawCommand(device,"PRINT POS",dummy);
   shm_addr->MODS.pos[device]=atof(dummy);
+  replyAppend(&rb,"%s %s POS %0.3f",who_selected,shm_addr->MODS.who[device],
+	      shm_addr->MODS.pos[device]);
 
   rawCommand(device,"PRINT IO 20,\" EXTENED=\",IO 30",dummy);
-  sprintf(EncBits,"%s",dummy);
-  sprintf(reply,"%s %s POS %0.3f ENCBITS %s IP:PORT %s MLID ml%d", 
-	  who_selected,shm_addr->MODS.who[device],
-	  shm_addr->MODS.pos[device],EncBits,
-	  shm_addr->MODS.commport[device].Port,device+1);
+  replyAppend(&rb," ENCBITS %s",dummy);
+  replyAppend(&rb," IP:PORT %s MLID ml%d",shm_addr->MODS.commport[device].Port,device+1);
 
   return CMD_OK;
 }
@@ -671,6 +679,10 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
   char msg[PAGE_SIZE];
   char ttfKeeper[PAGE_SIZE];
   char cmd_instruction[PAGE_SIZE];
+  replybuf_t rb;     // the reply
+  replybuf_t ttf;    // channel mechanisms, goes after the IR laser status
+  replybuf_t lamps;  // lamps that are on
+  static const char *lampNames[9] = {"AR","XE","NE","HG","KR","QTH6V","QTH1","QTH2","VFLAT"};
 
   short pressureTemps[10];
   float glycolSupplyPressure;
@@ -696,6 +708,7 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
   int ierr;
   int icnter;
   int retuneMODS;
+  int i;
   float ttffoc;
   float ttfa;
   float ttfb;
@@ -752,6 +765,8 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
   sprintf(Port,"%d",shm_addr->MODS.modsPorts[2]);
 
   // Red and Blue channel Instrument Electronics Boxes (IEBs)
+
+  replyInit(&ttf,ttfKeeper,sizeof(ttfKeeper));
   
   if(!strcasecmp(cmd_instruction,"BLUE") || !strcasecmp(cmd_instruction,"RED") || 
      !strcasecmp(cmd_instruction,"R") || !strcasecmp(cmd_instruction,"B")) {
@@ -760,42 +775,42 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
       device1=getMechanismID("bcolttfa",dummy); // TTFA
       device2=getMechanismID("bcolttfb",dummy); // TTFB
       device3=getMechanismID("bcolttfc",dummy); // TTFC
-      sprintf(ttfKeeper,"CHANNEL=BLUE");
+      replyAppend(&ttf,"CHANNEL=BLUE");
 
     } else if(!strcasecmp(cmd_instruction,"RED") || !strcasecmp(cmd_instruction,"R")) {
       device1=getMechanismID("rcolttfa",dummy); // TTFA
       device2=getMechanismID("rcolttfb",dummy); // TTFB
       device3=getMechanismID("rcolttfc",dummy); // TTFC
-      sprintf(ttfKeeper,"CHANNEL=RED");
+      replyAppend(&ttf,"CHANNEL=RED");
 
     }
     
     if(!shm_addr->MODS.host[device1]) {
       ttfa=0.0;
-      sprintf(ttfKeeper,"%s COLTTFA=-1",ttfKeeper);
+      replyKey(&ttf,"COLTTFA","-1");
     } else {
       ttfa=shm_addr->MODS.pos[device1]*shm_addr->MODS.convf[device1];
-      sprintf(ttfKeeper,"%s COLTTFA=%0.0f",ttfKeeper,ttfa);
+      replyFloat(&ttf,"COLTTFA",ttfa,0);
     }
 
     if(!shm_addr->MODS.host[device2]) {
       ttfb=0.0;
-      sprintf(ttfKeeper,"%s COLTTFB=-1",ttfKeeper);
+      replyKey(&ttf,"COLTTFB","-1");
     }  else {
       ttfb=shm_addr->MODS.pos[device2]*shm_addr->MODS.convf[device2];
-      sprintf(ttfKeeper,"%s COLTTFB=%0.0f",ttfKeeper,ttfb);
+      replyFloat(&ttf,"COLTTFB",ttfb,0);
     }
 
     if(!shm_addr->MODS.host[device3]) {
       ttfc=0.0;
-      sprintf(ttfKeeper,"%s COLTTFC=-1",ttfKeeper);
+      replyKey(&ttf,"COLTTFC","-1");
     } else {
       ttfc=shm_addr->MODS.pos[device3]*shm_addr->MODS.convf[device3];
-      sprintf(ttfKeeper,"%s COLTTFC=%0.0f",ttfKeeper,ttfc);
+      replyFloat(&ttf,"COLTTFC",ttfc,0);
     }
 
     ttffoc = (ttfa+ttfb+ttfc)/3.0;
-    sprintf(ttfKeeper,"%s COLFOCUS=%0.0f",ttfKeeper,ttffoc);
+    replyFloat(&ttf,"COLFOCUS",ttffoc,0);
     
     if(!strncasecmp(cmd_instruction,"R",1)) 
       device=getMechanismID("rgrating",dummy);
@@ -803,9 +818,9 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
       device=getMechanismID("bgrating",dummy);
 
     if(!shm_addr->MODS.host[device])
-      sprintf(ttfKeeper,"%s GRATING=0 GRATNAME='None' GRATINFO='None'",ttfKeeper);
+      replyAppend(&ttf," GRATING=0 GRATNAME='None' GRATINFO='None'");
     else
-      sprintf(ttfKeeper,"%s GRATING=%d GRATNAME='%s' GRATINFO='%s'",ttfKeeper,
+      replyAppend(&ttf," GRATING=%d GRATNAME='%s' GRATINFO='%s'",
 	      atoi(shm_addr->MODS.state_word[device]),
 	      (!strcasecmp(cmd_instruction,"RED") || !strcasecmp(cmd_instruction,"R")) ? \
 	      shm_addr->MODS.rgrating[atoi(shm_addr->MODS.state_word[device])] :\
@@ -820,43 +835,40 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
       device=getMechanismID("bgrtilt1",dummy);
 
     if(!shm_addr->MODS.host[device])
-      sprintf(ttfKeeper,"%s GRATTILT=-1",ttfKeeper);
+      replyKey(&ttf,"GRATTILT","-1");
     else
-      sprintf(ttfKeeper,"%s GRATTILT=%d",ttfKeeper,
-	      (int)(shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device]));
+      replyKey(&ttf,"GRATTILT","%d",
+	       (int)(shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device]));
     
     if(!strncasecmp(cmd_instruction,"R",1)) 
       device=getMechanismID("rcamfoc",dummy);
     else device=getMechanismID("bcamfoc",dummy);
 
     if(!shm_addr->MODS.host[device])
-      sprintf(ttfKeeper,"%s CAMFOCUS=-1",ttfKeeper);
+      replyKey(&ttf,"CAMFOCUS","-1");
     else
-      sprintf(ttfKeeper,"%s CAMFOCUS=%0.0f",ttfKeeper,
-	      shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device]);
+      replyFloat(&ttf,"CAMFOCUS",
+		 shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device],0);
 
     if(!strncasecmp(cmd_instruction,"R",1)) 
       device=getMechanismID("rfilter",dummy);
     else device=getMechanismID("bfilter",dummy);
 
     if(!shm_addr->MODS.host[device]) {
-      sprintf(ttfKeeper,"%s FILTER=-1 FILTNAME='Unknown' FILTINFO='Unknown'",
-	      ttfKeeper);
+      replyAppend(&ttf," FILTER=-1 FILTNAME='Unknown' FILTINFO='Unknown'");
     } else {
       if(shm_addr->MODS.pos[device]<=0) {
-	sprintf(ttfKeeper,"%s FILTER=-1 FILTNAME='Unknown' FILTINFO='Unknown'",
-		ttfKeeper);
+	replyAppend(&ttf," FILTER=-1 FILTNAME='Unknown' FILTINFO='Unknown'");
 
       } else {
-	sprintf(ttfKeeper,"%s FILTER=%0.0f",ttfKeeper,
-		shm_addr->MODS.pos[device]);
+	replyFloat(&ttf,"FILTER",shm_addr->MODS.pos[device],0);
 	ierr=shm_addr->MODS.pos[device];
 	if(!strncasecmp(cmd_instruction,"R",1)) 
-	  sprintf(ttfKeeper,"%s FILTNAME='%s' FILTINFO='%s'",ttfKeeper,
-		  shm_addr->MODS.rcamfilters[ierr],shm_addr->MODS.rcamfiltInfo[ierr]);
+	  replyAppend(&ttf," FILTNAME='%s' FILTINFO='%s'",
+		      shm_addr->MODS.rcamfilters[ierr],shm_addr->MODS.rcamfiltInfo[ierr]);
 	else
-	  sprintf(ttfKeeper,"%s FILTNAME='%s' FILTINFO='%s'",ttfKeeper,
-		  shm_addr->MODS.bcamfilters[ierr],shm_addr->MODS.bcamfiltInfo[ierr]);
+	  replyAppend(&ttf," FILTNAME='%s' FILTINFO='%s'",
+		      shm_addr->MODS.bcamfilters[ierr],shm_addr->MODS.bcamfiltInfo[ierr]);
       }
     }
   } else {
@@ -866,64 +878,64 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
     device=getMechanismID("bcolttfa",dummy); // TTFA
     if(!shm_addr->MODS.host[device]) {
       ttfa=0.0;
-      sprintf(ttfKeeper,"BCOLTTFA=-1");
+      replyAppend(&ttf,"BCOLTTFA=-1");
     } else {
       ttfa=shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device];
-      sprintf(ttfKeeper,"BCOLTTFA=%0.0f",ttfa);
+      replyAppend(&ttf,"BCOLTTFA=%0.0f",ttfa);
     }
     
     device=getMechanismID("bcolttfb",dummy); // TTFB
     if(!shm_addr->MODS.host[device]) {
       ttfb=0.0;
-      sprintf(ttfKeeper,"%s BCOLTTFB=-1",ttfKeeper);
+      replyKey(&ttf,"BCOLTTFB","-1");
     }  else {
       ttfb=shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device];
-      sprintf(ttfKeeper,"%s BCOLTTFB=%0.0f",ttfKeeper,ttfb);
+      replyFloat(&ttf,"BCOLTTFB",ttfb,0);
     }
     
     device=getMechanismID("bcolttfc",dummy); // TTFC
     if(!shm_addr->MODS.host[device]) {
       ttfc=0.0;
-      sprintf(ttfKeeper,"%s BCOLTTFC=-1",ttfKeeper);
+      replyKey(&ttf,"BCOLTTFC","-1");
     } else {
       ttfc=shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device];
-      sprintf(ttfKeeper,"%s BCOLTTFC=%0.0f",ttfKeeper,ttfc);
+      replyFloat(&ttf,"BCOLTTFC",ttfc,0);
     }
     
     ttffoc = (ttfa+ttfb+ttfc)/3.0;
-    sprintf(ttfKeeper,"%s BCOLFOC=%0.0f",ttfKeeper,ttffoc);
+    replyFloat(&ttf,"BCOLFOC",ttffoc,0);
     
     device=getMechanismID("bgrating",dummy);
     
     if(!shm_addr->MODS.host[device])
-      sprintf(ttfKeeper,"%s BGRATING=0 BGRATID=None",ttfKeeper);
+      replyAppend(&ttf," BGRATING=0 BGRATID=None");
     else
-      sprintf(ttfKeeper,"%s BGRATING=%d BGRATID='%s'",ttfKeeper,
+      replyAppend(&ttf," BGRATING=%d BGRATID='%s'",
 	      atoi(shm_addr->MODS.state_word[device]),
     	      shm_addr->MODS.bgrating[atoi(shm_addr->MODS.state_word[device])]);
 
     device=getMechanismID("bgrtilt1",dummy);
     if(!shm_addr->MODS.host[device])
-      sprintf(ttfKeeper,"%s BGRTILT1=-1",ttfKeeper);
+      replyKey(&ttf,"BGRTILT1","-1");
     else
-      sprintf(ttfKeeper,"%s BGRTILT1=%d",ttfKeeper,
-	      (int)(shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device]));
+      replyKey(&ttf,"BGRTILT1","%d",
+	       (int)(shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device]));
     
     device=getMechanismID("bcamfoc",dummy);
     if(!shm_addr->MODS.host[device])
-      sprintf(ttfKeeper,"%s BCAMFOC=-1",ttfKeeper);
+      replyKey(&ttf,"BCAMFOC","-1");
     else
-      sprintf(ttfKeeper,"%s BCAMFOC=%0.0f",ttfKeeper,
-	      shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device]);
+      replyFloat(&ttf,"BCAMFOC",
+		 shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device],0);
     
     device=getMechanismID("bfilter",dummy);
     if(!shm_addr->MODS.host[device]) {
-      sprintf(ttfKeeper,"%s BFILTER=-1 BFILTID='Unknown'",ttfKeeper);
+      replyAppend(&ttf," BFILTER=-1 BFILTID='Unknown'");
     } else {
       if(shm_addr->MODS.pos[device]<=0) {
-	sprintf(ttfKeeper,"%s BFILTER=-1 BFILTID='Unknown'",ttfKeeper);
+	replyAppend(&ttf," BFILTER=-1 BFILTID='Unknown'");
       } else {
-	sprintf(ttfKeeper,"%s BFILTER=%0.0f BFILTID='%s'",ttfKeeper,
+	replyAppend(&ttf," BFILTER=%0.0f BFILTID='%s'",
 		shm_addr->MODS.pos[device],
 		shm_addr->MODS.bcamfilters[(int)shm_addr->MODS.pos[device]]);
       }
@@ -934,64 +946,64 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
     device=getMechanismID("rcolttfa",dummy); // TTFA
     if(!shm_addr->MODS.host[device]) {
       ttfa=0.0;
-      sprintf(ttfKeeper,"%s RCOLTTFA=-1",ttfKeeper);
+      replyKey(&ttf,"RCOLTTFA","-1");
     } else {
       ttfa=shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device];
-      sprintf(ttfKeeper,"%s RCOLTTFA=%0.0f",ttfKeeper,ttfa);
+      replyFloat(&ttf,"RCOLTTFA",ttfa,0);
     }
     
     device=getMechanismID("rcolttfb",dummy); // TTFB
     if(!shm_addr->MODS.host[device]) {
       ttfb=0.0;
-      sprintf(ttfKeeper,"%s RCOLTTFA=-1",ttfKeeper);
+      replyKey(&ttf,"RCOLTTFA","-1");
     }  else {
       ttfb=shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device];
-      sprintf(ttfKeeper,"%s RCOLTTFB=%0.0f",ttfKeeper,ttfb);
+      replyFloat(&ttf,"RCOLTTFB",ttfb,0);
     }
     
     device=getMechanismID("rcolttfc",dummy); // TTFC
     if(!shm_addr->MODS.host[device]) {
       ttfc=0.0;
-      sprintf(ttfKeeper,"%s RCOLTTFC=-1",ttfKeeper);
+      replyKey(&ttf,"RCOLTTFC","-1");
     } else {
       ttfc=shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device];
-      sprintf(ttfKeeper,"%s RCOLTTFC=%0.0f",ttfKeeper,ttfc);
+      replyFloat(&ttf,"RCOLTTFC",ttfc,0);
     }
     
     ttffoc = (ttfa+ttfb+ttfc)/3.0;
-    sprintf(ttfKeeper,"%s RCOLFOC=%0.0f",ttfKeeper,ttffoc);
+    replyFloat(&ttf,"RCOLFOC",ttffoc,0);
     
     device=getMechanismID("rgrating",dummy);
     
     if(!shm_addr->MODS.host[device])
-      sprintf(ttfKeeper,"%s RGRATING=-1 RGRATID='Unknown'",ttfKeeper);
+      replyAppend(&ttf," RGRATING=-1 RGRATID='Unknown'");
     else 
-      sprintf(ttfKeeper,"%s RGRATING=%d RGRATID='%s'",ttfKeeper,
+      replyAppend(&ttf," RGRATING=%d RGRATID='%s'",
 	      atoi(shm_addr->MODS.state_word[device]),
 	      shm_addr->MODS.rgrating[atoi(shm_addr->MODS.state_word[device])]);
     
     device=getMechanismID("rgrtilt1",dummy);
     if(!shm_addr->MODS.host[device]) 
-      sprintf(ttfKeeper,"%s RGRTILT1=-1",ttfKeeper);
+      replyKey(&ttf,"RGRTILT1","-1");
     else
-      sprintf(ttfKeeper,"%s RGRTILT1=%d",ttfKeeper,
-	      (int)(shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device]));
+      replyKey(&ttf,"RGRTILT1","%d",
+	       (int)(shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device]));
     
     device=getMechanismID("rcamfoc",dummy);
     if(!shm_addr->MODS.host[device])
-      sprintf(ttfKeeper,"%s RCAMFOC=-1",ttfKeeper);
+      replyKey(&ttf,"RCAMFOC","-1");
     else
-      sprintf(ttfKeeper,"%s RCAMFOC=%0.0f",ttfKeeper,
-	      shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device]);
+      replyFloat(&ttf,"RCAMFOC",
+		 shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device],0);
     
     device=getMechanismID("rfilter",dummy);
     if(!shm_addr->MODS.host[device]) {
-      sprintf(ttfKeeper,"%s RFILTER=-1 RFILTID='Unknown'",ttfKeeper);
+      replyAppend(&ttf," RFILTER=-1 RFILTID='Unknown'");
     } else {
       if(shm_addr->MODS.pos[device]<=0) {
-	sprintf(ttfKeeper,"%s RFILTER=-1 RFILTID='Unknown'",ttfKeeper);
+	replyAppend(&ttf," RFILTER=-1 RFILTID='Unknown'");
       } else {
-	sprintf(ttfKeeper,"%s RFILTER=%0.0f RFILTID='%s'",ttfKeeper,
+	replyAppend(&ttf," RFILTER=%0.0f RFILTID='%s'",
 		shm_addr->MODS.pos[device],
 		shm_addr->MODS.rcamfilters[(int)shm_addr->MODS.pos[device]]);
       }
@@ -1004,14 +1016,16 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
   
   device = getMechanismID("hatch",dummy);
   
+  replyInit(&rb,reply,MMC_REPLYSIZE);
+  replyAppend(&rb,"%s",who_selected);
+
   if(!shm_addr->MODS.host[device])
-    sprintf(reply,"%s HATCH=Unknown", who_selected);
+    replyKey(&rb,"HATCH","Unknown");
   else {
     if(strlen(shm_addr->MODS.state_word[device])<=0)
-      sprintf(reply,"%s HATCH=FAULT", who_selected);
+      replyKey(&rb,"HATCH","FAULT");
     else
-      sprintf(reply,"%s HATCH=%s",
-	      who_selected,shm_addr->MODS.state_word[device]);
+      replyKey(&rb,"HATCH","%s",shm_addr->MODS.state_word[device]);
   }
 
   // Calibration tower
@@ -1019,32 +1033,21 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
   device=getMechanismID("calib",dummy);
   
   if(!shm_addr->MODS.host[device])
-    sprintf(reply,"%s CALIB=Unknown", reply, who_selected);
+    replyKey(&rb,"CALIB","Unknown");
   else 
     if(strlen(shm_addr->MODS.state_word[device])<=0)
-      sprintf(reply,"%s CALIB=UNKNOWN",reply);
+      replyKey(&rb,"CALIB","UNKNOWN");
     else
-      sprintf(reply,"%s CALIB=%s",reply,
-	      shm_addr->MODS.state_word[device]);
+      replyKey(&rb,"CALIB","%s",shm_addr->MODS.state_word[device]);
 
   // Calibration Lamps:  AR|XE|NE|HG|KR|QTH6V|QTH1|QTH2|VFLAT
 
-  ierr=0;
-  sprintf(reply,"%s CALLAMPS='",reply);
-  if(shm_addr->MODS.lamps.lamp_state[0]) {sprintf(reply,"%sAR ",reply); ierr++;}
-  if(shm_addr->MODS.lamps.lamp_state[1]) {sprintf(reply,"%sXE ",reply); ierr++;}
-  if(shm_addr->MODS.lamps.lamp_state[2]) {sprintf(reply,"%sNE ",reply); ierr++;}
-  if(shm_addr->MODS.lamps.lamp_state[3]) {sprintf(reply,"%sHG ",reply); ierr++;}
-  if(shm_addr->MODS.lamps.lamp_state[4]) {sprintf(reply,"%sKR ",reply); ierr++;}
-  if(shm_addr->MODS.lamps.lamp_state[5]) {sprintf(reply,"%sQTH6V ",reply); ierr++;}
-  if(shm_addr->MODS.lamps.lamp_state[6]) {sprintf(reply,"%sQTH1 ",reply); ierr++;}
-  if(shm_addr->MODS.lamps.lamp_state[7]) {sprintf(reply,"%sQTH2 ",reply); ierr++;}
-  if(shm_addr->MODS.lamps.lamp_state[8]) {sprintf(reply,"%sVFLAT ",reply); ierr++;}
-
-  if(!ierr)
-    sprintf(reply,"%sNone' VFLAT=%.1f",reply,shm_addr->MODS.vflat_power);
-  else
-    sprintf(reply,"%s' VFLAT=%.1f",reply,shm_addr->MODS.vflat_power);
+  replyInit(&lamps,msg,sizeof(msg));
+  for (i=0; i<9; i++)
+    if(shm_addr->MODS.lamps.lamp_state[i]) replyAppend(&lamps,"%s ",lampNames[i]);
+
+  replyQuoted(&rb,"CALLAMPS",(lamps.len>0 ? msg : "None"));
+  replyFloat(&rb,"VFLAT",shm_addr->MODS.vflat_power,1);
 
   // Slitmask (select and insert/retract)
   
@@ -1052,10 +1055,9 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
   
   if(cmd_instruction[0]=='R' || cmd_instruction[0]=='B') {
     if(!shm_addr->MODS.host[device])
-
-      sprintf(reply,"%s SLITMASK=-1 MASKPOS=Unknown MASKNAME='Unknown' MASKINFO='Unknown'",reply);
+      replyAppend(&rb," SLITMASK=-1 MASKPOS=Unknown MASKNAME='Unknown' MASKINFO='Unknown'");
     else {
-      sprintf(reply,"%s SLITMASK=%d MASKPOS=%s MASKNAME='%s' MASKINFO='%s'",reply,
+      replyAppend(&rb," SLITMASK=%d MASKPOS=%s MASKNAME='%s' MASKINFO='%s'",
 	      shm_addr->MODS.active_smask,
 	      (shm_addr->MODS.active_smask<=0 ?	"UNKNOWN" : shm_addr->MODS.maskpos),
 	      (shm_addr->MODS.active_smask<=0 ?	"UNKNOWN" : shm_addr->MODS.slitmaskName[shm_addr->MODS.active_smask]),
@@ -1063,9 +1065,9 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
     }
   } else {
     if(!shm_addr->MODS.host[device])
-      sprintf(reply,"%s SLITMASK=0 MASKPOS=Unknown",reply);
+      replyAppend(&rb," SLITMASK=0 MASKPOS=Unknown");
     else {
-      sprintf(reply,"%s SLITMASK=%d MASKPOS=%s",reply,
+      replyAppend(&rb," SLITMASK=%d MASKPOS=%s",
 	      shm_addr->MODS.active_smask,
 	      (shm_addr->MODS.active_smask<=0 ?	"UNKNOWN" : shm_addr->MODS.maskpos),
 	      (shm_addr->MODS.active_smask<=0 ?	"UNKNOWN" : shm_addr->MODS.slitmaskName[shm_addr->MODS.active_smask]));
@@ -1075,17 +1077,17 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
   MilliSleep(100);
   memset(get_buff,0,sizeof(get_buff));
   ierr=agwcu("localhost",0,"getxy", get_buff);
-  sprintf(reply,"%s %s",reply, &get_buff[6]);
+  replyAppend(&rb," %s",&get_buff[6]);
 
   MilliSleep(100);
   memset(get_buff,0,sizeof(get_buff));
   ierr=agwcu("localhost",0,"getfilter ",get_buff);
   if(cmd_instruction[0]=='R' || cmd_instruction[0]=='B') {
     agwfiltnum=atoi(&get_buff[14]);
-    sprintf(reply,"%s %s AGWFINFO='%s'", reply, &get_buff[6],
+    replyAppend(&rb," %s AGWFINFO='%s'",&get_buff[6],
   	    shm_addr->MODS.agwfiltInfo[agwfiltnum]);
   } else
-    sprintf(reply,"%s %s", reply, &get_buff[6]);
+    replyAppend(&rb," %s",&get_buff[6]);
 
   // Dichroic beam splitter turret
   
@@ -1093,13 +1095,13 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
 
   if(cmd_instruction[0]=='R' || cmd_instruction[0]=='B') {
     if(!shm_addr->MODS.host[device])
-      sprintf(reply,"%s DICHROIC=0 DICHNAME='Unknown' DICHINFO='Unknown'",reply);
+      replyAppend(&rb," DICHROIC=0 DICHNAME='Unknown' DICHINFO='Unknown'");
     else {
       if(shm_addr->MODS.pos[device] < 1.0 || 
 	 shm_addr->MODS.pos[device] > 3.0)  
-	sprintf(reply,"%s DICHROIC=UNKNOWN DICHNAME='Unknown' DICHINFO='Unknown'",reply);
+	replyAppend(&rb," DICHROIC=UNKNOWN DICHNAME='Unknown' DICHINFO='Unknown'");
       else {
-	sprintf(reply,"%s DICHROIC=%d DICHNAME='%s' DICHINFO='%s'",reply,
+	replyAppend(&rb," DICHROIC=%d DICHNAME='%s' DICHINFO='%s'",
 		int(shm_addr->MODS.pos[device]),
 		shm_addr->MODS.dichroicName[(int)shm_addr->MODS.pos[device]],
 		shm_addr->MODS.dichroicInfo[(int)shm_addr->MODS.pos[device]]);
@@ -1107,23 +1109,23 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
     }
   } else {
     if(!shm_addr->MODS.host[device])
-      sprintf(reply,"%s DICHROIC=-1 DICHNAME=Unknown",reply);
+      replyAppend(&rb," DICHROIC=-1 DICHNAME=Unknown");
     else {
       if(shm_addr->MODS.pos[device] < 1.0 ||shm_addr->MODS.pos[device] > 3.0)
-	sprintf(reply,"%s DICHROIC=UNKNOWN DICHNAME=UNKNOWN",reply);
+	replyAppend(&rb," DICHROIC=UNKNOWN DICHNAME=UNKNOWN");
       else
-	sprintf(reply,"%s DICHROIC=%d DICHNAME='%s'",reply,
+	replyAppend(&rb," DICHROIC=%d DICHNAME='%s'",
 		int(shm_addr->MODS.pos[device]),shm_addr->MODS.dichroicName[device]);
     }
   }
 
   // IMCS IR Laser Status
   
-  ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,devOnOff,1);
+  ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,devOnOff,1);
   if(ierr==-1) {
-    sprintf(reply,"%s IRLASER=OFF",reply);
+    replyKey(&rb,"IRLASER","OFF");
   } else {
-    sprintf(reply,"%s IRLASER=%s IRBEAM=%s IRPSET=%.1f IRPOUT=%.1f IRTSET=%.1f IRTEMP=%.1f",reply,
+    replyAppend(&rb," IRLASER=%s IRBEAM=%s IRPSET=%.1f IRPOUT=%.1f IRTSET=%.1f IRTEMP=%.1f",
 	    (shm_addr->MODS.lasers.irlaser_state==1 ? "ON" : "OFF"),
 	    (shm_addr->MODS.lasers.irbeam_state==1 ? "ENABLED" : "DISABLED"),
 	    shm_addr->MODS.lasers.irlaser_setpoint,
@@ -1132,7 +1134,7 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
 	    shm_addr->MODS.lasers.irlaser_temp);
   }
 
-  sprintf(reply,"%s %s",reply,ttfKeeper);
+  replyAppend(&rb," %s",ttfKeeper);
 
   //--------------------------------------
   //
@@ -1142,14 +1144,14 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
   // IEB temperatures (red and blue)
   
   KeyCommand("ieb r temp", dummy);
-  sprintf(reply,"%s %s",reply,&dummy[11]);
+  replyAppend(&rb," %s",&dummy[11]);
 
   KeyCommand("ieb b temp", dummy);
-  sprintf(reply,"%s %s",reply,&dummy[11]);
+  replyAppend(&rb," %s",&dummy[11]);
 
   // IUB pressure and temperature sensors
   
-  ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[utilID],1,0,pressureTemps,10);
+  ierr = wagoMirrorCached(shm_addr->MODS.WAGOIP[utilID],1,0,pressureTemps,10);
 
   glycolSupplyPressure = (float)pressureTemps[0]/327.64;
   glycolReturnPressure = (float)pressureTemps[1]/327.64;
@@ -1167,40 +1169,42 @@ cmd_istatus(char *args, MsgType msgtype, char *reply)
   shm_addr->MODS.outsideAirTemperature = outsideAirTemperature;
   shm_addr->MODS.agwHeatSinkTemperature = agwHeatSinkTemperature;
   
-  sprintf(reply,"%s GSPRES=%.1f",reply,glycolSupplyPressure);
-  sprintf(reply,"%s GSTEMP=%.1f",reply,glycolSupplyTemperature);
-  sprintf(reply,"%s GRPRES=%.1f",reply, glycolReturnPressure);
-  sprintf(reply,"%s GRTEMP=%.1f",reply,glycolReturnTemperature);
-  sprintf(reply,"%s IUBTAIR=%.1f",reply,utilBoxAirTemperature);
-  sprintf(reply,"%s AMBTEMP=%.1f",reply,outsideAirTemperature);
-  sprintf(reply,"%s AGHSTEMP=%.1f",reply,agwHeatSinkTemperature);
+  replyFloat(&rb,"GSPRES",glycolSupplyPressure,1);
+  replyFloat(&rb,"GSTEMP",glycolSupplyTemperature,1);
+  replyFloat(&rb,"GRPRES",glycolReturnPressure,1);
+  replyFloat(&rb,"GRTEMP",glycolReturnTemperature,1);
+  replyFloat(&rb,"IUBTAIR",utilBoxAirTemperature,1);
+  replyFloat(&rb,"AMBTEMP",outsideAirTemperature,1);
+  replyFloat(&rb,"AGHSTEMP",agwHeatSinkTemperature,1);
 
   // WAGO HEB temperature sensors are on WAGO register addr 5 (4-channel RTD)
 
   // Red HEB
   
-  ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[rhebID],1,4,hebTemps,2);
+  ierr = wagoMirrorCached(shm_addr->MODS.WAGOIP[rhebID],1,4,hebTemps,2);
   
   redHEBTemperature = ptRTD2C(hebTemps[0]);
   redDewarTemperature = ptRTD2C(hebTemps[1]);
   shm_addr->MODS.redHEBTemperature = redHEBTemperature;
   shm_addr->MODS.redDewarTemperature = redDewarTemperature;
 
-  sprintf(reply,"%s RHEBTEMP=%.1f",reply,redHEBTemperature);
-  sprintf(reply,"%s RDEWTEMP=%.1f",reply,redDewarTemperature);
+  replyFloat(&rb,"RHEBTEMP",redHEBTemperature,1);
+  replyFloat(&rb,"RDEWTEMP",redDewarTemperature,1);
 
   // Blue HEB
   
-  ierr=wagoSetGet(0,shm_addr->MODS.WAGOIP[bhebID],1,4,hebTemps,2);
+  ierr=wagoMirrorCached(shm_addr->MODS.WAGOIP[bhebID],1,4,hebTemps,2);
   
   blueHEBTemperature = ptRTD2C(hebTemps[0]);
   blueDewarTemperature = ptRTD2C(hebTemps[1]);
   shm_addr->MODS.blueHEBTemperature = blueHEBTemperature;
   shm_addr->MODS.blueDewarTemperature = blueDewarTemperature;
 
-  sprintf(reply,"%s BHEBTEMP=%.1f",reply,blueHEBTemperature);
-  sprintf(reply,"%s BDEWTEMP=%.1f",reply,blueDewarTemperature);
+  replyFloat(&rb,"BHEBTEMP",blueHEBTemperature,1);
+  replyFloat(&rb,"BDEWTEMP",blueDewarTemperature,1);
 
+  if (rb.overflow || ttf.overflow)
+    mmcLOGGER(shm_addr->MODS.LLOG,(char*)"ISTATUS reply too long, truncated");
   
   return CMD_OK;
 }
@@ -1236,64 +1240,63 @@ cmd_pstatus(char *args, MsgType msgtype, char *reply)
 {
   char who_selected[24];
   char dummy[PAGE_SIZE];
+  replybuf_t rb;
 
   strcpy(who_selected,cmdtab[commandID].cmd);
   StrUpper(who_selected);
 
+  replyInit(&rb,reply,MMC_REPLYSIZE);
+
   /* IEB 1 */
   ierr=wagoRW(1,"IEBS",0,0,dummy);             // IEB power
-  sprintf(reply,"%s %s",who_selected,dummy);
   
   if(!ierr) {
-    sprintf(reply,"%s %s",who_selected,dummy);
+    replyAppend(&rb,"%s %s",who_selected,dummy);
     wagoRW(1,"MLCS",0,0,dummy);                // MLC[1-16] power
-    sprintf(reply,"%s%s",reply,dummy);
+    replyAppend(&rb,"%s",dummy);
 
   } else if(ierr==1) {
-    sprintf(reply,"%s %s",who_selected,dummy);
+    replyAppend(&rb,"%s %s",who_selected,dummy);
     wagoRW(1,"MLCS",0,0,dummy);                // MLC[1-16] power
-    sprintf(reply,"%s%s",reply,dummy);
+    replyAppend(&rb,"%s",dummy);
 
   } else if(ierr==-1) {
-    sprintf(reply,"%s %s",who_selected,dummy);
+    replyAppend(&rb,"%s %s",who_selected,dummy);
 
   } else {
-    sprintf(reply,"%s IEB_R=UNKNOWN ",who_selected);
+    replyAppend(&rb,"%s IEB_R=UNKNOWN ",who_selected);
 
   }
 
   /* IEB 2 */
   ierr=wagoRW(2,"IEBS",0,0,dummy);             // IEB power
   if(!ierr) {
-    sprintf(reply,"%s %s",reply,dummy);
+    replyAppend(&rb," %s",dummy);
     wagoRW(2,"MLCS",0,0,dummy);                // MLC[1-16] power
-    sprintf(reply,"%s%s",reply,dummy);
+    replyAppend(&rb,"%s",dummy);
 
   } else if(ierr==1) {
-    sprintf(reply,"%s %s",reply,dummy);
+    replyAppend(&rb," %s",dummy);
     wagoRW(2,"MLCS",0,0,dummy);                // MLC[1-16] power
-    sprintf(reply,"%s%s",reply,dummy);
+    replyAppend(&rb,"%s",dummy);
 
   } else if(ierr==-1) {
-    sprintf(reply,"%s %s",reply,dummy);
+    replyAppend(&rb," %s",dummy);
 
   } else {
-    sprintf(reply,"%s %s",reply,dummy);
+    replyAppend(&rb," %s",dummy);
 
   }
 
   cmd_lamp("status", EXEC, dummy);
-  sprintf(reply,"%s %s UTIL=UNAVAIL",reply,&dummy[8]);
+  replyAppend(&rb," %s",&dummy[8]);
+  replyKey(&rb,"UTIL","UNAVAIL");
 
-  if(shm_addr->MODS.blueIMCS_OnOff)
-    sprintf(reply,"%s BIMCS=ON",reply);
-  else
-    sprintf(reply,"%s BIMCS=OFF",reply);
+  replyKey(&rb,"BIMCS",(shm_addr->MODS.blueIMCS_OnOff ? "ON" : "OFF"));
+  replyKey(&rb,"RIMCS",(shm_addr->MODS.redIMCS_OnOff ? "ON" : "OFF"));
 
-  if(shm_addr->MODS.redIMCS_OnOff)
-    sprintf(reply,"%s RIMCS=ON",reply);
-  else
-    sprintf(reply,"%s RIMCS=OFF",reply);
+  if (rb.overflow)
+    mmcLOGGER(shm_addr->MODS.LLOG,(char*)"PSTATUS reply too long, truncated");
   
   return CMD_OK;
 }
@@ -1389,6 +1392,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
   int  len            = 0; // Length for building the reply
   int  cmdLen         = 0; // Command length
   int  errorLen       = 0; // Length for building error message
+  replybuf_t rb;           // status reply builder
 
   // Instrument Utility Box power relay digital output channel assignments
   
@@ -1722,7 +1726,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
     llbID = getWagoID("llb", dummy); // Get Lamp/Laser Box(LLB) ID
     shm_addr->MODS.lamps.lamplaser_all[0] &= 0x03C0; 
-    ierr = wagoSetGet(1, shm_addr->MODS.WAGOIP[llbID], 1, LLBONOFF, &shm_addr->MODS.lamps.lamplaser_all[0], 1);
+    ierr = wagoMirror(1, shm_addr->MODS.WAGOIP[llbID], 1, LLBONOFF, &shm_addr->MODS.lamps.lamplaser_all[0], 1);
     if ( ierr < 0 ) {
       sprintf(statusMsg,"%s could not talk to Lamps, no IP Address, CALLAMPS=FAULT", who_selected);
       if ( mechanismError == 0 ) {
@@ -2020,7 +2024,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
   // Below this point we need the IUB temperatures and pressure readouts
 
-  ierr=wagoSetGet(0,shm_addr->MODS.WAGOIP[utilID],1,0,pressureTemps,10);
+  ierr=wagoMirrorCached(shm_addr->MODS.WAGOIP[utilID],1,0,pressureTemps,10);
 
   glycolSupplyPressure = (float)pressureTemps[0]/327.64;
   glycolReturnPressure = (float)pressureTemps[1]/327.64;
@@ -2042,7 +2046,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
   // Red IEB (ieb1)
   
-  ierr=wagoSetGet(0,shm_addr->MODS.WAGOIP[ieb1ID],1,4,iebTemps,4);
+  ierr=wagoMirrorCached(shm_addr->MODS.WAGOIP[ieb1ID],1,4,iebTemps,4);
 
   redIEBAirTemperature = ptRTD2C(iebTemps[0]);
   redIEBReturnTemperature = ptRTD2C(iebTemps[1]);
@@ -2056,7 +2060,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
   // Blue IEB (ieb2)
   
-  ierr=wagoSetGet(0,shm_addr->MODS.WAGOIP[ieb2ID],1,4,iebTemps,4);
+  ierr=wagoMirrorCached(shm_addr->MODS.WAGOIP[ieb2ID],1,4,iebTemps,4);
 
   blueIEBAirTemperature = ptRTD2C(iebTemps[0]);
   blueIEBReturnTemperature = ptRTD2C(iebTemps[1]);
@@ -2072,7 +2076,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
   
   // Red HEB
   
-  ierr=wagoSetGet(0,shm_addr->MODS.WAGOIP[rhebID],1,4,hebTemps,2);
+  ierr=wagoMirrorCached(shm_addr->MODS.WAGOIP[rhebID],1,4,hebTemps,2);
   
   redHEBTemperature = ptRTD2C(hebTemps[0]);
   redDewarTemperature = ptRTD2C(hebTemps[1]);
@@ -2081,7 +2085,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
   // Blue HEB
   
-  ierr=wagoSetGet(0,shm_addr->MODS.WAGOIP[bhebID],1,4,hebTemps,2);
+  ierr=wagoMirrorCached(shm_addr->MODS.WAGOIP[bhebID],1,4,hebTemps,2);
     
   blueHEBTemperature = ptRTD2C(hebTemps[0]);
   blueDewarTemperature = ptRTD2C(hebTemps[1]);
@@ -2103,7 +2107,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
     // Get the power relay states - if the IUB is off, everybody is off
     // (or the IUB is disconnected from the network, so OFF == UNKNOWN)
 
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
     if (ierr<0) {
       sprintf(reply,"%s %s", who_selected,"UTIL=OFF");
       shm_addr->MODS.utilState = 0;
@@ -2142,7 +2146,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
     
     // Get circuit breaker states
 
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[utilID],1,10,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[utilID],1,10,devOnOff,1);
     allUtilBreaker = devOnOff[0];
 
     // Circuit breaker states (current sense past break)
@@ -2169,7 +2173,8 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
       // Start building the reply
 	
-      sprintf(reply,"%s",who_selected);
+      replyInit(&rb,reply,MMC_REPLYSIZE);
+      replyAppend(&rb,"%s",who_selected);
 
       // Note that the power control relays for the IEBs and LLB are
       // normally closed (immediate power up on application of main AC
@@ -2183,31 +2188,31 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 	
       if (iebRedPower != 1) {
 	if (iebRedBreaker == 1) {
-	  sprintf(reply,"%s IEB_R=ON IEB_R_BRK=OK",reply);
+	  replyAppend(&rb," IEB_R=ON IEB_R_BRK=OK");
 	  shm_addr->MODS.redIEBState = 1;
 	}
 	else {
-	  sprintf(reply,"%s IEB_R=ON IEB_R_BRK=FAULT",reply);
+	  replyAppend(&rb," IEB_R=ON IEB_R_BRK=FAULT");
 	  shm_addr->MODS.redIEBState = -1;
 	}
       }
       else {
-	sprintf(reply,"%s IEB_R=OFF IEB_R_BRK=UNKNOWN",reply);
+	replyAppend(&rb," IEB_R=OFF IEB_R_BRK=UNKNOWN");
 	shm_addr->MODS.redIEBState = 0;
       }
 
       if (iebBluePower != 2) {
 	if (iebBlueBreaker == 2) {
-	  sprintf(reply,"%s IEB_B=ON IEB_B_BRK=OK",reply);
+	  replyAppend(&rb," IEB_B=ON IEB_B_BRK=OK");
 	  shm_addr->MODS.blueIEBState = 1;
 	}
 	else {
-	  sprintf(reply,"%s IEB_B=ON IEB_B_BRK=FAULT",reply);
+	  replyAppend(&rb," IEB_B=ON IEB_B_BRK=FAULT");
 	  shm_addr->MODS.blueIEBState = -1;
 	}
       }
       else {
-	sprintf(reply,"%s IEB_B=OFF IEB_B_BRK=UNKNOWN",reply);
+	replyAppend(&rb," IEB_B=OFF IEB_B_BRK=UNKNOWN");
 	shm_addr->MODS.blueIEBState = 0;
       }
       
@@ -2217,16 +2222,16 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
       
       if (hebRedPower != 8) {
 	if (hebRedBreaker == 4) {
-	  sprintf(reply,"%s HEB_R=ON HEB_R_BRK=OK",reply);
+	  replyAppend(&rb," HEB_R=ON HEB_R_BRK=OK");
 	  shm_addr->MODS.redHEBState = 1;
 	}
 	else {
-	  sprintf(reply,"%s HEB_R=ON HEB_R_BRK=FAULT",reply);
+	  replyAppend(&rb," HEB_R=ON HEB_R_BRK=FAULT");
 	  shm_addr->MODS.redHEBState = -1;
 	}
       }
       else {
-	sprintf(reply,"%s HEB_R=OFF HEB_R_BRK=UNKNOWN",reply);
+	replyAppend(&rb," HEB_R=OFF HEB_R_BRK=UNKNOWN");
 	shm_addr->MODS.redHEBState = 0;
       }
 
@@ -2235,16 +2240,16 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
       
       if (hebBluePower != 32) {
 	if (hebBlueBreaker == 8) {
-	  sprintf(reply,"%s HEB_B=ON HEB_B_BRK=OK",reply);
+	  replyAppend(&rb," HEB_B=ON HEB_B_BRK=OK");
 	  shm_addr->MODS.blueHEBState = 1;
 	}
 	else {
-	  sprintf(reply,"%s HEB_B=ON HEB_B_BRK=FAULT",reply);
+	  replyAppend(&rb," HEB_B=ON HEB_B_BRK=FAULT");
 	  shm_addr->MODS.blueHEBState = -1;
 	}
       }
       else {
-	sprintf(reply,"%s HEB_B=OFF HEB_B_BRK=UNKNOWN",reply);
+	replyAppend(&rb," HEB_B=OFF HEB_B_BRK=UNKNOWN");
 	shm_addr->MODS.blueHEBState = 0;
       }
 
@@ -2252,31 +2257,31 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 	
       if (agwWFSPower == 64) {
 	if (agwWFSBreaker == 16) {
-	  sprintf(reply,"%s WFS=ON WFS_BRK=OK",reply);
+	  replyAppend(&rb," WFS=ON WFS_BRK=OK");
 	  shm_addr->MODS.wfsCamState = 1;
 	}
 	else {
-	  sprintf(reply,"%s WFS=ON WFS_BRK=FAULT",reply);
+	  replyAppend(&rb," WFS=ON WFS_BRK=FAULT");
 	  shm_addr->MODS.wfsCamState = -1;
 	}
       }
       else {
-	sprintf(reply,"%s WFS=OFF WFS_BRK=UNKNOWN",reply);
+	replyAppend(&rb," WFS=OFF WFS_BRK=UNKNOWN");
 	shm_addr->MODS.wfsCamState = 0;
       }
 
       if (agwGuidePower == 128) {
 	if (agwGuideBreaker == 32) {
-	  sprintf(reply,"%s AGC=ON AGC_BRK=OK",reply);
+	  replyAppend(&rb," AGC=ON AGC_BRK=OK");
 	  shm_addr->MODS.guideCamState = 1;
 	}
 	else {
-	  sprintf(reply,"%s AGC=ON AGC_BRK=FAULT",reply);
+	  replyAppend(&rb," AGC=ON AGC_BRK=FAULT");
 	  shm_addr->MODS.guideCamState = -1;
 	}
       }
       else {
-	sprintf(reply,"%s AGC=OFF AGC_BRK=UNKNOWN",reply);
+	replyAppend(&rb," AGC=OFF AGC_BRK=UNKNOWN");
 	  shm_addr->MODS.guideCamState = 0;
       }
 
@@ -2284,48 +2289,52 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 	
       if (lampLaserPower != 256) {
 	if (lampLaserBreaker == 64) {
-	  sprintf(reply,"%s LLB=ON LLB_BRK=OK",reply);
+	  replyAppend(&rb," LLB=ON LLB_BRK=OK");
 	  shm_addr->MODS.llbState = 1;
 	}
 	else {
-	  sprintf(reply,"%s LLB=ON LLB_BRK=FAULT",reply);
+	  replyAppend(&rb," LLB=ON LLB_BRK=FAULT");
 	  shm_addr->MODS.llbState = -1;
 	}
       }
       else {
-	sprintf(reply,"%s LLB=OFF LLB_BRK=UNKNOWN",reply);
+	replyAppend(&rb," LLB=OFF LLB_BRK=UNKNOWN");
 	shm_addr->MODS.llbState = 0;
       }
       
       // Glycol supply and return pressures and temperatures
 	
-      sprintf(reply,"%s GSPRES=%.1f",reply,glycolSupplyPressure);
-      sprintf(reply,"%s GRPRES=%.1f",reply, glycolReturnPressure);
-      sprintf(reply,"%s GSTEMP=%.1f",reply,glycolSupplyTemperature);
-      sprintf(reply,"%s GRTEMP=%.1f",reply,glycolReturnTemperature);
+      replyFloat(&rb,"GSPRES",glycolSupplyPressure,1);
+      replyFloat(&rb,"GRPRES",glycolReturnPressure,1);
+      replyFloat(&rb,"GSTEMP",glycolSupplyTemperature,1);
+      replyFloat(&rb,"GRTEMP",glycolReturnTemperature,1);
       
       // Utility box temperature sensors 
 
-      sprintf(reply,"%s IUBTAIR=%.1f",reply,utilBoxAirTemperature);
-      sprintf(reply,"%s AMBTEMP=%.1f",reply,outsideAirTemperature);
-      sprintf(reply,"%s AGHSTEMP=%.1f",reply,agwHeatSinkTemperature);
+      replyFloat(&rb,"IUBTAIR",utilBoxAirTemperature,1);
+      replyFloat(&rb,"AMBTEMP",outsideAirTemperature,1);
+      replyFloat(&rb,"AGHSTEMP",agwHeatSinkTemperature,1);
       
     } else if(!strcasecmp(argbuf,"GLYCOL")) {
       
-      sprintf(reply,"%s GSPRES=%.1f",who_selected,glycolSupplyPressure);
-      sprintf(reply,"%s GSTEMP=%.1f",reply,glycolSupplyTemperature);
-      sprintf(reply,"%s GRPRES=%.1f",reply, glycolReturnPressure);
-      sprintf(reply,"%s GRTEMP=%.1f",reply,glycolReturnTemperature);
+      replyInit(&rb,reply,MMC_REPLYSIZE);
+      replyAppend(&rb,"%s",who_selected);
+      replyFloat(&rb,"GSPRES",glycolSupplyPressure,1);
+      replyFloat(&rb,"GSTEMP",glycolSupplyTemperature,1);
+      replyFloat(&rb,"GRPRES",glycolReturnPressure,1);
+      replyFloat(&rb,"GRTEMP",glycolReturnTemperature,1);
 
       return CMD_OK;
 
     } else if(!strcasecmp(argbuf,"TEMP")) {
 
-      sprintf(reply,"%s GSTEMP=%.1f",who_selected,glycolSupplyTemperature);
-      sprintf(reply,"%s GRTEMP=%.1f",reply,glycolReturnTemperature);
-      sprintf(reply,"%s IUBTAIR=%.1f",reply,utilBoxAirTemperature);
-      sprintf(reply,"%s AMBTEMP=%.1f",reply,outsideAirTemperature);
-      sprintf(reply,"%s AGHSTEMP=%.1f",reply,agwHeatSinkTemperature);
+      replyInit(&rb,reply,MMC_REPLYSIZE);
+      replyAppend(&rb,"%s",who_selected);
+      replyFloat(&rb,"GSTEMP",glycolSupplyTemperature,1);
+      replyFloat(&rb,"GRTEMP",glycolReturnTemperature,1);
+      replyFloat(&rb,"IUBTAIR",utilBoxAirTemperature,1);
+      replyFloat(&rb,"AMBTEMP",outsideAirTemperature,1);
+      replyFloat(&rb,"AGHSTEMP",agwHeatSinkTemperature,1);
 
       return CMD_OK;
 
@@ -2412,7 +2421,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
       } else if(!strcasecmp(argbuf,"ON")) {
 	if(hebRedPower==8) {
 	  devOnOff[0]=(short )(allUtilPower ^ 8);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
 	}
 	MilliSleep(200);
 	KeyCommand("util heb_r", dummy);
@@ -2421,7 +2430,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
       } else if(!strcasecmp(argbuf,"OFF")) {
 	if(hebRedPower==0) {
 	  devOnOff[0]=(short )(allUtilPower | 8);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
 	}
 	MilliSleep(200);
 	KeyCommand("util heb_r", dummy);
@@ -2459,7 +2468,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
       } else if(!strcasecmp(argbuf,"ON")) {
 	if(hebBluePower==32) {
 	  devOnOff[0]=(short )(allUtilPower ^ 32);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
 	}
 	MilliSleep(200);
 	KeyCommand("util heb_b", dummy);
@@ -2468,7 +2477,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
       } else if(!strcasecmp(argbuf,"OFF")) {
 	if(hebBluePower==0) {
 	  devOnOff[0]=(short )(allUtilPower | 32);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
 	}
 	MilliSleep(200);
 	KeyCommand("util heb_b", dummy);
@@ -2509,7 +2518,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
 	if(iebRedPower==1) {
 	  devOnOff[0]=(short )(allUtilPower^1);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
 	}
 	MilliSleep(200);
 	KeyCommand("util ieb_r", dummy);
@@ -2519,7 +2528,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
 	if(iebRedPower==0) {
 	  devOnOff[0]=(short )(allUtilPower|1);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
 	}
 	MilliSleep(200);
 	KeyCommand("util ieb_r", dummy);
@@ -2558,7 +2567,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
 	if(iebBluePower==2) {
 	  devOnOff[0]=(short )(allUtilPower^2);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
 	}
 	MilliSleep(200);
 	KeyCommand("util ieb_b", dummy);
@@ -2568,7 +2577,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
 	if(iebBluePower==0) {
 	  devOnOff[0]=(short )(allUtilPower|2);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
 	}
 	MilliSleep(200);
 	KeyCommand("util ieb_b", dummy);
@@ -2609,7 +2618,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
 	if(agwWFSPower==64) {
 	  devOnOff[0]=(short )(allUtilPower^64);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
 	}
 	MilliSleep(200);
 	KeyCommand("util wfs", dummy);
@@ -2619,7 +2628,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
 	if(agwWFSPower==0) {
 	  devOnOff[0]=(short )(allUtilPower|64);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
 	}
 	MilliSleep(200);
 	KeyCommand("util wfs", dummy);
@@ -2659,7 +2668,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
 	if(agwGuidePower==128) {
 	  devOnOff[0]=(short )(allUtilPower^128);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
 	}
 	MilliSleep(200);
 	KeyCommand("util agc", dummy);
@@ -2669,7 +2678,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
 	if(agwGuidePower==0) {
 	  devOnOff[0]=(short )(allUtilPower|128);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
 	}
 	MilliSleep(200);
 	KeyCommand("util agc", dummy);
@@ -2755,7 +2764,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
 	if(lampLaserPower==256) {
 	  devOnOff[0]=(short )(allUtilPower^256);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
 	}
 	MilliSleep(200);
 	KeyCommand("util llb", dummy);
@@ -2765,7 +2774,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
 	if(lampLaserPower==0) {
 	  devOnOff[0]=(short )(allUtilPower|256);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[utilID],1,512,devOnOff,1);
 	}
 	MilliSleep(200);
 	KeyCommand("util llb", dummy);
@@ -2792,16 +2801,18 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
     if(!strcasecmp(argbuf,"RESET")) {
       shm_addr->MODS.lamps.lamplaser_all[0] = 0; // Turn off all lamps and lasers
-      ierr = wagoSetGet(1, shm_addr->MODS.WAGOIP[llbID], 1, LLBONOFF, &shm_addr->MODS.lamps.lamplaser_all[0], 1);
+      wagoMirrorHold(shm_addr->MODS.WAGOIP[llbID]);  // send the three writes together
+      ierr = wagoMirror(1, shm_addr->MODS.WAGOIP[llbID], 1, LLBONOFF, &shm_addr->MODS.lamps.lamplaser_all[0], 1);
 
       for(i=0;i<9;i++) shm_addr->MODS.lamps.lamp_state[i]=0;
       
-      ierr = wagoSetGet(1, shm_addr->MODS.WAGOIP[llbID], 1, 513, &shm_addr->MODS.lamps.lamplaser_all[0], 1);
+      ierr = wagoMirror(1, shm_addr->MODS.WAGOIP[llbID], 1, 513, &shm_addr->MODS.lamps.lamplaser_all[0], 1);
       
       shm_addr->MODS.lasers.vislaser_state=0;
       shm_addr->MODS.lasers.visbeam_state=0;
 
-      ierr = wagoSetGet(1, shm_addr->MODS.WAGOIP[llbID], 1, 514, &shm_addr->MODS.lamps.lamplaser_all[0], 1);
+      ierr = wagoMirror(1, shm_addr->MODS.WAGOIP[llbID], 1, 514, &shm_addr->MODS.lamps.lamplaser_all[0], 1);
+      ierr = wagoMirrorFlush(shm_addr->MODS.WAGOIP[llbID]);
 
       shm_addr->MODS.lasers.irlaser_state=0;
       shm_addr->MODS.lasers.irbeam_state=0;
@@ -2831,35 +2842,36 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
 
     // start the reply
     
-    sprintf(reply,"%s ",who_selected);  // start the reply
+    replyInit(&rb,reply,MMC_REPLYSIZE);
+    replyAppend(&rb,"%s ",who_selected);  // start the reply
 
     // IEB temperature sensors
 
-    sprintf(reply,"%s IEBTEMPR=%.1f",reply,redIEBAirTemperature);
-    sprintf(reply,"%s IEBGRT_R=%.1f",reply,redIEBReturnTemperature);
-    sprintf(reply,"%s IEBTEMPB=%.1f",reply,blueIEBAirTemperature);
-    sprintf(reply,"%s IEBGRT_B=%.1f",reply,blueIEBReturnTemperature);
-    sprintf(reply,"%s TAIRTOP=%.1f",reply,TrussTopAirTemperature);
-    sprintf(reply,"%s TAIRBOT=%.1f",reply,TrussBottomAirTemperature);
-    sprintf(reply,"%s TCOLLTOP=%.1f",reply,TrussTopTemperature);
-    sprintf(reply,"%s TCOLLBOT=%.1f",reply,TrussBottomTemperature);
+    replyFloat(&rb,"IEBTEMPR",redIEBAirTemperature,1);
+    replyFloat(&rb,"IEBGRT_R",redIEBReturnTemperature,1);
+    replyFloat(&rb,"IEBTEMPB",blueIEBAirTemperature,1);
+    replyFloat(&rb,"IEBGRT_B",blueIEBReturnTemperature,1);
+    replyFloat(&rb,"TAIRTOP",TrussTopAirTemperature,1);
+    replyFloat(&rb,"TAIRBOT",TrussBottomAirTemperature,1);
+    replyFloat(&rb,"TCOLLTOP",TrussTopTemperature,1);
+    replyFloat(&rb,"TCOLLBOT",TrussBottomTemperature,1);
 
     // Utility Box Temperatures and pressures (readout above)
 
-    sprintf(reply,"%s GSPRES=%.1f",reply,glycolSupplyPressure);
-    sprintf(reply,"%s GSTEMP=%.1f",reply,glycolSupplyTemperature);
-    sprintf(reply,"%s GRPRES=%.1f",reply, glycolReturnPressure);
-    sprintf(reply,"%s GRTEMP=%.1f",reply,glycolReturnTemperature);
-    sprintf(reply,"%s IUBTAIR=%.1f",reply,utilBoxAirTemperature);
-    sprintf(reply,"%s AMBTEMP=%.1f",reply,outsideAirTemperature);
-    sprintf(reply,"%s AGHSTEMP=%.1f",reply,agwHeatSinkTemperature);
+    replyFloat(&rb,"GSPRES",glycolSupplyPressure,1);
+    replyFloat(&rb,"GSTEMP",glycolSupplyTemperature,1);
+    replyFloat(&rb,"GRPRES",glycolReturnPressure,1);
+    replyFloat(&rb,"GRTEMP",glycolReturnTemperature,1);
+    replyFloat(&rb,"IUBTAIR",utilBoxAirTemperature,1);
+    replyFloat(&rb,"AMBTEMP",outsideAirTemperature,1);
+    replyFloat(&rb,"AGHSTEMP",agwHeatSinkTemperature,1);
 
     // WAGO HEB temperature sensors are on WAGO register addr 5 (4-channel RTD)
 
-    sprintf(reply,"%s RHEBTEMP=%.1f",reply,redHEBTemperature);
-    sprintf(reply,"%s RDEWTEMP=%.1f",reply,redDewarTemperature);
-    sprintf(reply,"%s BHEBTEMP=%.1f",reply,blueHEBTemperature);
-    sprintf(reply,"%s BDEWTEMP=%.1f",reply,blueDewarTemperature);
+    replyFloat(&rb,"RHEBTEMP",redHEBTemperature,1);
+    replyFloat(&rb,"RDEWTEMP",redDewarTemperature,1);
+    replyFloat(&rb,"BHEBTEMP",blueHEBTemperature,1);
+    replyFloat(&rb,"BDEWTEMP",blueDewarTemperature,1);
 
   }
   else if (!strcasecmp(who_selected,"HEB")) {
@@ -2884,7 +2896,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
     // module has registar address 513 If a fault, HEB_x=OFF is the
     // mostly likely reason
     
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
     if (ierr<0) {
       sprintf(reply,"%s HEB_%c=OFF", who_selected,hebChan);
       if (hebChan == 'R') {
@@ -2981,15 +2993,15 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
       
       GetArg(args,3,argbuf);
       if (strlen(argbuf) > 0) {
-	ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
+	ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
 	allHEBPower = devOnOff[0];
 	if (!strcasecmp(argbuf,"ON")) {
 	  devOnOff[0]=(short)(allHEBPower | 1);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
 	}
 	else if (!strcasecmp(argbuf,"OFF")) {
 	  devOnOff[0]=(short)(allHEBPower ^ 1);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
 	}
 	else {
 	  sprintf(reply,"%s unrecognized power state %s - must be ON or OFF",reply,argbuf);
@@ -2998,7 +3010,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
       }
       MilliSleep(200);
 
-      ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
+      ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
       allHEBPower = devOnOff[0];
       archonPower  = allHEBPower & 1;
       ionGaugePower = allHEBPower & 2;
@@ -3029,15 +3041,15 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
       
       GetArg(args,3,argbuf);
       if (strlen(argbuf) > 0) {
-	ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
+	ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
 	allHEBPower = devOnOff[0];
 	if (!strcasecmp(argbuf,"ON")) {
 	  devOnOff[0]=(short)(allHEBPower | 2);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
 	}
 	else if (!strcasecmp(argbuf,"OFF")) {
 	  devOnOff[0]=(short)(allHEBPower ^ 2);
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
 	}
 	else {
 	  sprintf(reply,"%s unrecognized power state %s - must be ON or OFF",reply,argbuf);
@@ -3046,7 +3058,7 @@ cmd_misc(char *args, MsgType msgtype, char *reply)
       }
       MilliSleep(200);
 
-      ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
+      ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[hebWAGO],1,512,devOnOff,1);
       allHEBPower = devOnOff[0];
       archonPower  = allHEBPower & 1;
       ionGaugePower = allHEBPower & 2;
@@ -3134,9 +3146,9 @@ cmd_open(char *args, MsgType msgtype, char *reply)
 	;
       } else {
 	if(unit!=MAX_ML-1) {
-	  CloseTTYPort(&shm_addr->MODS.commport[unit]); // Close
+	  mlcClosePort(unit); // Close
 	  MilliSleep(100);
-	  OpenTTYPort(&shm_addr->MODS.commport[unit]); // Open
+	  mlcOpenPort(unit); // Open
 	}
       }
     }
@@ -3160,9 +3172,9 @@ cmd_open(char *args, MsgType msgtype, char *reply)
 	;
       } else {
 	if(unit!=MAX_ML-1) {
-	  CloseTTYPort(&shm_addr->MODS.commport[unit]); // Close
+	  mlcClosePort(unit); // Close
 	  MilliSleep(100);
-	  OpenTTYPort(&shm_addr->MODS.commport[unit]); // Open
+	  mlcOpenPort(unit); // Open
 	}
       }
     }
@@ -3197,10 +3209,10 @@ cmd_open(char *args, MsgType msgtype, char *reply)
       return CMD_OK;
     }
 
-    CloseTTYPort(&shm_addr->MODS.commport[unit]);
+    mlcClosePort(unit);
     MilliSleep(1000);
 
-    if(OpenTTYPort(&shm_addr->MODS.commport[unit])<0) {
+    if(mlcOpenPort(unit)<0) {
       sprintf(reply,"%s Can not open %s COMM port, reason %s",
 	      who_selected,shm_addr->MODS.who[unit],strerror(errno));
       return CMD_ERR;
@@ -3253,7 +3265,7 @@ cmd_close(char *args, MsgType msgtype, char *reply)
 	 !strncasecmp(shm_addr->MODS.who[unit],"agw",3));
       else
 	if(unit!=MAX_ML-1)
-	  CloseTTYPort(&shm_addr->MODS.commport[unit]);
+	  mlcClosePort(unit);
     }
     strcpy(dummy,"close");  // Reset and Open all AGW COMM ports
     ierr=agwcu("localhost",0,"mmcIC 0 ",dummy);
@@ -3286,7 +3298,7 @@ cmd_close(char *args, MsgType msgtype, char *reply)
       return CMD_ERR;
     }
 
-    CloseTTYPort(&shm_addr->MODS.commport[unit]);
+    mlcClosePort(unit);
     sprintf(reply,"%s CLOSED %s COMM closed",who_selected,
 	    shm_addr->MODS.who[unit]);
   } 
@@ -7141,6 +7153,7 @@ cmd_agwfilt(char *args, MsgType msgtype, char *reply)
 int
 cmd_dichroic(char *args, MsgType msgtype, char *reply)
 {
+  static char *query[] = {"PWRFAIL=0","PRINT IO 24","PRINT IO 22,IO 21","PRINT IO 24"};
   int ierr;
   int device;
   int dichnum;
@@ -7233,6 +7246,11 @@ cmd_dichroic(char *args, MsgType msgtype, char *reply)
     return CMD_ERR;
   }
 
+  // query, send the rest of its commands as one batch now that the
+  // controller is known to be there, answering, and not locked out
+
+  if (strlen(args)<=0) mlcPrefetch(device,query,4);
+
   if(!strcasecmp(cmd_instruction,"RESET")) {  // initialize
 
     rawCommand(device,"PWRFAIL=0",dummy);
@@ -8174,6 +8192,7 @@ cmd_gpfocus(char *args, MsgType msgtype, char *reply)
 int
 cmd_colttf(char *args, MsgType msgtype, char *reply)
 {
+  static char *query[] = {"PRINT IO 20","PRINT IO 22,IO 21","PRINT PWRFAIL","PRINT POS"};
   int i;
   int device;
   int argcnt;
@@ -8234,6 +8253,13 @@ cmd_colttf(char *args, MsgType msgtype, char *reply)
     return CMD_ERR;
   }
 
+  if (strlen(args)<=0 && mlcCached(device)) { // query, answer from the state poller
+    shm_addr->MODS.pos[device]=fabs(shm_addr->MODS.mlcPos[device]);
+    sprintf(reply,"%s %s=%.1f",who_selected,who_selected,
+	    shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device]);
+    return CMD_OK;
+  }
+
   ierr=mlcQuery(device,1,dummy); // Check if the microLynx is ON
   if(ierr!=0) {
     sprintf(reply,"%s %s",who_selected,dummy);
@@ -8245,6 +8271,11 @@ cmd_colttf(char *args, MsgType msgtype, char *reply)
     return CMD_ERR;
   }
 
+  // query, send the rest of its commands as one batch now that the
+  // controller is known to be there, answering, and not locked out
+
+  if (strlen(args)<=0) mlcPrefetch(device,query,4);
+
   if (strncasecmp(args,"M#",2)) { // check for low-level command
     ierr = mlcCheckBits(device,dummy); // check limit bits 21,22
     if((ierr&3)== 3 || ierr==-1) {
@@ -9329,6 +9360,7 @@ cmd_colfoc(char *args, MsgType msgtype, char *reply)
 int
 cmd_grating(char *args, MsgType msgtype, char *reply)
 {
+  static char *query[] = {"PRINT IO 20","PRINT PWRFAIL"};
   int device;
   int bit_nomove;
   int bit_mask;
@@ -9426,6 +9458,11 @@ cmd_grating(char *args, MsgType msgtype, char *reply)
     return CMD_ERR;
   }
 
+  // query, send the rest of its commands as one batch now that the
+  // controller is known to be there, answering, and not locked out
+
+  if (strlen(args)<=0) mlcPrefetch(device,query,2);
+
   if (strncasecmp(args,"M#",2)) { // check for low-level command
       ierr = mlcCheckBits(device,dummy);
       if((ierr&3)== 3 || ierr==-1) {
@@ -9678,6 +9715,7 @@ return CMD_OK;
 int
 cmd_grtilt(char *args, MsgType msgtype, char *reply)
 {
+  static char *query[] = {"PRINT IO 20","PRINT PWRFAIL","PRINT POS"};
   int device;
   int bit_mask;
   int len;
@@ -9734,6 +9772,15 @@ cmd_grtilt(char *args, MsgType msgtype, char *reply)
     return CMD_ERR;
   }
 
+  if (strlen(args)<=0 && mlcCached(device)) { // query, answer from the state poller
+    shm_addr->MODS.pos[device]=fabs(shm_addr->MODS.mlcPos[device]);
+    sprintf(shm_addr->MODS.state_word[device],"%0.0f",
+	    shm_addr->MODS.pos[device]);
+    sprintf(reply,"%s %s=%0.0f",who_selected,who_selected,
+	    shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device]);
+    return CMD_OK;
+  }
+
   ierr=mlcQuery(device,1,dummy); // Check if the microLynx is ON
   if(ierr!=0) {
     sprintf(reply,"%s %s",who_selected,dummy);
@@ -9751,6 +9798,11 @@ cmd_grtilt(char *args, MsgType msgtype, char *reply)
     return CMD_ERR;
   }
 
+  // query, send the rest of its commands as one batch now that the
+  // controller is known to be there, answering, and not locked out
+
+  if (strlen(args)<=0) mlcPrefetch(device,query,3);
+
   if (strncasecmp(args,"M#",2)) { // check for low-level command
     ierr = mlcCheckBits(device,dummy); // check limit bits 21,22
     if((ierr&3)== 3 || ierr==-1) {
@@ -10043,7 +10095,7 @@ cmd_shutter(char *args, MsgType msgtype, char *reply)
     ierr = mlcStopMechanism(device,dummy); //  STOP the operation
     rawCommandOnly(device,"RSTATE=0");// Disable the HE trigger
     sprintf(reply,"%s %s=DISABLED Head Electronics trigger disabled",who_selected,who_selected);
-    he_token=0;
+    heDisabled[device]=1;
     return CMD_OK;
   }
 
@@ -10051,11 +10103,11 @@ cmd_shutter(char *args, MsgType msgtype, char *reply)
      !strcasecmp(cmd_instruction,"REMOTE")) {
     rawCommandOnly(device,"EXEC STARTIT");// Enable the HE trigger
     sprintf(reply,"%s %s=ENABLED Head Electronics trigger enabled",who_selected,who_selected);
-    he_token=1;
+    heDisabled[device]=0;
     return CMD_OK;
   }
 
-  if (he_token) {
+  if (!heDisabled[device]) {
     sprintf(reply,"%s %s=ENABLED You must disable to query, enable when done with query",who_selected,who_selected);
     return CMD_ERR;
   }
@@ -10166,6 +10218,7 @@ cmd_shutter(char *args, MsgType msgtype, char *reply)
 int
 cmd_camfoc(char *args, MsgType msgtype, char *reply)
 {
+  static char *query[] = {"PRINT IO 20","PRINT PWRFAIL","PRINT POS","PRINT POS"};
   int  ierr;
   int  cmdlen;
   int  device;
@@ -10212,12 +10265,27 @@ cmd_camfoc(char *args, MsgType msgtype, char *reply)
     return CMD_ERR;
   }
 
+  if (cmdlen<=0 && mlcCached(device)) { // query, answer from the state poller
+    shm_addr->MODS.pos[device]=fabs(shm_addr->MODS.mlcPos[device]);
+    if (shm_addr->MODS.pos[device] == 0) 
+      camfocPos = 0;
+    else
+      camfocPos = (int)((shm_addr->MODS.pos[device]*shm_addr->MODS.convf[device]));
+    sprintf(reply,"%s %s=%d",who_selected,who_selected,camfocPos);
+    return CMD_OK;
+  }
+
   ierr=mlcQuery(device,1,dummy); // Check if the microLynx is ON
   if(ierr!=0) {
     sprintf(reply,"%s %s",who_selected,dummy);
     return CMD_ERR;
   }
 
+  // query, send the rest of its commands as one batch now that the
+  // controller is known to be there and answering
+
+  if (cmdlen<=0) mlcPrefetch(device,query,4);
+
   if (!strcasecmp(cmd_instruction,"CONFIG")) { // get mechanism ip
     
     mlcMechanismConfig(device,who_selected,dummy);
@@ -10539,6 +10607,7 @@ cmd_camfoc(char *args, MsgType msgtype, char *reply)
 int
 cmd_filter(char *args, MsgType msgtype, char *reply)
 {
+  static char *query[] = {"PWRFAIL=0","PRINT IO 24","PRINT IO 23,IO 22,IO 21"};
   int ierr,i;
   int device;
   int load_filter;
@@ -10609,6 +10678,11 @@ cmd_filter(char *args, MsgType msgtype, char *reply)
     return CMD_ERR;
   }
 
+  // query, send the rest of its commands as one batch now that the
+  // controller is known to be there and answering
+
+  if (strlen(args)<=0) mlcPrefetch(device,query,3);
+
   if(!strcasecmp(cmd_instruction,"RESET")) {
 
     rawCommand(device,"INITIAL",dummy);
@@ -10977,7 +11051,7 @@ cmd_lamp(char *args, MsgType msgtype, char *reply)
   if(!strcasecmp(stateOnOff,"STATUS")) {
     printf(who_selected,"LAMP");
 
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,devOnOff,1);
     if(ierr==-1) {
       sprintf(reply,"%s LLB comm fault",who_selected);
 
@@ -10993,7 +11067,7 @@ cmd_lamp(char *args, MsgType msgtype, char *reply)
     return CMD_OK;
   }
 
-  ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,devOnOff,1);
+  ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,devOnOff,1);
   if (ierr<0) {
     sprintf(reply,"%s CALLAMPS='None' MODS LLB unresponsive, LAMP command unavailable",who_selected);
     return CMD_ERR;
@@ -11003,14 +11077,14 @@ cmd_lamp(char *args, MsgType msgtype, char *reply)
   if (strlen(args)<=0) { // Query when no command is issued
     sprintf(who_selected,"LAMP");
 
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VFLATPSET,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VFLATPSET,devOnOff,1);
     vflatPRet = devOnOff[0];
     vflatPOut=-2.033972 + (0.000480 * (float)vflatPRet);
     
     if(vflatPOut < 0.0) vflatPOut = 0.0;
     shm_addr->MODS.vflat_power = vflatPOut;
 
-    ierr=wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,devOnOff,1);
+    ierr=wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,devOnOff,1);
 
     if(!ierr) {   // Reset Shared Memory if address has been cleared
       for(i=0;i<9;i++) {
@@ -11086,7 +11160,7 @@ cmd_lamp(char *args, MsgType msgtype, char *reply)
 	  }
 
 	  vflatShort = (short)vflatPower;
-	  ierr=wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,VFLATPSET,&vflatShort,1);
+	  ierr=wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,VFLATPSET,&vflatShort,1);
 	  nc++;
 	  indexLamp++;
 
@@ -11095,7 +11169,7 @@ cmd_lamp(char *args, MsgType msgtype, char *reply)
 	  // VFLAT getting and processing register:
 	  // vflatPOut = -2.033972 + (0.000480 * vflatPRet)
 	  */
-	  ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VFLATPSET,devOnOff,1);
+	  ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VFLATPSET,devOnOff,1);
 	  vflatPRet = devOnOff[0];
 	  vflatPOut=-2.033972 + (0.000480 * (float)vflatPRet);
 
@@ -11133,7 +11207,7 @@ cmd_lamp(char *args, MsgType msgtype, char *reply)
 
     if (!strcasecmp(temp[1],"OFF")) {
       shm_addr->MODS.lamps.lamplaser_all[0] &= 0x03C0; // Turn off all lamps
-      ierr = wagoSetGet(1, shm_addr->MODS.WAGOIP[llbID], 1, LLBONOFF, &shm_addr->MODS.lamps.lamplaser_all[0], 1);
+      ierr = wagoMirror(1, shm_addr->MODS.WAGOIP[llbID], 1, LLBONOFF, &shm_addr->MODS.lamps.lamplaser_all[0], 1);
 
       for(i=0;i<9;i++) {
 	if(shm_addr->MODS.lamps.lamp_state[i]==1) {
@@ -11164,7 +11238,7 @@ cmd_lamp(char *args, MsgType msgtype, char *reply)
 	      if (i<6) {
 		// This is one of the spectral (pen-ray) lamps
 		shm_addr->MODS.lamps.lamplaser_all[0] |= k;
-		ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+		ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 		shm_addr->MODS.lamps.lamp_state[i]=1;
 	      }
 	      else {
@@ -11173,17 +11247,17 @@ cmd_lamp(char *args, MsgType msgtype, char *reply)
 		  // one if the QTH lamps, turn on the QTH 6V power supply first
 		  if(shm_addr->MODS.lamps.lamp_state[5]==0) {
 		    shm_addr->MODS.lamps.lamplaser_all[0] |= 32;
-		    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+		    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 		    shm_addr->MODS.lamps.lamp_state[5]=1;
 		  }
 		  shm_addr->MODS.lamps.lamplaser_all[0] |= (k*16);
-		  ierr=wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+		  ierr=wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 		  shm_addr->MODS.lamps.lamp_state[i]=1;
 		}
 		else {
 		  // This is the VFLAT lamp
 		  shm_addr->MODS.lamps.lamplaser_all[0] |= (k*16);
-		  ierr=wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+		  ierr=wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 		  shm_addr->MODS.lamps.lamp_state[i]=1;
 		}
 	      }
@@ -11193,12 +11267,12 @@ cmd_lamp(char *args, MsgType msgtype, char *reply)
 	      if (i<6) {
 		// This is one of the spectral (pen-ray) lamps:
 		shm_addr->MODS.lamps.lamplaser_all[0] &= (0x1FFF-k);
-		ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+		ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 
 		// 6V power supply is turned *OFF*, Turn *OFF* all flats
 		if (k==32) {
 		  shm_addr->MODS.lamps.lamplaser_all[0] &= (0x1FFF-0x1C00);
-		  ierr=wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+		  ierr=wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 		  for(int l=5;l<9;l++) {
 		    shm_addr->MODS.lamps.lamp_state[l] = 0;
 		    shm_addr->MODS.lamps.lamp_cycle[l]++;
@@ -11215,20 +11289,20 @@ cmd_lamp(char *args, MsgType msgtype, char *reply)
 
 		if (i!=8) {
 		  shm_addr->MODS.lamps.lamplaser_all[0] &= 0x1FFF-(k*16);
-		  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+		  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 		  shm_addr->MODS.lamps.lamp_state[i]=0;
 		  shm_addr->MODS.lamps.lamp_cycle[i]++;
 		
 		  if (shm_addr->MODS.lamps.lamp_state[6]==0 && shm_addr->MODS.lamps.lamp_state[7]==0) {
 		    shm_addr->MODS.lamps.lamplaser_all[0] &= 0x1FDF;
-		    ierr=wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+		    ierr=wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 		    shm_addr->MODS.lamps.lamp_state[5]=0;
 		    shm_addr->MODS.lamps.lamp_cycle[5]++;
 		  }
 		}
 		else {
 		  shm_addr->MODS.lamps.lamplaser_all[0] &= 0x1FFF-(k*16);
-		  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+		  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 		  shm_addr->MODS.lamps.lamp_state[i]=0;
 		  shm_addr->MODS.lamps.lamp_cycle[i]++;
 		}
@@ -11421,10 +11495,10 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
     // Query when no command is issued
     // Get value for Visable Laser Power Out
     */
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
     regPOut = devOnOff[0];
 
-    ierr=wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,devOnOff,1);
+    ierr=wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,devOnOff,1);
     if(!ierr) { // Reset Shared Memory if address has been cleared
       if(shm_addr->MODS.lasers.vislaser_state==1)
 	shm_addr->MODS.lasers.vislaser_state=0;
@@ -11438,7 +11512,7 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
     /* 
     // Get value for Visable Laser Power Set Point
     */
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
     regPSet = devOnOff[0];
     shm_addr->MODS.lasers.vislaser_setpoint = findPoly((float)regPSet, &shm_addr->MODS.lasers.vislaserRegToPSetCoeff[0], shm_addr->MODS.lasers.vislaserRegToPSetNCoeff);
 
@@ -11462,7 +11536,7 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
     */
     if (shm_addr->MODS.lasers.vislaser_state == 0) {
       shm_addr->MODS.lamps.lamplaser_all[0] |=  64;
-      ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+      ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
       
       shm_addr->MODS.lasers.vislaser_state=1;
       shm_addr->MODS.lasers.visbeam_state=0;
@@ -11489,7 +11563,7 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
 	 // and then send the value to WAGO
 	 */
 	 vispowerShort = (short)reqRegPOut;
-	 ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,
+	 ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,
 			   &vispowerShort,1);
 	 
 	 sleep(2);
@@ -11498,13 +11572,13 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
 	 // Get the reported POut and PSet from the WAGO and store the returned
 	 // value, converted to physical units, in the shared memory
 	 */
-	 ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
+	 ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
 	 regPOut = devOnOff[0];
 	 shm_addr->MODS.lasers.vislaser_power = findPoly((float)regPOut, &shm_addr->MODS.lasers.vislaserRegToPOutCoeff[0], shm_addr->MODS.lasers.vislaserRegToPOutNCoeff);
 
 	 if (shm_addr->MODS.lasers.vislaser_power < 0) shm_addr->MODS.lasers.vislaser_power = 0;
 
-	 ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
+	 ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
 	 regPSet = devOnOff[0];
 	 shm_addr->MODS.lasers.vislaser_setpoint = findPoly((float)regPSet, &shm_addr->MODS.lasers.vislaserRegToPSetCoeff[0], shm_addr->MODS.lasers.vislaserRegToPSetNCoeff);
 	 
@@ -11528,7 +11602,7 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
      
   } else if(!strcasecmp(temp,"OFF")) {
     shm_addr->MODS.lamps.lamplaser_all[0] &= 0x1EBF;
-    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 
     shm_addr->MODS.lasers.vislaser_state=0;
     shm_addr->MODS.lasers.visbeam_state=0;
@@ -11551,7 +11625,7 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
 	  // 'Press' the enable/disable switch
 	  */
 	  shm_addr->MODS.lamps.lamplaser_all[0] |= 256;
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 	  
 	  MilliSleep(500); // Hold the switch down for 0.5 sec 
 
@@ -11559,7 +11633,7 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
 	  // 'Release' the enable/disable switch
 	  */
 	  shm_addr->MODS.lamps.lamplaser_all[0] &= 0x1EFF;
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 	  /*
 	  // Set the Visible Laser Enable/Disable state variable in shared 
 	  // memory
@@ -11587,19 +11661,19 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
 	    // and then send the value to WAGO
 	    */
 	    vispowerShort = (short)reqRegPOut;
-	    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,&vispowerShort,1);
+	    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,&vispowerShort,1);
 	    sleep(2);
 	    /*
 	    // Get the reported POut and PSet from the WAGO and store the
 	    // return value, converted to physical units, in the shared memory
 	    */
-	    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
+	    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
 	    regPOut = devOnOff[0];
 	    shm_addr->MODS.lasers.vislaser_power = findPoly((float)regPOut, &shm_addr->MODS.lasers.vislaserRegToPOutCoeff[0], shm_addr->MODS.lasers.vislaserRegToPOutNCoeff);
 
 	    if (shm_addr->MODS.lasers.vislaser_power < 0) shm_addr->MODS.lasers.vislaser_power = 0;
 
-	    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
+	    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
 	    regPSet = devOnOff[0];
 	    shm_addr->MODS.lasers.vislaser_setpoint = findPoly((float)regPSet, &shm_addr->MODS.lasers.vislaserRegToPSetCoeff[0], shm_addr->MODS.lasers.vislaserRegToPSetNCoeff);
 
@@ -11637,14 +11711,14 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
 	// 'Press' the enable/disable switch
 	*/
 	shm_addr->MODS.lamps.lamplaser_all[0] |= 256;
-	ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+	ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 
 	MilliSleep(500); // Hold the switch down for 0.5 sec 
 	/*
 	// 'Release' the enable/disable switch
 	*/
 	shm_addr->MODS.lamps.lamplaser_all[0] &= 0x1EFF;
-	ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+	ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 	/*
 	// Set the Visible Laser Enable/Disable state variable in shared memory
 	*/
@@ -11671,18 +11745,18 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
 
   } else if(!strcasecmp(temp,"RAWPOWER") && numArgs == 2) {
     vispowerShort = (short)vispower;
-    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,&vispowerShort,1);
+    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,&vispowerShort,1);
     
     sleep(2);
     /*
     // Get the reported POut and PSet from the WAGO and store the returned
     // value, converted to physical units, in the shared memory
     */
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
     regPOut = devOnOff[0];
     shm_addr->MODS.lasers.vislaser_power = findPoly((float)regPOut, &shm_addr->MODS.lasers.vislaserRegToPOutCoeff[0], shm_addr->MODS.lasers.vislaserRegToPOutNCoeff);
     
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
     regPSet = devOnOff[0];
     shm_addr->MODS.lasers.vislaser_setpoint = findPoly((float)regPSet,	&shm_addr->MODS.lasers.vislaserRegToPSetCoeff[0], shm_addr->MODS.lasers.vislaserRegToPSetNCoeff);
     
@@ -11703,14 +11777,14 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
       /*
       // Get value for Visable Laser Power Out
       */
-      ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
+      ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
       regPOut = devOnOff[0];
       shm_addr->MODS.lasers.vislaser_power = findPoly((float)regPOut, &shm_addr->MODS.lasers.vislaserRegToPOutCoeff[0], shm_addr->MODS.lasers.vislaserRegToPOutNCoeff);
 
       /* 
       // Get value for Visable Laser Power Set Point
       */
-      ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
+      ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
       regPSet = devOnOff[0];
       shm_addr->MODS.lasers.vislaser_setpoint = findPoly((float)regPSet, &shm_addr->MODS.lasers.vislaserRegToPSetCoeff[0], shm_addr->MODS.lasers.vislaserRegToPSetNCoeff);
       
@@ -11741,7 +11815,7 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
         // and then send the value to WAGO
 	*/
 	vispowerShort = (short)reqRegPOut;
-	ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,&vispowerShort,1);
+	ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,&vispowerShort,1);
 
 	sleep(2);
 
@@ -11749,11 +11823,11 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
         // Get the reported POut and PSet from the WAGO and store the returned
         // value, converted to physical units, in the shared memory
 	*/
-	ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
+	ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
 	regPOut = devOnOff[0];
 	shm_addr->MODS.lasers.vislaser_power = findPoly((float)regPOut, &shm_addr->MODS.lasers.vislaserRegToPOutCoeff[0], shm_addr->MODS.lasers.vislaserRegToPOutNCoeff);
 
-	ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
+	ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
 	regPSet = devOnOff[0];
 	shm_addr->MODS.lasers.vislaser_setpoint = findPoly((float)regPSet, &shm_addr->MODS.lasers.vislaserRegToPSetCoeff[0], shm_addr->MODS.lasers.vislaserRegToPSetNCoeff);
 
@@ -11779,14 +11853,14 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
     /* 
     // Get value for Visable Laser Power Out
     */
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
     regPOut = devOnOff[0];
     shm_addr->MODS.lasers.vislaser_power = findPoly((float)regPOut, &shm_addr->MODS.lasers.vislaserRegToPOutCoeff[0], shm_addr->MODS.lasers.vislaserRegToPOutNCoeff);
 
     /* 
     // Get value for Visable Laser Power Set Point
     */
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
     regPSet = devOnOff[0];
     shm_addr->MODS.lasers.vislaser_setpoint = findPoly((float)regPSet,	&shm_addr->MODS.lasers.vislaserRegToPSetCoeff[0], shm_addr->MODS.lasers.vislaserRegToPSetNCoeff);
 
@@ -11804,7 +11878,7 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
     
   } else if(!strcasecmp(temp,"RESET")) {
     shm_addr->MODS.lamps.lamplaser_all[0] &= 0x1EBF; // Turn the laser off
-    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 
     shm_addr->MODS.lasers.vislaser_state=0;
     shm_addr->MODS.lasers.visbeam_state=0;
@@ -11813,14 +11887,14 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
     sleep(2);
 
     shm_addr->MODS.lamps.lamplaser_all[0] |=  64; // Turn the laser on
-    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 
     shm_addr->MODS.lasers.vislaser_state=1;
     shm_addr->MODS.lasers.visbeam_state=0;
  
     vispower = 0; // Set the power setpoint to zero
     vispowerShort = (short)vispower;
-    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,&vispowerShort,1);
+    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,&vispowerShort,1);
 
     sleep(2);
 
@@ -11828,11 +11902,11 @@ cmd_vislaser(char *args, MsgType msgtype, char *reply)
     // Get the reported POut and PSet from the WAGO and store the returned
     // value, converted to physical units, in the shared memory
     */
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPOUTWAGO,devOnOff,1);
     regPOut = devOnOff[0];
     shm_addr->MODS.lasers.vislaser_power = findPoly((float)regPOut, &shm_addr->MODS.lasers.vislaserRegToPOutCoeff[0], shm_addr->MODS.lasers.vislaserRegToPOutNCoeff);
 
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,VISPSETWAGO,devOnOff,1);
     regPSet = devOnOff[0];
     shm_addr->MODS.lasers.vislaser_setpoint = findPoly((float)regPSet,	&shm_addr->MODS.lasers.vislaserRegToPSetCoeff[0], shm_addr->MODS.lasers.vislaserRegToPSetNCoeff);
  
@@ -11917,12 +11991,12 @@ cmd_irlaser(char *args, MsgType msgtype, char *reply)
     // Query when no command is issued
     // Get value for IR Laser Temperature Set Point
     */
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRTSETWAGO,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRTSETWAGO,devOnOff,1);
 
      /* 
      // Reset Shared Memory if address has been cleared
      */
-     if(!wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,devOnOff,1)){
+     if(!wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,devOnOff,1)){
        if(shm_addr->MODS.lasers.irlaser_state==1)
 	 shm_addr->MODS.lasers.irlaser_state=0;
        if(shm_addr->MODS.lasers.irbeam_state==1)
@@ -11937,20 +12011,20 @@ cmd_irlaser(char *args, MsgType msgtype, char *reply)
      /* 
      // Get value for IR Laser Temperature Out
      */
-     ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRTOUTWAGO,devOnOff,1);
+     ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRTOUTWAGO,devOnOff,1);
      shm_addr->MODS.lasers.irlaser_temp = findPoly((float)ierr, &shm_addr->MODS.lasers.irlaserRegToTOutCoeff[0], shm_addr->MODS.lasers.irlaserRegToTOutNCoeff);
 
      /* 
      // Get value for IR Laser Power Set Point
      */
-     ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,devOnOff,1);
+     ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,devOnOff,1);
      regPSet = devOnOff[0];
      shm_addr->MODS.lasers.irlaser_setpoint = findPoly((float)regPSet,	&shm_addr->MODS.lasers.irlaserRegToPSetCoeff[0], shm_addr->MODS.lasers.irlaserRegToPSetNCoeff);
 
      /* 
      // Get value for IR Laser Power Out
      */	
-     ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRPOUTWAGO,devOnOff,1);
+     ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRPOUTWAGO,devOnOff,1);
      regPOut = devOnOff[0];
      shm_addr->MODS.lasers.irlaser_power = findPoly((float)regPOut, &shm_addr->MODS.lasers.irlaserRegToPOutCoeff[0], shm_addr->MODS.lasers.irlaserRegToPOutNCoeff);
 
@@ -11978,7 +12052,7 @@ cmd_irlaser(char *args, MsgType msgtype, char *reply)
   if(!strcasecmp(temp,"ON")) { // if the laser is off, turn it on
     if (shm_addr->MODS.lasers.irlaser_state == 0) {
         shm_addr->MODS.lamps.lamplaser_all[0] |=  128;
-        ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+        ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 
         shm_addr->MODS.lasers.irlaser_state=1;
         shm_addr->MODS.lasers.irbeam_state=0;
@@ -12002,18 +12076,18 @@ cmd_irlaser(char *args, MsgType msgtype, char *reply)
 	// and then send the value to WAGO
 	*/
 	irpowerShort = (short)reqRegPOut;
-	ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,&irpowerShort,1);
+	ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,&irpowerShort,1);
 
 	sleep(2);
 	/*
 	// Get the reported POut and PSet from the WAGO and store the returned
 	// value, converted to physical units, in the shared memory
 	*/
-	ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRPOUTWAGO,devOnOff,1);
+	ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRPOUTWAGO,devOnOff,1);
 	regPOut = devOnOff[0];
 	shm_addr->MODS.lasers.irlaser_power = findPoly((float)regPOut,	&shm_addr->MODS.lasers.irlaserRegToPOutCoeff[0], shm_addr->MODS.lasers.irlaserRegToPOutNCoeff);
 
-	ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,devOnOff,1);
+	ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,devOnOff,1);
 	regPSet = devOnOff[0];
 	shm_addr->MODS.lasers.irlaser_setpoint = findPoly((float)regPSet, &shm_addr->MODS.lasers.irlaserRegToPSetCoeff[0], shm_addr->MODS.lasers.irlaserRegToPSetNCoeff);
 
@@ -12038,7 +12112,7 @@ cmd_irlaser(char *args, MsgType msgtype, char *reply)
 
   } else if(!strcasecmp(temp,"OFF")) {
     shm_addr->MODS.lamps.lamplaser_all[0] &= 0x1D7F;
-    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 
     shm_addr->MODS.lasers.irlaser_state=0;
     shm_addr->MODS.lasers.irbeam_state=0;
@@ -12062,14 +12136,14 @@ cmd_irlaser(char *args, MsgType msgtype, char *reply)
 	// 'Press' the enable/disable switch
 	*/
 	shm_addr->MODS.lamps.lamplaser_all[0] |= 512;
-	ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+	ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 	
 	MilliSleep(500); // Hold the switch down for 0.5 sec 
 	/*
 	// 'Release' the enable/disable switch
 	*/
 	shm_addr->MODS.lamps.lamplaser_all[0] &= 0x1DFF;
-	ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+	ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 
 	/*
 	// Set the IR Laser Enable/Disable state variable in shared memory
@@ -12096,20 +12170,20 @@ cmd_irlaser(char *args, MsgType msgtype, char *reply)
 	  // and then send the value to WAGO
 	  */
 	  irpowerShort = (short)reqRegPOut;
-	  ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,&irpowerShort,1);
+	  ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,&irpowerShort,1);
 	  sleep(2);
 	  /*
 	  // Get the reported POut and PSet from the WAGO and store the
 	  // returned value, converted to physical units, in the shared 
 	  // memory
 	  */
-	  ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRPOUTWAGO,devOnOff,1);
+	  ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRPOUTWAGO,devOnOff,1);
 	  regPOut = devOnOff[0];
 	  shm_addr->MODS.lasers.irlaser_power = findPoly((float)regPOut, &shm_addr->MODS.lasers.irlaserRegToPOutCoeff[0], shm_addr->MODS.lasers.irlaserRegToPOutNCoeff);
 	  
 	  if (shm_addr->MODS.lasers.irlaser_power < 0) shm_addr->MODS.lasers.irlaser_power = 0;
 
-	  ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,devOnOff,1);
+	  ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,devOnOff,1);
 	  regPSet = devOnOff[0];
 	  shm_addr->MODS.lasers.irlaser_setpoint = findPoly((float)regPSet, &shm_addr->MODS.lasers.irlaserRegToPSetCoeff[0], shm_addr->MODS.lasers.irlaserRegToPSetNCoeff);
 
@@ -12149,14 +12223,14 @@ cmd_irlaser(char *args, MsgType msgtype, char *reply)
 	// 'Press' the enable/disable switch
 	*/
 	shm_addr->MODS.lamps.lamplaser_all[0] |= 512;
-	ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+	ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 
 	MilliSleep(500); // Hold the switch down for 0.5 sec 
 	/*
 	// 'Release' the enable/disable switch
 	*/
 	shm_addr->MODS.lamps.lamplaser_all[0] &= 0x1DFF;
-	ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+	ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 	/*
 	// Set the IR Laser Enable/Disable state variable in shared memory
 	*/
@@ -12190,18 +12264,18 @@ cmd_irlaser(char *args, MsgType msgtype, char *reply)
     // and then send the value to WAGO
     */
     irpowerShort = (short)irpower;
-    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,&irpowerShort,1);
+    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,&irpowerShort,1);
 
     sleep(2);
     /*
     // Get the reported POut and PSet from the WAGO and store the returned
     // value, converted to physical units, in the shared memory
     */
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRPOUTWAGO,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRPOUTWAGO,devOnOff,1);
     regPOut = devOnOff[0];
     shm_addr->MODS.lasers.irlaser_power = findPoly((float)regPOut, &(shm_addr->MODS.lasers.irlaserRegToPOutCoeff[0]), shm_addr->MODS.lasers.irlaserRegToPOutNCoeff);
 
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,devOnOff,1);
     regPSet = devOnOff[0];
     shm_addr->MODS.lasers.irlaser_setpoint = findPoly((float)regPSet, &(shm_addr->MODS.lasers.irlaserRegToPSetCoeff[0]), shm_addr->MODS.lasers.irlaserRegToPSetNCoeff);
 
@@ -12225,26 +12299,26 @@ cmd_irlaser(char *args, MsgType msgtype, char *reply)
       /* 
       // Get value for IR Laser Temperature Set Point
       */
-      ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRTSETWAGO,devOnOff,1);
+      ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRTSETWAGO,devOnOff,1);
       shm_addr->MODS.lasers.irlaser_tempSet = findPoly((float)ierr, &shm_addr->MODS.lasers.irlaserRegToTSetCoeff[0], shm_addr->MODS.lasers.irlaserRegToTSetNCoeff);
 	
       /* 
       // Get value for IR Laser Temperature Out
       */
-      ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRTOUTWAGO,devOnOff,1);
+      ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRTOUTWAGO,devOnOff,1);
       shm_addr->MODS.lasers.irlaser_temp = findPoly((float)ierr, &shm_addr->MODS.lasers.irlaserRegToTOutCoeff[0], shm_addr->MODS.lasers.irlaserRegToTOutNCoeff);
 
       /* 
       // Get value for IR Laser Power Set Point
       */
-      ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,devOnOff,1);
+      ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,devOnOff,1);
       regPSet = devOnOff[0];
       shm_addr->MODS.lasers.irlaser_setpoint = findPoly((float)regPSet, &shm_addr->MODS.lasers.irlaserRegToPSetCoeff[0], shm_addr->MODS.lasers.irlaserRegToPSetNCoeff);
 
       /* 
       // Get value for IR Laser Power Out
       */	
-      ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRPOUTWAGO,devOnOff,1);
+      ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRPOUTWAGO,devOnOff,1);
       regPOut = devOnOff[0];
       
       shm_addr->MODS.lasers.irlaser_power = findPoly((float)regPOut,	&shm_addr->MODS.lasers.irlaserRegToPOutCoeff[0], shm_addr->MODS.lasers.irlaserRegToPOutNCoeff);
@@ -12277,18 +12351,18 @@ cmd_irlaser(char *args, MsgType msgtype, char *reply)
         // and then send the value to WAGO
 	*/
 	irpowerShort = (short)irpower;
-	ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,&irpowerShort,1);
+	ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,&irpowerShort,1);
 	sleep(2);
 
 	/*
         // Get the reported POut and PSet from the WAGO and store the returned
         // value, converted to physical units, in the shared memory
 	*/
-	ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRPOUTWAGO,devOnOff,1);
+	ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRPOUTWAGO,devOnOff,1);
 	regPOut = devOnOff[0];
 	shm_addr->MODS.lasers.irlaser_power = findPoly((float)regPOut,	&(shm_addr->MODS.lasers.irlaserRegToPOutCoeff[0]), shm_addr->MODS.lasers.irlaserRegToPOutNCoeff);
 
-	ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,devOnOff,1);
+	ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,devOnOff,1);
 	regPSet = devOnOff[0];
 	shm_addr->MODS.lasers.irlaser_setpoint = findPoly((float)regPSet, &(shm_addr->MODS.lasers.irlaserRegToPSetCoeff[0]), shm_addr->MODS.lasers.irlaserRegToPSetNCoeff);
  
@@ -12328,7 +12402,7 @@ cmd_irlaser(char *args, MsgType msgtype, char *reply)
     
   } else if(!strcasecmp(temp,"RESET")) { 
     shm_addr->MODS.lamps.lamplaser_all[0] &= 0x1D7F; // Turn the laser off
-    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 
     shm_addr->MODS.lasers.irlaser_state=0;
     shm_addr->MODS.lasers.irbeam_state=0;
@@ -12337,39 +12411,39 @@ cmd_irlaser(char *args, MsgType msgtype, char *reply)
     sleep(2);
     
     shm_addr->MODS.lamps.lamplaser_all[0] |=  128; // Turn the laser on
-    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
+    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,LLBONOFF,&shm_addr->MODS.lamps.lamplaser_all[0],1);
 
     shm_addr->MODS.lasers.irlaser_state=1;
     shm_addr->MODS.lasers.irbeam_state=0;
     
     
     irpowerShort = (short)irpower; // Set the power setpoint to zero
-    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,&irpowerShort,1);
+    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,&irpowerShort,1);
     sleep(2);
 
     /*
     // Get everything back and report to the user
     // Get value for IR Laser Temperature Set Point
     */
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRTSETWAGO,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRTSETWAGO,devOnOff,1);
     shm_addr->MODS.lasers.irlaser_tempSet = findPoly((float)ierr, &shm_addr->MODS.lasers.irlaserRegToTSetCoeff[0], shm_addr->MODS.lasers.irlaserRegToTSetNCoeff);
     /*    
     // Get value for IR Laser Temperature Out 
     */
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRTOUTWAGO,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRTOUTWAGO,devOnOff,1);
     shm_addr->MODS.lasers.irlaser_temp = findPoly((float)ierr,	&shm_addr->MODS.lasers.irlaserRegToTOutCoeff[0], shm_addr->MODS.lasers.irlaserRegToTOutNCoeff);
 
     /*
     // Get value for IR Laser Power Set Point
     */
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRPSETWAGO,devOnOff,1);
     regPSet = devOnOff[0];
     shm_addr->MODS.lasers.irlaser_setpoint = findPoly((float)regPSet, &shm_addr->MODS.lasers.irlaserRegToPSetCoeff[0], shm_addr->MODS.lasers.irlaserRegToPSetNCoeff);
 
     /*
     // Get value for IR Laser Power Out
     */
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[llbID],1,IRPOUTWAGO,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[llbID],1,IRPOUTWAGO,devOnOff,1);
     regPOut = devOnOff[0];
     shm_addr->MODS.lasers.irlaser_power = findPoly((float)regPOut, &shm_addr->MODS.lasers.irlaserRegToPOutCoeff[0], shm_addr->MODS.lasers.irlaserRegToPOutNCoeff);
 
@@ -12506,7 +12580,7 @@ cmd_power65(char *args, MsgType msgtype, char *reply)
   GetArg(args,1,argbuf);
   
   if(!strcasecmp(argbuf,"READ")) {
-    ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[ieb1ID],1,513,devOnOff,1);
+    ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[ieb1ID],1,513,devOnOff,1);
     if(!ierr)
       sprintf(reply,"65 DVC power supply is ON, POWER65=ON");
     else {
@@ -12515,12 +12589,12 @@ cmd_power65(char *args, MsgType msgtype, char *reply)
     }
 
   } else if(!strcasecmp(argbuf,"OFF")) {
-    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[ieb1ID],1,513,(short *)1,1);
+    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[ieb1ID],1,513,(short *)1,1);
 
     sprintf(reply,"[%d]65 DVC power supply is OFF",ierr);
 
   } else if(!strcasecmp(argbuf,"ON")) {
-    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[ieb1ID],1,513,(short *)0,1);
+    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[ieb1ID],1,513,(short *)0,1);
     sprintf(reply,"[%d]65 DVC power supply is ON",ierr);
 
   } else {
@@ -12683,7 +12757,7 @@ cmd_ieb(char *args, MsgType msgtype, char *reply)
       iebID = toupper(iebID);
 
       ieb_id=iebIDval-1;
-      ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[ieb_id],1,514,regData,1);
+      ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[ieb_id],1,514,regData,1);
       if (ierr&=0x2)
 	sprintf(reply,"IEB GLYCOL=NOFLOW");
       else
@@ -12701,9 +12775,9 @@ cmd_ieb(char *args, MsgType msgtype, char *reply)
       if (!strcasecmp(argbuf,"ON")) {
 	onoff[0]=0; // Turn on the 65V power supply
 	onoff[1]=1;
-	ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[ieb_id],1,514,&onoff[0],1);
+	ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[ieb_id],1,514,&onoff[0],1);
 	MilliSleep(100);
-	ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[ieb_id],1,514,regData,1);
+	ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[ieb_id],1,514,regData,1);
 	if (!ierr)
 	  sprintf(reply,"IEB MPOWER_%c=ON",iebID);
 	else
@@ -12712,9 +12786,9 @@ cmd_ieb(char *args, MsgType msgtype, char *reply)
       else if (!strcasecmp(argbuf,"OFF")) {
 	onoff[0]=1; // Turn off the 65V power supply
 	onoff[1]=1;
-	ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[ieb_id],1,514,&onoff[0],1);
+	ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[ieb_id],1,514,&onoff[0],1);
 	MilliSleep(100);
-	ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[ieb_id],1,514,regData,1);
+	ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[ieb_id],1,514,regData,1);
 	if (!ierr)
 	  sprintf(reply,"IEB IEB_%c=OFF",iebID);
 	else
@@ -12759,7 +12833,7 @@ cmd_ieb(char *args, MsgType msgtype, char *reply)
       GetArg(args,1,&iebID);
       iebID = toupper(iebID);
       ieb_id=iebIDval-1;
-      ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[ieb_id],1,0,devOnOff,1);
+      ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[ieb_id],1,0,devOnOff,1);
       vdrive = ((float)(devOnOff[0])/pow(2,15)*10)*9.28;
       sprintf(reply,"%s %s_%c=%0.3f",who_selected,argbuf,iebID,vdrive);
       return CMD_OK;
@@ -12772,7 +12846,7 @@ cmd_ieb(char *args, MsgType msgtype, char *reply)
       GetArg(args,1,&iebID);
       iebID = toupper(iebID);
       ieb_id=iebIDval-1;
-      ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[ieb_id],1,2,devOnOff,1);
+      ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[ieb_id],1,2,devOnOff,1);
       idrive = ((float)(devOnOff[0])/pow(2,15)*10)*1.25;
       sprintf(reply,"%s %s_%c=%0.3f",who_selected,argbuf,iebID,idrive);
       return CMD_OK;
@@ -12785,7 +12859,7 @@ cmd_ieb(char *args, MsgType msgtype, char *reply)
       GetArg(args,1,&iebID);
       iebID = toupper(iebID);
       ieb_id=iebIDval-1;
-      ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[ieb_id],2,0,devOnOff,1);
+      ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[ieb_id],2,0,devOnOff,1);
       vcontrol = ((float)(devOnOff[0])/pow(2,15)*10)*3.12;
       sprintf(reply,"%s %s_%c=%0.3f",who_selected,argbuf,iebID,vcontrol);
       return CMD_OK;
@@ -12832,20 +12906,20 @@ cmd_ieb(char *args, MsgType msgtype, char *reply)
       if (!strcasecmp(argbuf,"RESET")) {
 	// Turn it off
 
-	ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[ieb_id],1,512,devOnOff,1);
+	ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[ieb_id],1,512,devOnOff,1);
 	onoff[0] = devOnOff[0];
 	onoff[0] |= (short )bits[cmd];
 
-	ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[ieb_id],1,512,onoff,1);
+	ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[ieb_id],1,512,onoff,1);
 
 	MilliSleep(500); // Wait 500ms and let it adjust
 
 	// Now Turn it on 
 
-	ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[ieb_id],1,512,devOnOff,1);
+	ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[ieb_id],1,512,devOnOff,1);
 	onoff[0] = devOnOff[0];
 	onoff[0]&=onoff[0] ^ (short)bits[cmd];
-	ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[ieb_id],1,512,onoff,1);
+	ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[ieb_id],1,512,onoff,1);
 
 	if (cmd==0 || cmd>18) {
 	  sprintf(reply,"%s",who_selected);
@@ -12857,7 +12931,7 @@ cmd_ieb(char *args, MsgType msgtype, char *reply)
 
       }
       else if (!strcasecmp(argbuf,"STATUS") || cmd==0) {
-	ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[ieb_id],1,514,regData,1);
+	ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[ieb_id],1,514,regData,1);
 	if (ierr < 0) {
 	  sprintf(reply,"%s IEB_%c=OFF",who_selected,iebID);
 	  return CMD_ERR;
@@ -12878,10 +12952,10 @@ cmd_ieb(char *args, MsgType msgtype, char *reply)
       else if (!strcasecmp(argbuf,"ON")) {
 	if(cmd>18) cmd+=18; // BLUE IEB starts at 18-33 in Shared Memory
 
-	ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[ieb_id],1,512,devOnOff,1);
+	ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[ieb_id],1,512,devOnOff,1);
 	onoff[0] = devOnOff[0];
 	onoff[0]&=onoff[0] ^ (short)bits[cmd];
-	ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[ieb_id],1,512,onoff,1);
+	ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[ieb_id],1,512,onoff,1);
 
 	sprintf(reply,"IEB MLC%d_%c=ON",cmd,iebID);
 	
@@ -12889,11 +12963,11 @@ cmd_ieb(char *args, MsgType msgtype, char *reply)
       else if(!strcasecmp (argbuf,"OFF")) {
 	if(cmd>18) cmd+=18; // BLUE IEB starts at 18-33 in Shared Memory
 
-	ierr = wagoSetGet(0,shm_addr->MODS.WAGOIP[ieb_id],1,512,devOnOff,1);
+	ierr = wagoMirror(0,shm_addr->MODS.WAGOIP[ieb_id],1,512,devOnOff,1);
 	onoff[0] = devOnOff[0];
 
 	onoff[0]|=(short)bits[cmd];
-	ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[ieb_id],1,512,onoff,1);
+	ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[ieb_id],1,512,onoff,1);
 
 	sprintf(reply,"IEB MLC%d_%c=OFF",cmd,iebID);
 	
@@ -13303,6 +13377,681 @@ cmd_loadplc(char *args, MsgType msgtype, char *reply)
   return CMD_OK;
 }
 #endif
+/* ***************************************************************************
+//
+// Per-mechanism command queues
+//
+// The mmcServer runs commands on a pool of worker threads.  Each
+// MicroLynx controller is on its own serial/IP port, so commands for
+// different mechanisms may run at the same time, but two commands for
+// the same mechanism must not interleave on its port.  Every
+// mechanism has a FIFO command queue (a ticket lock), and a command
+// waits its turn on the queues of all mechanisms it drives before its
+// cmd_xxx() action function runs.  The last queue, MMC_WAGOQ, guards
+// the WAGO power and IEB/LLB/HEB/Utility Box interfaces.  The
+// background state poller (statePoller()) takes a mechanism's queue
+// the same way, but only while nothing else holds or waits on it.
+// Closing, reopening or reconfiguring the ports holds every queue and
+// stops the poller for the duration (queueHoldAll()).
+//
+//---------------------------------------------------------------------------
+*/
+
+#define MMC_WAGOQ  MAX_ML      // WAGO/IEB power queue
+#define MMC_NQUEUE (MAX_ML+1)  // number of command queues
+
+static pthread_mutex_t queueLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  queueTurn = PTHREAD_COND_INITIALIZER;
+static unsigned long queueNext[MMC_NQUEUE];    // next ticket to hand out
+static unsigned long queueServing[MMC_NQUEUE]; // ticket now allowed to run
+static __thread int cmdDepth;  // >0 while running a command (nested KeyCommand()s)
+static pthread_mutex_t pollLock = PTHREAD_MUTEX_INITIALIZER; // held by each poller cycle
+
+/*
+ * Queues used by commands that do not just drive the mechanism they
+ * are named for.  "$1" is the mechanism named by the first argument,
+ * "wago" the WAGO/IEB power queue, and "*" every queue (the command
+ * runs alone).  Commands not listed use the queue of the mechanism
+ * with the same name, if there is one, otherwise no queue.  Commands
+ * that must not wait (quit, ping, help, ...) are simply not mechanisms.
+ */
+
+static struct {
+  const char *cmd;      // command name
+  const char *queues;   // space-separated list of queues
+} cmdQueues[] = {
+  {"agw",      "agwx agwy agwfoc agwfilt calib"},
+  {"agwx",     "agwx calib"},
+  {"agwy",     "agwy calib"},
+  {"agwfoc",   "agwfoc calib"},
+  {"gprobe",   "agwx agwy calib"},
+  {"gpfocus",  "agwfoc calib"},
+  {"rcolfoc",  "rcolttfa rcolttfb rcolttfc"},
+  {"bcolfoc",  "bcolttfa bcolttfb bcolttfc"},
+  {"rimcs",    "rimcs rcolttfa rcolttfb rcolttfc"},
+  {"bimcs",    "bimcs bcolttfa bcolttfb bcolttfc"},
+  {"minsert",  "minsert mselect"},
+  {"mselect",  "minsert mselect"},
+  {"slitmask", "minsert mselect"},
+  {"mstatus",  "$1"},
+  {"moverel",  "$1"},
+  {"moveabs",  "$1"},
+  {"lamp",     "wago"},
+  {"irlaser",  "wago"},
+  {"vislaser", "wago"},
+  {"ieb",      "wago"},
+  {"util",     "wago"},
+  {"llb",      "wago"},
+  {"heb",      "wago"},
+  {"estatus",  "wago"},
+  {"pstatus",  "wago"},
+  {"istatus",  "wago"},
+  {"calmode",  "wago hatch calib agwx agwy agwfoc"},
+  {"obsmode",  "wago hatch calib agwx agwy agwfoc"},
+  {"open",     "*"},
+  {"close",    "*"},
+  {"setport",  "*"},
+  {"config",   ""}     // each step takes its own queues, see cmd_config()
+};
+
+//---------------------------------------------------------------------------
+//
+// Command lookup
+//
+// cmdtab[] is fixed at compile time, so cmdIndexBuild() hashes its
+// names once at startup (case-folded, see nameHash() in libislutils)
+// and resolves each command's queue list from cmdQueues[].  Mechanism
+// names are hashed in shared memory by mechIndexBuild() whenever
+// mechanisms.ini is loaded, see getMechanismID().
+//
+
+#define CMD_HASHSIZE 256  // command hash slots, power of 2 > 2*NumCommands
+#define CMD_NTAB (int)(sizeof(cmdtab)/sizeof(cmdtab[0]))
+
+static short cmdHash[CMD_HASHSIZE];      // cmdtab[] index+1, 0 if empty
+static const char *cmdQueueList[CMD_NTAB];  // queues used by each command
+
+/*!
+  \brief Build the command name hash and per-command queue lists
+
+  Called once by the mmcServer main() before any commands are taken.
+  The first of several commands with the same name wins, as in the
+  linear search it replaces.
+*/
+
+void
+cmdIndexBuild(void)
+{
+  int i, j, slot;
+
+  memset(cmdHash,0,sizeof(cmdHash));
+  for (i=0; i<CMD_NTAB; i++) {
+    slot = nameHash(cmdtab[i].cmd) & (CMD_HASHSIZE-1);
+    while (cmdHash[slot] != 0 && strcasecmp(cmdtab[cmdHash[slot]-1].cmd,cmdtab[i].cmd) != 0)
+      slot = (slot+1) & (CMD_HASHSIZE-1);
+    if (cmdHash[slot] == 0) cmdHash[slot] = i+1;
+
+    cmdQueueList[i] = cmdtab[i].cmd;
+    for (j=0; j<(int)(sizeof(cmdQueues)/sizeof(cmdQueues[0])); j++) {
+      if (strcasecmp(cmdQueues[j].cmd,cmdtab[i].cmd)==0) {
+	cmdQueueList[i] = cmdQueues[j].queues;
+	break;
+      }
+    }
+  }
+}
+
+/*!
+  \brief Find a command in cmdtab[]
+  \param cmd command name, case-insensitive, no abbreviations
+  \return index in cmdtab[], or -1 if not a command
+*/
+
+static int
+cmdLookup(char *cmd)
+{
+  int slot;
+
+  slot = nameHash(cmd) & (CMD_HASHSIZE-1);
+  while (cmdHash[slot] != 0) {
+    if (strcasecmp(cmdtab[cmdHash[slot]-1].cmd,cmd)==0) return cmdHash[slot]-1;
+    slot = (slot+1) & (CMD_HASHSIZE-1);
+  }
+  return -1;
+}
+
+//---------------------------------------------------------------------------
+//
+// queueID() - queue index for a mechanism or queue name
+//
+// Unlike getMechanismID() this wants an exact (case-insensitive) name,
+// and returns -1 for names that are not mechanisms.
+//
+
+static int
+queueID(const char *name)
+{
+  int dev;
+
+  if (strcasecmp(name,"wago")==0) return MMC_WAGOQ;
+  if ((dev=mechIndex((char *)name)) >= 0) return dev;
+  for (dev=0; dev<MAX_ML; dev++)
+    if (strlen(shm_addr->MODS.who[dev])>0 &&
+	strcasecmp(shm_addr->MODS.who[dev],name)==0) return dev;
+  return -1;
+}
+
+//---------------------------------------------------------------------------
+//
+// commandQueues() - mark the queues command icmd with args must wait on
+//
+
+static void
+commandQueues(int icmd, char *args, char need[])
+{
+  char list[BIG_STR_SIZE];
+  char name[MAXPGMLINE];
+  char *tok;
+  char *save;
+  int i, n;
+
+  memset(need,0,MMC_NQUEUE);
+
+  strcpy(list,cmdQueueList[icmd]);
+
+  for (tok=strtok_r(list," ",&save); tok!=NULL; tok=strtok_r(NULL," ",&save)) {
+    if (strcmp(tok,"*")==0) {
+      memset(need,1,MMC_NQUEUE);
+      return;
+    }
+    if (strcmp(tok,"$1")==0) {
+      memset(name,0,sizeof(name));
+      if (sscanf(args,"%79s",name)!=1) continue;
+      tok = name;
+    }
+    if ((n=queueID(tok))>=0) need[n] = 1;
+  }
+}
+
+//---------------------------------------------------------------------------
+//
+// runAction() - run a command action function in its mechanism queues
+//
+
+/*!
+  \brief Run a command action function on its mechanism queues
+  \param icmd index of the command in cmdtab[]
+  \param args string with the command arguments
+  \param msgtype message type, passed to the action function
+  \param reply string to contain the command return reply
+  \return the action function's return code
+
+  Waits its turn in the FIFO queue of every mechanism the command
+  drives (see cmdQueues[]), runs the action function, then passes each
+  queue to the next waiting command.  Tickets for all of a command's
+  queues are taken together, so commands run in arrival order on every
+  queue they share and can never deadlock.  Commands for different
+  mechanisms run concurrently, so setting up the red and blue channels
+  together takes as long as the slower channel rather than the sum of
+  both.  Commands an action function runs itself with KeyCommand() are
+  covered by the outer command's queues and do not queue again.
+
+  \sa KeyCommand(), SocketCommand()
+*/
+
+static int
+runAction(int icmd, char *args, MsgType msgtype, char *reply)
+{
+  char need[MMC_NQUEUE];
+  unsigned long ticket[MMC_NQUEUE];
+  int saveID = commandID;
+  int status;
+  int i;
+
+  commandID = icmd; // save to identify mechanism name
+
+  if (cmdDepth > 0) {
+    cmdDepth++;
+    status = cmdtab[icmd].action(args,msgtype,reply);
+    cmdDepth--;
+    commandID = saveID;
+    return status;
+  }
+
+  commandQueues(icmd,args,need);
+
+  // Take a ticket on every queue at once, so a command never waits on
+  // a later one, then wait until all of them come up
+
+  pthread_mutex_lock(&queueLock);
+  for (i=0; i<MMC_NQUEUE; i++)
+    if (need[i]) ticket[i] = queueNext[i]++;
+  for (i=0; i<MMC_NQUEUE; i++)
+    while (need[i] && ticket[i]!=queueServing[i])
+      pthread_cond_wait(&queueTurn,&queueLock);
+  pthread_mutex_unlock(&queueLock);
+
+  cmdDepth++;
+  status = cmdtab[icmd].action(args,msgtype,reply);
+  cmdDepth--;
+  mlcPrefetchDone();
+
+  pthread_mutex_lock(&queueLock);
+  for (i=0; i<MMC_NQUEUE; i++)
+    if (need[i]) queueServing[i]++;
+  pthread_cond_broadcast(&queueTurn);
+  pthread_mutex_unlock(&queueLock);
+
+  commandID = saveID;
+  return status;
+}
+
+//---------------------------------------------------------------------------
+//
+// config - set up a whole instrument configuration in one command
+//
+// configGraph[] lists the mechanism commands a CONFIG may include and,
+// for each, the commands that must finish first when both are in the
+// same CONFIG (a grating tilt after its grating turret, the mask insert
+// after the mask select, a collimator actuator after the collimator
+// focus).  Each step runs in its own thread through runAction(), so it
+// still waits its turn on its mechanism queues, and steps with nothing
+// in common move at the same time on their IEBs.
+//
+
+static struct {
+  const char *cmd;    // mechanism command
+  const char *after;  // commands that must finish first, space-separated
+} configGraph[] = {
+  {"dichroic", ""},
+  {"slitmask", ""},
+  {"mselect",  "slitmask"},
+  {"minsert",  "slitmask mselect"},
+  {"rgrating", ""},
+  {"bgrating", ""},
+  {"rgrtilt1", "rgrating"},
+  {"rgrtilt2", "rgrating"},
+  {"rgrtilt3", "rgrating"},
+  {"rgrtilt4", "rgrating"},
+  {"bgrtilt1", "bgrating"},
+  {"bgrtilt2", "bgrating"},
+  {"bgrtilt3", "bgrating"},
+  {"bgrtilt4", "bgrating"},
+  {"rfilter",  ""},
+  {"bfilter",  ""},
+  {"rcamfoc",  ""},
+  {"bcamfoc",  ""},
+  {"rcolfoc",  ""},
+  {"bcolfoc",  ""},
+  {"rcolttfa", "rcolfoc"},
+  {"rcolttfb", "rcolfoc"},
+  {"rcolttfc", "rcolfoc"},
+  {"bcolttfa", "bcolfoc"},
+  {"bcolttfb", "bcolfoc"},
+  {"bcolttfc", "bcolfoc"},
+  {"agwfilt",  ""}
+};
+
+#define CONFIG_MAXSTEPS (int)(sizeof(configGraph)/sizeof(configGraph[0]))
+
+struct config_run;
+
+struct config_step {
+  struct config_run *run;       // the CONFIG this step belongs to
+  int icmd;                     // cmdtab[] index of the command
+  char args[MAXPGMLINE];        // command arguments
+  char after[CONFIG_MAXSTEPS];  // 1 for each step that must finish first
+  int done;                     // 1 once the step has finished
+  int status;                   // action function return code
+  char reply[MMC_REPLYSIZE];    // action function reply
+};
+
+struct config_run {
+  pthread_mutex_t lock;         // protects done and status
+  pthread_cond_t finished;      // signalled as each step finishes
+  MsgType msgtype;              // passed to every step
+  char srcID[MAXPGMLINE];       // who_srcID of the CONFIG command
+  int nsteps;
+  struct config_step step[CONFIG_MAXSTEPS];
+};
+
+// A step counts as failed only on errors, a warning still lets the
+// steps after it go ahead
+
+static int
+configFailed(int status)
+{
+  return (status == CMD_ERR || status == CMD_FERR);
+}
+
+static void
+configFree(struct config_run *run)
+{
+  pthread_mutex_destroy(&run->lock);
+  pthread_cond_destroy(&run->finished);
+  free(run);
+}
+
+// Run one CONFIG step once the steps it comes after have finished
+
+static void *
+configStep(void *arg)
+{
+  struct config_step *sp = (struct config_step *)arg;
+  struct config_run *run = sp->run;
+  char key[MAXPGMLINE];
+  int i, ok = 1;
+
+  pthread_mutex_lock(&run->lock);
+  for (i=0; i<run->nsteps; i++) {
+    if (!sp->after[i]) continue;
+    while (!run->step[i].done)
+      pthread_cond_wait(&run->finished,&run->lock);
+    if (configFailed(run->step[i].status)) ok = 0;
+  }
+  pthread_mutex_unlock(&run->lock);
+
+  strcpy(who_srcID,run->srcID);  // for any ISIS status messages
+
+  if (ok)
+    sp->status = runAction(sp->icmd,sp->args,run->msgtype,sp->reply);
+  else {
+    for (i=0; cmdtab[sp->icmd].cmd[i] && i<MAXPGMLINE-1; i++)
+      key[i] = toupper(cmdtab[sp->icmd].cmd[i]);
+    key[i] = '\0';
+    snprintf(sp->reply,MMC_REPLYSIZE,"%s %s=SKIPPED an earlier step failed",
+	     cmdtab[sp->icmd].cmd,key);
+    sp->status = CMD_ERR;
+  }
+
+  pthread_mutex_lock(&run->lock);
+  sp->done = 1;
+  pthread_cond_broadcast(&run->finished);
+  pthread_mutex_unlock(&run->lock);
+
+  return NULL;
+}
+
+/*!
+  \brief CONFIG command - set up several mechanisms at once
+  \param args string with the command-line arguments
+  \param msgtype message type if the command was sent as an IMPv2 message
+  \param reply string to contain the command return reply
+  \return #CMD_OK if every step executed without errors, #CMD_ERR if any
+  step failed or the command is invalid.
+
+  \par Usage:
+  config mech=value [mech=value ...]
+
+  Each \e mech is one of the mechanism commands in configGraph[] and
+  \e value its argument, with commas for spaces (e.g., rcolfoc=a,b,c).
+  For example:
+  <pre>
+    config dichroic=both rgrating=2 rgrtilt2=23400 bgrating=1 bgrtilt1=18000
+           rfilter=3 bfilter=1 rcamfoc=2500 bcamfoc=2450 mselect=5 minsert=in
+  </pre>
+  The whole command is checked before anything moves.  Steps that
+  depend on another in the same CONFIG (see configGraph[]) start when
+  it finishes, and are skipped if it fails.  All other steps move
+  concurrently, each on its own mechanism queues, so the configuration
+  takes about as long as its slowest chain of moves instead of the sum
+  of all of them.
+
+  The reply carries each step's own reply, in the order given, without
+  its leading command name, so it has the same KEY=value pairs as the
+  individual commands.  If any step failed, a FAILED=mech,mech,...
+  keyword is added at the end.
+*/
+
+int
+cmd_config(char *args, MsgType msgtype, char *reply)
+{
+  struct config_run *run;
+  struct config_step *sp;
+  pthread_t tid[CONFIG_MAXSTEPS];
+  char started[CONFIG_MAXSTEPS];
+  char list[BIG_STR_SIZE];
+  char deps[MAXPGMLINE];
+  char failed[MAXPGMLINE];
+  char *tok, *save, *val, *dep, *dsave, *text;
+  replybuf_t rb;
+  int i, j, k, len;
+
+  if (strlen(args) == 0) {
+    sprintf(reply,"config Usage: %s",cmdtab[commandID].usage);
+    return CMD_ERR;
+  }
+
+  if ((run = (struct config_run *)calloc(1,sizeof(struct config_run))) == NULL) {
+    sprintf(reply,"config Cannot allocate memory for the configuration steps");
+    return CMD_ERR;
+  }
+  pthread_mutex_init(&run->lock,NULL);
+  pthread_cond_init(&run->finished,NULL);
+  run->msgtype = msgtype;
+  strcpy(run->srcID,who_srcID);
+
+  // Parse and check every mech=value pair before anything moves
+
+  snprintf(list,sizeof(list),"%s",args);
+  for (tok=strtok_r(list," \t",&save); tok!=NULL; tok=strtok_r(NULL," \t",&save)) {
+    if ((val=strchr(tok,'=')) == NULL || val == tok || strlen(val+1) == 0) {
+      sprintf(reply,"config Invalid '%s', Usage: %s",tok,cmdtab[commandID].usage);
+      configFree(run);
+      return CMD_ERR;
+    }
+    *val++ = '\0';
+
+    for (k=0; k<CONFIG_MAXSTEPS && strcasecmp(configGraph[k].cmd,tok); k++);
+    if (k == CONFIG_MAXSTEPS || cmdLookup(tok) < 0) {
+      sprintf(reply,"config Invalid '%s', not a mechanism config can set",tok);
+      configFree(run);
+      return CMD_ERR;
+    }
+    for (i=0; i<run->nsteps; i++)
+      if (!strcasecmp(cmdtab[run->step[i].icmd].cmd,tok)) {
+	sprintf(reply,"config Invalid, %s given more than once",tok);
+	configFree(run);
+	return CMD_ERR;
+      }
+
+    sp = &run->step[run->nsteps++];
+    sp->run = run;
+    sp->icmd = cmdLookup(tok);
+    snprintf(sp->args,sizeof(sp->args),"%s",val);
+    for (i=0; sp->args[i]; i++)
+      if (sp->args[i] == ',') sp->args[i] = ' ';
+  }
+
+  // Steps that must finish before each step starts
+
+  for (i=0; i<run->nsteps; i++) {
+    for (k=0; strcasecmp(configGraph[k].cmd,cmdtab[run->step[i].icmd].cmd); k++);
+    snprintf(deps,sizeof(deps),"%s",configGraph[k].after);
+    for (dep=strtok_r(deps," ",&dsave); dep!=NULL; dep=strtok_r(NULL," ",&dsave))
+      for (j=0; j<run->nsteps; j++)
+	if (!strcasecmp(cmdtab[run->step[j].icmd].cmd,dep)) run->step[i].after[j] = 1;
+  }
+
+  // Start every step, then wait for them all.  A step that cannot get a
+  // thread fails, and so do the steps after it.
+
+  for (i=0; i<run->nsteps; i++) {
+    started[i] = (pthread_create(&tid[i],NULL,configStep,&run->step[i]) == 0);
+    if (!started[i]) {
+      pthread_mutex_lock(&run->lock);
+      sprintf(run->step[i].reply,"%s Cannot start a thread for this step",
+	      cmdtab[run->step[i].icmd].cmd);
+      run->step[i].status = CMD_ERR;
+      run->step[i].done = 1;
+      pthread_cond_broadcast(&run->finished);
+      pthread_mutex_unlock(&run->lock);
+    }
+  }
+  for (i=0; i<run->nsteps; i++)
+    if (started[i]) pthread_join(tid[i],NULL);
+
+  // Aggregate the step replies, dropping each one's leading command name
+
+  replyInit(&rb,reply,MMC_REPLYSIZE);
+  replyAppend(&rb,"%s","config");
+  memset(failed,0,sizeof(failed));
+  for (i=0; i<run->nsteps; i++) {
+    sp = &run->step[i];
+    text = sp->reply;
+    while (*text == ' ') text++;
+    len = strlen(cmdtab[sp->icmd].cmd);
+    if (!strncasecmp(text,cmdtab[sp->icmd].cmd,len) && (text[len] == ' ' || text[len] == '\0'))
+      text += len;
+    while (*text == ' ') text++;
+    if (strlen(text) > 0) replyAppend(&rb," %s",text);
+    if (configFailed(sp->status))
+      snprintf(&failed[strlen(failed)],sizeof(failed)-strlen(failed),"%s%s",
+	       (strlen(failed) > 0 ? "," : ""),cmdtab[sp->icmd].cmd);
+  }
+  if (strlen(failed) > 0) replyKey(&rb,"FAILED","%s",failed);
+  if (rb.overflow)
+    mmcLOGGER(shm_addr->MODS.LLOG,(char*)"CONFIG reply too long, truncated");
+
+  configFree(run);
+
+  return (strlen(failed) > 0) ? CMD_ERR : CMD_OK;
+}
+
+/*!
+  \brief Hold every command queue and stop the state poller
+
+  Waits until all commands queued ahead have finished and the poller
+  is between cycles, then keeps every mechanism, the WAGO queue and
+  the poller out until queueReleaseAll().  The mmcServer's
+  serviceControl() holds them while it closes, reopens or reloads the
+  MicroLynx ports, so nothing is reading or writing a port or the
+  configuration while it changes.  Must not be called from inside a
+  command (the command's own tickets would never come up).
+
+  \sa queueReleaseAll(), runAction()
+*/
+
+void
+queueHoldAll(void)
+{
+  unsigned long ticket[MMC_NQUEUE];
+  int i;
+
+  pthread_mutex_lock(&pollLock);
+
+  pthread_mutex_lock(&queueLock);
+  for (i=0; i<MMC_NQUEUE; i++)
+    ticket[i] = queueNext[i]++;
+  for (i=0; i<MMC_NQUEUE; i++)
+    while (ticket[i]!=queueServing[i])
+      pthread_cond_wait(&queueTurn,&queueLock);
+  pthread_mutex_unlock(&queueLock);
+}
+
+/*!
+  \brief Release the queues and poller held by queueHoldAll()
+*/
+
+void
+queueReleaseAll(void)
+{
+  int i;
+
+  pthread_mutex_lock(&queueLock);
+  for (i=0; i<MMC_NQUEUE; i++)
+    queueServing[i]++;
+  pthread_cond_broadcast(&queueTurn);
+  pthread_mutex_unlock(&queueLock);
+
+  pthread_mutex_unlock(&pollLock);
+}
+
+/*!
+  \brief Background MicroLynx and WAGO state poller thread
+  \param arg unused
+
+  Every MLC_POLLMS msec reads the state of each idle mechanism into the
+  shared-memory cache with mlcPollState(), then refreshes the WAGO
+  register mirrors with wagoMirrorRefresh().  The poll takes the
+  mechanism's queue like a command, but only if nothing holds or waits
+  on it, so it never delays a command by more than one poll and never
+  interleaves with one.  Mechanisms that are busy, locked, or not
+  connected are skipped, and so are ports this process did not open
+  (mlcOwnPort()), like the agwServer's, whose FD numbers in shared
+  memory mean nothing here.
+
+  The WAGO refresh needs no queue: wagoMirror() discards a refresh
+  that overlapped a write.
+
+  Each cycle runs under pollLock, and a mechanism is checked again
+  once its queue is held, so the poller never touches a port while
+  queueHoldAll() is closing or reopening it.
+
+  \sa startStatePoller(), mlcCached(), wagoMirror()
+*/
+
+static void *
+statePoller(void *arg)
+{
+  int i;
+
+  for (;;) {
+    MilliSleep((mlcPollMS > 0) ? mlcPollMS : MLC_POLLMS);
+    pthread_mutex_lock(&pollLock);
+    if (mlcPollMS <= 0) {  // turned off when the config was reloaded
+      pthread_mutex_unlock(&pollLock);
+      continue;
+    }
+
+    for (i=0; i<MAX_ML; i++) {
+      if (!shm_addr->MODS.host[i] || shm_addr->MODS.LOCKS[i] ||
+	  shm_addr->MODS.busy[i] || !mlcOwnPort(i))
+	continue;
+
+      pthread_mutex_lock(&queueLock);
+      if (queueNext[i] != queueServing[i]) { // in use, try next round
+	pthread_mutex_unlock(&queueLock);
+	continue;
+      }
+      queueNext[i]++;
+      pthread_mutex_unlock(&queueLock);
+
+      // The port may have been closed while we waited for the queue
+
+      if (shm_addr->MODS.host[i] && !shm_addr->MODS.LOCKS[i] &&
+	  !shm_addr->MODS.busy[i] && mlcOwnPort(i))
+	mlcPollState(i);
+
+      pthread_mutex_lock(&queueLock);
+      queueServing[i]++;
+      pthread_cond_broadcast(&queueTurn);
+      pthread_mutex_unlock(&queueLock);
+    }
+
+    wagoMirrorRefresh();
+    pthread_mutex_unlock(&pollLock);
+  }
+  return NULL;
+}
+
+/*!
+  \brief Start the background MicroLynx state poller
+
+  Does nothing if MLC_POLLMS in mechanisms.ini is 0.  Called by the
+  mmcServer main() once the configuration is loaded.
+*/
+
+void
+startStatePoller(void)
+{
+  pthread_t tid;
+
+  if (mlcPollMS <= 0) return;
+  pthread_create(&tid,NULL,&statePoller,NULL);
+  pthread_detach(tid);
+}
+
 /* ***************************************************************************
 //
 // Command Interpreter I/O Handlers
@@ -13330,10 +14079,11 @@ KeyCommand(char *line, char reply[])
 {
   char cmd[BIG_STR_SIZE];       // command string (oversized)
   char args[BIG_STR_SIZE];      // command-line argument buffer (oversized)
+  isisargs_t cmdArgs;           // tokenized command line (see ISISTokenize())
 
   // ISIS message handling stuff
 
-  char temp[ISIS_MSGSIZE];       // ISIS message buffer
+  char temp[MMC_REPLYSIZE];     // action reply buffer
   char msg[ISIS_MSGSIZE];       // ISIS message buffer
   char srcID[ISIS_NODESIZE];    // ISIS message sending node ID
   char destID[ISIS_NODESIZE];   // ISIS message destination node ID
@@ -13387,7 +14137,10 @@ KeyCommand(char *line, char reply[])
 
   // Split message into command and argument strings
 
-  sscanf(message,"%s %[^\n]",cmd,args);
+  if (ISISTokenize(message,&cmdArgs) > 0) {
+    ISISArgCopy(cmdArgs.argv[0],cmd,sizeof(cmd));
+    strncpy(args,ISISArgTail(&cmdArgs,1),sizeof(args)-1);
+  }
 
   // We're all done with the message string, free its memory
 
@@ -13434,17 +14187,12 @@ KeyCommand(char *line, char reply[])
     
   } else {   // All other commands use the cmd_xxx() action calls
 
-    // Traverse the command table, matches are case-insensitive, but
-    // must be exact word matches (no abbreviations or aliases)
+    // Look up the command (hashed, see cmdLookup()), matches are
+    // case-insensitive, but must be exact word matches (no
+    // abbreviations or aliases)
     
     nfound = 0;
-    for (i=0; i<NumCommands; i++) {
-      if (strcasecmp(cmdtab[i].cmd,cmd)==0) { 
-	nfound++;
-	icmd=i;
-	break;
-      }
-    }
+    if ((icmd=cmdLookup(cmd)) >= 0) nfound++;
 
     if (nfound == 0) { // Send an error.
       sprintf(reply,"ERROR: unknown command - %s",cmd);
@@ -13452,23 +14200,22 @@ KeyCommand(char *line, char reply[])
     } 
     else { // All console keyboard are treated as EXEC: type messages
 
-      commandID = icmd; // save to identify mechanism name
-      switch (cmdtab[icmd].action(args,EXEC,temp)) {
+      switch (runAction(icmd,args,EXEC,temp)) {
 	
       case CMD_ERR:
-	sprintf(reply,"ERROR: %s",temp);
+	snprintf(reply,LONG_STR_SIZE,"ERROR: %s",temp);
 	break;
 	
       case CMD_OK:
-	sprintf(reply,"DONE: %s",temp);
+	snprintf(reply,LONG_STR_SIZE,"DONE: %s",temp);
 	break;
 
       case CMD_WARN:
-	sprintf(reply,"WARNING: %s",temp);
+	snprintf(reply,LONG_STR_SIZE,"WARNING: %s",temp);
 	break;
 
       case CMD_FERR:
-	sprintf(reply,"FATAL: %s",temp);
+	snprintf(reply,LONG_STR_SIZE,"FATAL: %s",temp);
 	break;
 	
       case CMD_NOOP:
@@ -13530,7 +14277,8 @@ SocketCommand(char *buf)
   // Command components (command args)
 
   char cmd[BIG_STR_SIZE];       // command string (oversized)
-  char args[BIG_STR_SIZE];      // command-line argument buffer (oversized)
+  char *args;                   // command arguments, points into msgbody
+  isisargs_t cmdArgs;           // tokenized message body (see ISISTokenize())
   char reply[LONG_STR_SIZE];     // command reply string
   //  char reply[BIG_STR_SIZE];     // command reply string
 
@@ -13582,20 +14330,15 @@ SocketCommand(char *buf)
   case EXEC:   // and executive override commands
 
     memset(msg,0,ISIS_MSGSIZE);
-    memset(args,0,sizeof(args));
 
-    sscanf(msgbody,"%s %[^\n]",cmd,args);  // split into command + args
+    if (ISISTokenize(msgbody,&cmdArgs) > 0)  // split into command + args
+      ISISArgCopy(cmdArgs.argv[0],cmd,sizeof(cmd));
+    args = ISISArgTail(&cmdArgs,1);
 
-    // Traverse the command table, exact case-insensitive match required
+    // Look up the command, exact case-insensitive match required
 
     nfound = 0;
-    for (i=0; i<NumCommands; i++) {
-      if (strcasecmp(cmdtab[i].cmd,cmd)==0) { 
-	nfound++;
-	icmd=i;
-	break;
-      }
-    }
+    if ((icmd=cmdLookup(cmd)) >= 0) nfound++;
 
     if (nfound == 0) {
       StrUpper(cmd);
@@ -13607,8 +14350,7 @@ SocketCommand(char *buf)
       memset(cmd,0,sizeof(cmd));
 
     } else {
-      commandID = icmd; // save to identify mechanism name
-      switch(cmdtab[icmd].action(args,msgtype,reply)) {
+      switch(runAction(icmd,args,msgtype,reply)) {
 
       case CMD_ERR: // command generated an error
 	sprintf(msg,"%s>%s ERROR: %s",client.ID,srcID,reply);
@@ -66,6 +66,10 @@
 <pre>  
 2005 May 05 - modified for the mods IE app wiht the mechanisms.ini file [rdg/osu]
 2025 Jun 25 - MODS2025 controller upgrade port, see notes [rwp/osu]
+2026 Oct 17 - added MLC_REPLYMS keyword for the MicroLynx prompt deadline
+2026 Oct 17 - added MLC_POLLMS and MLC_CACHEMS keywords for the MicroLynx state poller
+2026 Oct 17 - added WAGO_MIRROR and WAGO_CACHEMS keywords for the WAGO register mirror
+2026 Oct 17 - rebuild the mechanism name hash index after loading
 </pre>
  
 */
@@ -83,6 +87,13 @@
 
 #define MAXCFGLINE 80 //!< Maximum mumber of characters/line in the runtime config file
 
+extern long mlcReplyMS; // MicroLynx prompt deadline, msec (see mlc.c)
+extern long mlcPollMS;  // MicroLynx state poll cadence, msec (see mlc.c)
+extern long mlcCacheMS; // age limit of polled MicroLynx state, msec
+extern long wagoCacheMS; // age limit of a WAGO register mirror, msec
+extern int wagoMirrorSetup(int, int, int, int, int);
+extern void mechIndexBuild(void); // mechanism name hash index (see libislutils)
+
 /*!
   \brief Load/Parse ISIS client's runtime configuration file.
   \param cfgfile Path/name of the client runtime configuration file
@@ -126,6 +137,7 @@ LoadConfig(char *cfgfile)
                                          //          than an ISIS client
   strcpy(client.isisHost,DEFAULT_ISISHOST); 
   client.isisPort = DEFAULT_ISISPORT;       
+  strcpy(client.isisSocket,"");   // default: UDP to the ISIS server
   strcpy(client.isisID,DEFAULT_ISISID);     
 
   // Client information (defaults in client.h):
@@ -243,6 +255,15 @@ LoadConfig(char *cfgfile)
 	client.isisPort = atoi(argbuf);
       }
 
+      // ISISSocket: path of the ISIS server's Unix-domain socket (its
+      //             LocalSocket).  Only if ISISHost is this host, to
+      //             talk to the server without going through UDP.
+
+      else if (strcasecmp(keyword,"ISISSOCKET")==0) {
+	GetArg(inbuf, 2, argbuf);
+	strcpy(client.isisSocket,argbuf);
+      }
+
       // LogFile: Runtime log file rootname (including path) 
       //
       // The .log extension will be appended to this rootname. 
@@ -645,6 +666,56 @@ LoadConfig(char *cfgfile)
         shm_addr->MODS.r_gtiltNominal=atoi(argbuf);
       }
 
+      // MLC_REPLYMS - msec to wait for a MicroLynx prompt (see mlcTransact())
+
+      else if (strcasecmp(keyword, "MLC_REPLYMS")==0) {
+        GetArg(inbuf,2,argbuf);
+        if (atol(argbuf) > 0) mlcReplyMS = atol(argbuf);
+      }
+
+      // MLC_POLLMS - msec between MicroLynx state polls, 0 = no poller (see statePoller())
+
+      else if (strcasecmp(keyword, "MLC_POLLMS")==0) {
+        GetArg(inbuf,2,argbuf);
+        if (atol(argbuf) >= 0) mlcPollMS = atol(argbuf);
+      }
+
+      // MLC_CACHEMS - msec a polled state may answer a query, 0 = never (see mlcCached())
+
+      else if (strcasecmp(keyword, "MLC_CACHEMS")==0) {
+        GetArg(inbuf,2,argbuf);
+        if (atol(argbuf) >= 0) mlcCacheMS = atol(argbuf);
+      }
+
+      // WAGO_MIRROR - register ranges of a WAGO to mirror (see wagoMirror())
+      //   5 arguments:
+      //      wagoName = WAGO controller id given by its WAGOIP_PORT keyword
+      //      first0 n0 = first register and register count of the 1st range
+      //      first1 n1 = first register and register count of the 2nd range
+      // Limits: 32 registers per range, n=0 for no range
+      // Syntax: WAGO_MIRROR wagoName first0 n0 first1 n1
+      // Example: WAGO_MIRROR llb 0 4 512 5
+
+      else if (strcasecmp(keyword, "WAGO_MIRROR")==0) {
+        int k, n, reg[4];
+        GetArg(inbuf,2,argbuf);
+        for (k=0; k<wagoCnt; k++)
+          if (!strcasecmp(shm_addr->MODS.WAGOWHO[k],argbuf)) break;
+        for (n=0; n<4; n++) {
+          GetArg(inbuf,n+3,argbuf);
+          reg[n] = atoi(argbuf);
+        }
+        if (k == wagoCnt || wagoMirrorSetup(k,reg[0],reg[1],reg[2],reg[3]) < 0)
+          printf("WARNING: invalid WAGO_MIRROR entry, WAGO not mirrored\n");
+      }
+
+      // WAGO_CACHEMS - msec a mirrored WAGO image may answer a status report, 0 = never
+
+      else if (strcasecmp(keyword, "WAGO_CACHEMS")==0) {
+        GetArg(inbuf,2,argbuf);
+        if (atol(argbuf) >= 0) wagoCacheMS = atol(argbuf);
+      }
+
       // SPEED - port speed in baud (1200,2400,4800,9600,19200,38400)
 
       else if (strcasecmp(keyword, "SPEED")==0) {
@@ -688,6 +759,8 @@ LoadConfig(char *cfgfile)
   if (cfgFP!=0)
     fclose(cfgFP);
 
+  mechIndexBuild();  // who[] and WAGOWHO[] may have changed
+
   return(0);
 
 }
@@ -4,6 +4,8 @@
 #include <cstring>
 #include <vector>
 #include <cstdlib>            // For atoi()
+#include <poll.h>             // MicroLynx prompt reads
+#include <cstdarg>            // reply builder
 
 #include "ISLSocket.h"        // For Socket and SocketException
 #include "timer.h" // Timer
@@ -108,6 +110,606 @@ StrUpper(char *str)
       str[i] = toupper(str[i]);
 }
 
+//---------------------------------------------------------------------------
+//
+// Reply builder
+//
+// Status commands build their replies one KEY=value pair at a time.
+// sprintf(reply,"%s KEY=%d",reply,...) rescans the whole reply on
+// every call, overlaps its source and destination, and has no bound.
+// A replybuf_t keeps the reply length so each append writes only the
+// new text, and checks every append against the buffer size.  An
+// append that does not fit is dropped whole (the reply never ends in
+// half a keyword) and sets the overflow flag.
+//
+
+#define MMC_REPLYSIZE PAGE_SIZE  // size of the reply buffer an action function gets
+
+typedef struct replybuf {
+  char *buf;     // the reply string
+  int size;      // size of buf
+  int len;       // strlen(buf)
+  int overflow;  // 1 if an append did not fit
+} replybuf_t;
+
+/*!
+  \brief Start building a reply
+  \param rb reply builder
+  \param buf buffer for the reply, emptied
+  \param size size of buf, e.g., #MMC_REPLYSIZE
+*/
+
+void
+replyInit(replybuf_t *rb, char *buf, int size)
+{
+  rb->buf = buf;
+  rb->size = size;
+  rb->len = 0;
+  rb->overflow = 0;
+  buf[0] = '\0';
+}
+
+// Append formatted text, all or nothing
+
+static int
+replyAppendV(replybuf_t *rb, const char *fmt, va_list ap)
+{
+  int n;
+
+  n = vsnprintf(rb->buf+rb->len,rb->size-rb->len,fmt,ap);
+  if (n < 0 || n >= rb->size-rb->len) {
+    rb->buf[rb->len] = '\0';
+    rb->overflow = 1;
+    return -1;
+  }
+  rb->len += n;
+  return 0;
+}
+
+/*!
+  \brief Append printf-style text to a reply
+  \param rb reply builder
+  \param fmt format, then its arguments
+  \return 0 on success, -1 if the text did not fit (nothing appended)
+*/
+
+int
+replyAppend(replybuf_t *rb, const char *fmt, ...)
+{
+  va_list ap;
+  int ierr;
+
+  va_start(ap,fmt);
+  ierr = replyAppendV(rb,fmt,ap);
+  va_end(ap);
+  return ierr;
+}
+
+/*!
+  \brief Append a " KEY=value" pair to a reply
+  \param rb reply builder
+  \param key keyword
+  \param fmt format of the value, then its arguments
+  \return 0 on success, -1 if the pair did not fit (nothing appended)
+*/
+
+int
+replyKey(replybuf_t *rb, const char *key, const char *fmt, ...)
+{
+  va_list ap;
+  int len = rb->len;
+  int ierr;
+
+  if (replyAppend(rb," %s=",key) < 0) return -1;
+  va_start(ap,fmt);
+  ierr = replyAppendV(rb,fmt,ap);
+  va_end(ap);
+  if (ierr < 0) {
+    rb->len = len;
+    rb->buf[len] = '\0';
+  }
+  return ierr;
+}
+
+/*!
+  \brief Append a " KEY='value'" pair to a reply
+  \param rb reply builder
+  \param key keyword
+  \param value string value, quoted in the reply
+  \return 0 on success, -1 if the pair did not fit (nothing appended)
+*/
+
+int
+replyQuoted(replybuf_t *rb, const char *key, const char *value)
+{
+  return replyAppend(rb," %s='%s'",key,value);
+}
+
+/*!
+  \brief Append a " KEY=value" pair with a floating-point value
+  \param rb reply builder
+  \param key keyword
+  \param value value
+  \param prec digits after the decimal point
+  \return 0 on success, -1 if the pair did not fit (nothing appended)
+*/
+
+int
+replyFloat(replybuf_t *rb, const char *key, double value, int prec)
+{
+  return replyAppend(rb," %s=%.*f",key,prec,value);
+}
+
+//---------------------------------------------------------------------------
+//
+// MicroLynx prompt protocol
+//
+// A MicroLynx echoes each command line, prints its output lines, then
+// prompts with '>' when it is ready for the next command, or '?' if
+// the command failed.  mlcTransact() writes a command and reads until
+// that prompt or a millisecond deadline, so a command costs one
+// controller round trip rather than a fixed MilliSleep() plus a
+// whole-second ReadTTYPort() timeout.
+//
+
+#define MLC_REPLYMS  1000  // default prompt deadline, msec
+#define MLC_NOWRITE  -1    // mlcTransact(): command could not be written
+#define MLC_NOREPLY  -2    // mlcTransact(): no prompt before the deadline
+
+long mlcReplyMS = MLC_REPLYMS;  // MLC_REPLYMS in mechanisms.ini, see LoadConfig()
+
+static int mlcPrefetched(int, char [], char []);
+
+static long
+mlcMSec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return (long)ts.tv_sec*1000L + ts.tv_nsec/1000000L;
+}
+
+/*!
+  \brief Prompt deadline for a command that may start a move
+  \param i index of the mechanism
+  \return the mechanism TIMEOUT from mechanisms.ini plus the reply deadline, msec
+*/
+
+long
+mlcDeadline(int i)
+{
+  return (long)shm_addr->MODS.timeout[i]*1000L + mlcReplyMS;
+}
+
+/*!
+  \brief Read a MicroLynx reply up to its prompt
+
+  \param i index of the mechanism
+  \param reply string to contain the raw reply (echo, output, and prompt)
+  \param maxlen size of reply
+  \param msec deadline for the prompt, msec
+
+  \return '>' or '?' for the prompt seen, #MLC_NOREPLY on timeout or
+  read errors.
+
+  The reply is scanned as it arrives, only the new bytes of each read.
+  A '>' or '?' is the prompt once the echoed command line has ended (or
+  as the first character, if echo is off), so prompts are never taken
+  from the command's own echo.
+*/
+
+int
+mlcReadPrompt(int i, char reply[], int maxlen, long msec)
+{
+  int fd = shm_addr->MODS.commport[i].FD;
+  struct pollfd pfd;
+  long deadline;
+  long wait;
+  int echoed = 0;  // the echoed command line has ended
+  int len = 0;
+  int n, k;
+
+  reply[0] = '\0';
+  pfd.fd = fd;
+  pfd.events = POLLIN;
+  deadline = mlcMSec() + msec;
+
+  while (len < maxlen-1) {
+    wait = deadline - mlcMSec();
+    n = poll(&pfd,1,(wait>0) ? (int)wait : 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;  // deadline or poll() error
+
+    n = read(fd,&reply[len],maxlen-1-len);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+
+    for (k=len; k<len+n; k++) {
+      if ((echoed || k==0) && (reply[k]=='>' || reply[k]=='?')) {
+	reply[len+n] = '\0';
+	return reply[k];
+      }
+      if (reply[k]=='\r' || reply[k]=='\n') echoed = 1;
+    }
+    len += n;
+    reply[len] = '\0';
+  }
+  return MLC_NOREPLY;
+}
+
+/*!
+  \brief Send a command line to a MicroLynx and read its reply
+
+  \param i index of the mechanism
+  \param line command line, written as-is (include the \\r terminator)
+  \param reply string to contain the raw reply, at least #BUFFSIZE long
+  \param msec deadline for the prompt, msec
+
+  \return '>' if the command was accepted, '?' if the controller
+  flagged an error, #MLC_NOWRITE if the command could not be written,
+  or #MLC_NOREPLY if no prompt came before the deadline.
+
+  Anything left unread on the port from an earlier command (e.g., after
+  a timeout) is discarded first so it cannot be taken for this reply.
+*/
+
+int
+mlcTransact(int i, char line[], char reply[], long msec)
+{
+  ttyport_t *port = &shm_addr->MODS.commport[i];
+  struct pollfd pfd;
+  char junk[BUFFSIZE];
+  long t0;
+  int status;
+
+  reply[0] = '\0';
+  if ((status=mlcPrefetched(i,line,reply)) != 0) return status;
+  if (port->FD <= 0) return MLC_NOWRITE;
+
+  pfd.fd = port->FD;
+  pfd.events = POLLIN;
+  while (poll(&pfd,1,0) > 0 && read(port->FD,junk,sizeof(junk)) > 0);
+
+  shm_addr->MODS.stateTime[i] = 0.0;  // the command may change the polled state
+  t0 = mlcMSec();
+  if (WriteTTYPort(port,line) < 0) return MLC_NOWRITE;
+  status = mlcReadPrompt(i,reply,BUFFSIZE,msec);
+
+  if (client.Debug)
+    printf("%s: %.*s round trip %ld ms\n",shm_addr->MODS.who[i],
+	   (int)strcspn(line,"\r"),line,mlcMSec()-t0);
+
+  return status;
+}
+
+//---------------------------------------------------------------------------
+//
+// MicroLynx command batches
+//
+// The mechanism query paths check WHO, the IO 20 limit bits, PWRFAIL,
+// and then read the state, each a separate transaction.  mlcPrefetch()
+// sends the whole list with mlcBatch() once the checks have passed, and
+// mlcTransact() then answers those commands from the replies held, so
+// the query code itself is unchanged.
+//
+// mlcBatch() sends one line at a time and reads each reply up to its
+// prompt before writing the next.  Writing the whole list in one go
+// and splitting the replies apart by their prompts was only tried on a
+// simulated controller; it waits on a test against a real MicroLynx
+// that it buffers the lines without dropping or interleaving them.
+//
+
+#define MLC_MAXBATCH 8  // commands in one batch
+
+static __thread struct {
+  int  device;                         // mechanism the replies are from
+  int  n;                              // commands held, 0 if none
+  char line[MLC_MAXBATCH][64];         // command line, with its \r
+  int  prompt[MLC_MAXBATCH];           // mlcTransact() status, 0 once used
+  char reply[MLC_MAXBATCH][BUFFSIZE];  // raw reply
+} mlcAhead;
+
+/*!
+  \brief Send a list of commands to a MicroLynx
+
+  \param i index of the mechanism
+  \param cmds list of commands, without the \\r terminators
+  \param n number of commands, at most #MLC_MAXBATCH
+  \param replies strings to contain the raw reply to each command
+  \param prompts '>' or '?' for each command as for mlcTransact(),
+  #MLC_NOREPLY for commands with no reply
+  \param msec deadline for each prompt after the one before, msec
+
+  \return the number of replies received, or #MLC_NOWRITE if the
+  commands could not be written.
+
+  Each command is written and its reply read up to the prompt before
+  the next is written (see "MicroLynx command batches" above).  The
+  list stops at the first command with no prompt by its deadline.
+  Only commands that would be sent regardless of what the earlier
+  replies say belong in a batch.
+*/
+
+int
+mlcBatch(int i, char *cmds[], int n, char replies[][BUFFSIZE], int prompts[],
+	 long msec)
+{
+  ttyport_t *port = &shm_addr->MODS.commport[i];
+  struct pollfd pfd;
+  char line[BUFFSIZE];
+  char junk[BUFFSIZE];
+  long t0;
+  int k;  // replies received
+  int m;
+
+  for (m=0; m<n; m++) {
+    replies[m][0] = '\0';
+    prompts[m] = MLC_NOREPLY;
+  }
+  if (n <= 0 || n > MLC_MAXBATCH || port->FD <= 0) return MLC_NOWRITE;
+  for (m=0; m<n; m++)
+    if (strlen(cmds[m])+2 > sizeof(line)) return MLC_NOWRITE;
+
+  pfd.fd = port->FD;
+  pfd.events = POLLIN;
+  while (poll(&pfd,1,0) > 0 && read(port->FD,junk,sizeof(junk)) > 0);
+
+  shm_addr->MODS.stateTime[i] = 0.0;  // the commands may change the polled state
+  t0 = mlcMSec();
+
+  for (k=0; k<n; k++) {
+    sprintf(line,"%s\r",cmds[k]);
+    if (WriteTTYPort(port,line) < 0) {
+      if (k == 0) return MLC_NOWRITE;
+      break;
+    }
+    prompts[k] = mlcReadPrompt(i,replies[k],BUFFSIZE,msec);
+    if (prompts[k] == MLC_NOREPLY) break;
+  }
+
+  if (client.Debug)
+    printf("%s: batch of %d, %d replies, round trip %ld ms\n",
+	   shm_addr->MODS.who[i],n,k,mlcMSec()-t0);
+
+  return k;
+}
+
+/*!
+  \brief Send the commands a query path is about to send as one batch
+
+  \param i index of the mechanism
+  \param cmds list of commands, without the \\r terminators
+  \param n number of commands
+
+  The replies are held for this thread and mlcTransact() returns them,
+  each once, when the same command is sent to the same mechanism.  The
+  first command sent that is not held drops the rest, and so does
+  mlcPrefetchDone() at the end of every command, so a reply is never
+  used once the caller has gone on to something else.  Nothing is held
+  if the batch cannot be written; the commands then fail on their own.
+  Commands after one that timed out were never sent, so they are not
+  held either.
+*/
+
+void
+mlcPrefetch(int i, char *cmds[], int n)
+{
+  int k;
+
+  mlcAhead.n = 0;
+  if (n > MLC_MAXBATCH) n = MLC_MAXBATCH;
+  for (k=0; k<n; k++) {
+    if (strlen(cmds[k]) > sizeof(mlcAhead.line[k])-2) return;
+    sprintf(mlcAhead.line[k],"%s\r",cmds[k]);
+  }
+  if ((k=mlcBatch(i,cmds,n,mlcAhead.reply,mlcAhead.prompt,mlcReplyMS)) < 0)
+    return;
+  mlcAhead.device = i;
+  mlcAhead.n = (k < n) ? k+1 : n;  // the commands sent, the last may have timed out
+}
+
+/*!
+  \brief Drop any prefetched replies held for this thread
+*/
+
+void
+mlcPrefetchDone(void)
+{
+  mlcAhead.n = 0;
+}
+
+/*!
+  \brief Look up a prefetched reply for mlcTransact()
+  \return the command's mlcTransact() status if held, otherwise 0
+*/
+
+static int
+mlcPrefetched(int i, char line[], char reply[])
+{
+  int status;
+  int k;
+
+  if (mlcAhead.n == 0) return 0;
+
+  if (mlcAhead.device == i)
+    for (k=0; k<mlcAhead.n; k++)
+      if (mlcAhead.prompt[k] && !strcmp(mlcAhead.line[k],line)) {
+	strcpy(reply,mlcAhead.reply[k]);
+	status = mlcAhead.prompt[k];
+	mlcAhead.prompt[k] = 0;
+	return status;
+      }
+
+  mlcAhead.n = 0;
+  return 0;
+}
+
+//---------------------------------------------------------------------------
+//
+// MicroLynx state cache
+//
+// A background poller in the mmcServer (see statePoller() in
+// commands.c) reads POS, IO 20 and PWRFAIL from each idle mechanism
+// every MLC_POLLMS into shared memory, stamping the entry with the
+// time and bumping its sequence number.  Any command written to the
+// mechanism marks the entry stale, so mechanism queries can answer
+// from it with mlcCached() instead of asking the controller again.
+//
+
+#define MLC_POLLMS   2000  // default state poll cadence, msec, 0 = no poller
+#define MLC_CACHEMS  5000  // default age limit of polled state, msec
+
+long mlcPollMS  = MLC_POLLMS;   // MLC_POLLMS in mechanisms.ini, see LoadConfig()
+long mlcCacheMS = MLC_CACHEMS;  // MLC_CACHEMS in mechanisms.ini
+
+static double
+mlcNow(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME,&ts);
+  return (double)ts.tv_sec + ts.tv_nsec*1.0e-9;
+}
+
+/*!
+  \brief Mechanisms whose query reports the MicroLynx POS
+  \param i index of the mechanism
+  \return 1 for the grating tilts, collimator TTFs and camera focus, 0 otherwise
+*/
+
+static int
+mlcPolledPos(int i)
+{
+  return (strstr(shm_addr->MODS.who[i],"grtilt") != NULL ||
+	  strstr(shm_addr->MODS.who[i],"colttf") != NULL ||
+	  strstr(shm_addr->MODS.who[i],"camfoc") != NULL);
+}
+
+/*!
+  \brief Poll a mechanism's state into the shared-memory cache
+
+  \param i index of the mechanism
+
+  \return CMD_OK if the state was read, CMD_ERR if the controller did
+  not answer all of the polls (the entry is left stale).
+
+  Sends PRINT POS, PRINT IO 20 and PRINT PWRFAIL as one batch and stores
+  the replies in mlcPos[], mlcIO20[] and mlcPwrFail[].  For the
+  mechanisms whose query reports the POS (mlcPolledPos()) pos[], and for
+  the grating tilts state_word[], are updated the way their query
+  would.  stateSeq[] is odd while the entry is being written, so readers
+  in other processes can tell a torn read.  The caller must hold the
+  mechanism's command queue.
+*/
+
+int
+mlcPollState(int i)
+{
+  static char *polls[] = {"PRINT POS","PRINT IO 20","PRINT PWRFAIL"};
+  char replies[3][BUFFSIZE];
+  int prompts[3];
+  int k;
+
+  if (mlcBatch(i,polls,3,replies,prompts,mlcReplyMS) < 3) return CMD_ERR;
+  for (k=0; k<3; k++) {
+    if (prompts[k] != '>') return CMD_ERR;
+    rmcrlf(replies[k],replies[k]);
+    if (strlen(replies[k]) < strlen(polls[k])+2) return CMD_ERR;
+  }
+
+  shm_addr->MODS.stateSeq[i]++;
+  shm_addr->MODS.mlcPos[i] = atof(&replies[0][strlen(polls[0])+2]);
+  shm_addr->MODS.mlcIO20[i] = atoi(&replies[1][strlen(polls[1])+2]);
+  shm_addr->MODS.mlcPwrFail[i] = atoi(&replies[2][strlen(polls[2])+2]);
+  if (mlcPolledPos(i) && !shm_addr->MODS.mlcPwrFail[i]) {
+    shm_addr->MODS.pos[i] = fabs(shm_addr->MODS.mlcPos[i]);
+    if (strstr(shm_addr->MODS.who[i],"grtilt"))
+      sprintf(shm_addr->MODS.state_word[i],"%0.0f",shm_addr->MODS.pos[i]);
+  }
+  shm_addr->MODS.stateTime[i] = mlcNow();
+  shm_addr->MODS.stateSeq[i]++;
+
+  return CMD_OK;
+}
+
+/*!
+  \brief Can a mechanism query be answered from the polled state?
+
+  \param i index of the mechanism
+
+  \return 1 if the polled state is younger than MLC_CACHEMS and clean
+  (host configured, not locked, not both limits, no power failure), 0
+  if the query must go to the controller.
+*/
+
+int
+mlcCached(int i)
+{
+  double age;
+
+  if (mlcCacheMS <= 0 || shm_addr->MODS.stateTime[i] <= 0.0) return 0;
+  if (!shm_addr->MODS.host[i] || shm_addr->MODS.LOCKS[i]) return 0;
+
+  age = mlcNow() - shm_addr->MODS.stateTime[i];
+  if (age < 0.0 || age*1000.0 > mlcCacheMS) return 0;
+
+  return ((shm_addr->MODS.mlcIO20[i]&0x3) != 3 && !shm_addr->MODS.mlcPwrFail[i]);
+}
+
+//---------------------------------------------------------------------------
+//
+// Ports opened by this process
+//
+// commport[] lives in shared memory.  The agwServer opens the agw*
+// ports itself, and FDs can be left over from an earlier run, so a
+// descriptor number there only means something to this process if it
+// opened it.  Every open and close in the mmcServer goes through
+// mlcOpenPort() and mlcClosePort(), which keep track in mlcOwnFD[], and
+// the state poller only talks to ports for which mlcOwnPort() is true.
+//
+
+static int mlcOwnFD[MAX_ML];  // descriptors this process opened, 0 if none
+
+/*!
+  \brief Open a mechanism's comm port and note that this process owns it
+  \param i index of the mechanism
+  \return OpenTTYPort()'s return value, <0 on errors
+*/
+
+int
+mlcOpenPort(int i)
+{
+  int ierr;
+
+  ierr = OpenTTYPort(&shm_addr->MODS.commport[i]);
+  mlcOwnFD[i] = (ierr < 0) ? 0 : shm_addr->MODS.commport[i].FD;
+  return ierr;
+}
+
+/*!
+  \brief Close a mechanism's comm port opened by mlcOpenPort()
+  \param i index of the mechanism
+*/
+
+void
+mlcClosePort(int i)
+{
+  mlcOwnFD[i] = 0;
+  CloseTTYPort(&shm_addr->MODS.commport[i]);
+}
+
+/*!
+  \brief Is a mechanism's comm port one this process opened?
+  \param i index of the mechanism
+  \return 1 if commport[i].FD is the descriptor mlcOpenPort() opened, 0 if not
+*/
+
+int
+mlcOwnPort(int i)
+{
+  return (mlcOwnFD[i] > 0 && mlcOwnFD[i] == shm_addr->MODS.commport[i].FD);
+}
+
 //---------------------------------------------------------------------------
 //
 // openCommand - Open command port to a mechanism
@@ -133,7 +735,7 @@ openCommand(int i, char dummy[])
   memset(dummy,0,sizeof(dummy));
   shm_addr->MODS.busy[i]=1;    // Set the HOST busy bit.
 
-  if (OpenTTYPort(&shm_addr->MODS.commport[i]) < 0) {
+  if (mlcOpenPort(i) < 0) {
     memset(dummy,0,sizeof(dummy));
     sprintf(dummy,"%s=OPENERR openCommand: IP:%s NOT found",
 	    makeUpper(shm_addr->MODS.who[i]),
@@ -172,7 +774,7 @@ closeCommand(int i, char dummy[])
   shm_addr->MODS.busy[i]=1;   // Set HOST busy bit.
   memset(dummy,0,sizeof(dummy));
 
-  CloseTTYPort(&shm_addr->MODS.commport[i]);
+  mlcClosePort(i);
   sprintf(dummy,"%s=CLOSED IP:%s has been closed by the User",
 	  makeUpper(shm_addr->MODS.who[i]),
 	  shm_addr->MODS.commport[i].Port);
@@ -202,22 +804,15 @@ closeCommand(int i, char dummy[])
 double 
 positionToShrMem(int i, char dummy[])
 {
+  int ierr;
 
   memset(dummy,0,sizeof(dummy));
   shm_addr->MODS.busy[i]=1; // Hold the IP until finished
 
-  if (WriteTTYPort(&shm_addr->MODS.commport[i],"PRINT POS\r")<0) {
-    sprintf(dummy,"%s=TIMEOUT positionToShrMem cannot write to %s",
-	    makeUpper(shm_addr->MODS.who[i]),
-	    shm_addr->MODS.commport[i].Port);
-    shm_addr->MODS.busy[i]=0;  // Clear the HOST busy bit.
-    return CMD_ERR;
-  }
-    
-  MilliSleep(10);
-  if (ReadTTYPort(&shm_addr->MODS.commport[i],dummy,10L)<0) {
-    sprintf(dummy,"%s=TIMEOUT positionToShrMem cannot read from %s",
+  if ((ierr=mlcTransact(i,"PRINT POS\r",dummy,mlcReplyMS))<0) {
+    sprintf(dummy,"%s=TIMEOUT positionToShrMem cannot %s %s",
 	    makeUpper(shm_addr->MODS.who[i]),
+	    (ierr==MLC_NOWRITE) ? "write to" : "read from",
 	    shm_addr->MODS.commport[i].Port);
     shm_addr->MODS.busy[i]=0;  // Clear the HOST busy bit.
     return CMD_ERR;
@@ -264,19 +859,10 @@ sendCommand(int i, char cmd[], char dummy[])
   memset(dummy,0,sizeof(dummy)); // Clear the dummy and start again.
   memset(dummy2,0,sizeof(dummy2)); // Clear the dummy and start again.
 
-  if (WriteTTYPort(&shm_addr->MODS.commport[i],send)<0) {
-    sprintf(dummy,"%s=TIMEOUT sendCommand cannot write to %s",
-	    makeUpper(shm_addr->MODS.who[i]),
-	    shm_addr->MODS.commport[i].Port);
-    shm_addr->MODS.busy[i]=0;    // Clear the HOST busy bit.
-    return CMD_ERR;
-  }
-
-  MilliSleep(20);
-  if (ReadTTYPort(&shm_addr->MODS.commport[i],dummy,
-		 shm_addr->MODS.timeout[i]+1L)<0) {
-    sprintf(dummy,"%s=TIMEOUT sendCommand cannot read from %s",
+  if ((ierr=mlcTransact(i,send,dummy,mlcDeadline(i)))<0) {
+    sprintf(dummy,"%s=TIMEOUT sendCommand cannot %s %s",
 	    makeUpper(shm_addr->MODS.who[i]),
+	    (ierr==MLC_NOWRITE) ? "write to" : "read from",
 	    shm_addr->MODS.commport[i].Port);
     shm_addr->MODS.busy[i]=0;   // Clear the HOST busy bit.
     return CMD_ERR;
@@ -286,19 +872,10 @@ sendCommand(int i, char cmd[], char dummy[])
     strcpy(dummy2,&dummy[strlen(send)+3]); // Save message if != standard
                                            // microLynx controller error.
     sprintf(modserr,"%s",dummy);
-    if (WriteTTYPort(&shm_addr->MODS.commport[i],"PRINT ERROR\r")<0) {
-      sprintf(dummy,"%s=TIMEOUT sendCommand cannot write to %s",
-	      makeUpper(shm_addr->MODS.who[i]),
-	      shm_addr->MODS.commport[i].Port);
-      shm_addr->MODS.busy[i]=0;   // Clear the HOST busy bit.
-      return CMD_ERR;
-    }
-    memset(dummy,0,sizeof(dummy)); // Clear dummy return
-      
-    MilliSleep(10);
-    if (ReadTTYPort(&shm_addr->MODS.commport[i],dummy,10L)<0) {
-      sprintf(dummy,"%s=TIMEOUT sendCommand cannot read from %s",
+    if ((ierr=mlcTransact(i,"PRINT ERROR\r",dummy,mlcReplyMS))<0) {
+      sprintf(dummy,"%s=TIMEOUT sendCommand cannot %s %s",
 	      makeUpper(shm_addr->MODS.who[i]),
+	      (ierr==MLC_NOWRITE) ? "write to" : "read from",
 	      shm_addr->MODS.commport[i].Port);
       shm_addr->MODS.busy[i]=0;   // Clear the HOST busy bit.
       return CMD_ERR;
@@ -390,18 +967,10 @@ sendMultiCommand(int i, char cmdlist[][80], int cnt, char dumlist[][512])
     strcpy(send,cmdlist[cmditem]); // command
     strcat(send,"\r"); // Add a '\r'. <CR> to satisfy MicroLynx controller
     /* Send nth command */
-    if (WriteTTYPort(&shm_addr->MODS.commport[i],send)<0) {
-      sprintf(dummy,"%s=TIMEOUT sendMultiCommand cannot write to %s",
-	      makeUpper(shm_addr->MODS.who[i]),
-	      shm_addr->MODS.commport[i].Port);
-      shm_addr->MODS.busy[i]=0;    // Clear the HOST busy bit.
-      return CMD_ERR;
-    }
-    MilliSleep(200);
-    if (ReadTTYPort(&shm_addr->MODS.commport[i],dumlist[cmditem],
-		   shm_addr->MODS.timeout[i]+1L)<0) {
-      sprintf(dummy,"%s=TIMEOUT sendMultiCommand cannot read from %s",
+    if ((ierr=mlcTransact(i,send,dumlist[cmditem],mlcDeadline(i)))<0) {
+      sprintf(dummy,"%s=TIMEOUT sendMultiCommand cannot %s %s",
 	      makeUpper(shm_addr->MODS.who[i]),
+	      (ierr==MLC_NOWRITE) ? "write to" : "read from",
 	      shm_addr->MODS.commport[i].Port);
       shm_addr->MODS.busy[i]=0;   // Clear the HOST busy bit.
       return CMD_ERR;
@@ -442,7 +1011,7 @@ sendTwoCommand(int i, char cmd[], char cmd2[], char dummy[])
   int ierr;
   char send[64];
   char send2[64];
-  char temp[79];
+  char temp[BUFFSIZE];
   char dummy2[PAGE_SIZE];
   char modserr[512];
 
@@ -459,61 +1028,31 @@ sendTwoCommand(int i, char cmd[], char cmd2[], char dummy[])
 
   /* Send 1st command */
 
-  if (WriteTTYPort(&shm_addr->MODS.commport[i],send)<0) {
-    sprintf(dummy,"%s=TIMEOUT sendTwoCommand cannot write to %s",
-	    makeUpper(shm_addr->MODS.who[i]),
-	    shm_addr->MODS.commport[i].Port);
-    shm_addr->MODS.busy[i]=0;    // Clear the HOST busy bit.
-    return CMD_ERR;
-  }
-
-  MilliSleep(10);
-  if (ReadTTYPort(&shm_addr->MODS.commport[i],temp,1L)<0) {
-    sprintf(dummy,"%s=TIMEOUT sendTwoCommand cannot read from %s",
+  if ((ierr=mlcTransact(i,send,temp,mlcReplyMS))<0) {
+    sprintf(dummy,"%s=TIMEOUT sendTwoCommand cannot %s %s",
 	    makeUpper(shm_addr->MODS.who[i]),
+	    (ierr==MLC_NOWRITE) ? "write to" : "read from",
 	    shm_addr->MODS.commport[i].Port);
     shm_addr->MODS.busy[i]=0;   // Clear the HOST busy bit.
     return CMD_ERR;
   }
 
-  MilliSleep(50); // Wait 50msec then send the 2nd command
-  /* Send 2nd command */
+  /* Send 2nd command once the 1st has been prompted */
 
-  memset(dummy,0,sizeof(dummy)); // Clear the dummy and start again.
-  if (WriteTTYPort(&shm_addr->MODS.commport[i],send2)<0) {
-    sprintf(dummy,"%s=TIMEOUT sendTwoCommand cannot write to %s",
-	    makeUpper(shm_addr->MODS.who[i]),
-	    shm_addr->MODS.commport[i].Port);
-    shm_addr->MODS.busy[i]=0;    // Clear the HOST busy bit.
-    return CMD_ERR;
-  }
-
-  memset(dummy,0,sizeof(dummy)); // Clear the dummy and start again.
-
-  MilliSleep(50);
-  if (ReadTTYPort(&shm_addr->MODS.commport[i],dummy,
-		 shm_addr->MODS.timeout[i]+1L)<0) {
-    sprintf(dummy,"%s=TIMEOUT sendTwoCommand cannot read from %s",
+  if ((ierr=mlcTransact(i,send2,dummy,mlcDeadline(i)))<0) {
+    sprintf(dummy,"%s=TIMEOUT sendTwoCommand cannot %s %s",
 	    makeUpper(shm_addr->MODS.who[i]),
+	    (ierr==MLC_NOWRITE) ? "write to" : "read from",
 	    shm_addr->MODS.commport[i].Port);
     shm_addr->MODS.busy[i]=0;   // Clear the HOST busy bit.
     return CMD_ERR;
   }
 
   if (strstr(dummy,"?")) { // check for a MicroLynx Controller ERROR '?'
-    if (WriteTTYPort(&shm_addr->MODS.commport[i],"PRINT ERROR\r")<0) {
-      sprintf(dummy,"%s=TIMEOUT sendTwoCommand cannot write to %s",
-	      makeUpper(shm_addr->MODS.who[i]),
-	      shm_addr->MODS.commport[i].Port);
-      shm_addr->MODS.busy[i]=0;   // Clear the HOST busy bit.
-      return CMD_ERR;
-    }
-    memset(dummy,0,sizeof(dummy)); // Clear dummy return
-      
-    MilliSleep(10);
-    if (ReadTTYPort(&shm_addr->MODS.commport[i],dummy,10L)<0) {
-      sprintf(dummy,"%s=TIMEOUT sendTwoCommand cannot read from %s",
+    if ((ierr=mlcTransact(i,"PRINT ERROR\r",dummy,mlcReplyMS))<0) {
+      sprintf(dummy,"%s=TIMEOUT sendTwoCommand cannot %s %s",
 	      makeUpper(shm_addr->MODS.who[i]),
+	      (ierr==MLC_NOWRITE) ? "write to" : "read from",
 	      shm_addr->MODS.commport[i].Port);
       shm_addr->MODS.busy[i]=0;   // Clear the HOST busy bit.
       return CMD_ERR;
@@ -566,20 +1105,10 @@ rawCommand(int i, char cmd[], char dummy[])
   memset(dummy,0,sizeof(dummy)); // Clear the dummy and start again.
   memset(dummy2,0,sizeof(dummy2)); // Clear the dummy and start again.
 
-  if (WriteTTYPort(&shm_addr->MODS.commport[i],send)<0) {
-    sprintf(dummy,"%s=TIMEOUT rawCommand cannot write to %s",
-	    makeUpper(shm_addr->MODS.who[i]),
-	    shm_addr->MODS.commport[i].Port);
-    shm_addr->MODS.busy[i]=0;    // Clear the HOST busy bit.
-    return CMD_ERR;
-  }
-
-  MilliSleep(100);
-
-  if (ierr=ReadTTYPort(&shm_addr->MODS.commport[i],dummy,
-		      (long )shm_addr->MODS.timeout[i])<0) {
-    sprintf(dummy,"%s=TIMEOUT rawCommand cannot read from %s",
+  if ((ierr=mlcTransact(i,send,dummy,mlcDeadline(i)))<0) {
+    sprintf(dummy,"%s=TIMEOUT rawCommand cannot %s %s",
 	    makeUpper(shm_addr->MODS.who[i]),
+	    (ierr==MLC_NOWRITE) ? "write to" : "read from",
 	    shm_addr->MODS.commport[i].Port);
     shm_addr->MODS.busy[i]=0;   // Clear the HOST busy bit.
     return CMD_ERR;
@@ -587,19 +1116,10 @@ rawCommand(int i, char cmd[], char dummy[])
 
   if (strstr(dummy,"?")) { // check for a MicroLynx Controller ERROR '?'
     sprintf(modserr,"%s",dummy);
-    if (WriteTTYPort(&shm_addr->MODS.commport[i],"PRINT ERROR\r")<0) {
-      sprintf(dummy,"%s=TIMEOUT rawCommand cannot write to %s",
-	      makeUpper(shm_addr->MODS.who[i]),
-	      shm_addr->MODS.commport[i].Port);
-      shm_addr->MODS.busy[i]=0;   // Clear the HOST busy bit.
-      return CMD_ERR;
-    }
-    memset(dummy,0,sizeof(dummy)); // Clear dummy return
-    
-    MilliSleep(10);
-    if (ReadTTYPort(&shm_addr->MODS.commport[i],dummy,1L)<0) {
-      sprintf(dummy,"%s=TIMEOUT rawCommand cannot read from %s",
+    if ((ierr=mlcTransact(i,"PRINT ERROR\r",dummy,mlcReplyMS))<0) {
+      sprintf(dummy,"%s=TIMEOUT rawCommand cannot %s %s",
 	      makeUpper(shm_addr->MODS.who[i]),
+	      (ierr==MLC_NOWRITE) ? "write to" : "read from",
 	      shm_addr->MODS.commport[i].Port);
       shm_addr->MODS.busy[i]=0;   // Clear the HOST busy bit.
       return CMD_ERR;
@@ -667,15 +1187,13 @@ rawCommandOnly(int i, char cmd[])
   memset(dummy,0,sizeof(dummy)); // Clear the dummy and start again.
   shm_addr->MODS.busy[i]=1;    // Set the HOST busy bit.
 
-  if (WriteTTYPort(&shm_addr->MODS.commport[i],send)<0) {
+  if (mlcTransact(i,send,dummy,mlcReplyMS)==MLC_NOWRITE) {
     sprintf(dummy,"%s=TIMEOUT rawCommandOnly cannot write %s",
 	    makeUpper(shm_addr->MODS.who[i]),
 	    shm_addr->MODS.commport[i].Port);
     return CMD_ERR;
   }
 
-  MilliSleep(10);
-  ReadTTYPort(&shm_addr->MODS.commport[i],dummy,3L);
   memset(dummy,0,sizeof(dummy)); // Clear the dummy and start again.
   shm_addr->MODS.busy[i]=0;    // reset busy bit.
   return CMD_OK;
@@ -773,18 +1291,10 @@ mlcCheckBits(int i, char dummy[])
 
   memset(dummy,0,sizeof(dummy)); // Clear the dummy and start again.
     
-  if (WriteTTYPort(&shm_addr->MODS.commport[i],IO20)<0) {
-    sprintf(dummy,"%s=TIMEOUT mlcCheckBits cannot write to %s",
-	    makeUpper(shm_addr->MODS.who[i]),
-	    shm_addr->MODS.commport[i].Port);
-    shm_addr->MODS.busy[i]=0;   // Clear the HOST busy bit.
-    return CMD_ERR;
-  }
-  
-  MilliSleep(10);
-  if (ReadTTYPort(&shm_addr->MODS.commport[i],dummy,10L)<0) {
-    sprintf(dummy,"%s=TIMEOUT mlcCheckBits cannot read from %s",
+  if ((ierr=mlcTransact(i,IO20,dummy,mlcReplyMS))<0) {
+    sprintf(dummy,"%s=TIMEOUT mlcCheckBits cannot %s %s",
 	    makeUpper(shm_addr->MODS.who[i]),
+	    (ierr==MLC_NOWRITE) ? "write to" : "read from",
 	    shm_addr->MODS.commport[i].Port);
     shm_addr->MODS.busy[i]=0;   // Clear the HOST busy bit.
     return CMD_ERR;
@@ -830,17 +1340,10 @@ mlcQuery(int i, long timeout, char dummy[])
 
   shm_addr->MODS.busy[i]=1;    // Clear the HOST busy bit.
   
-  if (WriteTTYPort(&shm_addr->MODS.commport[i],"PRINT WHO\r")<0) {
-    sprintf(dummy,"%s=TIMEOUT cannot write to %s",
-	    makeUpper(shm_addr->MODS.who[i]),
-	    shm_addr->MODS.commport[i].Port);
-    shm_addr->MODS.busy[i]=0;   // Clear the HOST busy bit.
-    return CMD_ERR;
-  }
-  MilliSleep(10);
-  if (ReadTTYPort(&shm_addr->MODS.commport[i],dummy,timeout)<0) {
-    sprintf(dummy,"%s=TIMEOUT cannot read from %s",
+  if ((ierr=mlcTransact(i,"PRINT WHO\r",dummy,timeout*1000L))<0) {
+    sprintf(dummy,"%s=TIMEOUT cannot %s %s",
 	    makeUpper(shm_addr->MODS.who[i]),
+	    (ierr==MLC_NOWRITE) ? "write to" : "read from",
 	    shm_addr->MODS.commport[i].Port);
     shm_addr->MODS.busy[i]=0;   // Clear the HOST busy bit.
     return CMD_ERR;
@@ -873,16 +1376,12 @@ int
 mlcStopMechanism(int i, char dummy[])
 {
   int ierr;
-  char *esc;
+  char esc[2];
 
   shm_addr->MODS.busy[i]=0;    // Clear the HOST busy bit.
   
   sprintf(esc,"%c",27);
-  WriteTTYPort(&shm_addr->MODS.commport[i],esc);
-
-  MilliSleep(100);
-
-  ReadTTYPort(&shm_addr->MODS.commport[i],dummy,1L);
+  mlcTransact(i,esc,dummy,mlcReplyMS);
 
   memset(dummy,0,sizeof(dummy)); // Clear the dummy before you start
   sprintf(dummy,"%s=STOPPED mechanism and/or operation was halted",
@@ -1001,8 +1500,7 @@ mlcWhoAmI(int device,char mechanism_name[],char dummy[])
 
   memset(dummy,0,sizeof(dummy)); // Clear the dummy before you start
   memset(dummy2,0,sizeof(dummy2));
-  WriteTTYPort(&shm_addr->MODS.commport[device],"WHO\r");
-  ReadTTYPort(&shm_addr->MODS.commport[device],dummy2,10L);
+  mlcTransact(device,"WHO\r",dummy2,mlcReplyMS);
 
   rmcrlf(dummy2,dummy2); // remove all CR and LF
   GetArg(dummy2,2,whoisit); // The one we want is the second argument.
@@ -1035,7 +1533,8 @@ mlcWhoAmI(int device,char mechanism_name[],char dummy[])
   \param reply reply message
   \return mechanismID  or error
 
-  Get Mechanism ID
+  Get Mechanism ID.  Exact names are found in the shared-memory hash
+  index (mechIndex()), anything else by the original substring scan.
 
   <pre>
   </pre>
@@ -1046,12 +1545,9 @@ int
 getMechanismID(char mechanism_name[], char dummy[])
 {
   int dev;
-  int len;
-  char dummy2[PAGE_SIZE];
 
-  memset(dummy2,0,sizeof(dummy2));
-  //  shm_addr->MODS.busy[device]=0;    // clear busy bit.
-  
+  if ((dev=mechIndex(mechanism_name)) >= 0) return dev;
+
   for (dev=0;
       !strstr(mechanism_name,shm_addr->MODS.who[dev]) && dev<=MAX_ML;
       dev++);
@@ -1076,7 +1572,7 @@ getMechanismID(char mechanism_name[], char dummy[])
   \param reply reply message
   \return wagoID  or error
 
-  Get WAGO ID
+  Get WAGO ID, from the hash index (wagoIndex()) for exact names.
 
   <pre>
   </pre>
@@ -1087,11 +1583,9 @@ int
 getWagoID(char wagoid_name[], char dummy[])
 {
   int dev;
-  int len;
-  char dummy2[PAGE_SIZE];
 
-  memset(dummy2,0,sizeof(dummy2));
-  
+  if ((dev=wagoIndex(wagoid_name)) >= 0) return dev;
+
   for (dev=0;
       !strstr(wagoid_name,shm_addr->MODS.WAGOWHO[dev]) && dev<=6;
       dev++);
@@ -1131,9 +1625,7 @@ checkPower(int device, char dummy[])
   shm_addr->MODS.busy[device]=1;    // set busy bit.
   memset(dummy,0,sizeof(dummy));
   /* Check the Power Failure variable PWRFAIL */
-  WriteTTYPort(&shm_addr->MODS.commport[device],"PRINT PWRFAIL\r");
-  MilliSleep(100);
-  ReadTTYPort(&shm_addr->MODS.commport[device],dummy,5L);
+  mlcTransact(device,"PRINT PWRFAIL\r",dummy,mlcReplyMS);
   rmcrlf(dummy,dummy); // remove all CR and LF
   ierr=atoi(&dummy[14]);
   if (ierr) {
@@ -1361,71 +1853,23 @@ mlcTechCmd(int device, char args[], char who[], char dummy[])
 int 
 mlcClear(int i,char dummy[])
 {
+  static const char *clearCmds[4] = {"IP\r","DVF\r","CP 1,1\r","SAVE\r"};
+  static const long clearMS[4] = {10000L,10000L,30000L,10000L}; // CP clears program memory, slow
+  int ierr;
+  int k;
+
   memset(dummy,0,sizeof(dummy));
   shm_addr->MODS.busy[i]=1;    // set busy bit.
 
-  if (WriteTTYPort(&shm_addr->MODS.commport[i],"IP\r")<0) {
-    sprintf(dummy,"%s=TIMEOUT mlcClear cannot write to %s",
-	    shm_addr->MODS.who[i],
-	    shm_addr->MODS.commport[i].Port);
-    shm_addr->MODS.busy[i]=0;    // clear busy bit.
-    return CMD_ERR;
-  }
-  if (ReadTTYPort(&shm_addr->MODS.commport[i],dummy,10L)<0) {
-    sprintf(dummy,"%s=TIMEOUT mlcClear cannot read from %s",
-	    shm_addr->MODS.who[i],
-	    shm_addr->MODS.commport[i].Port);
-	    shm_addr->MODS.busy[i]=0;    // clear busy bit.
-    return CMD_ERR;
-  }
-
-  MilliSleep(100);
-  if (WriteTTYPort(&shm_addr->MODS.commport[i],"DVF\r")<0) {
-    sprintf(dummy,"%s=TIMEOUT mlcClear cannot write to %s",
-	    shm_addr->MODS.who[i],
-	    shm_addr->MODS.commport[i].Port);
-    shm_addr->MODS.busy[i]=0;    // clear busy bit.
-    return CMD_ERR;
-  }
-
-  if (ReadTTYPort(&shm_addr->MODS.commport[i],dummy,10L)<0) {
-    sprintf(dummy,"%s=TIMEOUT mlcClear cannot read from %s",
-	    shm_addr->MODS.who[i],
-	    shm_addr->MODS.commport[i].Port);
-    shm_addr->MODS.busy[i]=0;  // Clear the HOST busy bit.
-    return CMD_ERR;
-  }
-
-  MilliSleep(100);
-  if (WriteTTYPort(&shm_addr->MODS.commport[i],"CP 1,1\r")<0) {
-    sprintf(dummy,"%s=TIMEOUT mlcClear cannot write to %s",
-	    shm_addr->MODS.who[i],
-	    shm_addr->MODS.commport[i].Port);
-    shm_addr->MODS.busy[i]=0;    // clear busy bit.
-    return CMD_ERR;
-  }
-  if (ReadTTYPort(&shm_addr->MODS.commport[i],dummy,30L)<0) {
-    sprintf(dummy,"%s=TIMEOUT mlcClear cannot read from %s",
-	    shm_addr->MODS.who[i],
-	    shm_addr->MODS.commport[i].Port);
-    shm_addr->MODS.busy[i]=0;  // Clear the HOST busy bit.
-    return CMD_ERR;
-  }
-
-  MilliSleep(100);
-  if (WriteTTYPort(&shm_addr->MODS.commport[i],"SAVE\r")<0) {
-    sprintf(dummy,"%s=TIMEOUT mlcClear cannot write to %s",
-	    shm_addr->MODS.who[i],
-	    shm_addr->MODS.commport[i].Port);
-    shm_addr->MODS.busy[i]=0;    // clear busy bit.
-    return CMD_ERR;
-  }
-  if (ReadTTYPort(&shm_addr->MODS.commport[i],dummy,10L)<0) {
-    sprintf(dummy,"%s=TIMEOUT mlcClear cannot read from %s",
-	    shm_addr->MODS.who[i],
-	    shm_addr->MODS.commport[i].Port);
-    shm_addr->MODS.busy[i]=0;  // Clear the HOST busy bit.
-    return CMD_ERR;
+  for (k=0; k<4; k++) {
+    if ((ierr=mlcTransact(i,(char *)clearCmds[k],dummy,clearMS[k]))<0) {
+      sprintf(dummy,"%s=TIMEOUT mlcClear cannot %s %s",
+	      shm_addr->MODS.who[i],
+	      (ierr==MLC_NOWRITE) ? "write to" : "read from",
+	      shm_addr->MODS.commport[i].Port);
+      shm_addr->MODS.busy[i]=0;    // clear busy bit.
+      return CMD_ERR;
+    }
   }
   shm_addr->MODS.busy[i]=0;  // Clear the HOST busy bit.
 
@@ -1844,6 +2288,315 @@ mlcStep(int i, char who [], int what, float val, char dummy[])
   return CMD_OK;
 }
 
+//---------------------------------------------------------------------------
+//
+// WAGO register mirror
+//
+// Commands read the WAGO fieldbus controllers one register at a time.
+// For each WAGO with a WAGO_MIRROR entry in mechanisms.ini the
+// mmcServer keeps an image of two register ranges (typically the
+// input image from 0 and the output image read back from 512), each
+// refreshed with one bulk read.  wagoMirror() is a drop-in for
+// wagoSetGet(): a read inside a range always goes to the WAGO, as one
+// bulk read of the whole range that also refreshes the image, so the
+// power, breaker and lamp states that commands act on are never
+// stale.  Only wagoMirrorCached(), for temperatures and pressures that
+// are just reported, answers from the image while it is younger than
+// WAGO_CACHEMS.  Writes go through at once and update the image; since
+// inputs can follow outputs, the WAGO's other range is marked stale.
+// Between wagoMirrorHold() and wagoMirrorFlush() writes inside a range
+// are staged apart from the image and sent as one multi-register write
+// per run of adjacent registers; until then reads return what the
+// WAGO has, not the staged values.
+//
+
+#define WAGO_CACHEMS  3000  // default age limit of a mirrored image, msec
+#define WAGO_NWAGO    6     // WAGOIP[] entries
+#define WAGO_MAXREGS  32    // registers in one mirrored range
+
+long wagoCacheMS = WAGO_CACHEMS;  // WAGO_CACHEMS in mechanisms.ini, see LoadConfig()
+
+static struct wago_mirror {
+  int first[2];                // first register of each range
+  int count[2];                // registers in each range, 0 if not mirrored
+  short image[2][WAGO_MAXREGS]; // registers as last read from or written to the WAGO
+  long time[2];                // mlcMSec() of the last refresh, 0 if stale
+  short stage[2][WAGO_MAXREGS]; // staged writes
+  char dirty[2][WAGO_MAXREGS]; // stage[][] entries waiting for wagoMirrorFlush()
+  int hold;                    // writes are being staged
+  unsigned long gen;           // bumped by every write
+  pthread_mutex_t lock;
+} wagoImage[WAGO_NWAGO];
+
+/*!
+  \brief Set up the register mirror for a WAGO
+
+  \param k index of the WAGO in WAGOIP[]
+  \param first0 first register of the 1st range
+  \param n0 registers in the 1st range, 0 for none
+  \param first1 first register of the 2nd range
+  \param n1 registers in the 2nd range, 0 for none
+
+  \return 0 on success, -1 if the WAGO index or a range is invalid.
+
+  Called by LoadConfig() for each WAGO_MIRROR keyword.
+*/
+
+int
+wagoMirrorSetup(int k, int first0, int n0, int first1, int n1)
+{
+  struct wago_mirror *wm;
+  static int init = 0;
+  int i;
+
+  if (!init) {
+    for (i=0; i<WAGO_NWAGO; i++) pthread_mutex_init(&wagoImage[i].lock,NULL);
+    init = 1;
+  }
+  if (k < 0 || k >= WAGO_NWAGO) return -1;
+  if (n0 < 0 || n0 > WAGO_MAXREGS || n1 < 0 || n1 > WAGO_MAXREGS) return -1;
+  wm = &wagoImage[k];
+
+  pthread_mutex_lock(&wm->lock);
+  wm->first[0] = first0;
+  wm->count[0] = n0;
+  wm->first[1] = first1;
+  wm->count[1] = n1;
+  wm->time[0] = wm->time[1] = 0;
+  memset(wm->dirty,0,sizeof(wm->dirty));
+  wm->hold = 0;
+  pthread_mutex_unlock(&wm->lock);
+  return 0;
+}
+
+// Mirror for a WAGO host, NULL if it has none
+
+static struct wago_mirror *
+wagoMirrorFind(char *host)
+{
+  int k;
+
+  for (k=0; k<WAGO_NWAGO; k++)
+    if ((wagoImage[k].count[0] > 0 || wagoImage[k].count[1] > 0) &&
+	!strcmp(host,shm_addr->MODS.WAGOIP[k]))
+      return &wagoImage[k];
+  return NULL;
+}
+
+// Range of a mirror holding registers startRef..startRef+refCnt-1, -1 if none
+
+static int
+wagoMirrorRange(struct wago_mirror *wm, int startRef, int refCnt)
+{
+  int r;
+
+  for (r=0; r<2; r++)
+    if (wm->count[r] > 0 && startRef >= wm->first[r] &&
+	startRef+refCnt <= wm->first[r]+wm->count[r])
+      return r;
+  return -1;
+}
+
+/*!
+  \brief Refresh one range of a WAGO mirror with a bulk read
+
+  \param host WAGO IP address
+  \param wm the WAGO's mirror
+  \param r range to refresh
+  \param regs buffer for the registers read, #WAGO_MAXREGS long
+
+  \return 0 on success, -1 on errors.
+
+  The image is only updated if no write came in while the read was
+  out, so a refresh cannot undo a write.
+*/
+
+static int
+wagoMirrorRead(char *host, struct wago_mirror *wm, int r, short regs[])
+{
+  unsigned long gen;
+
+  pthread_mutex_lock(&wm->lock);
+  gen = wm->gen;
+  pthread_mutex_unlock(&wm->lock);
+
+  if (wagoSetGet(0,host,1,wm->first[r],regs,wm->count[r]) < 0) return -1;
+
+  pthread_mutex_lock(&wm->lock);
+  if (wm->gen == gen) {
+    memcpy(wm->image[r],regs,wm->count[r]*sizeof(short));
+    wm->time[r] = mlcMSec();
+  }
+  pthread_mutex_unlock(&wm->lock);
+  return 0;
+}
+
+/*!
+  \brief Read or write WAGO registers through the register mirror
+
+  Same arguments and return values as wagoSetGet(), which it calls for
+  anything the mirror cannot serve.  Reads always come from the WAGO.
+*/
+
+int
+wagoMirror(int gs, char *host, int slaveAddr, int startRef, short regArr[], int refCnt)
+{
+  struct wago_mirror *wm;
+  short regs[WAGO_MAXREGS];
+  int ierr;
+  int r, i;
+
+  if (slaveAddr != 1 || (wm = wagoMirrorFind(host)) == NULL)
+    return wagoSetGet(gs,host,slaveAddr,startRef,regArr,refCnt);
+
+  r = wagoMirrorRange(wm,startRef,refCnt);
+
+  if (!gs) {  // read the whole range from the WAGO, refreshing the image
+    if (r < 0 || wagoMirrorRead(host,wm,r,regs) < 0)
+      return wagoSetGet(gs,host,slaveAddr,startRef,regArr,refCnt);
+    memcpy(regArr,&regs[startRef-wm->first[r]],refCnt*sizeof(short));
+    return refCnt;
+  }
+
+  pthread_mutex_lock(&wm->lock);
+  if (wm->hold && r >= 0) {  // staged until wagoMirrorFlush()
+    for (i=0; i<refCnt; i++) {
+      wm->stage[r][startRef-wm->first[r]+i] = regArr[i];
+      wm->dirty[r][startRef-wm->first[r]+i] = 1;
+    }
+    pthread_mutex_unlock(&wm->lock);
+    return refCnt;
+  }
+  wm->gen++;
+  pthread_mutex_unlock(&wm->lock);
+
+  ierr = wagoSetGet(gs,host,slaveAddr,startRef,regArr,refCnt);
+
+  pthread_mutex_lock(&wm->lock);
+  for (i=0; i<2; i++)
+    if (i != r || ierr < 0) wm->time[i] = 0;
+  if (r >= 0 && ierr >= 0)
+    memcpy(&wm->image[r][startRef-wm->first[r]],regArr,refCnt*sizeof(short));
+  pthread_mutex_unlock(&wm->lock);
+
+  return ierr;
+}
+
+/*!
+  \brief Read reported-only WAGO registers through the register mirror
+
+  Same arguments and return values as wagoSetGet().  Answers from the
+  image while it is younger than WAGO_CACHEMS, otherwise reads the
+  WAGO like wagoMirror().  Only for values that are reported, like the
+  temperatures and pressures in the status replies, never for states a
+  command acts on.
+*/
+
+int
+wagoMirrorCached(char *host, int slaveAddr, int startRef, short regArr[], int refCnt)
+{
+  struct wago_mirror *wm;
+  long age;
+  int r;
+
+  if (slaveAddr == 1 && (wm = wagoMirrorFind(host)) != NULL &&
+      (r = wagoMirrorRange(wm,startRef,refCnt)) >= 0) {
+    pthread_mutex_lock(&wm->lock);
+    age = mlcMSec() - wm->time[r];
+    if (wm->time[r] > 0 && age <= wagoCacheMS) {
+      memcpy(regArr,&wm->image[r][startRef-wm->first[r]],refCnt*sizeof(short));
+      pthread_mutex_unlock(&wm->lock);
+      return refCnt;
+    }
+    pthread_mutex_unlock(&wm->lock);
+  }
+  return wagoMirror(0,host,slaveAddr,startRef,regArr,refCnt);
+}
+
+/*!
+  \brief Start staging writes to a WAGO's mirrored registers
+  \param host WAGO IP address
+
+  Writes are not sent until wagoMirrorFlush(), and reads return what
+  the WAGO has until then, not the staged values.  Only for writes
+  whose order and timing do not matter, e.g., several outputs cleared
+  at once.
+*/
+
+void
+wagoMirrorHold(char *host)
+{
+  struct wago_mirror *wm;
+
+  if ((wm = wagoMirrorFind(host)) == NULL) return;
+  pthread_mutex_lock(&wm->lock);
+  wm->hold = 1;
+  pthread_mutex_unlock(&wm->lock);
+}
+
+/*!
+  \brief Send the writes staged since wagoMirrorHold()
+  \param host WAGO IP address
+  \return 0 on success, -1 if any of the writes failed
+
+  Each run of adjacent staged registers goes out as one write, and the
+  image takes the values written only if that write succeeded.
+*/
+
+int
+wagoMirrorFlush(char *host)
+{
+  struct wago_mirror *wm;
+  short regs[WAGO_MAXREGS];
+  int first, n, ok;
+  int ierr = 0;
+  int r, i;
+
+  if ((wm = wagoMirrorFind(host)) == NULL) return 0;
+
+  pthread_mutex_lock(&wm->lock);
+  wm->hold = 0;
+  for (r=0; r<2; r++) {
+    for (i=0; i<wm->count[r]; i++) {
+      if (!wm->dirty[r][i]) continue;
+      for (n=0; i+n<wm->count[r] && wm->dirty[r][i+n]; n++) {
+	regs[n] = wm->stage[r][i+n];
+	wm->dirty[r][i+n] = 0;
+      }
+      first = wm->first[r]+i;
+      wm->gen++;
+      pthread_mutex_unlock(&wm->lock);
+      ok = (wagoSetGet(1,host,1,first,regs,n) >= 0);
+      pthread_mutex_lock(&wm->lock);
+      if (ok)
+	memcpy(&wm->image[r][i],regs,n*sizeof(short));
+      else
+	ierr = -1;
+      i += n-1;
+    }
+  }
+  wm->time[0] = wm->time[1] = 0;  // inputs can follow the outputs just written
+  pthread_mutex_unlock(&wm->lock);
+  return ierr;
+}
+
+/*!
+  \brief Refresh every mirrored WAGO range
+  Called by the mmcServer state poller on its cadence.
+*/
+
+void
+wagoMirrorRefresh(void)
+{
+  short regs[WAGO_MAXREGS];
+  int k, r;
+
+  for (k=0; k<WAGO_NWAGO; k++)
+    for (r=0; r<2; r++)
+      if (wagoImage[k].count[r] > 0)
+	wagoMirrorRead(shm_addr->MODS.WAGOIP[k],&wagoImage[k],r,regs);
+}
+
 //---------------------------------------------------------------------------
 //
 // wagoRW(iebID, who, what, cmd, dummy) - Read and/or Write to Wago system
@@ -1891,7 +2644,7 @@ wagoRW(int iebID, char who[], int what, int value,char dummy[])
     if (what) {
       onoff[0]=(short)value; // Turn off the 65V power supply
       onoff[1]=(short)value;
-      ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[ieb_id],1,513,&onoff[0],1);
+      ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[ieb_id],1,513,&onoff[0],1);
       if (!ierr)
 	sprintf(dummy,"IEB_%c=ON MPOWER_%c=ON",
 		(iebID==1 ? 'R' : 'B'),
@@ -1904,7 +2657,7 @@ wagoRW(int iebID, char who[], int what, int value,char dummy[])
 
     }
     else {
-      ierr = wagoSetGet(what,shm_addr->MODS.WAGOIP[ieb_id],1,513,regData,1);
+      ierr = wagoMirror(what,shm_addr->MODS.WAGOIP[ieb_id],1,513,regData,1);
       if (!ierr)
 	sprintf(dummy,"IEB_%c=ON MPOWER_%c=ON",
 		(iebID==1 ? 'R' : 'B'),
@@ -1921,9 +2674,9 @@ wagoRW(int iebID, char who[], int what, int value,char dummy[])
     return CMD_OK;
   }
   else if (!strcasecmp(who,"BYNAME")) {
-    ierr = wagoSetGet(what,shm_addr->MODS.WAGOIP[ieb_id],1,513,regData,1);
+    ierr = wagoMirror(what,shm_addr->MODS.WAGOIP[ieb_id],1,513,regData,1);
     MilliSleep(100);
-    ierr = wagoSetGet(what,shm_addr->MODS.WAGOIP[ieb_id],1,512,onoff,1);
+    ierr = wagoMirror(what,shm_addr->MODS.WAGOIP[ieb_id],1,512,onoff,1);
     
     if (iebID==1)
       blueIndex=-1;
@@ -1951,9 +2704,9 @@ wagoRW(int iebID, char who[], int what, int value,char dummy[])
     }
   }
   else if (!strcasecmp(who,"MLCS")) {
-    ierr = wagoSetGet(what,shm_addr->MODS.WAGOIP[ieb_id],1,513,regData,1);
+    ierr = wagoMirror(what,shm_addr->MODS.WAGOIP[ieb_id],1,513,regData,1);
     MilliSleep(100);
-    ierr = wagoSetGet(what,shm_addr->MODS.WAGOIP[ieb_id],1,512,onoff,1);
+    ierr = wagoMirror(what,shm_addr->MODS.WAGOIP[ieb_id],1,512,onoff,1);
 
     if (value==0 || value>16) {
       if (ierr==-1) {
@@ -1982,7 +2735,7 @@ wagoRW(int iebID, char who[], int what, int value,char dummy[])
     
     if (!value) {
       for (i=4,ierr=0;i<8;i++,ierr++) {
-	ierr = wagoSetGet(what,shm_addr->MODS.WAGOIP[ieb_id],1,i,regData,1);
+	ierr = wagoMirror(what,shm_addr->MODS.WAGOIP[ieb_id],1,i,regData,1);
 	temperature[ierr]=(float)(regData[0])/10.0;
 	if (iebID==1) {
 	  sprintf(dummy,"%s %s=%0.1f",dummy,tempRMonitor[ierr],temperature[ierr]);
@@ -1992,7 +2745,7 @@ wagoRW(int iebID, char who[], int what, int value,char dummy[])
 	}
       }
     } else {
-      ierr = wagoSetGet(what,shm_addr->MODS.WAGOIP[ieb_id],1,value+3,regData,1);
+      ierr = wagoMirror(what,shm_addr->MODS.WAGOIP[ieb_id],1,value+3,regData,1);
       temperature[value-1]=(float)(regData[0])/10.0;
       if (iebID==1)
 	sprintf(dummy,"%s %s=%0.1f",dummy,tempRMonitor[value-1],temperature[value-1]);
@@ -2001,28 +2754,28 @@ wagoRW(int iebID, char who[], int what, int value,char dummy[])
     }
   }
   else if (!strcasecmp(who,"MPOWER")) {
-    ierr = wagoSetGet(what,shm_addr->MODS.WAGOIP[ieb_id],1,513,regData,1);
+    ierr = wagoMirror(what,shm_addr->MODS.WAGOIP[ieb_id],1,513,regData,1);
     sprintf(dummy,"%s MPOWER_%c=%s ",dummy,(iebID==1 ? 'R' : 'B'),( !ierr ? "ON" : "OFF"));
 
-    ierr = wagoSetGet(what,shm_addr->MODS.WAGOIP[ieb_id],1,0,regData,1);
+    ierr = wagoMirror(what,shm_addr->MODS.WAGOIP[ieb_id],1,0,regData,1);
     vdrive = ((float)(regData[0])/pow(2,15)*10)*9.28;
     sprintf(dummy,"%s VDRIVE_%c=%0.3f",dummy,(iebID==1 ? 'R' : 'B'),vdrive);
 
-    ierr = wagoSetGet(what,shm_addr->MODS.WAGOIP[ieb_id],1,2,regData,1);
+    ierr = wagoMirror(what,shm_addr->MODS.WAGOIP[ieb_id],1,2,regData,1);
     idrive = ((float)(regData[0])/pow(2,15)*10)*1.25;
     sprintf(dummy,"%s IDRIVE_%c=%0.3f",dummy,(iebID==1 ? 'R' : 'B'),idrive);
 
   }
   else if (!strcasecmp(who,"IVS")) {
-    ierr = wagoSetGet(what,shm_addr->MODS.WAGOIP[ieb_id],1,0,regData,1);
+    ierr = wagoMirror(what,shm_addr->MODS.WAGOIP[ieb_id],1,0,regData,1);
     vdrive = ((float)(regData[0])/pow(2,15)*10)*9.28;
     sprintf(dummy,"%s VDRIVE_%c=%0.3f",dummy,(iebID==1 ? 'R' : 'B'),vdrive);
 
-    ierr = wagoSetGet(what,shm_addr->MODS.WAGOIP[ieb_id],1,2,regData,1);
+    ierr = wagoMirror(what,shm_addr->MODS.WAGOIP[ieb_id],1,2,regData,1);
     idrive = ((float)(regData[0])/pow(2,15)*10)*1.25;
     sprintf(dummy,"%s IDRIVE_%c=%0.3f",dummy,(iebID==1 ? 'R' : 'B'),idrive);
 
-    ierr = wagoSetGet(what,shm_addr->MODS.WAGOIP[ieb_id],1,1,regData,1);
+    ierr = wagoMirror(what,shm_addr->MODS.WAGOIP[ieb_id],1,1,regData,1);
     vcontrol = ((float)(regData[0])/pow(2,15)*10)*3.12;
     sprintf(dummy,"%s VCONTROL_%c=%0.3f",dummy,(iebID==1 ? 'R' : 'B'),vcontrol);
   }
@@ -2146,12 +2899,12 @@ mlcPANIC(int device, char who [], char dummy[])
   if (!strcasecmp(who,"MODS1")) {
     devOnOff[0]=0;
     devOnOff[1]=0;
-    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[device],1,512,devOnOff,1);
+    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[device],1,512,devOnOff,1);
     
   } else if (!strcasecmp(who,"MODS2")) {
     devOnOff[0]=0;
     devOnOff[1]=0;
-    ierr = wagoSetGet(1,shm_addr->MODS.WAGOIP[device],1,512,devOnOff,1);
+    ierr = wagoMirror(1,shm_addr->MODS.WAGOIP[device],1,512,devOnOff,1);
 
   } else {
     sprintf(dummy,"Invalid '%s' command",argbuf); 
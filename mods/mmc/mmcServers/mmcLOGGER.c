@@ -4,6 +4,11 @@
 #include <sstream>
 #include <vector>
 #include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
 
 using namespace std;
  
@@ -36,6 +41,10 @@ int getCurrentTime(char* , char* );
   to properly initialize str and not use an append to build it.  That
   latter part proved to not be thread safe in fast computers like the new
   64-bit systems for the 2025 Archon updates [rwp/osu]
+
+  The string is now per-thread, and the date and the microseconds come
+  from the same gettimeofday() reading, so worker threads each get
+  their own timestamp [2026 Oct 17]
   
 */
 
@@ -43,36 +52,270 @@ char
 *getDateTime(void)
 {
   struct timeval tv;
-  static char str[64]; // was 30, made 64 for enough room
-  char *ptr;
-  struct tm *gmt;
-  time_t t;
-  int monthNum;
-  int ccyy;
+  static __thread char str[64]; // one per thread
+  struct tm gmt;
 
-  // First get the UTC time 
+  // Get the UTC time to usec precision, and break it out
 
-  t = time(NULL);
-  gmt = gmtime(&t);
+  gettimeofday(&tv,NULL);
+  gmtime_r(&tv.tv_sec,&gmt);
 
-  // Now get the usec part. If we're off a couple of usec no big deal.
+  // ISO 8601 date/time format to usec precision: ccyy-mm-ddThh:mm:ss.ssssss
 
-  gettimeofday(&tv,NULL);
-  ptr = ctime(&tv.tv_sec);
+  snprintf(str,sizeof(str),"%.4i-%.2i-%.2iT%.2i:%.2i:%.2i.%06ld",gmt.tm_year+1900,
+	   gmt.tm_mon+1,gmt.tm_mday,gmt.tm_hour,gmt.tm_min,gmt.tm_sec,(long)tv.tv_usec);
+
+  return(str);
+}
 
-  // compute month number 1s relative, and CCYY from YY
+//---------------------------------------------------------------------------
+//
+// Log writer
+//
+// mmcLOGGER() used to open the log file, write one line, flush and
+// close it again on every call, after checking the UT date for a
+// rollover.  Now each log file has a ring buffer in memory: callers
+// timestamp the line, copy it into the ring under a short lock, and go
+// on.  A flush thread, started on the first call, writes the rings out
+// through one persistent O_APPEND descriptor per file and checks for a
+// change of UT date once a second.  A line that does not fit in a full
+// ring is dropped and counted, and the count is written to the log
+// when there is room again, so a stalled disk never blocks a command.
+// Bytes that cannot be written (e.g., ENOSPC) are counted the same
+// way.  Lines still in the rings are written at exit().
+//
+// Signal handlers log too (agwServer's HandleInt()).  A handler that
+// interrupts its own thread inside mmcLOGGER() or mmcLogFlush() would
+// wait forever on a lock that thread holds, so logBusy marks those
+// calls and a line logged from inside one is dropped and counted.
+//
+
+#define LOG_MAXFILES  4        // log files one process can write
+#define LOG_RINGSIZE  262144   // ring buffer per log file, bytes
+#define LOG_MAXLINE   8192     // longest log line, longer lines are cut
+
+static struct log_file {
+  char path[80];        // log file name, "" if the entry is free
+  char dateTag[80];     // UT date of the lines in the file
+  int fd;               // open log file, -1 if none
+  char ring[LOG_RINGSIZE];
+  size_t head;          // total bytes put into the ring
+  size_t tail;          // total bytes written out of the ring
+  long dropped;         // lines dropped since the last report
+  size_t lost;          // bytes not written since the last report
+  int lostErr;          // errno of the last failed write
+} logFiles[LOG_MAXFILES];
+
+static int logCount = 0;  // entries in use in logFiles[]
+static long logReentered = 0;   // lines dropped by re-entry, see logBusy
+static __thread int logBusy = 0; // this thread is in mmcLOGGER() or mmcLogFlush()
+
+static pthread_mutex_t logLock = PTHREAD_MUTEX_INITIALIZER;   // rings
+static pthread_mutex_t logIOLock = PTHREAD_MUTEX_INITIALIZER; // file I/O
+static pthread_cond_t logReady = PTHREAD_COND_INITIALIZER;
+static pthread_once_t logOnce = PTHREAD_ONCE_INIT;
+
+// Open the log file for appending, world read/writable as before
+
+static void
+logOpen(struct log_file *lf)
+{
+  lf->fd = open(lf->path,O_WRONLY|O_APPEND|O_CREAT,0666);
+  if (lf->fd >= 0) fchmod(lf->fd,0666);
+}
 
-  monthNum = (gmt->tm_mon)+1;
-  ccyy = gmt->tm_year + 1900;
+// Start a new log file if the UT date has changed: rename the log to
+// logfile.date.log, as mmcLOGGER() always has
 
-  // ISO 8601 date/time format to usec precision: ccyy-mm-ddThh:mm:ss.ssssss
+static void
+logRollover(struct log_file *lf, char *today)
+{
+  char newfile[160];
+  int len;
 
-  memset(str,0,sizeof(str));
-  
-  sprintf(str,"%.4i-%.2i-%.2iT%.2i:%.2i:%.2i.%06ld",ccyy,monthNum,
-          gmt->tm_mday,gmt->tm_hour,gmt->tm_min,gmt->tm_sec,tv.tv_usec);
+  if (!strcasecmp(lf->dateTag,today)) return;
 
-  return(str);
+  len = strlen(lf->path);
+  if (len > 4) len -= 4;  // Remove the .log extention from filename
+  snprintf(newfile,sizeof(newfile),"%.*s.%s.log",len,lf->path,lf->dateTag);
+
+  if (lf->fd >= 0) close(lf->fd);
+  rename(lf->path,newfile);
+  chmod(newfile,0666);  // Give permissions for dated logfile
+
+  strcpy(lf->dateTag,today);
+  snprintf(shm_addr->MODS.mmcUpdate1,sizeof(shm_addr->MODS.mmcUpdate1),"%s",today);
+  logOpen(lf);
+}
+
+// Write out everything in the rings.  Only the ring pointers are
+// touched under logLock, the writes are done under logIOLock alone.
+
+static void
+logDrain(int rollover)
+{
+  struct log_file *lf;
+  char today[80];
+  char note[80];
+  size_t head, tail, n, off;
+  ssize_t nw;
+  long dropped;
+  int i, nfiles;
+
+  pthread_mutex_lock(&logIOLock);
+
+  pthread_mutex_lock(&logLock);
+  nfiles = logCount;
+  if (nfiles > 0) // lines from re-entry are noted in the first log
+    logFiles[0].dropped += __atomic_exchange_n(&logReentered,0,__ATOMIC_RELAXED);
+  pthread_mutex_unlock(&logLock);
+
+  if (rollover) snprintf(today,sizeof(today),"%s",UTCDateTag());
+
+  for (i=0; i<nfiles; i++) {
+    lf = &logFiles[i];
+    if (rollover) logRollover(lf,today);
+    if (lf->fd < 0) logOpen(lf);
+
+    pthread_mutex_lock(&logLock);
+    head = lf->head;
+    tail = lf->tail;
+    dropped = lf->dropped;
+    lf->dropped = 0;
+    pthread_mutex_unlock(&logLock);
+
+    // The bytes from tail to head are ours until tail is moved on.
+    // With no file open, or if a write fails, they are discarded and
+    // counted, and the count is noted once the log can be written.
+
+    while (tail < head && lf->fd >= 0) {
+      off = tail % LOG_RINGSIZE;
+      n = head - tail;
+      if (n > LOG_RINGSIZE - off) n = LOG_RINGSIZE - off;
+      if ((nw = write(lf->fd,&lf->ring[off],n)) <= 0) {
+	lf->lostErr = (nw < 0) ? errno : ENOSPC;
+	break;
+      }
+      tail += nw;
+    }
+    if (tail < head) {
+      if (lf->fd < 0) lf->lostErr = errno;
+      lf->lost += head - tail;
+    }
+    else if (lf->lost > 0 && lf->fd >= 0) {
+      n = snprintf(note,sizeof(note),"%s mmcLOGGER: %lu bytes lost, log write failed: %s\n",
+		   getDateTime(),(unsigned long)lf->lost,strerror(lf->lostErr));
+      if (write(lf->fd,note,n) == (ssize_t)n) lf->lost = 0;
+    }
+    if (dropped > 0 && lf->fd >= 0) {
+      n = snprintf(note,sizeof(note),"%s mmcLOGGER: %ld lines dropped, log buffer full or busy\n",
+		   getDateTime(),dropped);
+      if (write(lf->fd,note,n) == (ssize_t)n) dropped = 0;
+    }
+    if (dropped > 0) {
+      pthread_mutex_lock(&logLock);
+      lf->dropped += dropped;  // report them next time
+      pthread_mutex_unlock(&logLock);
+    }
+
+    pthread_mutex_lock(&logLock);
+    lf->tail = head;
+    pthread_mutex_unlock(&logLock);
+  }
+
+  pthread_mutex_unlock(&logIOLock);
+}
+
+// The flush thread: write out new lines as they arrive, and check the
+// UT date once a second
+
+static void *
+logFlusher(void *arg)
+{
+  struct timespec wake;
+  time_t lastCheck = 0;
+  int i, pending;
+
+  for (;;) {
+    pthread_mutex_lock(&logLock);
+    for (;;) {
+      for (pending=0, i=0; i<logCount; i++)
+	if (logFiles[i].head != logFiles[i].tail || logFiles[i].dropped) pending = 1;
+      if (pending || time(NULL) != lastCheck) break;
+      clock_gettime(CLOCK_REALTIME,&wake);
+      wake.tv_sec++;
+      wake.tv_nsec = 0;
+      pthread_cond_timedwait(&logReady,&logLock,&wake);
+    }
+    pthread_mutex_unlock(&logLock);
+
+    if (time(NULL) != lastCheck) {
+      lastCheck = time(NULL);
+      logDrain(1);
+    }
+    else
+      logDrain(0);
+  }
+  return NULL;
+}
+
+/*!
+  \brief Write out all buffered log lines now
+
+  Called at exit(), and by anyone who needs the log on disk before
+  going on.  Does nothing if this thread is already inside
+  mmcLOGGER() or mmcLogFlush(), i.e., exit() from a signal handler.
+*/
+
+void
+mmcLogFlush(void)
+{
+  if (logBusy) return;
+  logBusy = 1;
+  logDrain(0);
+  logBusy = 0;
+}
+
+// Start the flush thread with all signals blocked, so signal handlers
+// (which log) always run in some other thread
+
+static void
+logStart(void)
+{
+  pthread_t tid;
+  sigset_t all, old;
+
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK,&all,&old);
+  if (pthread_create(&tid,NULL,logFlusher,NULL) == 0)
+    pthread_detach(tid);
+  pthread_sigmask(SIG_SETMASK,&old,NULL);
+  atexit(mmcLogFlush);
+}
+
+// Find or add the entry for a log file, NULL if the table is full.
+// Call with logLock held.
+
+static struct log_file *
+logFind(char *path)
+{
+  int i;
+
+  for (i=0; i<logCount; i++)
+    if (!strcmp(logFiles[i].path,path)) return &logFiles[i];
+  if (i == LOG_MAXFILES || strlen(path) >= sizeof(logFiles[i].path)) return NULL;
+
+  // Lines already in a log from an earlier UT date (e.g., a restart
+  // after midnight) are renamed to that date at the first check
+
+  strcpy(logFiles[i].path,path);
+  if (strlen(shm_addr->MODS.mmcUpdate1) <= 0)
+    sprintf(shm_addr->MODS.mmcUpdate1,"%s",UTCDateTag());
+  snprintf(logFiles[i].dateTag,sizeof(logFiles[i].dateTag),"%s",shm_addr->MODS.mmcUpdate1);
+  logFiles[i].fd = -1;
+  logFiles[i].lost = 0;
+  logCount++;
+  return &logFiles[i];
 }
 
 /*!
@@ -80,38 +323,55 @@ char
 
   Reads system's UTC time with getDataTime() function and logs 
   Service infomation to mmc.log
+
+  The line is queued for the flush thread (see "Log writer" above)
+  and written out within milliseconds.  mmcLOGGER() never waits on the
+  disk, and is safe to call from any thread.  A call from a signal
+  handler that interrupted mmcLOGGER() in the same thread drops its
+  line and counts it, rather than deadlock on logLock.
   
 */
 
 int
 mmcLOGGER(char path[79], char msg[512])
 { 
-  int len;
-  int result;
-  char newfile[80];
+  struct log_file *lf;
+  char line[LOG_MAXLINE];
+  size_t len, off, n;
 
-  // Check for change of UT Date
+  if (logBusy) {
+    __atomic_add_fetch(&logReentered,1,__ATOMIC_RELAXED);
+    return -1;
+  }
+  logBusy = 1;
 
-  if (strlen(shm_addr->MODS.mmcUpdate1) <= 0)
-    sprintf(shm_addr->MODS.mmcUpdate1,"%s",UTCDateTag());
+  pthread_once(&logOnce,logStart);
 
-  if (strcasecmp(shm_addr->MODS.mmcUpdate1,UTCDateTag())) {
-    len=strlen(path);
-    strncpy(newfile,path,len-4); // Remove the .log extention from filename
-    len=strlen(newfile);
-    sprintf(&newfile[len],".%s.log",shm_addr->MODS.mmcUpdate1); // Append date
-    
-    result=rename(path,newfile); // rename the logfile to logfile.date.log
-
-    sprintf(shm_addr->MODS.mmcUpdate1,"%s",UTCDateTag()); // recap DateTag
-    chmod(path,0666);  // Give permissions to default logging file
-    chmod(newfile,0666); // Give permissions for dated logfile
+  len = snprintf(line,sizeof(line),"%s %s\n",getDateTime(),msg);
+  if (len >= sizeof(line)) {
+    len = sizeof(line)-1;
+    line[len-1] = '\n';
   }
 
-  ofstream mmclog;
-  mmclog.open(path, ios::app);
-  mmclog << getDateTime() << " " << msg << endl;
-  mmclog.close();
+  pthread_mutex_lock(&logLock);
+  if ((lf = logFind(path)) == NULL) {
+    pthread_mutex_unlock(&logLock);
+    logBusy = 0;
+    return -1;
+  }
+  if (LOG_RINGSIZE - (lf->head - lf->tail) < len) {
+    lf->dropped++;
+  }
+  else {
+    off = lf->head % LOG_RINGSIZE;
+    n = (len < LOG_RINGSIZE - off) ? len : LOG_RINGSIZE - off;
+    memcpy(&lf->ring[off],line,n);
+    memcpy(lf->ring,line+n,len-n);
+    lf->head += len;
+  }
+  pthread_cond_signal(&logReady);
+  pthread_mutex_unlock(&logLock);
+  logBusy = 0;
   return 0;
 }
 
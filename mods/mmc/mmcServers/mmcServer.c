@@ -6,13 +6,14 @@
  
   \section Usage
  
-  Purpose: Starts MODS get/set specific threads and then execute the following:
-            (1) thread (x) waits for connection from a MODS mechanism client
-            (2) thread (x) sends out command request to instrutils
-            (3) instrutils gets/sets information/commmand
-            (4) thread (x) sends MicroLynx requested information or ERROR to client.
-            (5) MODS mechanism client closes the connection.
-            (6) go back to step (1)
+  Purpose: Starts a pool of MODS get/set worker threads and then execute the following:
+            (1) the main thread waits (epoll) for a MODS mechanism client
+                connection or ISIS message and reads the complete request
+            (2) the main thread queues the request for the next free worker (x)
+            (3) worker (x) sends out command request to instrutils
+            (4) instrutils gets/sets information/commmand
+            (5) worker (x) sends MicroLynx requested information or ERROR to client.
+            (6) worker (x) closes the connection and waits for the next request
 
   Usage: 
   mmcServer &  - Default Port = 10435
@@ -29,6 +30,28 @@
   Accepts commands from a MODS mechanism client and returns
   information or errors.
 
+  TCP clients normally connect, send one NUL-terminated command, read
+  the reply, and the server closes the connection.  A client that sends
+  many commands can instead open a persistent session by sending
+  \c session as its first command.  The server replies "DONE: SESSION"
+  and keeps the connection open; the client then sends commands
+  terminated by newlines (or NULs), as many at a time as it likes, and
+  reads one NUL-terminated reply per command, in the order sent.  A
+  session's commands are run one at a time.  The client ends the
+  session by closing the connection.  See mmcSession.c in the mmc
+  client library.
+
+  Workers run commands for different mechanisms at the same time.
+  Commands for the same mechanism, or that share the WAGO power
+  interfaces, wait their turn in that mechanism's queue (see runAction()
+  in commands.c), so a slow move holds up only its own mechanism.
+
+  A background thread polls each idle mechanism's position, IO bits
+  and power-fail flag every MLC_POLLMS msec into shared memory
+  (stateTime[], stateSeq[], mlcPos[], mlcIO20[], mlcPwrFail[]), and
+  the grating tilt, collimator TTF and camera focus queries answer
+  from it while it is younger than MLC_CACHEMS.
+
   \section Notes
 
   This application uses the RTE library (link).
@@ -46,6 +69,16 @@
   2025 Aug 8 - Port to AlmaLinux 9.x [rwp/osu]
   2026 Feb 18 - need to add mutex locks to avoid resource conflicts, esp
                 when logging [rwp/osu]
+  2026 Oct 17 - replaced the 100 polling threads (1 ms MilliSleep()
+                loops sharing one command buffer) with an epoll reactor
+                feeding a worker pool, one request context per command,
+                and fixed the choose_thread() out-of-bounds bug
+  2026 Oct 17 - persistent TCP sessions: "session" then newline-framed
+                commands, NUL-framed replies in order
+  2026 Oct 17 - start the MicroLynx state poller thread
+  2026 Oct 17 - build the command and mechanism name lookup tables
+  2026 Oct 17 - serviceControl() closes, reopens and reloads the ports
+                holding every command queue
   </pre>
 */
 
@@ -61,6 +94,8 @@ using namespace std;
 #include <stdlib.h>
 #include <sys/timeb.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <netinet/in.h>
@@ -69,6 +104,7 @@ using namespace std;
 #include <signal.h>
 #include <errno.h>
 #include <unistd.h>
+#include <time.h>
 
 #include "mmc_client.h"  // Custom client application header
 
@@ -84,39 +120,65 @@ struct islcommon *mechs;
 extern int wagoSetGet(int,char [],int,int,short int*,int);
 extern int getWagoID(char [],char []); // Get WAGO ID
 extern int isisStatusMsg(char []);
+extern void startStatePoller(void); // MicroLynx state poller (see commands.c)
+extern void cmdIndexBuild(void);    // command lookup tables (see commands.c)
+extern void queueHoldAll(void);     // hold every command queue (see commands.c)
+extern void queueReleaseAll(void);
+extern int  mlcOpenPort(int);       // open/close a mechanism port (see mlc.c)
+extern void mlcClosePort(int);
 // extern int MSOpenPort(char *);
 
-#define MAX_CLIENT_PER_THREAD 64
-#define MAX_THREAD 100
 #define PORT 10435
 #define PROMPT "M1%"
 
-char buf[ISIS_MSGSIZE]; // command/message buffer
-char tempbuf[80]; // temporary buffer for saving last command before failiar
+#define MMC_WORKERS   32  // request worker threads
+#define MMC_MAXEVENTS 64  // epoll events handled per wakeup
+#define MMC_REQWAIT   50  // msec to wait for the rest of an unterminated TCP request
+#define MMC_SENDWAIT  10000  // msec to wait for a client to accept a reply
+
+char buf[ISIS_MSGSIZE]; // startup message buffer (main thread only)
 
 isisclient_t appClient; // ISIS AGW Client data structure
 isisclient_t client; // ISIS Client data structure
 
 struct sockaddr_in srv, cli;
-                                                                               
+
 void sig_chld(int);
 
 char timestr[80];
 int cmdCounter;
 int listenfd;
-int clifd;
-fd_set read_fd;
-int charReceived;
-int readFromListen_port;
-char getset_reply[ISIS_MSGSIZE]; // This is for logging purposes
 int mmcLOGGER(char [],char []);
 int allPower;
 
-typedef struct {
-  pthread_t tid;
-  int client_count;
-  int clients[MAX_CLIENT_PER_THREAD];
-} Thread;
+/*!
+  \brief mmcServer request context
+
+  One per TCP connection or ISIS message, so concurrent requests never
+  share buffers.  The main thread fills it in and passes it to a worker
+  thread on the request queue, and the worker frees it when done.
+
+  A TCP connection that opens with the \c session command stays open
+  as a persistent session: the client sends newline-terminated
+  commands back to back and gets one NUL-terminated reply per command,
+  in order.  The main thread keeps reading into in[] while a worker
+  runs the commands already received, one at a time (see
+  sessionCommands()).  The session fields are protected by sessLock.
+*/
+
+typedef struct mmc_request {
+  int  fd;                   // TCP connection, -1 for an ISIS message
+  long t0;                   // msecNow() when the first bytes arrived
+  int  session;              // persistent session connection
+  int  busy;                 // a worker is running the session's commands
+  int  closed;               // session closed by the client, free when idle
+  int  paused;               // session input is full, not being read
+  int  inLen;                // bytes in in[]
+  char in[ISIS_MSGSIZE];     // bytes received, not yet taken as a command
+  char buf[ISIS_MSGSIZE];    // request
+  char reply[LONG_STR_SIZE]; // reply to a TCP request
+  struct mmc_request *next;  // reading or request queue list link
+} mmcRequest;
 
 typedef struct {
   char errors[25][128];
@@ -124,19 +186,30 @@ typedef struct {
 } agw_errors;
 
 agw_errors errmsgs;
+pthread_mutex_t errLock = PTHREAD_MUTEX_INITIALIZER; // protects errmsgs
+
+// Request queue from the main thread to the workers
+
+mmcRequest *reqHead = NULL;
+mmcRequest *reqTail = NULL;
+pthread_mutex_t reqLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t reqReady = PTHREAD_COND_INITIALIZER;
 
-// Thread declarations
+// Connections still being read (main thread only)
 
-void *thread_init_func(void *);
-pthread_cond_t new_connection_cond = PTHREAD_COND_INITIALIZER;
-pthread_mutex_t new_connection_mutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t lock; // generic mutex lock
+mmcRequest *readList = NULL;
 
-Thread threads[MAX_THREAD];
+pthread_mutex_t sessLock = PTHREAD_MUTEX_INITIALIZER; // session input and state
+pthread_mutex_t slotLock = PTHREAD_MUTEX_INITIALIZER; // ieb_msg[] slot counter
+pthread_mutex_t ctlLock = PTHREAD_MUTEX_INITIALIZER;  // serializes service control
+pthread_t workers[MMC_WORKERS];
+int epfd; // epoll instance, sessions are re-armed by workers
+
+void *requestWorker(void *);
 
 //------------------------------------------------
 
-// nonblock() function (currently unused)
+// nonblock() function - make a socket non-blocking
 
 void
 nonblock(int sockfd)
@@ -158,308 +231,623 @@ nonblock(int sockfd)
 
 extern char *getDateTime(void);
 
+// Monotonic time in milliseconds, for request timeouts
+
+static long
+msecNow(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return (long)ts.tv_sec*1000 + ts.tv_nsec/1000000;
+}
+
 //------------------------------------------------
 //
-// Thread function: thread_init_func()
+// Service control: serviceControl()
+//
+// This is a way of terminating the mmcServers via a client
+//   * close all MicroLynx Controller(MLC) communications(COMM)
+//   * exit the mmcServer
+//
+// Commands set client.KeepGoing to request an action, which is
+// carried out here after the command is done.  Serialized, since
+// any worker may find the request.  The ports are closed, reopened
+// and reconfigured holding every command queue with the state poller
+// stopped (queueHoldAll()), so no other worker and not the poller is
+// using a port or the configuration while it changes.
 //
 
 void
-*thread_init_func(void *arg)
+serviceControl(void)
 {
-  int tid = (long long) arg;
-
-  int readsocks;
-  int isis_read;
-  int fromlen;
-  int i;
-  int ierr;
-  int len;
-  char srcID[ISIS_NODESIZE];    // ISIS message sending node ID
-  char cmdName[BIG_STR_SIZE];
-  //char timestr[80];
-  char dummy[BIG_STR_SIZE];
-  char msg[ISIS_MSGSIZE];
-  char destID[ISIS_NODESIZE];   // ISIS message destination node ID
-  char c;
-  int n;
-  int m;
   int unit;
-  int ieb1_state=0;  // ON=1, OFF=0 for IEB1
-  int ieb2_state=0;  // ON=1, OFF=0 for IEB2
-  time_t ieb_timer;
-  int time_30sec=0;
-  int getMechanismID(char[],char[]);
-  int rawCommand(int,char[],char[]);
+  char dummy[BIG_STR_SIZE];
 
-  time(&ieb_timer); // IEB(s) timer
+  if (client.KeepGoing==1) return;
 
-  memset((int *) &threads[tid].clients,0,sizeof(threads[tid].clients));
-  memset(buf,0,sizeof(buf));
-  memset(tempbuf,0,sizeof(tempbuf));
-  shm_addr->MODS.mmcServerCounter=0;
+  pthread_mutex_lock(&ctlLock);
 
-  while(1) {
+  if (client.KeepGoing==1) { // another worker already did it
+    pthread_mutex_unlock(&ctlLock);
+    return;
+  }
 
-    MilliSleep(1);
+  queueHoldAll();
 
-    for (i = 0; i < MAX_CLIENT_PER_THREAD; i++) {
+  // Close all Host to MicroLynx communications and stop the
+  // mmcServers except the AGW
 
-      if (threads[tid].clients[i] != 0) {
+  if (client.KeepGoing==0) { // Close all MLC COMM. except AGW
+    for (unit=0;unit<MAX_ML-1;unit++) {
+      if (shm_addr->MODS.host[unit]==0);
+      else if (shm_addr->MODS.host[unit]==1 &&
+	       !strncasecmp(shm_addr->MODS.who[unit],"agw",3));
+      else
+	if (unit!=MAX_ML-1)
+	  mlcClosePort(unit);
+    }
+    isisStatusMsg((char*)"mmcServer communication closed and mmcServer halted");
+    mmcLOGGER(shm_addr->MODS.LLOG,(char*)"mmcServer communication closed and mmcServer halted");
+    exit(0); // exit mmcServer
+  }
 
-	if (readFromListen_port==1) { // Bypass the ISIS server
-	  memset(buf,0,sizeof(buf));
-	  memset(tempbuf,0,sizeof(tempbuf));
-	  n = recv(threads[tid].clients[i], buf, ISIS_MSGSIZE, 0);
+  // Close all Host to MicroLynx communications except the AGW
 
-	}
-	else if(readFromListen_port==2) { // Bypass the Listen server
-	  n=charReceived; // Check for ISIS reads
-	}
-	else
-	  n=0;
+  if (client.KeepGoing==2) {
+    for (unit=0;unit<MAX_ML-1;unit++) {
+      if (shm_addr->MODS.host[unit]==0);
+      else if (shm_addr->MODS.host[unit]==1 &&
+	       !strncasecmp(shm_addr->MODS.who[unit],"agw",3));
+      else
+	mlcClosePort(unit);
+    }
+    isisStatusMsg((char*)"mmcServer communication service to mechanisms closed");
+    mmcLOGGER(shm_addr->MODS.LLOG,(char*)"agwService communication service to mechanisms closed");
+    appClient.KeepGoing=2; // close AGW comm.
 
-	if (n == 0 ) {
-	  threads[tid].clients[i] = 0;
-	  threads[tid].client_count--;
+    client.KeepGoing=1;
+  }
 
+  // Open mmcServers restoring communications from Host to MicroLynx, except the AGW
+
+  if (client.KeepGoing==3) {
+
+    // Make MicroLynx inactive or active depending on config file
+
+    for (unit=0;unit<MAX_ML-1;unit++) {
+      if (strncasecmp(shm_addr->MODS.commport[unit].Port,"NONE",4)) {
+	shm_addr->MODS.host[unit]=1;
+	shm_addr->MODS.busy[unit]=0; // initialize
+      }
+    }
+
+    for (unit=0;unit<MAX_ML-1;unit++) {
+      if (shm_addr->MODS.host[unit]==0);
+      else if (shm_addr->MODS.host[unit]==1 &&
+	       !strncasecmp(shm_addr->MODS.who[unit],"agw",3) ||
+	       !strncasecmp(shm_addr->MODS.who[unit],"rimcs",5) ||
+	       !strncasecmp(shm_addr->MODS.who[unit],"bimcs",5));
+      else
+	if (unit!=MAX_ML-1) {
+	  mlcOpenPort(unit);
 	}
-	else if (n < 0) {
-	  if (errno == EAGAIN) {
-	    threads[tid].clients[i] = 0;
-	    threads[tid].client_count--;
-	  }
-	  else {
-	    threads[tid].clients[i] = 0;
-	    threads[tid].client_count--;
-	  }
+      sprintf(dummy,"%s mechanism opened",shm_addr->MODS.who[unit]);
+      isisStatusMsg(dummy);
+    }
+    isisStatusMsg((char*)"mmcServer communication service to mechanisms established");
+    mmcLOGGER(shm_addr->MODS.LLOG,(char*)"mmcServer communication service to mechanisms established");
+    appClient.KeepGoing=3; // open AGW comm.
 
+    client.KeepGoing=1;
+
+  }
+
+  // Reconfigure mmcServers and restore communications except the AGW
+
+  if (client.KeepGoing==4) {
+
+    // Make MicroLynx inactive or active depending on config file
+
+    for (unit=0;unit<MAX_ML-1;unit++) {
+      if (strncasecmp(shm_addr->MODS.commport[unit].Port,"NONE",4)) {
+	shm_addr->MODS.host[unit]=1;
+	shm_addr->MODS.busy[unit]=0; // initialize
+      }
+    }
+
+    for (unit=0;unit<MAX_ML-1;unit++) {
+      if (shm_addr->MODS.host[unit]==0);
+      else if (shm_addr->MODS.host[unit]==1 &&
+	       !strncasecmp(shm_addr->MODS.who[unit],"agw",3));
+      else
+	if (unit!=MAX_ML-1) {
+	  mlcClosePort(unit);
 	}
-	else {
-	  if (strstr(buf,"geterrormsg")) {
-	    readFromListen_port=0;  // reset client.FD listen
-	    for (ierr=0; ierr<errmsgs.err_cnt; ierr++) {
-	      send(threads[tid].clients[i], 
-		   errmsgs.errors[ierr], 
-                   strlen(errmsgs.errors[ierr]), 0); 
-	    }
-	    memset(buf,0,sizeof(buf));
-	    if (threads[tid].clients[i]>0)
-	      close(threads[tid].clients[i]);
-	    
-	  }
-	  else {
-
-	    if (readFromListen_port==1) {  // This bypasses ISIS
-
-	      readFromListen_port=0;  // reset client.FD listen
-
-	      // Save time and who sent command in Shared Memory
-	      
-	      ierr=shm_addr->MODS.mmcServerCounter;
-
-	      mmcLOGGER(shm_addr->MODS.LLOG,buf);
-
-	      strncpy(tempbuf,buf,79);
-	      tempbuf[79]='\0';
-	      sprintf(shm_addr->MODS.ieb_msg[ierr],"[%d] %s,t%d,fd%d,%d %s",ierr,getDateTime(),tid, threads[tid].clients[i],clifd,tempbuf);
-
-	      KeyCommand(buf,getset_reply);
-
-	      send(threads[tid].clients[i], getset_reply, strlen(getset_reply), 0);
-	      mmcLOGGER(shm_addr->MODS.LLOG,getset_reply);
-	      
-	      if (threads[tid].clients[i]>0)
-		close(threads[tid].clients[i]);
-
-	      memset(getset_reply,0,sizeof(getset_reply));
-	      memset(buf,0,sizeof(buf));
-	      memset(tempbuf,0,sizeof(tempbuf));
-
-	    }
-
-	    // This goes out to the isis server
-	    
-	    if (readFromListen_port==2) {
-
-	      readFromListen_port=0;  // reset client.FD listen
-
-	      // Save time and who sent command in Shared Memory
-	      
-	      ierr=shm_addr->MODS.mmcServerCounter;
-
-	      mmcLOGGER(shm_addr->MODS.LLOG,buf);
-
-	      strncpy(tempbuf,buf,79);
-	      tempbuf[79]='\0';
-	      sprintf(shm_addr->MODS.ieb_msg[ierr],"[%d] %s,t%d,fd%d %s",ierr,getDateTime(),tid, threads[tid].clients[i],tempbuf);
-
-	      SocketCommand(buf);
-	      memset(buf,0,sizeof(buf));
-	      memset(tempbuf,0,sizeof(tempbuf));
-	    }
-
-	    //----------------------------------------------------------------
-	    //
-	    // This is a way of terminating the mmcServers via a client
-	    //   * close all MicroLynx Controller(MLC) communications(COMM)
-	    //   * exit the mmcServer
-	    //
-	    
-	    // Close all Host to MicroLynx communications and stop the
-	    // mmcServers except the AGW
-
-	    if (client.KeepGoing==0) { // Close all MLC COMM. except AGW
-	      for (unit=0;unit<MAX_ML-1;unit++) {
-		if (shm_addr->MODS.host[unit]==0);
-		else if (shm_addr->MODS.host[unit]==1 &&
-			!strncasecmp(shm_addr->MODS.who[unit],"agw",3));
-		else
-		  if (unit!=MAX_ML-1)
-		    CloseTTYPort(&shm_addr->MODS.commport[unit]);
-	      }
-	      isisStatusMsg((char*)"mmcServer communication closed and mmcServer halted");
-	      mmcLOGGER(shm_addr->MODS.LLOG,(char*)"mmcServer communication closed and mmcServer halted");
-	      memset(buf,0,sizeof(buf));
-	      exit(0); // exit mmcServer
-	    }
-
-	    // Close all Host to MicroLynx communications except the AGW
-	    
-	    if (client.KeepGoing==2) {
-	      for (unit=0;unit<MAX_ML-1;unit++) {
-		if (shm_addr->MODS.host[unit]==0);
-		else if (shm_addr->MODS.host[unit]==1 &&
-			!strncasecmp(shm_addr->MODS.who[unit],"agw",3));
-		else
-		  CloseTTYPort(&shm_addr->MODS.commport[unit]);
-	      }
-	      isisStatusMsg((char*)"mmcServer communication service to mechanisms closed");
-	      mmcLOGGER(shm_addr->MODS.LLOG,(char*)"agwService communication service to mechanisms closed");
-	      memset(buf,0,sizeof(buf));
-	      appClient.KeepGoing=2; // close AGW comm.
-
-	      client.KeepGoing=1;
-	    }
-
-	    // Open mmcServers restoring communications from Host to MicroLynx, except the AGW 
-
-	    if (client.KeepGoing==3) {
-
-	      // Make MicroLynx inactive or active depending on config file
-	      
-	      for (unit=0;unit<MAX_ML-1;unit++) {
-		if (strncasecmp(shm_addr->MODS.commport[unit].Port,"NONE",4)) {
-		  shm_addr->MODS.host[unit]=1;
-		  shm_addr->MODS.busy[unit]=0; // initialize
-		}
-	      }
-
-	      for (unit=0;unit<MAX_ML-1;unit++) {
-		if (shm_addr->MODS.host[unit]==0);
-		else if (shm_addr->MODS.host[unit]==1 &&
-			!strncasecmp(shm_addr->MODS.who[unit],"agw",3) ||
-			!strncasecmp(shm_addr->MODS.who[unit],"rimcs",5) ||
-			!strncasecmp(shm_addr->MODS.who[unit],"bimcs",5));
-		else
-		  if (unit!=MAX_ML-1) {
-		    OpenTTYPort(&shm_addr->MODS.commport[unit]);
-		  }
-		sprintf(dummy,"%s mechanism opened",shm_addr->MODS.who[unit]);
-		isisStatusMsg(dummy);
-	      }
-	      isisStatusMsg((char*)"mmcServer communication service to mechanisms established");
-	      mmcLOGGER(shm_addr->MODS.LLOG,(char*)"mmcServer communication service to mechanisms established");
-	      memset(buf,0,sizeof(buf));
-	      appClient.KeepGoing=3; // open AGW comm.
-
-	      client.KeepGoing=1;
-
-	    }
-
-	    // Reconfigure mmcServers and restore communications except the AGW 
-
-	    if (client.KeepGoing==4) {
-
-	      // Make MicroLynx inactive or active depending on config file
-	      
-	      for (unit=0;unit<MAX_ML-1;unit++) {
-		if (strncasecmp(shm_addr->MODS.commport[unit].Port,"NONE",4)) {
-		  shm_addr->MODS.host[unit]=1;
-		  shm_addr->MODS.busy[unit]=0; // initialize
-		}
-	      }
-
-	      for (unit=0;unit<MAX_ML-1;unit++) {
-		if (shm_addr->MODS.host[unit]==0);
-		else if (shm_addr->MODS.host[unit]==1 &&
-			!strncasecmp(shm_addr->MODS.who[unit],"agw",3));
-		else
-		  if (unit!=MAX_ML-1) {
-		    CloseTTYPort(&shm_addr->MODS.commport[unit]);
-		  }
-	      }
-	      
-	      LoadConfig(DEFAULT_RCFILE);
-	      
-	      for (unit=0;unit<MAX_ML-1;unit++) {
-		if (shm_addr->MODS.host[unit]==0);
-		else if (shm_addr->MODS.host[unit]==1 &&
-			!strncasecmp(shm_addr->MODS.who[unit],"rimcs",5) ||
-			!strncasecmp(shm_addr->MODS.who[unit],"bimcs",5) ||
-			!strncasecmp(shm_addr->MODS.who[unit],"agw",3));
-		else
-		  if (unit!=MAX_ML-1) {
-		    CloseTTYPort(&shm_addr->MODS.commport[unit]);
-		    OpenTTYPort(&shm_addr->MODS.commport[unit]);
-		  }
-	      }
-
-	      isisStatusMsg((char*)"MODS instance has been reconfigured and communication to mechanisms have been reestablished");
-
-	      mmcLOGGER(shm_addr->MODS.LLOG,(char*)"MODS instance has been reconfigured and communication to mechanisms have been reestablished");
-	      memset(buf,0,sizeof(buf));
-	      appClient.KeepGoing=4; // Reconfigure AGW and open comm.
-
-	      client.KeepGoing=1;
-	    }
-	  }
-	
-	  if (strstr(getset_reply,"ERROR")) {
-	    
-	    if (errmsgs.err_cnt > 24) errmsgs.err_cnt=0;
-	    else errmsgs.err_cnt++;
-	    
-	    strcpy (errmsgs.errors[errmsgs.err_cnt],getset_reply);
-	    strcat (errmsgs.errors[errmsgs.err_cnt],"\n");
-	    errmsgs.errors[errmsgs.err_cnt]\
-	      [strlen(errmsgs.errors[errmsgs.err_cnt])]=\
-	      '\0';
-	  }
+    }
 
-	  readFromListen_port=0; // reset listenfd listen
-	  memset(getset_reply, 0, sizeof(getset_reply));
-	  memset(buf,0,sizeof(buf));
+    LoadConfig(DEFAULT_RCFILE);
+
+    for (unit=0;unit<MAX_ML-1;unit++) {
+      if (shm_addr->MODS.host[unit]==0);
+      else if (shm_addr->MODS.host[unit]==1 &&
+	       !strncasecmp(shm_addr->MODS.who[unit],"rimcs",5) ||
+	       !strncasecmp(shm_addr->MODS.who[unit],"bimcs",5) ||
+	       !strncasecmp(shm_addr->MODS.who[unit],"agw",3));
+      else
+	if (unit!=MAX_ML-1) {
+	  mlcClosePort(unit);
+	  mlcOpenPort(unit);
 	}
+    }
+
+    isisStatusMsg((char*)"MODS instance has been reconfigured and communication to mechanisms have been reestablished");
+
+    mmcLOGGER(shm_addr->MODS.LLOG,(char*)"MODS instance has been reconfigured and communication to mechanisms have been reestablished");
+    appClient.KeepGoing=4; // Reconfigure AGW and open comm.
+
+    client.KeepGoing=1;
+  }
+
+  queueReleaseAll();
+  pthread_mutex_unlock(&ctlLock);
+}
+
+//------------------------------------------------
+//
+// Request queue: queueRequest() and nextRequest()
+//
+
+// Give a complete request to the workers
+
+void
+queueRequest(mmcRequest *req)
+{
+  req->next = NULL;
+
+  pthread_mutex_lock(&reqLock);
+  if (reqTail == NULL)
+    reqHead = req;
+  else
+    reqTail->next = req;
+  reqTail = req;
+  pthread_cond_signal(&reqReady);
+  pthread_mutex_unlock(&reqLock);
+}
+
+// Wait for the next request.  Idle workers sleep here.
+
+mmcRequest *
+nextRequest(void)
+{
+  mmcRequest *req;
+
+  pthread_mutex_lock(&reqLock);
+  while (reqHead == NULL)
+    pthread_cond_wait(&reqReady,&reqLock);
+  req = reqHead;
+  reqHead = req->next;
+  if (reqHead == NULL) reqTail = NULL;
+  pthread_mutex_unlock(&reqLock);
+
+  return req;
+}
+
+// Next ieb_msg[] slot in shared memory for logging a command
+
+int
+nextSlot(void)
+{
+  int slot;
+
+  pthread_mutex_lock(&slotLock);
+  if(shm_addr->MODS.mmcServerCounter >= MAX_ML-2) {
+    shm_addr->MODS.mmcServerCounter=0;
+    cmdCounter++;
+  } else {
+    shm_addr->MODS.mmcServerCounter++;
+    cmdCounter++;
+  }
+  slot = shm_addr->MODS.mmcServerCounter;
+  pthread_mutex_unlock(&slotLock);
+
+  return slot;
+}
+
+//------------------------------------------------
+//
+// TCP input framing: takeCommand() and hasCommand()
+//
+// Commands end with a NUL, newline, or carriage return.  Called by
+// the main thread, or for sessions by either thread under sessLock.
+//
+
+// Move the first command in req->in into req->buf.  If all is set, or
+// in[] is full, unterminated input is taken as a command.  Returns 1
+// if a command was taken, 0 if none is complete.
+
+int
+takeCommand(mmcRequest *req, int all)
+{
+  int i;
+
+  for (i=0; i<req->inLen; i++)
+    if (req->in[i]=='\0' || req->in[i]=='\n' || req->in[i]=='\r') break;
+
+  if (i == req->inLen && !all && req->inLen < ISIS_MSGSIZE-1) return 0;
+  if (i == 0 && req->inLen == 0) return 0;
+
+  memcpy(req->buf,req->in,i);
+  req->buf[i] = '\0';
+  if (i < req->inLen) i++; // drop the terminator
+  req->inLen -= i;
+  memmove(req->in,&req->in[i],req->inLen);
+  return 1;
+}
+
+// Is there a command for a session worker to take?
+
+int
+hasCommand(mmcRequest *req)
+{
+  if (req->inLen == 0) return 0;
+  if (req->closed || req->inLen >= ISIS_MSGSIZE-1) return 1;
+  return (memchr(req->in,'\0',req->inLen) != NULL ||
+	  memchr(req->in,'\n',req->inLen) != NULL ||
+	  memchr(req->in,'\r',req->inLen) != NULL);
+}
+
+// Send all of a reply on a non-blocking socket, waiting up to
+// MMC_SENDWAIT msec for a slow reader
+
+int
+sendAll(int fd, char *msg, int len)
+{
+  struct pollfd pfd;
+  int n;
+
+  while (len > 0) {
+    n = send(fd, msg, len, MSG_NOSIGNAL);
+    if (n > 0) {
+      msg += n;
+      len -= n;
+      continue;
+    }
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      pfd.fd = fd;
+      pfd.events = POLLOUT;
+      if (poll(&pfd,1,MMC_SENDWAIT) > 0) continue;
+    }
+    return -1;
+  }
+  return 0;
+}
+
+//------------------------------------------------
+//
+// Worker functions: runCommand(), sessionCommands(), requestWorker()
+//
+
+// Run the TCP command in req->buf and leave the reply in req->reply
+
+void
+runCommand(mmcRequest *req, int wid)
+{
+  int ierr;
+  int slot;
+  char tempbuf[80]; // command saved in shared memory
+
+  if (strstr(req->buf,"geterrormsg")) {
+    req->reply[0] = '\0';
+    pthread_mutex_lock(&errLock);
+    for (ierr=0; ierr<errmsgs.err_cnt; ierr++)
+      strcat(req->reply,errmsgs.errors[ierr]);
+    pthread_mutex_unlock(&errLock);
+    return;
+  }
+
+  // Save time and who sent command in Shared Memory
+
+  mmcLOGGER(shm_addr->MODS.LLOG,req->buf);
+  strncpy(tempbuf,req->buf,79);
+  tempbuf[79]='\0';
+  slot = nextSlot();
+  sprintf(shm_addr->MODS.ieb_msg[slot],"[%d] %s,t%d,fd%d %s",slot,getDateTime(),wid,req->fd,tempbuf);
+
+  memset(req->reply,0,ISIS_MSGSIZE);
+  KeyCommand(req->buf,req->reply);
+  mmcLOGGER(shm_addr->MODS.LLOG,req->reply);
+
+  if (strstr(req->reply,"ERROR")) {
+    pthread_mutex_lock(&errLock);
+    if (errmsgs.err_cnt >= 24) errmsgs.err_cnt=0;
+    else errmsgs.err_cnt++;
+    strncpy(errmsgs.errors[errmsgs.err_cnt],req->reply,126);
+    errmsgs.errors[errmsgs.err_cnt][126]='\0';
+    strcat(errmsgs.errors[errmsgs.err_cnt],"\n");
+    pthread_mutex_unlock(&errLock);
+  }
+}
+
+// Run a session's commands in order until none are left.  The main
+// thread queues a session only when it is idle and has a command, so
+// only one worker at a time runs it.  Replies end with a NUL.
+
+void
+sessionCommands(mmcRequest *req, int wid)
+{
+  struct epoll_event ev;
+  int done;
+
+  while (1) {
+    pthread_mutex_lock(&sessLock);
+    if (!takeCommand(req,req->closed)) {
+      req->busy = 0;
+      done = req->closed;
+      pthread_mutex_unlock(&sessLock);
+      if (done) {
+	close(req->fd);
+	free(req);
       }
+      return;
+    }
+    if (req->paused && !req->closed) { // room again, resume reading
+      ev.events = EPOLLIN;
+      ev.data.ptr = req;
+      epoll_ctl(epfd,EPOLL_CTL_MOD,req->fd,&ev);
+      req->paused = 0;
+    }
+    pthread_mutex_unlock(&sessLock);
+
+    if (req->buf[0] == '\0') continue; // blank line
+
+    runCommand(req,wid);
+    if (sendAll(req->fd,req->reply,strlen(req->reply)+1) < 0) {
+      pthread_mutex_lock(&sessLock);
+      req->inLen = 0;  // client is gone, drop the rest
+      pthread_mutex_unlock(&sessLock);
+      shutdown(req->fd,SHUT_RDWR); // main thread will see it closed
+    }
+
+    serviceControl();
+  }
+}
+
+void
+*requestWorker(void *arg)
+{
+  int wid = (long long) arg;
+  int slot;
+  char tempbuf[80]; // command saved in shared memory
+  mmcRequest *req;
+
+  while(1) {
+
+    req = nextRequest();
+
+    if (req->session) {
+      sessionCommands(req,wid);
+      continue;
+    }
+
+    if (req->fd < 0) { // This goes out to the isis server
+
+      // Save time and who sent command in Shared Memory
+
+      mmcLOGGER(shm_addr->MODS.LLOG,req->buf);
+      strncpy(tempbuf,req->buf,79);
+      tempbuf[79]='\0';
+      slot = nextSlot();
+      sprintf(shm_addr->MODS.ieb_msg[slot],"[%d] %s,t%d,fd%d %s",slot,getDateTime(),wid,client.FD,tempbuf);
+
+      SocketCommand(req->buf);
+    }
+    else { // This bypasses ISIS
+      runCommand(req,wid);
+      sendAll(req->fd,req->reply,strlen(req->reply));
+      close(req->fd);
+    }
+
+    serviceControl();
+
+    free(req);
+  }
+}
+
+//------------------------------------------------
+//
+// Main thread reactor: acceptConnections(), readInput(), etc.
+//
+// The main thread does all of the socket waiting with epoll, and only
+// hands complete requests to the workers.  The epoll data pointer
+// identifies the source: NULL for the listen socket, &client for the
+// ISIS socket, otherwise the request context of a TCP connection.
+//
+
+// Accept all pending TCP connections
+
+void
+acceptConnections(void)
+{
+  int fd;
+  mmcRequest *req;
+  struct epoll_event ev;
+
+  while ((fd = accept(listenfd, NULL, NULL)) >= 0) {
+    nonblock(fd);
+    req = (mmcRequest *)calloc(1,sizeof(mmcRequest));
+    if (req == NULL) {
+      mmcLOGGER(shm_addr->MODS.LLOG,(char*)"mmcServer: out of memory for request, connection dropped");
+      close(fd);
+      continue;
     }
+    req->fd = fd;
+    ev.events = EPOLLIN;
+    ev.data.ptr = req;
+    if (epoll_ctl(epfd,EPOLL_CTL_ADD,fd,&ev) < 0) {
+      close(fd);
+      free(req);
+      continue;
+    }
+    req->next = readList;
+    readList = req;
   }
 }
 
-// Thread chooser
+// Read what has arrived on a TCP connection into req->in.  Returns 1
+// if the connection is still open, 0 if the client closed it or it
+// failed.
 
 int
-choose_thread()
+readInput(mmcRequest *req)
 {
-  int i=MAX_THREAD-1;
-  int min = 0;
-  while(i > -1) {
-    if(threads[i].client_count < threads[i-1].client_count) {
-      min = i;
+  int n;
+
+  while (req->inLen < ISIS_MSGSIZE-1) {
+    n = recv(req->fd, &req->in[req->inLen], ISIS_MSGSIZE-1-req->inLen, 0);
+    if (n == 0) return 0;
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    if (req->inLen == 0) req->t0 = msecNow();
+    req->inLen += n;
+  }
+  return 1;
+}
+
+// Stop watching a new TCP connection.  If done is set the request in
+// req->buf goes to the workers, otherwise the connection is closed.
+
+void
+finishRead(mmcRequest *req, int done)
+{
+  mmcRequest **rp;
+
+  epoll_ctl(epfd,EPOLL_CTL_DEL,req->fd,NULL);
+  for (rp=&readList; *rp!=NULL; rp=&(*rp)->next) {
+    if (*rp == req) {
+      *rp = req->next;
       break;
     }
-    i--;
   }
-  return min;
+  if (done) {
+    if (client.isVerbose) cout << "mmcServer: fd" << req->fd << " " << req->buf << endl;
+    queueRequest(req);
+  }
+  else {
+    close(req->fd);
+    free(req);
+  }
+}
+
+// Make a new TCP connection a persistent session.  Input that came
+// with the session command is kept for the first commands.
+
+void
+startSession(mmcRequest *req)
+{
+  mmcRequest **rp;
+  const char *ok = "DONE: SESSION";
+
+  for (rp=&readList; *rp!=NULL; rp=&(*rp)->next) {
+    if (*rp == req) {
+      *rp = req->next;
+      break;
+    }
+  }
+  req->session = 1;
+  if (client.isVerbose) cout << "mmcServer: fd" << req->fd << " session started" << endl;
+  sendAll(req->fd,(char *)ok,strlen(ok)+1);
+
+  if (hasCommand(req)) {
+    req->busy = 1;
+    queueRequest(req);
+  }
+}
+
+// Session input from the client.  Commands are left in req->in for the
+// session's worker, which is started if the session is idle.
+
+void
+sessionInput(mmcRequest *req, int hangup)
+{
+  struct epoll_event ev;
+  int isOpen;
+
+  pthread_mutex_lock(&sessLock);
+
+  isOpen = readInput(req) && !(hangup && req->inLen >= ISIS_MSGSIZE-1);
+  if (!isOpen) {
+    req->closed = 1;
+    epoll_ctl(epfd,EPOLL_CTL_DEL,req->fd,NULL);
+  }
+  else if (req->inLen >= ISIS_MSGSIZE-1) { // full, wait for the worker
+    ev.events = 0;
+    ev.data.ptr = req;
+    epoll_ctl(epfd,EPOLL_CTL_MOD,req->fd,&ev);
+    req->paused = 1;
+  }
+
+  if (!req->busy) {
+    if (hasCommand(req)) {
+      req->busy = 1;
+      queueRequest(req);
+    }
+    else if (req->closed) {
+      pthread_mutex_unlock(&sessLock);
+      if (client.isVerbose) cout << "mmcServer: fd" << req->fd << " session closed" << endl;
+      close(req->fd);
+      free(req);
+      return;
+    }
+  }
+
+  pthread_mutex_unlock(&sessLock);
+}
+
+// Input on a new TCP connection.  The first command is run once and
+// the connection closed, unless it is the session command.
+
+void
+requestInput(mmcRequest *req)
+{
+  int isOpen;
+
+  isOpen = readInput(req);
+  if (takeCommand(req,!isOpen)) {
+    if (isOpen && !strcasecmp(req->buf,"session"))
+      startSession(req);
+    else
+      finishRead(req,1);
+  }
+  else if (!isOpen)
+    finishRead(req,0);
+}
+
+// epoll_wait() timeout: forever unless a new connection has a partial
+// request waiting for its terminator, in which case MMC_REQWAIT msec.
+// Partial requests older than that are taken as complete.
+
+int
+expireRequests(void)
+{
+  mmcRequest *req;
+  mmcRequest *nextReq;
+  long now = msecNow();
+  int wait = -1;
+
+  for (req=readList; req!=NULL; req=nextReq) {
+    nextReq = req->next;
+    if (req->inLen == 0) continue;
+    if (now - req->t0 >= MMC_REQWAIT) {
+      takeCommand(req,1);
+      finishRead(req,1);
+    }
+    else
+      wait = MMC_REQWAIT;
+  }
+  return wait;
 }
 
 //
@@ -471,7 +859,6 @@ main(int argc, char *argv[])
 {
   char c;
   struct sockaddr_in srv, cli;
-  int tid;
   int i;
   int n;
   int unit;
@@ -481,17 +868,18 @@ main(int argc, char *argv[])
   int ieb2ID;
   int iebRedOnOff;
   int iebBlueOnOff;
-  int choosen;
   int n_ready;
   short onoff[1];
   char temp[PAGE_SIZE];
   char HALTKey[10];
-  static int sel_wid; 
+  int wait;
+  struct epoll_event ev;
+  struct epoll_event events[MMC_MAXEVENTS];
+  mmcRequest *req;
 
   // Basic initializations
 
   setup_ids();
-  sel_wid = getdtablesize();
   
   signal(SIGCHLD,sig_chld); // Avoid "zombie" process generation.
   signal(SIGINT,HandleInt);    // Ctrl+C sends a move abort to controller
@@ -537,13 +925,12 @@ main(int argc, char *argv[])
       shm_addr->MODS.busy[unit]=0; // initialize
     }
   }
+  mechIndexBuild();  // unused units were renamed
+  cmdIndexBuild();
 
   // In keeping with various other instruments provide by OSU we also
   // need to 'listen()'
 
-  readFromListen_port=0;
-  charReceived=0;
-
   for(i = 0; i < MAX_ML-1; i++) {
     sprintf(shm_addr->MODS.ieb_msg[i],"Empty");
   }
@@ -694,8 +1081,8 @@ main(int argc, char *argv[])
       if (unit!=MAX_ML-1) {
 	if ((shm_addr->MODS.ieb_i[unit]==iebRedOnOff) ||
 	    (shm_addr->MODS.ieb_i[unit]==iebBlueOnOff)) {
-	  CloseTTYPort(&shm_addr->MODS.commport[unit]); // Close before opening
-	  if (OpenTTYPort(&shm_addr->MODS.commport[unit]) < 0) {
+	  mlcClosePort(unit); // Close before opening
+	  if (mlcOpenPort(unit) < 0) {
 	    os << "ERROR: MODS MLC" << unit+1 << " , " 
 	       << shm_addr->MODS.who[unit]
 	       << ", " << shm_addr->MODS.commport[unit].Port
@@ -723,6 +1110,12 @@ main(int argc, char *argv[])
     exit(1);
   }
 
+  // The server closes every connection, so allow a restart while old
+  // connections are still in TIME_WAIT
+
+  n = 1;
+  setsockopt(listenfd, SOL_SOCKET, SO_REUSEADDR, &n, sizeof(n));
+
   shm_addr->MODS.modsPorts[2]=PORT; // Save the Port number in shared memory
 
   bzero(&srv, sizeof(srv));
@@ -738,128 +1131,101 @@ main(int argc, char *argv[])
     exit(1);
   }
 
-  listen(listenfd, 1024);
+  if (listen(listenfd, 1024) < 0) {
+    sprintf(buf,"mmcServer: Socket listen failed %s",strerror(errno));
+    mmcLOGGER(shm_addr->MODS.LLOG,buf);
+    perror("listen\n");
+    exit(1);
+  }
+  nonblock(listenfd); // accept() in a loop until none are left
 
   //nonblock(client.FD); // Make ISIS client non-blocking
 
-  // Initialize the mutex lock
-  
-  // pthread_mutex_init(&lock,NULL);
+  // Watch the listen socket and, if enabled, this app's ISIS socket
 
-  // Create the threads
-  
-  for(i = 0; i < MAX_THREAD; i++) {
-    //pthread_create(&threads[i].tid, NULL, &thread_init_func, (void *)i);
-    pthread_create(&threads[i].tid, NULL, &thread_init_func, (void *)(long long)(i));
-    threads[i].client_count = 0;
+  if ((epfd = epoll_create1(0)) < 0) {
+    sprintf(buf,"mmcServer: epoll_create1 failed %s",strerror(errno));
+    mmcLOGGER(shm_addr->MODS.LLOG,buf);
+    perror("epoll_create1\n");
+    exit(1);
   }
 
-  client.KeepGoing = 1;
+  ev.events = EPOLLIN;
+  ev.data.ptr = NULL;
+  epoll_ctl(epfd,EPOLL_CTL_ADD,listenfd,&ev);
 
-  while (client.KeepGoing) {
+  if (client.FD > 0) {
+    ev.events = EPOLLIN;
+    ev.data.ptr = &client;
+    epoll_ctl(epfd,EPOLL_CTL_ADD,client.FD,&ev);
+  }
 
-    MilliSleep(1);
+  // Start the MicroLynx state poller, then create the worker threads
 
-    // clear the table of active file descriptors
-    FD_ZERO(&read_fd);
+  startStatePoller();
 
-    // we always listen to the listen IP and Socket
-    if (listenfd > 0) FD_SET(listenfd, &read_fd);
+  for(i = 0; i < MMC_WORKERS; i++) {
+    pthread_create(&workers[i], NULL, &requestWorker, (void *)(long long)(i));
+  }
 
-    // if enabled, listen to this app's ISIS socket
-    if (client.FD > 0) FD_SET(client.FD, &read_fd);
+  client.KeepGoing = 1;
+  wait = -1;
+
+  while (client.KeepGoing) {
 
-    n_ready = 0; // Do the select() call and wait for activity from anyone
-    n_ready = select(sel_wid, &read_fd, NULL, NULL, NULL);
+    // Wait for activity from anyone, no timeout unless a TCP request
+    // is waiting for its terminator
 
-    if (n_ready == 0) { // would be a timeout if enabled, do nothing...
-      cout << "select() interrupted by Ctrl+C..." << endl;
-      continue;
+    n_ready = epoll_wait(epfd, events, MMC_MAXEVENTS, wait);
 
-    } else if (n_ready < 0) {
+    if (n_ready < 0) {
       if (errno == EINTR) { // caught Ctrl+C, hopefully sigint handler caught it
 	if (client.isVerbose)
-	  cout << "select() interrupted by Ctrl+C...\n";
+	  cout << "epoll_wait() interrupted by Ctrl+C...\n";
 
       } else { // something else bad happened, let us know
-	cout << "Warning: select() failed - " << strerror(errno) 
+	cout << "Warning: epoll_wait() failed - " << strerror(errno)
 	     << " - pressing on anyway...\n";
       }
       continue;
+    }
 
-    } else { // somebody wants something, figure out who...
-
-      if (FD_ISSET(client.FD, &read_fd)) {  // Client socket input
-	memset(buf,0,sizeof(buf));
-	if (charReceived=ReadClientSocket(&client,buf)>0) {
-	  if (client.isVerbose) cout << "mmcServer: " << buf << endl;
-	  readFromListen_port=2;
-	  if(shm_addr->MODS.mmcServerCounter >= MAX_ML-2) {
-	    shm_addr->MODS.mmcServerCounter=0;
-	    cmdCounter++;
-	  } else {
-	    shm_addr->MODS.mmcServerCounter++;
-	    cmdCounter++;
-	  }
-	  if (client.isVerbose)
-	    cout << " ISIS_port=" << readFromListen_port << ", client.FD=" << client.FD << endl;
-	  
-	}
-      }
+    for (i = 0; i < n_ready; i++) {  // somebody wants something, figure out who...
 
-      if (FD_ISSET(listenfd, &read_fd)) {  // Client socket input
-	memset(buf,0,sizeof(buf));
-	readFromListen_port=1;
-	if(shm_addr->MODS.mmcServerCounter >= MAX_ML-2) {
-	  shm_addr->MODS.mmcServerCounter=0;
-	  cmdCounter++;
-	} else {
-	  shm_addr->MODS.mmcServerCounter++;
-	  cmdCounter++;
+      if (events[i].data.ptr == NULL) { // new TCP connection(s)
+	acceptConnections();
+      }
+      else if (events[i].data.ptr == &client) {  // ISIS socket input
+	req = (mmcRequest *)calloc(1,sizeof(mmcRequest));
+	if (req == NULL) {
+	  ReadClientSocket(&client,buf);  // drop it
+	  continue;
+	}
+	req->fd = -1;
+	if (ReadClientSocket(&client,req->buf)>0) {
+	  if (client.isVerbose) cout << "mmcServer: " << req->buf << endl;
+	  queueRequest(req);
 	}
-      	if (client.isVerbose)
-      	  cout << " Listen_port=" << readFromListen_port << ", clifd=" << clifd << endl;
+	else
+	  free(req);
       }
-
-      pthread_mutex_lock(&new_connection_mutex);
-      
-      choosen = choose_thread();
-      
-      for(i = 0; i < MAX_CLIENT_PER_THREAD; i++) {
-	if(threads[choosen].clients[i] == 0) {
-	  if(readFromListen_port==1) { // for listen protocol
-	    clifd = accept(listenfd, NULL, NULL);
-	    //nonblock(clifd);
-	    threads[choosen].clients[i] = clifd;
-	    threads[choosen].client_count++;
-	    break;
-	  } else if(readFromListen_port==2) { // for ISIS protocol
-	    threads[choosen].clients[i] = client.FD;
-	    threads[choosen].client_count++;
-	    break;
-	  }
-	}	
+      else {  // TCP request data
+	req = (mmcRequest *)events[i].data.ptr;
+	if (req->session)
+	  sessionInput(req,(events[i].events & (EPOLLHUP|EPOLLERR)));
+	else
+	  requestInput(req);
       }
     }
 
-    for(i = 0; i < MAX_THREAD; i++) {
-      if (client.isVerbose)
-	cout << "threads[" << i << "].client_count: "
-	     << threads[i].client_count
-	     << "thread_id:" << threads[i].tid 
-	     << endl;
-    }
-    
-    pthread_mutex_unlock(&new_connection_mutex);
+    wait = expireRequests();
 
-  } // end of select() I/O handling checking
+  } // end of epoll() I/O handling checking
 
   if(errno) {
     cout << "errno: " << errno << endl;
   }
 
-  // pthread_mutex_destroy(&lock);
-  
   return 0;
 }
 
@@ -868,7 +1234,6 @@ main(int argc, char *argv[])
 void
 HandleInt(int signalValue) 
 {
-  int i;
   int unit;
   char dummy[79];
 
@@ -881,7 +1246,7 @@ HandleInt(int signalValue)
 	    !strncasecmp(shm_addr->MODS.who[unit],"agw",3));
     else
       if(unit!=MAX_ML-1) {
-	CloseTTYPort(&shm_addr->MODS.commport[unit]);
+	mlcClosePort(unit);
 	sprintf(dummy,"mmcServer %s connection CLOSED",
 		shm_addr->MODS.who[unit]);
 	mmcLOGGER(shm_addr->MODS.LLOG,dummy);
@@ -894,15 +1259,6 @@ HandleInt(int signalValue)
   cout << "mmcServers have been halted by a 'killall -s SIGINT mmcServer'"
        << endl;
 
-  memset(buf,0,sizeof(buf));
-  for(i = 0; i < MAX_THREAD; i++) {
-    threads[i].clients[i] = 0;
-    threads[i].client_count = 0;
-  }
-  if(clifd>0) {
-    close(clifd);
-  }
-
   client.KeepGoing = 0;
 
   exit(0); // exit mmcServer
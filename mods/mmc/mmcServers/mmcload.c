@@ -0,0 +1,563 @@
+//
+// mmcload - concurrent request load generator for the mmcServer
+//
+// Date:
+//   2026 October 17
+//
+// Modification History:
+//
+
+/*!
+  \mainpage mmcload - mmcServer load generator
+
+  \date 2026 October 17
+
+  \section Usage Usage
+
+  \verbatim
+  mmcload [-h host] [-p port] [-n tcp] [-S depth] [-u isis] [-I port]
+          [-m nodeID] [-s serverID] [-c cmd] [-d sec] [-o file]
+  \endverbatim
+
+  Where:
+  <pre>
+   -h host      mmcServer (and ISIS server) host (default: localhost)
+   -p port      mmcServer TCP port (default: 10435)
+   -n tcp       number of concurrent TCP clients (default: 16)
+   -S depth     TCP clients use persistent sessions with depth commands in flight
+   -u isis      number of concurrent ISIS clients (default: 0)
+   -I port      UDP port ISIS clients send to (default: 10700)
+   -m nodeID    mmcServer ISIS node ID (default: M1.IE)
+   -s serverID  ISIS server node ID, if -I is an ISIS server port
+   -c cmd       command to send (default: a unique unknown command)
+   -d sec       test duration in seconds (default: 10)
+   -o file      append the results line to file as well as printing it
+  </pre>
+
+  \section Intro Description
+
+  Runs closed-loop clients against a running mmcServer, each in its
+  own thread with one request in flight:
+  <ul>
+  <li>TCP clients work like the mmc client applications: connect to the
+      mmcServer port, send one NUL-terminated command, read the reply
+      until the server closes the connection.  With -S each TCP
+      client instead opens one persistent session and keeps depth
+      newline-terminated commands in flight, reading the NUL-terminated
+      replies in order.
+  <li>ISIS clients (node IDs LD00, LD01, ...) send IMPv2 requests by
+      UDP, either straight to a standalone mmcServer (-I its client
+      port) or through an ISIS server (-I the server port and -s its
+      node ID, in which case each client PINGs the server first).
+  </ul>
+
+  By default every request is a unique unknown command like LD03X000042
+  that the mmcServer echoes in its ERROR reply without touching any
+  hardware, so each reply is checked against the request it answers.
+  A reply for some other request is counted as a mismatch, which would
+  mean requests are sharing buffers in the server.  With -c a real
+  command (e.g., ping) is sent instead and only the presence of a reply
+  is checked.  Requests not answered within 2 seconds are counted as
+  timeouts.
+
+  When done it prints one line of keyword=value pairs:
+  \verbatim
+  mmcload TCP=n Depth=n ISIS=n Duration=s Requests=n TcpReqs=n IsisReqs=n
+          Timeouts=n Errors=n Mismatch=n ReqRate=req/s RttMean=us
+          RttP50=us RttP99=us RttP999=us RttMax=us
+  \endverbatim
+  where Errors counts failed connections or sends.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define MSGSIZE      4096      //!< maximum message size
+#define MAXCLIENTS   256       //!< maximum number of TCP plus ISIS clients
+#define HISTSIZE     100000    //!< RTT histogram bins, 1 usec each, plus overflow
+#define TIMEOUT_SEC  2         //!< request timeout
+#define MAXDEPTH     64        //!< maximum session commands in flight
+
+/*!
+  \brief Per-client results
+*/
+
+struct results {
+  long requests;         //!< completed requests
+  long timeouts;         //!< requests that timed out
+  long errors;           //!< failed connections or sends
+  long mismatch;         //!< replies that did not match the request
+  long long sumRtt;      //!< sum of RTTs in ns
+  long long maxRtt;      //!< longest RTT in ns
+  long hist[HISTSIZE+1]; //!< RTT histogram in usec, last bin is overflow
+};
+
+// Test setup, shared read-only by all threads
+
+struct sockaddr_in tcpServer;
+struct sockaddr_in udpServer;
+char nodeID[16] = "M1.IE";
+char serverID[16] = "";
+char *command = NULL;
+int numTCP = 16;
+int depth = 0;
+int numISIS = 0;
+double duration = 10.0;
+pthread_barrier_t startBarrier;
+volatile int stopNow = 0;
+
+/*!
+  \brief Read the monotonic clock
+  \return CLOCK_MONOTONIC time in nanoseconds
+*/
+
+long long
+monoTime(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return((long long)ts.tv_sec*1000000000LL + ts.tv_nsec);
+}
+
+/*!
+  \brief Record a completed request
+  \param res results to count in
+  \param t0 monoTime() when the request was sent
+*/
+
+void
+endRequest(struct results *res, long long t0)
+{
+  long long rtt = monoTime() - t0;
+  long usec = (long)(rtt/1000);
+
+  res->requests++;
+  res->sumRtt += rtt;
+  if (rtt > res->maxRtt) res->maxRtt = rtt;
+  res->hist[(usec < HISTSIZE) ? usec : HISTSIZE]++;
+}
+
+/*!
+  \brief Does a reply answer a request?
+  \param reply reply received
+  \param token unique command sent, or NULL if -c was given
+  \return 1 if it does, 0 if not.
+*/
+
+int
+replyMatches(char *reply, char *token)
+{
+  if (token == NULL) return(strlen(reply) > 0);
+  return(strstr(reply,token) != NULL);
+}
+
+/*!
+  \brief Set the receive timeout on a socket
+  \param fd socket
+*/
+
+void
+setTimeout(int fd)
+{
+  struct timeval tv;
+
+  tv.tv_sec = TIMEOUT_SEC;
+  tv.tv_usec = 0;
+  setsockopt(fd,SOL_SOCKET,SO_RCVTIMEO,&tv,sizeof(tv));
+}
+
+/*!
+  \brief TCP client thread
+  \param arg client number
+  \return the client's results
+
+  One connection per request, as the mmc client applications do.
+*/
+
+void *
+tcpThread(void *arg)
+{
+  int id = (int)(long)arg;
+  struct results *res;
+  char token[32];
+  char reply[MSGSIZE+1];
+  char *cmd;
+  long seq = 0;
+  long long t0;
+  int fd;
+  int len;
+  int n;
+  int one = 1;
+
+  res = (struct results *)calloc(1,sizeof(struct results));
+  pthread_barrier_wait(&startBarrier);
+
+  while (!stopNow) {
+    sprintf(token,"LT%02dX%06ld",id,++seq);
+    cmd = (command != NULL) ? command : token;
+
+    t0 = monoTime();
+    if ((fd = socket(AF_INET,SOCK_STREAM,0)) < 0) {
+      res->errors++;
+      usleep(10000);
+      continue;
+    }
+    setsockopt(fd,IPPROTO_TCP,TCP_NODELAY,&one,sizeof(one));
+    setTimeout(fd);
+    if (connect(fd,(struct sockaddr *)&tcpServer,sizeof(tcpServer)) < 0 ||
+	send(fd,cmd,strlen(cmd)+1,0) < 0) {
+      res->errors++;
+      close(fd);
+      usleep(10000);
+      continue;
+    }
+
+    // Read until the server closes the connection
+
+    len = 0;
+    while (len < MSGSIZE && (n = recv(fd,&reply[len],MSGSIZE-len,0)) > 0)
+      len += n;
+    reply[len] = '\0';
+    close(fd);
+
+    if (len == 0 && n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      res->timeouts++;
+    else if (!replyMatches(reply,(command != NULL) ? NULL : token))
+      res->mismatch++;
+    else
+      endRequest(res,t0);
+  }
+  return(res);
+}
+
+/*!
+  \brief TCP session client thread
+  \param arg client number
+  \return the client's results
+
+  One persistent session, keeping depth commands in flight.  Replies
+  come back in order, so each is checked against the oldest command.
+*/
+
+void *
+sessionThread(void *arg)
+{
+  int id = (int)(long)arg;
+  struct results *res;
+  char token[MAXDEPTH][32];
+  long long t0[MAXDEPTH];
+  char msg[MSGSIZE];
+  char in[MSGSIZE+1];
+  char *cmd;
+  char *end;
+  long seq = 0;
+  int inLen = 0;
+  int head = 0;
+  int numOut = 0;
+  int fd;
+  int len;
+  int n;
+  int one = 1;
+
+  res = (struct results *)calloc(1,sizeof(struct results));
+
+  fd = socket(AF_INET,SOCK_STREAM,0);
+  setsockopt(fd,IPPROTO_TCP,TCP_NODELAY,&one,sizeof(one));
+  setTimeout(fd);
+  if (fd < 0 || connect(fd,(struct sockaddr *)&tcpServer,sizeof(tcpServer)) < 0 ||
+      send(fd,"session\n",8,0) != 8 ||
+      (n = recv(fd,in,MSGSIZE,0)) <= 0 || strcmp(in,"DONE: SESSION") != 0) {
+    printf("ERROR: client %d could not open a session\n",id);
+    exit(1);
+  }
+  pthread_barrier_wait(&startBarrier);
+
+  while (!stopNow) {
+
+    // Fill the pipeline
+
+    while (numOut < depth) {
+      n = (head + numOut) % MAXDEPTH;
+      sprintf(token[n],"LS%02dX%06ld",id,++seq);
+      cmd = (command != NULL) ? command : token[n];
+      len = sprintf(msg,"%s\n",cmd);
+      t0[n] = monoTime();
+      if (send(fd,msg,len,0) != len) {
+	res->errors++;
+	close(fd);
+	return(res);
+      }
+      numOut++;
+    }
+
+    // Next reply, in order
+
+    while ((end = (char *)memchr(in,'\0',inLen)) == NULL) {
+      n = recv(fd,&in[inLen],MSGSIZE-inLen,0);
+      if (n <= 0) {
+	if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+	  res->timeouts++;
+	else
+	  res->errors++;
+	close(fd);
+	return(res);
+      }
+      inLen += n;
+    }
+    if (!replyMatches(in,(command != NULL) ? NULL : token[head]))
+      res->mismatch++;
+    else
+      endRequest(res,t0[head]);
+    head = (head + 1) % MAXDEPTH;
+    numOut--;
+    len = end - in + 1;
+    inLen -= len;
+    memmove(in,&in[len],inLen);
+  }
+  close(fd);
+  return(res);
+}
+
+/*!
+  \brief ISIS client thread
+  \param arg client number
+  \return the client's results
+*/
+
+void *
+isisThread(void *arg)
+{
+  int id = (int)(long)arg;
+  struct results *res;
+  struct sockaddr_in addr;
+  char myID[16];
+  char myToken[16];
+  char token[32];
+  char msg[MSGSIZE];
+  char reply[MSGSIZE+1];
+  long seq = 0;
+  long long t0;
+  int fd;
+  int len;
+  int n;
+  int i;
+
+  res = (struct results *)calloc(1,sizeof(struct results));
+  sprintf(myID,"LD%02d",id);
+
+  fd = socket(AF_INET,SOCK_DGRAM,0);
+  memset(&addr,0,sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (fd < 0 || bind(fd,(struct sockaddr *)&addr,sizeof(addr)) < 0) {
+    printf("ERROR: cannot create ISIS client socket - %s\n",strerror(errno));
+    exit(1);
+  }
+  setTimeout(fd);
+
+  // Handshake with the ISIS server, if any, so it knows our address
+
+  if (strlen(serverID) > 0) {
+    sprintf(msg,"%s>%s PING\r",myID,serverID);
+    for (i=0; i<10; i++) {
+      sendto(fd,msg,strlen(msg),0,(struct sockaddr *)&udpServer,sizeof(udpServer));
+      if (recv(fd,reply,MSGSIZE,0) > 0) break;
+    }
+    if (i == 10) {
+      printf("ERROR: client %s got no PONG from the ISIS server\n",myID);
+      exit(1);
+    }
+  }
+  pthread_barrier_wait(&startBarrier);
+
+  while (!stopNow) {
+    sprintf(token,"LD%02dX%06ld",id,++seq);
+    len = sprintf(msg,"%s>%s %s\r",myID,nodeID,(command != NULL) ? command : token);
+
+    t0 = monoTime();
+    if (sendto(fd,msg,len,0,(struct sockaddr *)&udpServer,sizeof(udpServer)) != len) {
+      res->errors++;
+      usleep(10000);
+      continue;
+    }
+
+    // Wait for our reply, skipping late replies to timed-out requests
+
+    sprintf(myToken,"LD%02dX",id);
+    while (1) {
+      n = recv(fd,reply,MSGSIZE,0);
+      if (n < 0) {
+	res->timeouts++;
+	break;
+      }
+      reply[n] = '\0';
+      if (replyMatches(reply,(command != NULL) ? NULL : token)) {
+	endRequest(res,t0);
+	break;
+      }
+      if (strstr(reply,myToken) == NULL) { // someone else's reply
+	res->mismatch++;
+	break;
+      }
+    }
+  }
+  close(fd);
+  return(res);
+}
+
+/*!
+  \brief Latency at a percentile of the merged histogram
+  \param res merged results
+  \param pct percentile, 0-100
+  \return latency in usec
+*/
+
+long
+percentile(struct results *res, double pct)
+{
+  long target = (long)(pct*0.01*res->requests + 0.5);
+  long count = 0;
+  long i;
+
+  if (target < 1) target = 1;
+  for (i=0; i<HISTSIZE; i++) {
+    count += res->hist[i];
+    if (count >= target) return(i+1);
+  }
+  return(HISTSIZE);
+}
+
+void
+printUsage(void)
+{
+  printf("Usage: mmcload [-h host] [-p port] [-n tcp] [-S depth] [-u isis] [-I port]\n");
+  printf("               [-m nodeID] [-s serverID] [-c cmd] [-d sec] [-o file]\n");
+  printf("  -h host      mmcServer (and ISIS server) host (default: localhost)\n");
+  printf("  -p port      mmcServer TCP port (default: 10435)\n");
+  printf("  -n tcp       number of concurrent TCP clients (default: 16)\n");
+  printf("  -S depth     TCP clients use persistent sessions with depth commands in flight\n");
+  printf("  -u isis      number of concurrent ISIS clients (default: 0)\n");
+  printf("  -I port      UDP port ISIS clients send to (default: 10700)\n");
+  printf("  -m nodeID    mmcServer ISIS node ID (default: M1.IE)\n");
+  printf("  -s serverID  ISIS server node ID, if -I is an ISIS server port\n");
+  printf("  -c cmd       command to send (default: a unique unknown command)\n");
+  printf("  -d sec       test duration in seconds (default: 10)\n");
+  printf("  -o file      append the results line to file as well as printing it\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+  char *host = (char *)"localhost";
+  char *outFile = NULL;
+  int tcpPort = 10435;
+  int udpPort = 10700;
+  pthread_t threads[MAXCLIENTS];
+  struct results total, *res;
+  struct hostent *hostInfo;
+  long tcpReqs = 0;
+  char resultStr[1024];
+  long long tStart, tEnd;
+  double elapsed;
+  FILE *fp;
+  int c;
+  int i, j;
+
+  while ((c = getopt(argc,argv,"h:p:n:S:u:I:m:s:c:d:o:")) != -1) {
+    switch (c) {
+    case 'h': host = optarg; break;
+    case 'p': tcpPort = atoi(optarg); break;
+    case 'n': numTCP = atoi(optarg); break;
+    case 'S': depth = atoi(optarg); break;
+    case 'u': numISIS = atoi(optarg); break;
+    case 'I': udpPort = atoi(optarg); break;
+    case 'm': strncpy(nodeID,optarg,sizeof(nodeID)-1); break;
+    case 's': strncpy(serverID,optarg,sizeof(serverID)-1); break;
+    case 'c': command = optarg; break;
+    case 'd': duration = atof(optarg); break;
+    case 'o': outFile = optarg; break;
+    default:
+      printUsage();
+      exit(1);
+    }
+  }
+  if (optind != argc || numTCP < 0 || numISIS < 0 || numISIS > 100 ||
+      depth < 0 || depth > MAXDEPTH ||
+      numTCP+numISIS < 1 || numTCP+numISIS > MAXCLIENTS || duration <= 0.0) {
+    printUsage();
+    exit(1);
+  }
+
+  if ((hostInfo = gethostbyname(host)) == NULL) {
+    printf("ERROR: unknown host %s\n",host);
+    exit(1);
+  }
+  memset(&tcpServer,0,sizeof(tcpServer));
+  tcpServer.sin_family = AF_INET;
+  memcpy(&tcpServer.sin_addr,hostInfo->h_addr_list[0],hostInfo->h_length);
+  udpServer = tcpServer;
+  tcpServer.sin_port = htons(tcpPort);
+  udpServer.sin_port = htons(udpPort);
+
+  // Run the test
+
+  pthread_barrier_init(&startBarrier,NULL,numTCP+numISIS+1);
+  for (i=0; i<numTCP; i++)
+    pthread_create(&threads[i],NULL,(depth > 0) ? sessionThread : tcpThread,(void *)(long)i);
+  for (i=0; i<numISIS; i++)
+    pthread_create(&threads[numTCP+i],NULL,isisThread,(void *)(long)i);
+  pthread_barrier_wait(&startBarrier);
+  tStart = monoTime();
+  usleep((useconds_t)(duration*1.0e6));
+  stopNow = 1;
+  tEnd = monoTime();
+
+  memset(&total,0,sizeof(total));
+  for (i=0; i<numTCP+numISIS; i++) {
+    pthread_join(threads[i],(void **)&res);
+    if (i < numTCP) tcpReqs += res->requests;
+    total.requests += res->requests;
+    total.timeouts += res->timeouts;
+    total.errors += res->errors;
+    total.mismatch += res->mismatch;
+    total.sumRtt += res->sumRtt;
+    if (res->maxRtt > total.maxRtt) total.maxRtt = res->maxRtt;
+    for (j=0; j<=HISTSIZE; j++)
+      total.hist[j] += res->hist[j];
+    free(res);
+  }
+  elapsed = 1.0e-9*(tEnd-tStart);
+
+  sprintf(resultStr,"mmcload TCP=%d Depth=%d ISIS=%d Duration=%.3f Requests=%ld TcpReqs=%ld "
+	  "IsisReqs=%ld Timeouts=%ld Errors=%ld Mismatch=%ld ReqRate=%.1f "
+	  "RttMean=%.1f RttP50=%ld RttP99=%ld RttP999=%ld RttMax=%.1f",
+	  numTCP,depth,numISIS,elapsed,total.requests,tcpReqs,total.requests-tcpReqs,
+	  total.timeouts,total.errors,total.mismatch,total.requests/elapsed,
+	  (total.requests > 0) ? 0.001*total.sumRtt/total.requests : 0.0,
+	  percentile(&total,50.0),percentile(&total,99.0),percentile(&total,99.9),
+	  0.001*total.maxRtt);
+  printf("%s\n",resultStr);
+
+  if (outFile != NULL) {
+    if ((fp = fopen(outFile,"a")) == NULL)
+      printf("ERROR: cannot append to %s - %s\n",outFile,strerror(errno));
+    else {
+      fprintf(fp,"%s\n",resultStr);
+      fclose(fp);
+    }
+  }
+
+  exit(0);
+}
@@ -0,0 +1,138 @@
+/*!
+  \file mechindex.c
+  \brief mechindex - hashed lookup of mechanism and WAGO names in shared memory
+
+  \date 2026 October 17
+
+  Programs find a mechanism's index by scanning
+  shm_addr->MODS.who[] for the first name that is a substring of the
+  name wanted (and likewise WAGOWHO[] for WAGOs).  These functions keep
+  an open-addressing hash index of both tables in shared memory
+  (whoHash[] and wagoHash[]), built by the mmcServer each time it
+  loads mechanisms.ini, so that an exact name is found with one or two
+  probes by any program that attaches the shared memory.
+
+  Contents:
+  <pre>
+    nameHash()       - case-folded FNV-1a hash of a name
+    mechIndexBuild() - (re)build the who[] and WAGOWHO[] hash indexes
+    mechIndex()      - index of a mechanism name in who[], -1 if not indexed
+    wagoIndex()      - index of a WAGO name in WAGOWHO[], -1 if not indexed
+  </pre>
+
+  A name is only indexed if the linear scan would return it for its
+  own name, i.e., no earlier entry is empty or a substring of it.  A
+  hit is checked against the table before it is returned, so a miss,
+  or an index made stale by another program rewriting who[], only
+  means the caller falls back to its linear scan.
+
+*/
+
+#include <string.h>
+#include <ctype.h>
+
+// No paths!  Use -I in Makefile
+//
+#include "instrutils.h"   // Command action functions header file
+#include "isl_funcs.h"
+#include "isl_types.h"
+#include "params.h"       // Common parameters and defines
+#include "islcommon.h"    // Common parameters and defines
+#include "isl_shmaddr.h"  // Shared memory attachment.
+
+/*!
+  \brief Case-folded FNV-1a hash of a name
+  \param name string to hash
+  \return hash value
+*/
+
+unsigned int
+nameHash(const char *name)
+{
+  unsigned int h = 2166136261u;
+
+  for (; *name; name++) {
+    h ^= (unsigned char)tolower((unsigned char)*name);
+    h *= 16777619u;
+  }
+  return h;
+}
+
+// Build the hash index of a table of count names, each size chars long
+
+static void
+nameIndexBuild(char *names, int size, int count, short index[], int slots)
+{
+  char *name;
+  int i, k, slot;
+
+  memset(index,0,slots*sizeof(short));
+
+  for (i=0; i<count; i++) {
+    name = names + i*size;
+    if (strlen(name) == 0) break;  // the linear scan stops here for every name
+    for (k=0; k<i && !strstr(name,names+k*size); k++);
+    if (k < i) continue;           // an earlier entry would match first
+
+    slot = nameHash(name) & (slots-1);
+    while (index[slot] != 0) slot = (slot+1) & (slots-1);
+    index[slot] = i+1;
+  }
+}
+
+// Look up an exact name in a hash index, -1 if not found
+
+static int
+nameIndexFind(char *name, char *names, int size, short index[], int slots)
+{
+  int slot, n;
+
+  slot = nameHash(name) & (slots-1);
+  for (n=0; n<slots && index[slot] != 0; n++) {
+    if (strcmp(names+(index[slot]-1)*size,name) == 0) return index[slot]-1;
+    slot = (slot+1) & (slots-1);
+  }
+  return -1;
+}
+
+/*!
+  \brief (Re)build the mechanism and WAGO name hash indexes
+
+  Must be called by whoever changes who[] or WAGOWHO[], i.e., after
+  the mmcServer loads mechanisms.ini.
+*/
+
+void
+mechIndexBuild(void)
+{
+  nameIndexBuild(&shm_addr->MODS.who[0][0],sizeof(shm_addr->MODS.who[0]),
+		 MAX_ML-1,shm_addr->MODS.whoHash,MECH_HASHSIZE);
+  nameIndexBuild(&shm_addr->MODS.WAGOWHO[0][0],sizeof(shm_addr->MODS.WAGOWHO[0]),
+		 6,shm_addr->MODS.wagoHash,WAGO_HASHSIZE);
+}
+
+/*!
+  \brief Index of a mechanism in shared memory
+  \param name mechanism name, exact (e.g., "rgrating")
+  \return index in who[], or -1 if the name is not indexed
+*/
+
+int
+mechIndex(char name[])
+{
+  return nameIndexFind(name,&shm_addr->MODS.who[0][0],sizeof(shm_addr->MODS.who[0]),
+		       shm_addr->MODS.whoHash,MECH_HASHSIZE);
+}
+
+/*!
+  \brief Index of a WAGO in shared memory
+  \param name WAGO name, exact (e.g., "llb")
+  \return index in WAGOWHO[], or -1 if the name is not indexed
+*/
+
+int
+wagoIndex(char name[])
+{
+  return nameIndexFind(name,&shm_addr->MODS.WAGOWHO[0][0],sizeof(shm_addr->MODS.WAGOWHO[0]),
+		       shm_addr->MODS.wagoHash,WAGO_HASHSIZE);
+}